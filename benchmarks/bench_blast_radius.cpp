@@ -0,0 +1,108 @@
+/**
+ * bench_blast_radius.cpp - Files per second: parallel getdents64/statx walk vs recursive_directory_iterator
+ *
+ *   bench_blast_radius [files] [dir]
+ *
+ * Builds a synthetic tree of `files` small files (100 per directory, three
+ * levels deep) under `dir`, or walks `dir` as is when `files` is 0, e.g.
+ * `bench_blast_radius 0 /usr`. Each walk runs after a warm-up pass, so the
+ * numbers are for a hot dentry cache, which is what a confirmation prompt
+ * right after the command was typed sees.
+ */
+
+#include "tt/BlastRadius.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+void buildTree(const fs::path& root, size_t files) {
+    constexpr size_t PER_DIR = 100;
+    for (size_t i = 0; i < files; ++i) {
+        size_t dir = i / PER_DIR;
+        fs::path parent = root / ("a" + std::to_string(dir / 100)) / ("b" + std::to_string(dir % 100 / 10)) /
+                          ("c" + std::to_string(dir % 10));
+        if (i % PER_DIR == 0) fs::create_directories(parent);
+        std::ofstream(parent / ("f" + std::to_string(i % PER_DIR))) << i;
+    }
+}
+
+struct Baseline {
+    uint64_t files = 0;
+    uint64_t bytes = 0;
+};
+
+Baseline walkBaseline(const fs::path& root) {
+    Baseline out;
+    std::error_code ec;
+    for (fs::recursive_directory_iterator it(root, fs::directory_options::skip_permission_denied, ec), end;
+         it != end; it.increment(ec)) {
+        if (ec) continue;
+        if (!it->is_directory(ec) || it->is_symlink(ec)) {
+            ++out.files;
+            if (it->is_regular_file(ec)) out.bytes += it->file_size(ec);
+        }
+    }
+    return out;
+}
+
+template <typename Fn>
+double seconds(Fn&& fn) {
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+} // anonymous namespace
+
+int main(int argc, char* argv[]) {
+    size_t files = argc > 1 ? std::stoul(argv[1]) : 200000;
+    fs::path root = argc > 2 ? fs::path(argv[2]) : fs::temp_directory_path() / "tt_bench_blast_radius";
+
+    if (files > 0) {
+        fs::remove_all(root);
+        double build = seconds([&] { buildTree(root, files); });
+        std::printf("built %zu files in %.1f s\n", files, build);
+    }
+
+    tt::ImpactOptions options;
+    options.budget = std::chrono::hours(1);
+    tt::measurePaths({root.string()}, options);  // Warm the dentry and inode caches
+
+    Baseline baseline;
+    double baseline_secs = seconds([&] { baseline = walkBaseline(root); });
+    std::printf("\n%-32s %10s %12s %10s\n", "walk", "ms", "files/s", "files");
+    std::printf("%-32s %10.1f %12.0f %10llu\n", "recursive_directory_iterator", baseline_secs * 1e3,
+                static_cast<double>(baseline.files) / baseline_secs, static_cast<unsigned long long>(baseline.files));
+
+    unsigned hardware = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<unsigned> counts;
+    for (unsigned threads = 1; threads < hardware; threads *= 2) counts.push_back(threads);
+    counts.push_back(hardware);
+    for (unsigned threads : counts) {
+        options.threads = threads;
+        tt::ImpactReport report;
+        double secs = seconds([&] { report = tt::measurePaths({root.string()}, options); });
+        std::string name = "measurePaths, " + std::to_string(threads) + " thread(s)";
+        std::printf("%-32s %10.1f %12.0f %10llu\n", name.c_str(), secs * 1e3,
+                    static_cast<double>(report.files) / secs, static_cast<unsigned long long>(report.files));
+        if (report.files != baseline.files) std::printf("  count differs from baseline (%llu)\n",
+                                                        static_cast<unsigned long long>(baseline.files));
+    }
+
+    // What the confirmation prompt gets within its default budget
+    tt::ImpactReport budgeted = tt::measurePaths({root.string()});
+    std::printf("\ndefault budget: %llu files in %.0f ms, %s\n", static_cast<unsigned long long>(budgeted.files),
+                budgeted.elapsed_ms, budgeted.complete ? "complete" : "partial");
+
+    if (files > 0) fs::remove_all(root);
+    return 0;
+}
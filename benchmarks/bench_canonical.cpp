@@ -0,0 +1,151 @@
+/**
+ * bench_canonical.cpp - Cache hit rate of raw vs canonical command keys
+ *
+ *   bench_canonical [history-file]...
+ *   bench_canonical --synthetic [lines] [seed]
+ *
+ * Replays shell history entries in order against a cache keyed first on the
+ * raw command text, then on canonicalizeCommand(). An entry hits when an
+ * earlier one had the same key, which is what an explanation cache keyed
+ * that way would have answered without a model call. Accepts bash, zsh
+ * (plain or extended) and fish history files; with no arguments reads
+ * ~/.bash_history and ~/.zsh_history.
+ *
+ * The synthetic corpus always spells a command the same way, so
+ * --synthetic mixes in respellings of a few commands (bundles split or
+ * reordered, options after operands) that differ only in ways the
+ * canonical form removes.
+ */
+
+#include "shell_corpus.hpp"
+#include "tt/CommandCanonicalizer.hpp"
+#include "tt/QuestionClassifier.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+namespace {
+
+// One entry per line; timestamps and format prefixes removed
+void readHistory(const std::string& path, std::vector<std::string>& out) {
+    std::ifstream file(path);
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.size() > 1 && line[0] == '#' && line.find_first_not_of("0123456789", 1) == std::string::npos) {
+            continue;  // bash HISTTIMEFORMAT stamp
+        }
+        if (line.rfind(": ", 0) == 0) {
+            size_t semi = line.find(';');
+            if (semi != std::string::npos) line.erase(0, semi + 1);  // zsh ": <epoch>:<duration>;"
+        } else if (line.rfind("- cmd: ", 0) == 0) {
+            line.erase(0, 7);  // fish
+        } else if (line.rfind("  when: ", 0) == 0 || line.rfind("  paths:", 0) == 0) {
+            continue;
+        }
+        if (!line.empty()) out.push_back(std::move(line));
+    }
+}
+
+// Each row runs one command; options that override each other keep their order
+const char* const SPELLINGS[][4] = {
+    {"ls -la {p}", "ls -al {p}", "ls -l -a {p}", "ls {p} -la"},
+    {"ls -lhS {p}", "ls -Shl {p}", "ls -l -h -S {p}", "ls {p} -hlS"},
+    {"du -sh {p}", "du -hs {p}", "du -s -h {p}", "du {p} -sh"},
+    {"grep -rn {g} {p}", "grep -nr {g} {p}", "grep -r -n {g} {p}", "grep {g} {p} -rn"},
+    {"rm -rf {p}", "rm -fr {p}", "rm -r -f {p}", "rm {p} -rf"},
+    {"cp -rv {p} {p}", "cp -vr {p} {p}", "cp -r -v {p} {p}", "cp {p} {p} -rv"},
+    {"head -n 20 {f}", "head -n20 {f}", "head {f} -n 20", "head  -n 20  {f}"},
+    {"tail -fn 50 {f}", "tail -f -n 50 {f}", "tail -n50 -f {f}", "tail {f} -fn 50"},
+};
+
+// The synthetic corpus with a respelled command after about one line in six
+std::vector<std::string> syntheticEntries(size_t count, uint32_t seed) {
+    std::vector<std::string> lines = corpus::generateShellCorpus(count, seed);
+    corpus::Random rng(seed ^ 0x5bd1e995u);
+    std::vector<std::string> entries;
+    entries.reserve(count + count / 4);
+    for (auto& line : lines) {
+        entries.push_back(std::move(line));
+        if (!rng.chance(16)) continue;
+        size_t row = rng.below(std::size(SPELLINGS));
+        // A few fills per row, each filled alike in every spelling
+        corpus::Random fill_rng(static_cast<uint32_t>(1 + row * 8 + rng.below(3)));
+        std::string entry;
+        corpus::fill(entry, SPELLINGS[row][rng.below(4)], fill_rng);
+        entries.push_back(std::move(entry));
+    }
+    return entries;
+}
+
+struct Replay {
+    size_t hits = 0;
+    size_t distinct = 0;
+};
+
+template <typename KeyFn>
+Replay replay(const std::vector<std::string>& entries, KeyFn&& key) {
+    std::unordered_set<std::string> seen;
+    Replay r;
+    for (const auto& entry : entries) {
+        if (!seen.insert(key(entry)).second) ++r.hits;
+    }
+    r.distinct = seen.size();
+    return r;
+}
+
+} // anonymous namespace
+
+int main(int argc, char* argv[]) {
+    std::vector<std::string> entries;
+    std::string source;
+
+    if (argc > 1 && std::string(argv[1]) == "--synthetic") {
+        size_t count = argc > 2 ? std::stoul(argv[2]) : 20000;
+        uint32_t seed = argc > 3 ? static_cast<uint32_t>(std::stoul(argv[3])) : 1;
+        entries = syntheticEntries(count, seed);
+        source = "synthetic corpus with respellings";
+    } else {
+        std::vector<std::string> paths(argv + 1, argv + argc);
+        if (paths.empty()) {
+            const char* home = std::getenv("HOME");
+            if (home) {
+                paths.push_back(std::string(home) + "/.bash_history");
+                paths.push_back(std::string(home) + "/.zsh_history");
+            }
+        }
+        for (const auto& path : paths) readHistory(path, entries);
+        source = std::to_string(paths.size()) + " history file(s)";
+    }
+
+    // Questions go to the query cache, not the explanation cache
+    std::erase_if(entries, [](const std::string& e) { return tt::isQuestion(e); });
+    if (entries.empty()) {
+        std::fprintf(stderr, "no history entries found\n");
+        return 1;
+    }
+
+    Replay raw = replay(entries, [](const std::string& e) { return e; });
+
+    std::string canonical;
+    auto start = std::chrono::steady_clock::now();
+    Replay canon = replay(entries, [&](const std::string& e) {
+        tt::canonicalizeCommand(e, canonical);
+        return canonical;
+    });
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    double n = static_cast<double>(entries.size());
+    std::printf("%zu commands from %s\n\n", entries.size(), source.c_str());
+    std::printf("%-12s %10s %10s %10s\n", "key", "distinct", "hits", "hit rate");
+    std::printf("%-12s %10zu %10zu %9.2f%%\n", "raw", raw.distinct, raw.hits, 100.0 * raw.hits / n);
+    std::printf("%-12s %10zu %10zu %9.2f%%\n", "canonical", canon.distinct, canon.hits, 100.0 * canon.hits / n);
+    std::printf("\n+%.2f points, %zu fewer distinct keys, %.0f ns/command\n",
+                100.0 * (canon.hits - raw.hits) / n, raw.distinct - canon.distinct, secs * 1e9 / n);
+    return 0;
+}
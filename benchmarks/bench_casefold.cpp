@@ -0,0 +1,91 @@
+/**
+ * bench_casefold.cpp - Bytes per second: foldCase vs a copy + std::transform(::tolower) loop
+ *
+ *   bench_casefold [lines] [iterations]
+ *
+ * Runs over the synthetic shell corpus (mostly ASCII, with pt/es questions)
+ * and over a Latin-1-heavy sample, where the UTF-8 path does the work.
+ */
+
+#include "shell_corpus.hpp"
+#include "tt/CaseFold.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace {
+
+const std::vector<std::string> ACCENTED = {
+    "COMO EU LISTO OS ARQUIVOS DA PASTA DE AÇÕES?",
+    "¿Cómo Comprimo Una Carpeta Con Tar En Éste Equipo?",
+    "Quais Portas Estão Abertas Nesta Máquina",
+    "Mostrar Conexões Ativas E Informações De Memória",
+    "ПОКАЖИ ПРОЦЕССЫ И ИСПОЛЬЗОВАНИЕ ПАМЯТИ",
+};
+
+template <typename Fn>
+double measure(size_t iterations, Fn&& fn) {
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; ++i) {
+        fn();
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(end - start).count();
+}
+
+// What the matchers used to do per call
+std::string legacyLower(const std::string& text) {
+    std::string lower = text;
+    std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
+    return lower;
+}
+
+void run(const char* name, const std::vector<std::string>& lines, size_t iterations) {
+    size_t bytes = 0;
+    for (const auto& line : lines) bytes += line.size();
+    double total = static_cast<double>(bytes * iterations);
+
+    size_t sink = 0;
+    double legacy_secs = measure(iterations, [&] {
+        for (const auto& line : lines) sink += legacyLower(line).back();
+    });
+
+    std::string folded;
+    double fold_secs = measure(iterations, [&] {
+        for (const auto& line : lines) {
+            tt::foldCase(line, folded);
+            sink += static_cast<unsigned char>(folded.back());
+        }
+    });
+
+    std::vector<std::string> copies = lines;
+    double inplace_secs = measure(iterations, [&] {
+        for (auto& line : copies) {
+            tt::foldCaseInPlace(line.data(), line.size());
+            sink += static_cast<unsigned char>(line.back());
+        }
+    });
+
+    std::printf("%s (%zu lines, %zu bytes)\n", name, lines.size(), bytes);
+    std::printf("  %-22s %10.1f MB/s\n", "transform(::tolower)", total / legacy_secs / 1e6);
+    std::printf("  %-22s %10.1f MB/s\n", "foldCase", total / fold_secs / 1e6);
+    std::printf("  %-22s %10.1f MB/s\n", "foldCaseInPlace", total / inplace_secs / 1e6);
+    std::printf("  (%zu)\n\n", sink);
+}
+
+} // anonymous namespace
+
+int main(int argc, char* argv[]) {
+    size_t lines = argc > 1 ? std::stoul(argv[1]) : 20000;
+    size_t iterations = argc > 2 ? std::stoul(argv[2]) : 50;
+
+    std::vector<std::string> corpus = corpus::generateShellCorpus(lines, 1);
+    std::erase_if(corpus, [](const std::string& line) { return line.empty(); });
+    run("shell corpus", corpus, iterations);
+    run("accented queries", ACCENTED, iterations * lines / ACCENTED.size());
+    return 0;
+}
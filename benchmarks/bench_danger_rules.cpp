@@ -0,0 +1,93 @@
+/**
+ * bench_danger_rules.cpp - Startup cost of site rule packs: compile vs mapped image
+ *
+ *   bench_danger_rules [rules] [lines]
+ *
+ * Writes `rules` synthetic site rules (tool names with subcommands, like
+ * kubectl delete or terraform destroy) into a temporary rules.d, then times
+ * DangerRules::load() compiling them and mapping the cached image, and
+ * assessRisk() over the synthetic shell corpus with and without them.
+ */
+
+#include "shell_corpus.hpp"
+#include "tt/DangerCheck.hpp"
+#include "tt/DangerRules.hpp"
+#include "tt/ShellAst.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+const char* const SEVERITIES[] = {"low", "medium", "high", "critical"};
+const char* const VERBS[] = {"delete", "destroy", "drop", "purge", "reset", "wipe", "rollback", "scale"};
+
+void writeRules(const fs::path& dir, size_t count) {
+    std::ofstream file(dir / "bench.rules");
+    for (size_t i = 0; i < count; ++i) {
+        file << SEVERITIES[i % 4] << "  tool" << i / 8 << " " << VERBS[i % 8];
+        if (i % 3 == 0) file << " --force";
+        file << "\n";
+    }
+}
+
+template <typename Fn>
+double micros(size_t iterations, Fn&& fn) {
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; ++i) fn();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::micro>(end - start).count() / static_cast<double>(iterations);
+}
+
+double linesPerSecond(const std::vector<std::string>& lines, const tt::DangerRules& rules, size_t& sink) {
+    auto start = std::chrono::steady_clock::now();
+    for (const auto& line : lines) {
+        tt::ShellAst ast(line);
+        sink += static_cast<size_t>(tt::assessRisk(ast, rules).score);
+    }
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return static_cast<double>(lines.size()) / secs;
+}
+
+} // anonymous namespace
+
+int main(int argc, char* argv[]) {
+    size_t count = argc > 1 ? std::stoul(argv[1]) : 5000;
+    size_t lines = argc > 2 ? std::stoul(argv[2]) : 100000;
+
+    fs::path root = fs::temp_directory_path() / "tt_bench_danger_rules";
+    fs::remove_all(root);
+    fs::create_directories(root / "rules.d");
+    writeRules(root / "rules.d", count);
+    std::vector<std::string> dirs = {(root / "rules.d").string()};
+    std::string cache = (root / "cache").string();
+
+    size_t iterations = count > 20000 ? 5 : 50;
+    double compile_us = micros(iterations, [&] { tt::DangerRules::load(dirs); });
+    tt::DangerRules::load(dirs, cache);
+    double mapped_us = micros(iterations, [&] { tt::DangerRules::load(dirs, cache); });
+    double builtin_us = micros(iterations, [&] { tt::DangerRules::load({}); });
+
+    std::printf("%zu site rules\n", count);
+    std::printf("  %-26s %10.1f us\n", "compile (no cache)", compile_us);
+    std::printf("  %-26s %10.1f us\n", "map cached image", mapped_us);
+    std::printf("  %-26s %10.1f us\n", "builtin rules only", builtin_us);
+
+    std::vector<std::string> corpus = corpus::generateShellCorpus(lines, 1);
+    auto builtin = tt::DangerRules::load({});
+    auto site = tt::DangerRules::load(dirs, cache);
+    size_t sink = 0;
+    std::printf("\nassessRisk over %zu corpus lines\n", corpus.size());
+    std::printf("  %-26s %10.0f lines/s\n", "builtin rules", linesPerSecond(corpus, builtin, sink));
+    std::printf("  %-26s %10.0f lines/s\n", "builtin + site rules", linesPerSecond(corpus, site, sink));
+    std::printf("  (%zu)\n", sink);
+
+    fs::remove_all(root);
+    return 0;
+}
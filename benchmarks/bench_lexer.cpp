@@ -0,0 +1,83 @@
+/**
+ * bench_lexer.cpp - Tokens per second: ShellLexer vs the legacy tokenizer
+ */
+
+#include "legacy_parser.hpp"
+#include "tt/ShellLexer.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace {
+
+const std::vector<std::string> SAMPLES = {
+    "ls -la /home",
+    "find . -type f -name '*.cpp' -exec grep -l TODO {} \\;",
+    "grep -rn \"hello world\" src/ | sort | uniq -c | sort -rn | head -20",
+    "tar -czvf backup.tar.gz --exclude='*.log' ./project",
+    "docker run --rm -it -v \"$(pwd)\":/work -w /work ubuntu:22.04 bash",
+    "for f in *.txt; do mv \"$f\" \"${f%.txt}.md\"; done",
+    "git log --oneline --graph --decorate --all | head -n 50",
+    "du -ah . 2>/dev/null | sort -rh | head -n 10",
+    "curl -sSL https://example.com/install.sh | sh -s -- --yes",
+    "ps aux --sort=-%mem | awk 'NR<=10 {print $2, $4, $11}'",
+    "kill $(lsof -t -i:3000) && echo stopped || echo 'not running'",
+    "rsync -avz --delete ./dist/ user@host:/var/www/html/ > sync.log 2>&1 &",
+};
+
+template <typename Fn>
+double measure(size_t iterations, Fn&& fn) {
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; ++i) {
+        fn();
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(end - start).count();
+}
+
+} // anonymous namespace
+
+int main(int argc, char* argv[]) {
+    size_t iterations = argc > 1 ? std::stoul(argv[1]) : 20000;
+
+    size_t legacy_tokens = 0;
+    double legacy_secs = measure(iterations, [&] {
+        for (const auto& line : SAMPLES) {
+            legacy_tokens += legacy::tokenize(line).size();
+        }
+    });
+
+    size_t lexer_tokens = 0;
+    double lexer_secs = measure(iterations, [&] {
+        for (const auto& line : SAMPLES) {
+            tt::ShellLexer lexer(line);
+            while (!lexer.next().is(tt::TokenKind::END)) ++lexer_tokens;
+        }
+    });
+
+    // Lexing plus unquoting every word into one reused buffer
+    size_t unquoted_tokens = 0;
+    std::string buffer;
+    double unquote_secs = measure(iterations, [&] {
+        for (const auto& line : SAMPLES) {
+            tt::ShellLexer lexer(line);
+            for (auto token = lexer.next(); !token.is(tt::TokenKind::END); token = lexer.next()) {
+                if (token.is(tt::TokenKind::WORD)) {
+                    buffer.clear();
+                    tt::unquoteInto(token.text, buffer);
+                }
+                ++unquoted_tokens;
+            }
+        }
+    });
+
+    std::printf("%-22s %12s %14s\n", "tokenizer", "tokens", "tokens/sec");
+    std::printf("%-22s %12zu %14.0f\n", "legacy (istringstream)", legacy_tokens, legacy_tokens / legacy_secs);
+    std::printf("%-22s %12zu %14.0f\n", "ShellLexer", lexer_tokens, lexer_tokens / lexer_secs);
+    std::printf("%-22s %12zu %14.0f\n", "ShellLexer + unquote", unquoted_tokens, unquoted_tokens / unquote_secs);
+    std::printf("\nspeedup: %.1fx (token counts differ: the legacy tokenizer does not split operators)\n",
+                (lexer_tokens / lexer_secs) / (legacy_tokens / legacy_secs));
+    return 0;
+}
@@ -0,0 +1,217 @@
+/**
+ * bench_parser.cpp - Corpus throughput and differential checks, legacy vs current
+ *
+ *   bench_parser [lines] [seed]
+ *
+ * Runs every parser stage over the synthetic shell corpus (shell_corpus.hpp)
+ * and reports lines per second and heap allocations per line for the legacy
+ * implementation and the current one. Then compares their answers line by
+ * line: on plain lines (no quoting, operators or expansions) the tokenizers
+ * and parsers must agree exactly, and any mismatch fails the run. Question
+ * and danger classifiers are expected to disagree where the legacy substring
+ * matchers were wrong, so those differences are counted and sampled.
+ */
+
+#include "legacy_parser.hpp"
+#include "shell_corpus.hpp"
+#include "tt/CommandParser.hpp"
+#include "tt/DangerCheck.hpp"
+#include "tt/GeminiClient.hpp"
+#include "tt/QuestionClassifier.hpp"
+#include "tt/ShellAst.hpp"
+#include "tt/ShellLexer.hpp"
+#include "tt/Simulator.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <vector>
+
+// Count every heap allocation made by the process
+namespace {
+std::atomic<size_t> g_allocations{0};
+}
+
+void* operator new(std::size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+namespace {
+
+struct Result {
+    double lines_per_sec;
+    double allocs_per_line;
+    size_t hits;
+};
+
+template <typename Fn>
+Result measure(const std::vector<std::string>& corpus, size_t rounds, Fn&& fn) {
+    size_t hits = 0;
+    size_t allocs_before = g_allocations.load();
+    auto start = std::chrono::steady_clock::now();
+    for (size_t round = 0; round < rounds; ++round) {
+        for (const auto& line : corpus) {
+            hits += fn(line);
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+    size_t allocs = g_allocations.load() - allocs_before;
+
+    double lines = static_cast<double>(corpus.size() * rounds);
+    return {lines / std::chrono::duration<double>(end - start).count(), allocs / lines, hits / rounds};
+}
+
+void printRow(const char* stage, const char* impl, const Result& r) {
+    std::printf("%-14s %-22s %14.0f %12.2f %10zu\n", stage, impl, r.lines_per_sec, r.allocs_per_line, r.hits);
+}
+
+// No quotes, escapes, expansions, globs or operators: both tokenizers must agree
+bool isPlain(const std::string& line) {
+    for (char c : line) {
+        switch (c) {
+            case '\'': case '"': case '\\': case '$': case '`': case '*': case '?': case '[':
+            case '|': case '&': case ';': case '<': case '>': case '(': case ')': case '\n': case '#':
+                return false;
+            default:
+                break;
+        }
+    }
+    return true;
+}
+
+std::vector<std::string> lexWords(const std::string& line) {
+    std::vector<std::string> words;
+    tt::ShellLexer lexer(line);
+    for (auto token = lexer.next(); !token.is(tt::TokenKind::END); token = lexer.next()) {
+        if (token.is(tt::TokenKind::WORD)) words.push_back(tt::unquote(token.text));
+    }
+    return words;
+}
+
+struct Disagreement {
+    const char* name;
+    size_t legacy_only = 0;
+    size_t current_only = 0;
+    std::vector<std::string> samples;
+
+    explicit Disagreement(const char* n) : name(n) {}
+
+    void record(bool legacy, bool current, const std::string& line) {
+        if (legacy == current) return;
+        (legacy ? legacy_only : current_only)++;
+        if (samples.size() < 3) samples.push_back((legacy ? "legacy only:  " : "current only: ") + line);
+    }
+
+    void print() const {
+        std::printf("%-28s %8zu legacy only %8zu current only\n", name, legacy_only, current_only);
+        for (const auto& sample : samples) std::printf("    %s\n", sample.c_str());
+    }
+};
+
+} // anonymous namespace
+
+int main(int argc, char* argv[]) {
+    size_t count = argc > 1 ? std::stoul(argv[1]) : 20000;
+    uint32_t seed = argc > 2 ? static_cast<uint32_t>(std::stoul(argv[2])) : 1;
+    constexpr size_t ROUNDS = 3;
+
+    auto corpus = corpus::generateShellCorpus(count, seed);
+    tt::CommandParser parser;
+    tt::GeminiClient gemini("");
+    tt::Simulator simulator(gemini);
+
+    std::printf("%zu lines, seed %u, %zu rounds\n\n", corpus.size(), seed, ROUNDS);
+    std::printf("%-14s %-22s %14s %12s %10s\n", "stage", "implementation", "lines/sec", "allocs/line", "hits");
+
+    printRow("tokenize", "legacy istringstream", measure(corpus, ROUNDS, [](const std::string& line) {
+        return legacy::tokenize(line).size() > 0;
+    }));
+    tt::TokenList tokens;
+    printRow("tokenize", "ShellLexer", measure(corpus, ROUNDS, [&](const std::string& line) {
+        tt::ShellLexer::tokenize(line, tokens);
+        return tokens.size() > 0;
+    }));
+
+    printRow("parse", "legacy", measure(corpus, ROUNDS, [](const std::string& line) {
+        return !legacy::parse(line).executable.empty();
+    }));
+    printRow("parse", "CommandParser", measure(corpus, ROUNDS, [&](const std::string& line) {
+        return !parser.parse(line).executable.empty();
+    }));
+    printRow("parseCommands", "CommandParser", measure(corpus, ROUNDS, [&](const std::string& line) {
+        return parser.parseCommands(line).size() > 1;
+    }));
+    tt::CompactCommand compact;
+    printRow("parse", "CompactCommand", measure(corpus, ROUNDS, [&](const std::string& line) {
+        parser.parse(std::string_view(line), compact);
+        return !compact.executable().empty();
+    }));
+    tt::CompactCommandList compact_list;
+    printRow("parseCommands", "CompactCommandList", measure(corpus, ROUNDS, [&](const std::string& line) {
+        parser.parseCommands(std::string_view(line), compact_list);
+        return compact_list.size() > 1;
+    }));
+
+    printRow("isQuestion", "legacy", measure(corpus, ROUNDS, [](const std::string& line) {
+        return legacy::isQuestion(line);
+    }));
+    printRow("isQuestion", "QuestionClassifier", measure(corpus, ROUNDS, [](const std::string& line) {
+        return tt::isQuestion(line);
+    }));
+
+    printRow("main danger", "legacy substrings", measure(corpus, ROUNDS, [](const std::string& line) {
+        return legacy::isDangerousCommand(line);
+    }));
+    printRow("main danger", "DangerCheck", measure(corpus, ROUNDS, [](const std::string& line) {
+        return tt::isDangerousCommand(line);
+    }));
+    printRow("sim danger", "legacy substrings", measure(corpus, ROUNDS, [](const std::string& line) {
+        return legacy::simulatorIsDangerous(line);
+    }));
+    printRow("sim danger", "Simulator", measure(corpus, ROUNDS, [&](const std::string& line) {
+        return simulator.isDangerous(line);
+    }));
+
+    // Differential checks
+    size_t plain = 0, mismatches = 0;
+    Disagreement questions("isQuestion");
+    Disagreement main_danger("isDangerousCommand");
+    Disagreement sim_danger("Simulator::isDangerous");
+
+    for (const auto& line : corpus) {
+        bool legacy_question = legacy::isQuestion(line);
+        bool question = tt::isQuestion(line);
+        questions.record(legacy_question, question, line);
+        main_danger.record(legacy::isDangerousCommand(line), tt::isDangerousCommand(line), line);
+        sim_danger.record(legacy::simulatorIsDangerous(line), simulator.isDangerous(line), line);
+
+        if (!isPlain(line)) continue;
+        ++plain;
+
+        bool same = legacy::tokenize(line) == lexWords(line);
+        if (same && legacy_question == question) {
+            auto old_cmd = legacy::parse(line);
+            auto new_cmd = parser.parse(line);
+            same = old_cmd.executable == new_cmd.executable && old_cmd.flags == new_cmd.flags &&
+                   old_cmd.args == new_cmd.args;
+        }
+        if (!same) {
+            if (mismatches < 5) std::printf("MISMATCH: %s\n", line.c_str());
+            ++mismatches;
+        }
+    }
+
+    std::printf("\nplain lines: %zu, tokenize/parse mismatches: %zu\n\n", plain, mismatches);
+    questions.print();
+    main_danger.print();
+    sim_danger.print();
+    return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,132 @@
+/**
+ * bench_prompts.cpp - Prompt construction: ostringstream per call vs templates into a reused buffer
+ *
+ *   bench_prompts [lines] [iterations]
+ *
+ * Builds the smartQuery and whatif prompts for every line of the synthetic
+ * shell corpus, the old way (request first, instructions after, rebuilt
+ * with ostringstream) and with the compile-time templates. Besides the
+ * time per prompt it reports the prefix reuse between consecutive prompts
+ * of the same kind: the share of each prompt's bytes equal to the previous
+ * one's from the start, which is the most a server-side prefix cache can
+ * serve from cache.
+ */
+
+#include "shell_corpus.hpp"
+#include "tt/PromptTemplate.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+const std::string LANGUAGE = "Respond in Portuguese (Brazilian).";
+
+// GeminiClient::smartQuery before templates
+std::string legacySmartQuery(const std::string& query) {
+    std::ostringstream prompt;
+    prompt << "User request: " << query << "\n\n"
+           << "Analyze the request:\n"
+           << "1. EXECUTE: If user wants to DO something with the system (find files, list processes, check disk, etc.)\n"
+           << "2. EXPLAIN: For greetings, questions about concepts, explanations (hi, hello, why, what is, how does X work)\n\n"
+           << "Greetings like 'hi', 'hello', 'ola' are ALWAYS type explain.\n"
+           << "Only use execute if the user clearly wants to run a shell command.\n\n"
+           << "Respond with ONLY valid JSON:\n"
+           << "Execute: {\"type\":\"execute\",\"command\":\"shell command\",\"explanation\":\"1-line plain text explanation\"}\n"
+           << "Explain: {\"type\":\"explain\",\"response\":\"plain text response\"}\n\n"
+           << "CRITICAL: No markdown, no backticks, no asterisks, no formatting. Plain text only.\n"
+           << LANGUAGE;
+    return prompt.str();
+}
+
+// Simulator's prediction prompt before templates
+std::string legacyPrediction(const std::string& command) {
+    std::ostringstream prompt;
+    prompt << "Voce e um simulador de comandos Linux. Preveja o que aconteceria se o seguinte comando fosse executado.\n\n"
+           << "Comando: " << command << "\n\n";
+    prompt << "Responda em formato estruturado:\n"
+           << "ARQUIVOS_AFETADOS: (liste arquivos/diretorios que seriam modificados, criados ou deletados)\n"
+           << "SAIDA_ESPERADA: (o que apareceria no terminal)\n"
+           << "RISCOS: (possiveis problemas ou efeitos colaterais)\n"
+           << "NIVEL_DESTRUTIVIDADE: (BAIXO, MEDIO, ALTO)\n\n"
+           << "Responda em Portugues (Brasil). Seja preciso e tecnico.";
+    return prompt.str();
+}
+
+struct Measurement {
+    double ns_per_prompt = 0;
+    double prefix_reuse = 0;  // Bytes shared with the previous prompt / bytes
+    size_t sink = 0;
+};
+
+template <typename Build>
+Measurement measure(const std::vector<std::string>& lines, size_t iterations, Build&& build) {
+    Measurement m;
+    std::string previous;
+    size_t shared = 0;
+    size_t total = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t it = 0; it < iterations; ++it) {
+        for (const auto& line : lines) {
+            const std::string& prompt = build(line);
+            m.sink += prompt.size();
+            if (it == 0) {
+                size_t n = 0;
+                while (n < prompt.size() && n < previous.size() && prompt[n] == previous[n]) ++n;
+                shared += n;
+                total += prompt.size();
+                previous = prompt;
+            }
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+    m.ns_per_prompt = std::chrono::duration<double, std::nano>(end - start).count() /
+                      static_cast<double>(lines.size() * iterations);
+    m.prefix_reuse = static_cast<double>(shared) / static_cast<double>(total);
+    return m;
+}
+
+void report(const char* name, const Measurement& legacy, const Measurement& templated) {
+    std::printf("%-12s %-14s %9.0f ns   %5.1f%%\n", name, "ostringstream", legacy.ns_per_prompt,
+                100 * legacy.prefix_reuse);
+    std::printf("%-12s %-14s %9.0f ns   %5.1f%%   (%.1fx)\n", "", "template", templated.ns_per_prompt,
+                100 * templated.prefix_reuse, legacy.ns_per_prompt / templated.ns_per_prompt);
+}
+
+} // anonymous namespace
+
+int main(int argc, char* argv[]) {
+    size_t count = argc > 1 ? std::stoul(argv[1]) : 20000;
+    size_t iterations = argc > 2 ? std::stoul(argv[2]) : 20;
+    std::vector<std::string> lines = corpus::generateShellCorpus(count, 1);
+
+    std::printf("%zu corpus lines x %zu\n\n", lines.size(), iterations);
+    std::printf("%-12s %-14s %12s   %s\n", "prompt", "build", "per prompt", "prefix reuse");
+
+    std::string legacy_buffer;
+    std::string buffer;
+
+    auto legacy_smart = measure(lines, iterations, [&](const std::string& line) -> const std::string& {
+        return legacy_buffer = legacySmartQuery(line);
+    });
+    auto smart = measure(lines, iterations, [&](const std::string& line) -> const std::string& {
+        tt::prompts::SMART_QUERY.render(buffer, {LANGUAGE, line});
+        return buffer;
+    });
+    report("smartQuery", legacy_smart, smart);
+
+    auto legacy_prediction = measure(lines, iterations, [&](const std::string& line) -> const std::string& {
+        return legacy_buffer = legacyPrediction(line);
+    });
+    auto prediction = measure(lines, iterations, [&](const std::string& line) -> const std::string& {
+        tt::prompts::PREDICTION.render(buffer, {LANGUAGE, line, ""});
+        return buffer;
+    });
+    report("whatif", legacy_prediction, prediction);
+
+    std::printf("\n(%zu)\n", legacy_smart.sink + smart.sink + legacy_prediction.sink + prediction.sink);
+    return 0;
+}
@@ -0,0 +1,69 @@
+/**
+ * bench_query_key.cpp - Nanoseconds per query for normalizeQuery and queryKey
+ *
+ *   bench_query_key [iterations]
+ *
+ * The key is computed on every --run request, so it has to stay well under
+ * a microsecond for typical queries.
+ */
+
+#include "tt/QueryNormalizer.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace {
+
+const std::vector<std::string> SAMPLES = {
+    "Como eu listo arquivos?",
+    "como eu encontro arquivos maiores que 100MB",
+    "How do I find which process is using port 8080?",
+    "¿Cómo comprimo una carpeta con tar?",
+    "please show me the disk usage of this folder",
+    "o que faz o comando chmod 755",
+    "delete every .tmp file under /var/tmp/Build older than 3 days",
+    "quais portas estão abertas nesta máquina",
+    "grep for 'connection refused' in ~/logs/*.log",
+    "Me explique como funciona o AWK",
+};
+
+template <typename Fn>
+double measure(size_t iterations, Fn&& fn) {
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; ++i) {
+        fn();
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(end - start).count();
+}
+
+} // anonymous namespace
+
+int main(int argc, char* argv[]) {
+    size_t iterations = argc > 1 ? std::stoul(argv[1]) : 200000;
+    double queries = static_cast<double>(iterations * SAMPLES.size());
+
+    std::string normalized;
+    size_t bytes = 0;
+    double normalize_secs = measure(iterations, [&] {
+        for (const auto& query : SAMPLES) {
+            tt::normalizeQuery(query, normalized);
+            bytes += normalized.size();
+        }
+    });
+
+    uint64_t sink = 0;
+    double key_secs = measure(iterations, [&] {
+        for (const auto& query : SAMPLES) {
+            sink += tt::queryKey(query).lo;
+        }
+    });
+
+    std::printf("%-16s %12s\n", "stage", "ns/query");
+    std::printf("%-16s %12.1f\n", "normalizeQuery", normalize_secs * 1e9 / queries);
+    std::printf("%-16s %12.1f\n", "queryKey", key_secs * 1e9 / queries);
+    std::printf("\n(%zu bytes, %016llx)\n", bytes / iterations, static_cast<unsigned long long>(sink));
+    return 0;
+}
@@ -0,0 +1,76 @@
+/**
+ * bench_question.cpp - Inputs per second: QuestionClassifier vs legacy isQuestion
+ */
+
+#include "legacy_parser.hpp"
+#include "tt/QuestionClassifier.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+
+const std::vector<std::string> SAMPLES = {
+    "ls -la /home",
+    "como eu encontro arquivos maiores que 100MB",
+    "how do I find which process is using port 8080",
+    "find . -type f -name '*.cpp' -exec grep -l TODO {} \\;",
+    "show me the disk usage of this folder",
+    "git log --oneline --graph --decorate --all | head -n 50",
+    "¿Cómo comprimo una carpeta con tar?",
+    "o que faz o comando chmod 755",
+    "docker run --rm -it -v \"$(pwd)\":/work -w /work ubuntu:22.04 bash",
+    "sort quality_report.csv | uniq -c",
+    "quais portas estão abertas nesta máquina",
+    "ps aux --sort=-%mem | awk 'NR<=10 {print $2, $4, $11}'",
+};
+
+template <typename Fn>
+double measure(size_t iterations, Fn&& fn) {
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; ++i) {
+        fn();
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(end - start).count();
+}
+
+} // anonymous namespace
+
+int main(int argc, char* argv[]) {
+    size_t iterations = argc > 1 ? std::stoul(argv[1]) : 50000;
+    size_t inputs = iterations * SAMPLES.size();
+
+    size_t legacy_questions = 0;
+    double legacy_secs = measure(iterations, [&] {
+        for (const auto& line : SAMPLES) {
+            legacy_questions += legacy::isQuestion(line);
+        }
+    });
+
+    size_t questions = 0;
+    double classifier_secs = measure(iterations, [&] {
+        for (const auto& line : SAMPLES) {
+            questions += tt::isQuestion(line);
+        }
+    });
+
+    // Batch API over one reused output buffer
+    size_t batch_questions = 0;
+    auto flags = std::make_unique<bool[]>(SAMPLES.size());
+    std::span<bool> out(flags.get(), SAMPLES.size());
+    double batch_secs = measure(iterations, [&] {
+        batch_questions += tt::classifyQuestions(std::span<const std::string>(SAMPLES), out);
+    });
+
+    std::printf("%-24s %12s %14s\n", "classifier", "questions", "inputs/sec");
+    std::printf("%-24s %12zu %14.0f\n", "legacy isQuestion", legacy_questions, inputs / legacy_secs);
+    std::printf("%-24s %12zu %14.0f\n", "QuestionClassifier", questions, inputs / classifier_secs);
+    std::printf("%-24s %12zu %14.0f\n", "classifyQuestions", batch_questions, inputs / batch_secs);
+    std::printf("\nspeedup: %.1fx (counts differ: the legacy matcher takes \"quality\" for \"qual\" and misses \"show\")\n",
+                legacy_secs / classifier_secs);
+    return 0;
+}
@@ -0,0 +1,304 @@
+/**
+ * bench_startup.cpp - Cold-start distribution of the tt binary against a mock API
+ *
+ *   bench_startup <path to tt> [runs] [tt arguments...]    (default: explain ls)
+ *
+ * Serves canned Gemini responses (generateContent, streamGenerateContent,
+ * countTokens) over plain HTTP on 127.0.0.1 and points tt at them with
+ * TT_API_BASE, so the network is out of the numbers. Each run spawns
+ * `tt --profile-startup <arguments>` with an empty HOME (no sessions or
+ * caches) and parses the profile tt prints on stderr. The first run is
+ * listed apart: it is the only one that may find the binary and its
+ * libraries outside the page cache.
+ *
+ * The keyring is whatever the environment provides; without a D-Bus
+ * session the lookups fail fast and GEMINI_API_KEY supplies the key.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <map>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <spawn.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char** environ;
+
+namespace fs = std::filesystem;
+
+namespace {
+
+const char* const ANSWER =
+    R"({"candidates":[{"content":{"parts":[{"text":"ls lists the files in a directory."}],"role":"model"}}],)"
+    R"("usageMetadata":{"promptTokenCount":120,"candidatesTokenCount":9,"totalTokenCount":129}})";
+
+// One connection per request (Connection: close), answered from canned bodies
+class MockServer {
+public:
+    MockServer() {
+        fd_ = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        socklen_t len = sizeof(addr);
+        if (fd_ < 0 || ::bind(fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+            ::listen(fd_, 64) != 0 || ::getsockname(fd_, reinterpret_cast<sockaddr*>(&addr), &len) != 0) {
+            std::perror("mock server");
+            std::exit(1);
+        }
+        port_ = ntohs(addr.sin_port);
+        thread_ = std::thread([this] { serve(); });
+    }
+
+    ~MockServer() {
+        stopping_ = true;
+        ::shutdown(fd_, SHUT_RDWR);
+        ::close(fd_);
+        thread_.join();
+    }
+
+    int port() const { return port_; }
+
+private:
+    void serve() {
+        while (!stopping_) {
+            int client = ::accept4(fd_, nullptr, nullptr, SOCK_CLOEXEC);
+            if (client < 0) continue;
+            answer(client);
+            ::close(client);
+        }
+    }
+
+    static void answer(int client) {
+        std::string request;
+        char buffer[4096];
+        size_t header_end = std::string::npos;
+        size_t body_length = 0;
+        while (true) {
+            ssize_t n = ::read(client, buffer, sizeof(buffer));
+            if (n <= 0) return;
+            request.append(buffer, static_cast<size_t>(n));
+            if (header_end == std::string::npos && (header_end = request.find("\r\n\r\n")) != std::string::npos) {
+                size_t at = request.find("Content-Length: ");
+                if (at == std::string::npos) at = request.find("content-length: ");
+                if (at != std::string::npos && at < header_end) body_length = std::strtoul(&request[at + 16], nullptr, 10);
+            }
+            if (header_end != std::string::npos && request.size() >= header_end + 4 + body_length) break;
+        }
+
+        std::string first_line = request.substr(0, request.find("\r\n"));
+        std::string body;
+        std::string type = "application/json";
+        if (first_line.find(":streamGenerateContent") != std::string::npos) {
+            body = std::string("data: ") + ANSWER + "\r\n\r\n";
+            type = "text/event-stream";
+        } else if (first_line.find(":countTokens") != std::string::npos) {
+            body = R"({"totalTokens":120})";
+        } else {
+            body = ANSWER;
+        }
+        std::string response = "HTTP/1.1 200 OK\r\nContent-Type: " + type + "\r\nContent-Length: " +
+                               std::to_string(body.size()) + "\r\nConnection: close\r\n\r\n" + body;
+        size_t sent = 0;
+        while (sent < response.size()) {
+            ssize_t n = ::write(client, response.data() + sent, response.size() - sent);
+            if (n <= 0) return;
+            sent += static_cast<size_t>(n);
+        }
+    }
+
+    int fd_ = -1;
+    int port_ = 0;
+    std::atomic<bool> stopping_{false};
+    std::thread thread_;
+};
+
+struct Run {
+    double wall_ms = 0;
+    std::vector<std::pair<std::string, double>> phases;  // Name, ms since main, in time order
+
+    std::optional<double> phase(const std::string& name) const {
+        for (const auto& [phase, ms] : phases) {
+            if (phase == name) return ms;
+        }
+        return std::nullopt;
+    }
+
+    std::optional<double> toMain() const {
+        auto start = phase("process start (10 ms resolution)");
+        if (!start) return std::nullopt;
+        return -*start;
+    }
+
+    // The first byte on the wire when the client reports it, else the hand-off to the HTTP library
+    std::optional<double> firstRequest() const {
+        auto byte = phase("first request byte");
+        return byte ? byte : phase("request start");
+    }
+};
+
+Run spawnOnce(const std::string& binary, const std::vector<std::string>& args, const std::vector<std::string>& env) {
+    int pipe_fds[2];
+    if (::pipe2(pipe_fds, O_CLOEXEC) != 0) {
+        std::perror("pipe2");
+        std::exit(1);
+    }
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_addopen(&actions, 0, "/dev/null", O_RDONLY, 0);
+    posix_spawn_file_actions_addopen(&actions, 1, "/dev/null", O_WRONLY, 0);
+    posix_spawn_file_actions_adddup2(&actions, pipe_fds[1], 2);
+
+    std::vector<char*> argv = {const_cast<char*>(binary.c_str())};
+    for (const auto& arg : args) argv.push_back(const_cast<char*>(arg.c_str()));
+    argv.push_back(nullptr);
+    std::vector<char*> envp;
+    for (const auto& var : env) envp.push_back(const_cast<char*>(var.c_str()));
+    envp.push_back(nullptr);
+
+    Run run;
+    pid_t pid = 0;
+    auto start = std::chrono::steady_clock::now();
+    int rc = posix_spawn(&pid, binary.c_str(), &actions, nullptr, argv.data(), envp.data());
+    posix_spawn_file_actions_destroy(&actions);
+    ::close(pipe_fds[1]);
+    if (rc != 0) {
+        std::fprintf(stderr, "cannot run %s: %s\n", binary.c_str(), std::strerror(rc));
+        std::exit(1);
+    }
+
+    std::string err;
+    char buffer[4096];
+    ssize_t n;
+    while ((n = ::read(pipe_fds[0], buffer, sizeof(buffer))) > 0) err.append(buffer, static_cast<size_t>(n));
+    ::close(pipe_fds[0]);
+    int status = 0;
+    ::waitpid(pid, &status, 0);
+    run.wall_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    // "  <ns> <ms since main> <+delta>  <phase>" after the header line
+    size_t header = err.find("startup profile:");
+    if (header == std::string::npos) {
+        std::fprintf(stderr, "no startup profile from tt (exit status %d):\n%s\n", status, err.c_str());
+        std::exit(1);
+    }
+    size_t pos = err.find('\n', header);
+    while (pos != std::string::npos && pos + 1 < err.size()) {
+        size_t end = err.find('\n', pos + 1);
+        std::string line = err.substr(pos + 1, end == std::string::npos ? std::string::npos : end - pos - 1);
+        long long ns = 0;
+        double ms = 0, delta = 0;
+        int consumed = 0;
+        if (std::sscanf(line.c_str(), " %lld %lf %lf %n", &ns, &ms, &delta, &consumed) == 3) {
+            run.phases.emplace_back(line.substr(static_cast<size_t>(consumed)), ms);
+        }
+        pos = end;
+    }
+    return run;
+}
+
+double percentile(std::vector<double> values, double p) {
+    if (values.empty()) return 0;
+    std::sort(values.begin(), values.end());
+    size_t rank = static_cast<size_t>(p * static_cast<double>(values.size()) + 0.999999);
+    return values[std::clamp<size_t>(rank, 1, values.size()) - 1];
+}
+
+// Runs that lack the phase are left out
+void row(const char* name, std::optional<double> first, const std::vector<std::optional<double>>& values) {
+    std::vector<double> rest;
+    for (const auto& value : values) {
+        if (value) rest.push_back(*value);
+    }
+    std::printf("  %-24s ", name);
+    if (first) {
+        std::printf("%8.1f", *first);
+    } else {
+        std::printf("%8s", "-");
+    }
+    if (rest.empty()) {
+        std::printf("\n");
+        return;
+    }
+    std::printf(" %8.1f %8.1f %8.1f %8.1f %8.1f\n", percentile(rest, 0),
+                percentile(rest, 0.5), percentile(rest, 0.9), percentile(rest, 0.99), percentile(rest, 1));
+}
+
+} // anonymous namespace
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::fprintf(stderr, "usage: bench_startup <path to tt> [runs] [tt arguments...]\n");
+        return 1;
+    }
+    std::string binary = argv[1];
+    size_t runs = std::max<size_t>(argc > 2 ? std::stoul(argv[2]) : 50, 1);
+    std::vector<std::string> args = {"--profile-startup"};
+    for (int i = 3; i < argc; ++i) args.push_back(argv[i]);
+    if (args.size() == 1) args.insert(args.end(), {"explain", "ls"});
+
+    MockServer server;
+    fs::path home = fs::temp_directory_path() / "tt_bench_startup";
+
+    std::vector<std::string> env;
+    for (char** var = environ; *var; ++var) {
+        std::string entry = *var;
+        if (entry.rfind("HOME=", 0) == 0 || entry.rfind("TT_", 0) == 0) continue;
+        env.push_back(entry);
+    }
+    env.push_back("HOME=" + home.string());
+    env.push_back("TT_API_BASE=http://127.0.0.1:" + std::to_string(server.port()));
+    if (!std::getenv("GEMINI_API_KEY")) env.push_back("GEMINI_API_KEY=bench-key");
+
+    std::vector<Run> results;
+    for (size_t i = 0; i < runs; ++i) {
+        fs::remove_all(home);
+        fs::create_directories(home);
+        results.push_back(spawnOnce(binary, args, env));
+    }
+    fs::remove_all(home);
+
+    std::printf("%zu runs of %s", runs, binary.c_str());
+    for (const auto& arg : args) std::printf(" %s", arg.c_str());
+    std::printf("\n\n  %-24s %8s %8s %8s %8s %8s %8s   (ms)\n", "", "first", "min", "p50", "p90", "p99", "max");
+
+    std::vector<std::optional<double>> wall, to_main, to_request;
+    for (size_t i = 1; i < results.size(); ++i) {
+        wall.push_back(results[i].wall_ms);
+        to_main.push_back(results[i].toMain());
+        to_request.push_back(results[i].firstRequest());
+    }
+    const Run& first = results.front();
+    row("spawn to exit", first.wall_ms, wall);
+    row("process start to main", first.toMain(), to_main);
+    row("main to first request", first.firstRequest(), to_request);
+
+    // Median time of each phase, in the order phases first appear
+    std::vector<std::string> order;
+    std::map<std::string, std::vector<double>> by_phase;
+    for (const auto& run : results) {
+        for (const auto& [phase, ms] : run.phases) {
+            if (by_phase.find(phase) == by_phase.end()) order.push_back(phase);
+            by_phase[phase].push_back(ms);
+        }
+    }
+    std::printf("\nMedian ms since main per phase (%zu runs):\n", results.size());
+    for (const auto& phase : order) {
+        std::printf("  %9.3f  %s\n", percentile(by_phase[phase], 0.5), phase.c_str());
+    }
+    return 0;
+}
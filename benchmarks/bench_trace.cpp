@@ -0,0 +1,60 @@
+/**
+ * bench_trace.cpp - Cost of a latency span with tracing off and on
+ *
+ *   bench_trace [spans]
+ *
+ * Times an empty loop, spans while tracing is off (the default for every
+ * run of tt) and spans with an argument while recording, then writes the
+ * recorded trace to see how long the exit-time write takes.
+ */
+
+#include "tt/Trace.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <string>
+
+namespace {
+
+template <typename Fn>
+double nanosPerCall(size_t count, Fn&& fn) {
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < count; ++i) fn(i);
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / static_cast<double>(count);
+}
+
+} // anonymous namespace
+
+int main(int argc, char* argv[]) {
+    size_t count = argc > 1 ? std::stoul(argv[1]) : 1000000;
+    volatile size_t sink = 0;
+
+    double baseline = nanosPerCall(count, [&](size_t i) { sink = sink + i; });
+    double disabled = nanosPerCall(count, [&](size_t i) {
+        tt::trace::Span span("bench", "bench");
+        span.arg("i", static_cast<int64_t>(i));
+        sink = sink + i;
+    });
+
+    std::string path = (std::filesystem::temp_directory_path() / "tt_bench_trace.json").string();
+    tt::trace::start(path);
+    double enabled = nanosPerCall(count, [&](size_t i) {
+        tt::trace::Span span("bench", "bench");
+        span.arg("i", static_cast<int64_t>(i));
+        sink = sink + i;
+    });
+    auto flush_start = std::chrono::steady_clock::now();
+    tt::trace::stop();
+    double flush_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - flush_start).count();
+
+    std::printf("%zu spans\n", count);
+    std::printf("  %-22s %8.1f ns\n", "empty loop", baseline);
+    std::printf("  %-22s %8.1f ns\n", "span, tracing off", disabled);
+    std::printf("  %-22s %8.1f ns\n", "span, recording", enabled);
+    std::printf("  %-22s %8.1f ms (%.0f MB)\n", "write trace", flush_ms,
+                static_cast<double>(std::filesystem::file_size(path)) / 1e6);
+    std::filesystem::remove(path);
+    return 0;
+}
@@ -0,0 +1,63 @@
+/**
+ * gen_corpus.cpp - Write the synthetic shell corpus to disk
+ *
+ *   gen_corpus <out.txt> [lines] [seed]
+ *       One line per entry; here-document lines are written with their
+ *       embedded newlines, so entries are separated by a NUL byte instead
+ *       when the file name ends in ".nul".
+ *
+ *   gen_corpus --seeds <dir> [count] [seed]
+ *       One file per entry, as a starting corpus for the fuzz targets.
+ */
+
+#include "shell_corpus.hpp"
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+namespace fs = std::filesystem;
+
+int main(int argc, char* argv[]) {
+    if (argc < 2 || (std::string(argv[1]) == "--seeds" && argc < 3)) {
+        std::cerr << "Usage: gen_corpus <out.txt> [lines] [seed]\n"
+                  << "       gen_corpus --seeds <dir> [count] [seed]\n";
+        return 1;
+    }
+
+    bool seeds = std::string(argv[1]) == "--seeds";
+    int arg = seeds ? 2 : 1;
+    std::string out = argv[arg];
+    size_t count = argc > arg + 1 ? std::stoul(argv[arg + 1]) : (seeds ? 500 : 100000);
+    uint32_t seed = argc > arg + 2 ? static_cast<uint32_t>(std::stoul(argv[arg + 2])) : 1;
+
+    auto lines = corpus::generateShellCorpus(count, seed);
+
+    if (seeds) {
+        std::error_code ec;
+        fs::create_directories(out, ec);
+        char name[32];
+        for (size_t i = 0; i < lines.size(); ++i) {
+            std::snprintf(name, sizeof(name), "seed-%05zu", i);
+            std::ofstream file(fs::path(out) / name, std::ios::binary);
+            file << lines[i];
+            if (!file) {
+                std::cerr << "Cannot write " << (fs::path(out) / name).string() << "\n";
+                return 1;
+            }
+        }
+    } else {
+        std::ofstream file(out, std::ios::binary);
+        char separator = out.size() > 4 && out.compare(out.size() - 4, 4, ".nul") == 0 ? '\0' : '\n';
+        for (const auto& line : lines) file << line << separator;
+        if (!file) {
+            std::cerr << "Cannot write " << out << "\n";
+            return 1;
+        }
+    }
+
+    std::printf("Wrote %zu entries to %s\n", lines.size(), out.c_str());
+    return 0;
+}
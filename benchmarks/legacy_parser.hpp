@@ -0,0 +1,173 @@
+/**
+ * legacy_parser.hpp - Pre-lexer CommandParser routines, kept as a baseline
+ *
+ * Verbatim copies of the original implementations (tokenizer, parse,
+ * question matcher and the two substring danger checks from main.cpp and Simulator)
+ * so benchmarks and differential checks can compare against them.
+ */
+
+#pragma once
+
+#include "tt/CommandParser.hpp"
+
+#include <algorithm>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace legacy {
+
+inline std::vector<std::string> tokenize(const std::string& input) {
+    std::vector<std::string> tokens;
+    std::istringstream iss(input);
+    std::string token;
+    
+    bool in_quotes = false;
+    std::string quoted_token;
+    
+    while (iss >> token) {
+        if (token.front() == '"' || token.front() == '\'') {
+            in_quotes = true;
+            quoted_token = token.substr(1);
+        } else if (in_quotes) {
+            if (token.back() == '"' || token.back() == '\'') {
+                quoted_token += " " + token.substr(0, token.size() - 1);
+                tokens.push_back(quoted_token);
+                in_quotes = false;
+            } else {
+                quoted_token += " " + token;
+            }
+        } else {
+            tokens.push_back(token);
+        }
+    }
+    
+    return tokens;
+}
+
+inline bool isQuestion(const std::string& input) {
+    static const std::vector<std::string> question_patterns = {
+        "como", "what", "how", "why", "quando", "where", "qual", "quais",
+        "o que", "por que", "porque", "explain", "explique"
+    };
+    
+    std::string lower = input;
+    std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
+    
+    // Check for question mark
+    if (lower.find('?') != std::string::npos) {
+        return true;
+    }
+    
+    // Check for question patterns
+    for (const auto& pattern : question_patterns) {
+        if (lower.find(pattern) == 0 || lower.find(" " + pattern) != std::string::npos) {
+            return true;
+        }
+    }
+    
+    return false;
+}
+
+inline tt::ParsedCommand parse(const std::string& input) {
+    tt::ParsedCommand result;
+    result.raw_input = input;
+    result.is_question = isQuestion(input);
+    
+    if (result.is_question) {
+        return result;
+    }
+    
+    auto tokens = tokenize(input);
+    
+    if (tokens.empty()) {
+        return result;
+    }
+    
+    result.executable = tokens[0];
+    
+    for (size_t i = 1; i < tokens.size(); ++i) {
+        const auto& token = tokens[i];
+        if (token.front() == '-') {
+            result.flags.push_back(token);
+        } else {
+            result.args.push_back(token);
+        }
+    }
+    
+    return result;
+}
+
+// main.cpp isDangerousCommand before DangerCheck
+inline bool isDangerousCommand(const std::string& cmd) {
+    static const std::vector<std::string> DANGEROUS_COMMANDS = {
+        "rm", "rmdir", "unlink", "shred",
+        "shutdown", "reboot", "poweroff", "halt", "init",
+        "mkfs", "fdisk", "parted", "dd", "format", "mkswap",
+        "apt-get remove", "apt remove", "apt-get purge", "apt purge",
+        "yum remove", "dnf remove", "pacman -R",
+        "chmod 777", "chmod -R", "chown -R", "chgrp -R",
+        "iptables -F", "ufw disable",
+        "kill -9", "killall", "pkill",
+        ":(){", "fork bomb",
+        "userdel", "deluser", "passwd",
+        "sudo",
+    };
+    static const std::vector<std::string> DANGEROUS_PATTERNS = {
+        "> /dev/", ">/dev/", "> /etc/", ">/etc/", "> /boot/", ">/boot/",
+        "| rm", "|rm", "| dd", "|dd",
+        "rf /", "rf ~/", "rf ~", "rf .",
+        "mv /* ", "mv / ", "> /", "| tee /", "|tee /",
+        "chmod 000", ":(){ :", "/dev/null >", "/dev/zero", "/dev/random",
+    };
+    
+    std::string lower_cmd = cmd;
+    std::transform(lower_cmd.begin(), lower_cmd.end(), lower_cmd.begin(), ::tolower);
+    
+    for (const auto& dangerous : DANGEROUS_COMMANDS) {
+        if (lower_cmd.find(dangerous) == 0) return true;
+        if (lower_cmd.find("| " + dangerous) != std::string::npos) return true;
+        if (lower_cmd.find("|" + dangerous) != std::string::npos) return true;
+        if (lower_cmd.find("sudo " + dangerous) != std::string::npos) return true;
+    }
+    
+    for (const auto& pattern : DANGEROUS_PATTERNS) {
+        if (lower_cmd.find(pattern) != std::string::npos) return true;
+    }
+    
+    return false;
+}
+
+// Simulator::isDangerous before DangerCheck
+inline bool simulatorIsDangerous(const std::string& command) {
+    static const std::vector<std::string> dangerous_patterns = {
+        "rm -rf", "rm -r /", "rm -rf /", "rm -rf ~", "rm -rf *",
+        "> /dev/sda", "dd if=", "mkfs.", ":(){:|:&};:",
+        "chmod -R 777 /", "chown -R", "sudo rm", "mv /* ",
+        "wget.*|.*sh", "curl.*|.*bash"
+    };
+    
+    std::string lower = command;
+    std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
+    
+    for (const auto& pattern : dangerous_patterns) {
+        if (lower.find(pattern) != std::string::npos) {
+            return true;
+        }
+    }
+    
+    if (lower.find("sudo") != std::string::npos) {
+        std::vector<std::string> dangerous_with_sudo = {
+            "rm", "dd", "mkfs", "chmod", "chown", "mv", "cp"
+        };
+        for (const auto& cmd : dangerous_with_sudo) {
+            if (lower.find(cmd) != std::string::npos) {
+                return true;
+            }
+        }
+    }
+    
+    return false;
+}
+
+} // namespace legacy
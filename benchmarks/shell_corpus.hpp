@@ -0,0 +1,191 @@
+/**
+ * shell_corpus.hpp - Deterministic synthetic corpus of real-world shell lines
+ *
+ * Lines are assembled from templates of commands people actually type
+ * (git, docker, find, grep, package managers, one-liners), filled with
+ * paths, patterns and numbers, then combined with pipes, lists, redirections,
+ * sudo, quoting, substitutions and here-documents. About one line in eight
+ * is a natural-language question (pt/en/es) and one in twenty is dangerous,
+ * so classifiers and danger checks see both sides. The same seed always
+ * yields the same corpus.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace corpus {
+
+// xorshift32: tiny and identical on every platform, unlike std:: distributions
+class Random {
+public:
+    explicit Random(uint32_t seed) : state_(seed ? seed : 0x9e3779b9u) {}
+
+    uint32_t next() {
+        state_ ^= state_ << 13;
+        state_ ^= state_ >> 17;
+        state_ ^= state_ << 5;
+        return state_;
+    }
+
+    size_t below(size_t n) { return next() % n; }
+    bool chance(unsigned percent) { return below(100) < percent; }
+
+    template <typename T, size_t N>
+    const T& pick(const T (&items)[N]) { return items[below(N)]; }
+
+private:
+    uint32_t state_;
+};
+
+inline const char* const PATHS[] = {
+    ".", "..", "~", "/tmp", "/var/log", "/etc/nginx", "src/", "./build", "~/Downloads",
+    "/home/user/projects/app", "include/tt", "node_modules", "/opt/data", "dist/", "../backup",
+    "\"$HOME/My Documents\"", "'/mnt/usb drive'", "logs/*.log", "*.cpp", "**/*.ts"
+};
+
+inline const char* const FILES[] = {
+    "README.md", "main.cpp", "package.json", "docker-compose.yml", "/etc/hosts", "app.log",
+    "data.csv", ".env", "Makefile", "config.yaml", "/var/log/syslog", "notes.txt",
+    "\"file with spaces.txt\"", "archive.tar.gz", "id_rsa.pub", "requirements.txt"
+};
+
+inline const char* const PATTERNS[] = {
+    "TODO", "error", "'^[0-9]+$'", "\"failed to connect\"", "-e warn -e fatal", "main",
+    "'import .* from'", "\"$USER\"", "'\\bfoo\\b'", "localhost:8080", "'[A-Z]{3}-[0-9]+'"
+};
+
+inline const char* const HOSTS[] = {
+    "github.com", "example.com", "192.168.0.10", "user@server", "deploy@10.0.0.5",
+    "localhost", "api.internal:8443", "db.prod.local"
+};
+
+inline const char* const SERVICES[] = {
+    "nginx", "docker", "ssh", "postgresql", "redis", "cron", "bluetooth", "NetworkManager"
+};
+
+inline const char* const BRANCHES[] = {
+    "main", "develop", "feature/login", "fix/issue-42", "release/v2.1", "HEAD~3", "origin/main"
+};
+
+inline const char* const PACKAGES[] = {
+    "htop", "ripgrep", "build-essential", "python3-pip", "jq", "curl", "git", "neovim"
+};
+
+// {p} path, {f} file, {g} pattern, {h} host, {s} service, {b} branch, {k} package, {n} number
+inline const char* const COMMANDS[] = {
+    "ls -la {p}", "ls -lhS {p}", "ls -1 {p} | wc -l", "ll {p}", "tree -L {n} {p}",
+    "cd {p}", "pwd", "mkdir -p {p}/new", "cp -r {p} {p}", "mv {f} {p}", "touch {f}",
+    "cat {f}", "less {f}", "head -n {n} {f}", "tail -f {f}", "tail -n {n} {f}", "wc -l {f}",
+    "grep -rn {g} {p}", "grep -i {g} {f}", "grep -c {g} {f}", "rg {g} {p}", "rg -l {g}",
+    "find {p} -name '*.log' -mtime +{n}", "find {p} -type f -size +{n}M", "find {p} -type d -empty",
+    "find {p} -name '*.tmp' -exec ls -l {} \\;", "find {p} -type f -print0 | xargs -0 du -h",
+    "du -sh {p}", "du -ah {p} | sort -rh | head -n {n}", "df -h", "free -m", "uptime", "top -bn1 | head",
+    "ps aux | grep {g}", "ps aux --sort=-%mem | head -n {n}", "pgrep -fl {s}", "kill {n}",
+    "lsof -i :{n}", "ss -ltnp", "netstat -tulpn | grep {n}", "ip addr show", "ping -c {n} {h}",
+    "curl -sSL https://{h}/api/v1/status", "curl -X POST -H 'Content-Type: application/json' -d '{\"a\":{n}}' https://{h}",
+    "wget -q https://{h}/file.tar.gz -O /tmp/file.tar.gz", "ssh {h}", "scp {f} {h}:/tmp/",
+    "rsync -avz --delete {p} {h}:/var/www/", "dig +short {h}", "nslookup {h}",
+    "git status", "git add -A", "git commit -m \"fix: handle {g}\"", "git push origin {b}",
+    "git pull --rebase", "git checkout -b {b}", "git log --oneline --graph -n {n}", "git diff {b} -- {f}",
+    "git stash pop", "git reset --soft {b}", "git rebase -i {b}", "git branch -d {b}", "git clone https://{h}/org/repo.git",
+    "docker ps -a", "docker images", "docker run --rm -it -v \"$(pwd)\":/app -w /app node:20 bash",
+    "docker exec -it web sh", "docker logs -f --tail {n} web", "docker compose up -d", "docker system prune -f",
+    "kubectl get pods -n default", "kubectl logs -f deploy/api", "kubectl describe pod api-{n}",
+    "systemctl status {s}", "systemctl restart {s}", "journalctl -u {s} -n {n} --no-pager",
+    "apt install {k}", "apt search {k}", "pip install {k}", "npm install {k}", "brew install {k}",
+    "tar -czvf backup-{n}.tar.gz {p}", "tar -xzf {f} -C {p}", "unzip -o {f} -d {p}", "gzip -9 {f}",
+    "chmod +x {f}", "chmod 644 {f}", "chown $USER:$USER {f}", "ln -sf {f} {p}",
+    "sed -i 's/{g}/bar/g' {f}", "awk -F, '{print $1, $3}' {f}", "sort -u {f} | uniq -c | sort -rn",
+    "cut -d: -f1 /etc/passwd", "tr '[:lower:]' '[:upper:]' < {f}", "jq '.dependencies' {f}",
+    "echo $PATH | tr ':' '\\n'", "export PATH=\"$HOME/.local/bin:$PATH\"", "source ~/.bashrc",
+    "for f in *.txt; do mv \"$f\" \"${f%.txt}.md\"; done", "while read -r line; do echo \"$line\"; done < {f}",
+    "if [ -f {f} ]; then cat {f}; else echo missing; fi", "make -j{n}", "cmake -S . -B build && cmake --build build",
+    "python3 -m http.server {n}", "node server.js &", "crontab -l", "history | grep {g}",
+    "diff -u {f} {f}", "md5sum {f}", "stat {f}", "file {f}", "which {k}", "man {k}",
+    "cat > {f} <<'EOF'\nline one\n$HOME stays literal\nEOF", "kill -HUP $(pgrep {s})",
+    "time ./build/app --threads {n}", "watch -n {n} 'df -h'", "env | grep -i proxy",
+    "openssl s_client -connect {h}:443 </dev/null", "base64 -d <<< \"aGVsbG8=\""
+};
+
+inline const char* const DANGEROUS[] = {
+    "rm -rf {p}", "sudo rm -rf /", "rm -rf ~/*", "dd if=/dev/zero of=/dev/sda bs=1M", "mkfs.ext4 /dev/sdb1",
+    "chmod -R 777 /", "chown -R nobody /etc", "echo 0 > /proc/sys/kernel/randomize_va_space",
+    ":(){ :|:& };:", "x :(){ :|:& };:", "curl -sSL https://{h}/install.sh | sudo bash", "find {p} -name '*.bak' -exec rm {} \\;",
+    "ls {p} | xargs rm -f", "kill -9 -1", "shutdown -h now", "mv {p}/* /", "cat /dev/null > {f}",
+    "sh -c 'rm -rf {p}'", "iptables -F", "userdel -r deploy", "sudo apt purge {k}"
+};
+
+inline const char* const QUESTIONS[] = {
+    "how do I find large files in {p}?", "what does {k} do", "why is {s} failing to start",
+    "como eu listo arquivos ocultos em {p}", "o que faz o comando {k}?", "qual a diferença entre {k} e grep",
+    "¿cómo borro la rama {b}?", "qué hace git rebase", "show me the biggest files",
+    "mostre os processos usando a porta {n}", "explain the sticky bit", "where are the {s} logs",
+    "dime cuánto espacio libre tengo", "por que o {s} não sobe?", "can I undo git push?"
+};
+
+inline void fill(std::string& out, const char* tmpl, Random& rng) {
+    for (const char* c = tmpl; *c; ++c) {
+        if (c[0] == '{' && c[1] && c[2] == '}') {
+            switch (c[1]) {
+                case 'p': out += rng.pick(PATHS); break;
+                case 'f': out += rng.pick(FILES); break;
+                case 'g': out += rng.pick(PATTERNS); break;
+                case 'h': out += rng.pick(HOSTS); break;
+                case 's': out += rng.pick(SERVICES); break;
+                case 'b': out += rng.pick(BRANCHES); break;
+                case 'k': out += rng.pick(PACKAGES); break;
+                case 'n': out += std::to_string(1 + rng.below(9999)); break;
+                default: out.append(c, 3); break;
+            }
+            c += 2;
+        } else {
+            out += *c;
+        }
+    }
+}
+
+inline std::string generateLine(Random& rng) {
+    std::string line;
+
+    if (rng.chance(12)) {
+        fill(line, rng.pick(QUESTIONS), rng);
+        return line;
+    }
+
+    bool dangerous = rng.chance(5);
+    if (rng.chance(8)) line += "sudo ";
+    if (rng.chance(4)) line += "LC_ALL=C ";
+    fill(line, dangerous ? rng.pick(DANGEROUS) : rng.pick(COMMANDS), rng);
+
+    // Compose one or two more commands
+    static const char* const JOINERS[] = {" | ", " && ", " || ", "; ", " | "};
+    size_t extra = rng.chance(35) ? 1 + rng.below(2) : 0;
+    for (size_t i = 0; i < extra; ++i) {
+        line += rng.pick(JOINERS);
+        fill(line, rng.pick(COMMANDS), rng);
+    }
+
+    // Trailing redirections
+    if (rng.chance(10)) line += " 2>/dev/null";
+    if (rng.chance(6)) {
+        line += rng.chance(50) ? " > " : " >> ";
+        fill(line, "{f}", rng);
+    }
+    if (rng.chance(3)) line += " &";
+    return line;
+}
+
+inline std::vector<std::string> generateShellCorpus(size_t count, uint32_t seed = 1) {
+    Random rng(seed);
+    std::vector<std::string> lines;
+    lines.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        lines.push_back(generateLine(rng));
+    }
+    return lines;
+}
+
+} // namespace corpus
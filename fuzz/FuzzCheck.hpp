@@ -0,0 +1,22 @@
+/**
+ * FuzzCheck.hpp - Invariant assertion for the fuzz targets
+ *
+ * Unlike assert(), stays active in release builds and prints the offending
+ * input before aborting, so the crash report is readable without a debugger.
+ */
+
+#pragma once
+
+#include <cstdio>
+#include <cstdlib>
+#include <string_view>
+
+#define FUZZ_CHECK(cond, input)                                                  \
+    do {                                                                         \
+        if (!(cond)) {                                                           \
+            std::fprintf(stderr, "%s:%d: invariant failed: %s\ninput: \"%.*s\"\n", \
+                         __FILE__, __LINE__, #cond,                              \
+                         static_cast<int>((input).size()), (input).data());      \
+            std::abort();                                                        \
+        }                                                                        \
+    } while (0)
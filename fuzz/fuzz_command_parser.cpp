@@ -0,0 +1,66 @@
+/**
+ * fuzz_command_parser.cpp - Fuzz CommandParser, isQuestion, extractIntent and normalizeQuery
+ *
+ * Besides crashes and sanitizer reports, checks that the entry points agree
+ * with each other: parse() classifies like isQuestion(), the batch classifier
+ * like the single one, lexer tokens are ordered views into the input and
+ * parseCommands() never yields a command without an executable, and query
+ * normalization and case folding are idempotent.
+ */
+
+#include "FuzzCheck.hpp"
+#include "tt/CaseFold.hpp"
+#include "tt/CommandParser.hpp"
+#include "tt/QueryNormalizer.hpp"
+#include "tt/QuestionClassifier.hpp"
+#include "tt/ShellLexer.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    static tt::CommandParser parser;
+    std::string input(reinterpret_cast<const char*>(data), size);
+    std::string_view view(input);
+
+    bool question = tt::isQuestion(view);
+    FUZZ_CHECK(parser.isQuestion(input) == question, view);
+
+    bool batch = false;
+    FUZZ_CHECK(tt::classifyQuestions(std::span<const std::string_view>(&view, 1),
+                                     std::span<bool>(&batch, 1)) == (question ? 1u : 0u), view);
+    FUZZ_CHECK(batch == question, view);
+
+    auto parsed = parser.parse(input);
+    FUZZ_CHECK(parsed.is_question == question, view);
+    FUZZ_CHECK(parsed.raw_input == input, view);
+    FUZZ_CHECK(!question || (parsed.executable.empty() && parsed.flags.empty() && parsed.args.empty()), view);
+
+    for (const auto& command : parser.parseCommands(input)) {
+        FUZZ_CHECK(!command.executable.empty(), view);
+    }
+
+    // Prefix and trailing punctuation removal only ever shortens the input
+    FUZZ_CHECK(parser.extractIntent(input).size() <= input.size(), view);
+
+    std::string normalized = tt::normalizeQuery(view);
+    FUZZ_CHECK(tt::normalizeQuery(normalized) == normalized, view);
+    FUZZ_CHECK(tt::queryKey(view) == tt::normalizedKey(normalized), view);
+
+    std::string folded = tt::foldCase(view);
+    FUZZ_CHECK(folded.size() == view.size(), view);
+    FUZZ_CHECK(tt::foldCase(folded) == folded, view);
+    FUZZ_CHECK(tt::equalsFolded(view, folded), view);
+
+    tt::TokenList tokens;
+    tt::ShellLexer::tokenize(view, tokens);
+    const char* last = view.data();
+    for (const auto& token : tokens) {
+        FUZZ_CHECK(token.text.data() >= last, view);
+        FUZZ_CHECK(token.text.data() + token.text.size() <= view.data() + view.size(), view);
+        last = token.text.data();
+    }
+    return 0;
+}
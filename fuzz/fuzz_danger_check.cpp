@@ -0,0 +1,65 @@
+/**
+ * fuzz_danger_check.cpp - Fuzz the confirmation check and Simulator::isDangerous
+ *
+ * Both checkers must be deterministic, and the string overloads must answer
+ * exactly like the ShellAst overloads they wrap, and the risk score must
+ * agree with the verdict. Also walks the whole tree
+ * so every node the parser built is touched under the sanitizers. The
+ * canonical form of a command is a fixed point and keeps its verdict, since
+ * explanations are cached under it.
+ */
+
+#include "FuzzCheck.hpp"
+#include "tt/CommandCanonicalizer.hpp"
+#include "tt/DangerCheck.hpp"
+#include "tt/GeminiClient.hpp"
+#include "tt/ShellAst.hpp"
+#include "tt/Simulator.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    // Simulator only needs the client for simulate(); it never connects here
+    static tt::GeminiClient gemini("");
+    static tt::Simulator simulator(gemini);
+
+    std::string input(reinterpret_cast<const char*>(data), size);
+    std::string_view view(input);
+
+    tt::ShellAst ast(view);
+    FUZZ_CHECK(ast.source() == view, view);
+
+    bool dangerous = tt::isDangerousCommand(ast);
+    FUZZ_CHECK(tt::isDangerousCommand(view) == dangerous, view);
+    FUZZ_CHECK(tt::isDangerousCommand(ast) == dangerous, view);
+
+    // Scores stay inside their severity's band
+    tt::RiskAssessment risk = tt::assessRisk(ast);
+    FUZZ_CHECK(risk.needsConfirmation() == dangerous, view);
+    FUZZ_CHECK((risk.severity == tt::Severity::NONE) == (risk.findings == 0), view);
+    int band = 25 * static_cast<int>(risk.severity);
+    FUZZ_CHECK(risk.score >= band && risk.score < band + 25, view);
+
+    bool destructive = simulator.isDangerous(ast);
+    FUZZ_CHECK(simulator.isDangerous(input) == destructive, view);
+
+    // The fork-bomb and download checks feed both verdicts
+    if (tt::containsForkBomb(ast) || tt::pipesDownloadToShell(ast)) {
+        FUZZ_CHECK(destructive, view);
+    }
+
+    // Every word is at least one byte of source, nested commands reuse theirs
+    size_t words = 0;
+    ast.forEachCommand([&](const tt::CommandNode& cmd) {
+        if (!cmd.runner) words += cmd.word_count + cmd.assignment_count;
+    });
+    FUZZ_CHECK(words <= size, view);
+
+    std::string canonical = tt::canonicalizeCommand(view);
+    FUZZ_CHECK(tt::canonicalizeCommand(canonical) == canonical, view);
+    FUZZ_CHECK(tt::isDangerousCommand(canonical) == dangerous, view);
+    return 0;
+}
@@ -0,0 +1,68 @@
+/**
+ * standalone_main.cpp - Replay driver for toolchains without libFuzzer
+ *
+ *   fuzz_<target> [file|dir]...
+ *
+ * Feeds every file (directories are walked recursively) to
+ * LLVMFuzzerTestOneInput once; with no arguments, reads a single input from
+ * stdin. Used to run the seed corpus and saved crashes as regression tests.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size);
+
+namespace fs = std::filesystem;
+
+namespace {
+
+void runOne(const std::string& bytes) {
+    LLVMFuzzerTestOneInput(reinterpret_cast<const uint8_t*>(bytes.data()), bytes.size());
+}
+
+bool runFile(const fs::path& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        std::cerr << "Cannot open " << path.string() << "\n";
+        return false;
+    }
+    runOne(std::string(std::istreambuf_iterator<char>(file), {}));
+    return true;
+}
+
+} // anonymous namespace
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        runOne(std::string(std::istreambuf_iterator<char>(std::cin), {}));
+        std::printf("Executed 1 input from stdin\n");
+        return 0;
+    }
+
+    size_t executed = 0;
+    for (int i = 1; i < argc; ++i) {
+        fs::path path = argv[i];
+        std::error_code ec;
+        if (fs::is_directory(path, ec)) {
+            for (const auto& entry : fs::recursive_directory_iterator(path, ec)) {
+                if (!entry.is_regular_file()) continue;
+                if (!runFile(entry.path())) return 1;
+                ++executed;
+            }
+        } else {
+            if (!runFile(path)) return 1;
+            ++executed;
+        }
+    }
+
+    std::printf("Executed %zu inputs\n", executed);
+    return 0;
+}
@@ -0,0 +1,57 @@
+/**
+ * BlastRadius.hpp - How much a destructive command would touch
+ *
+ * For rm, shred, truncate, chmod/chown/chgrp, mv and find -delete, the
+ * operands are expanded like the shell would (globs, ~) and, where the
+ * command recurses, walked with a work-stealing pool of threads reading
+ * directories with getdents64 and sizing files with statx. The result is
+ * the number of files and directories, their total size and the
+ * directories holding most of it. The walk stops at a time budget and
+ * then reports what it counted so far as partial.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace tt {
+
+class ShellAst;
+
+struct ImpactOptions {
+    std::chrono::milliseconds budget{300};
+    unsigned threads = 0;  // 0 = hardware concurrency
+    size_t top = 5;        // Directories listed in ImpactReport::top
+};
+
+struct DirectoryImpact {
+    std::string path;
+    uint64_t files = 0;
+    uint64_t bytes = 0;
+};
+
+struct ImpactReport {
+    uint64_t files = 0;        // Everything that is not a directory
+    uint64_t directories = 0;
+    uint64_t bytes = 0;        // Apparent size
+    uint64_t unreadable = 0;   // Directories that could not be listed
+    std::vector<std::string> targets;     // Operands after expansion
+    std::vector<std::string> unresolved;  // Operands with $vars or $(...)
+    std::vector<DirectoryImpact> top;     // By bytes, largest first
+    bool complete = true;      // False when the budget ran out
+    double elapsed_ms = 0;
+
+    bool empty() const { return files == 0 && directories == 0; }
+};
+
+ImpactReport analyzeImpact(const ShellAst& ast, const ImpactOptions& options = {});
+ImpactReport analyzeImpact(std::string_view command, const ImpactOptions& options = {});
+
+// Walks the given paths as recursive targets
+ImpactReport measurePaths(const std::vector<std::string>& paths, const ImpactOptions& options = {});
+
+} // namespace tt
@@ -0,0 +1,67 @@
+/**
+ * CaseFold.hpp - Case folding shared by the matchers
+ *
+ * Two folds, both without allocating:
+ *
+ * foldCase() lowercases text that is later compared as typed (normalized
+ * queries, intents). ASCII runs are lowered 16 bytes at a time; the UTF-8
+ * path only starts at a non-ASCII byte and folds the two-byte letters of
+ * Latin-1, Latin Extended-A, Greek and Cyrillic ("É" -> "é", "Ž" -> "ž",
+ * "Д" -> "д"). Every mapping keeps the byte length, so offsets found in the
+ * folded text apply to the original and the fold can run in place.
+ *
+ * foldLetter() maps one character to an ASCII base letter, dropping accents
+ * ("Ç" -> 'c'), for keyword and feature matchers that stream over the input
+ * one word at a time.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace tt {
+
+constexpr char asciiLower(char c) noexcept {
+    return (c >= 'A' && c <= 'Z') ? static_cast<char>(c + 32) : c;
+}
+
+// Bytes before the first non-ASCII byte
+size_t asciiPrefixLength(std::string_view text) noexcept;
+
+void foldCaseInPlace(char* data, size_t size) noexcept;
+void foldCase(std::string_view text, std::string& out);
+std::string foldCase(std::string_view text);
+
+// Whether `text` folds to `folded`, without building the folded copy
+bool equalsFolded(std::string_view text, std::string_view folded) noexcept;
+
+// ASCII base letters of U+00C0..U+00FF (UTF-8 0xC3 0x80..0xBF); 0 for non-letters
+inline constexpr char LATIN1_BASE_LETTER[64] = {
+    'a', 'a', 'a', 'a', 'a', 'a', 'a', 'c', 'e', 'e', 'e', 'e', 'i', 'i', 'i', 'i',
+    'd', 'n', 'o', 'o', 'o', 'o', 'o',  0,  'o', 'u', 'u', 'u', 'u', 'y',  0,   0,
+    'a', 'a', 'a', 'a', 'a', 'a', 'a', 'c', 'e', 'e', 'e', 'e', 'i', 'i', 'i', 'i',
+    'd', 'n', 'o', 'o', 'o', 'o', 'o',  0,  'o', 'u', 'u', 'u', 'u', 'y',  0,  'y'
+};
+
+struct FoldedLetter {
+    char letter = 0;    // Lowercase ASCII base; 0 when the character is not one
+    size_t length = 1;  // Bytes consumed
+};
+
+// Folds the character at text[i]: ASCII letters and digits, and Latin-1 letters
+constexpr FoldedLetter foldLetter(std::string_view text, size_t i) noexcept {
+    auto c = static_cast<unsigned char>(text[i]);
+    if ((c >= 'a' && c <= 'z') || (c >= '0' && c <= '9')) return {static_cast<char>(c), 1};
+    if (c >= 'A' && c <= 'Z') return {static_cast<char>(c + 32), 1};
+    if (c == 0xC3 && i + 1 < text.size()) {
+        auto next = static_cast<unsigned char>(text[i + 1]);
+        if (next >= 0x80 && next <= 0xBF && LATIN1_BASE_LETTER[next - 0x80]) {
+            return {LATIN1_BASE_LETTER[next - 0x80], 2};
+        }
+    }
+    return {};
+}
+
+} // namespace tt
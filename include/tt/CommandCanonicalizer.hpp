@@ -0,0 +1,25 @@
+/**
+ * CommandCanonicalizer.hpp - One spelling for commands that run the same way
+ *
+ * `ls -la`, `ls -al` and `ls -l -a` should share an explanation and a cache
+ * entry. For utilities whose options are known (coreutils, grep, ss, ...)
+ * bundled short flags are split, option arguments are attached to their
+ * option, and options are sorted in front of the operands, which keep their
+ * order. Everywhere else only the spelling changes: quoting is rewritten in
+ * a single style where that cannot change the expansion, redirections move
+ * to the end of their command, and whitespace and list operators get one
+ * form. Anything the rewrite cannot model (if/for/while bodies, syntax
+ * errors) is only respaced; commands with here-documents are left as is.
+ */
+
+#pragma once
+
+#include <string>
+#include <string_view>
+
+namespace tt {
+
+void canonicalizeCommand(std::string_view command, std::string& out);
+std::string canonicalizeCommand(std::string_view command);
+
+} // namespace tt
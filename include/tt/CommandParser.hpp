@@ -4,8 +4,11 @@
 
 #pragma once
 
+#include "tt/CompactCommand.hpp"
+
 #include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace tt {
@@ -24,6 +27,20 @@ public:
     ~CommandParser();
     
     ParsedCommand parse(const std::string& input);
+    
+    // Every simple command in a shell line: pipelines and lists are split at
+    // their operators; redirections, assignments and keywords are dropped
+    std::vector<ParsedCommand> parseCommands(const std::string& input);
+    
+    // Same results in the flat representation; reusing out across calls
+    // avoids allocating once its buffers have grown. In the list form each
+    // command's raw input is its own source text, not the whole line.
+    void parse(std::string_view input, CompactCommand& out);
+    void parseCommands(std::string_view input, CompactCommandList& out);
+    
+    // Executable names seen by this parser, indexed by executableId()
+    const StringInterner& executables() const;
+    
     bool isQuestion(const std::string& input);
     std::string extractIntent(const std::string& question);
     
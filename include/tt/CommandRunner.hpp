@@ -0,0 +1,97 @@
+/**
+ * CommandRunner.hpp - Run a command under /bin/sh, within limits, and account for what it cost
+ *
+ * The command runs in its own transient cgroup v2, created next to the
+ * caller's cgroup and removed afterwards, so CPU time, peak memory and disk
+ * I/O include every process it started, also those that outlived the shell.
+ * When cgroup v2 is not mounted or not writable (no delegation), the
+ * numbers come from the wait4() rusage of the shell and the children it
+ * waited for. Context switches always come from rusage; cgroups do not
+ * count them.
+ *
+ * The command also gets its own process group, which becomes the terminal's
+ * foreground group while it runs: Ctrl-C stops the command and not tt, and
+ * a timeout can kill the whole group (or the whole cgroup) at once.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace tt {
+
+// Execution policy; a zero field means no limit
+struct RunLimits {
+    std::chrono::milliseconds timeout{0};  // Wall clock; SIGTERM, then SIGKILL 1s later
+    uint64_t cpu_seconds = 0;              // RLIMIT_CPU, per process
+    uint64_t memory_bytes = 0;             // cgroup memory.max, or RLIMIT_AS per process
+    uint64_t file_bytes = 0;               // RLIMIT_FSIZE, largest file it may write
+    uint64_t output_rate = 0;              // Bytes/s read from it; beyond that it blocks on the pipe
+    int nice = 0;                          // Added to tt's niceness
+    int ionice = -1;                       // Best-effort I/O priority 0-7; -1 keeps tt's
+
+    // For commands suggested by the model: 10 min, nice 10, ionice 7, 8 MB/s
+    static RunLimits defaults();
+};
+
+// "timeout=60s,cpu=120,memory=2G,fsize=1G,output=4M,nice=10,ionice=7", on
+// top of the defaults; "none" or 0 turns a limit off, an empty spec keeps
+// the defaults. Returns nothing and sets error on an invalid spec.
+std::optional<RunLimits> parseRunLimits(std::string_view spec, std::string& error);
+std::string toString(const RunLimits& limits);
+
+struct ResourceUsage {
+    bool cgroup = false;             // Measured by a cgroup; rusage otherwise
+    double wall_ms = 0;
+    double user_ms = 0;
+    double sys_ms = 0;
+    uint64_t peak_rss = 0;           // Bytes; 0 when unknown
+    uint64_t read_bytes = 0;         // Storage I/O, not pipes or page cache hits
+    uint64_t write_bytes = 0;
+    uint64_t voluntary_switches = 0;
+    uint64_t involuntary_switches = 0;
+
+    // "1.24s wall, 0.80s user, 0.10s sys, 85.3 MB peak, 12.0 MB read, ..."
+    std::string summary() const;
+};
+
+struct RunOptions {
+    bool use_cgroup = true;
+    size_t max_output = 2000;  // Bytes of stdout/stderr kept in RunResult::output
+    RunLimits limits;
+};
+
+enum class StopReason : uint8_t {
+    NONE,
+    TIMEOUT,
+    CPU,        // SIGXCPU or SIGKILL from RLIMIT_CPU
+    MEMORY,     // Killed by the cgroup OOM killer
+    FILE_SIZE   // SIGXFSZ
+};
+
+struct RunResult {
+    int exit_code = -1;        // Exit code, or 128 + signal
+    std::string output;        // stdout and stderr, interleaved, up to max_output
+    bool truncated = false;
+    std::string error;         // Why it did not run
+    ResourceUsage usage;
+    StopReason stopped = StopReason::NONE;
+    double throttled_ms = 0;   // Time its output was held back by output_rate
+
+    // "timed out after 60s", "exceeded the 2.0 GB memory limit"...; empty
+    // when no limit was hit
+    std::string outcome(const RunLimits& limits) const;
+};
+
+// on_output sees every chunk as it arrives, untruncated
+RunResult runCommand(const std::string& command,
+                     const std::function<void(std::string_view)>& on_output = {},
+                     const RunOptions& options = {});
+
+} // namespace tt
@@ -0,0 +1,123 @@
+/**
+ * CompactCommand.hpp - Flat parsed command: one buffer, spans, interned names
+ *
+ * ParsedCommand keeps every token in its own std::string, so parsing a
+ * 20-word line costs dozens of allocations. A CompactCommand copies the
+ * source text and the unquoted words into a single buffer and refers to
+ * them by offset/length; flag and argument spans live inline for typical
+ * commands. Cleared commands keep their capacity, so a CompactCommandList
+ * reused across lines stops allocating once it has warmed up.
+ *
+ * Executable names are interned by the CommandParser that produced the
+ * command: equal names get equal ids, which callers can use to index their
+ * own per-executable tables instead of hashing strings.
+ */
+
+#pragma once
+
+#include "tt/ShellAst.hpp"
+#include "tt/SmallVector.hpp"
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace tt {
+
+struct ParsedCommand;
+
+struct TokenSpan {
+    uint32_t offset = 0;
+    uint32_t length = 0;
+};
+
+using SpanList = SmallVector<TokenSpan, 8>;
+
+// Maps names to dense ids; names are stored once and never move
+class StringInterner {
+public:
+    static constexpr uint32_t NONE = UINT32_MAX;
+
+    StringInterner();
+    StringInterner(const StringInterner&) = delete;
+    StringInterner& operator=(const StringInterner&) = delete;
+
+    uint32_t intern(std::string_view name);
+    uint32_t find(std::string_view name) const;  // NONE when never interned
+
+    // Valid for the lifetime of the interner
+    std::string_view name(uint32_t id) const { return names_[id]; }
+    size_t size() const { return names_.size(); }
+
+private:
+    Arena storage_;
+    std::vector<std::string_view> names_;
+    std::vector<uint32_t> slots_;  // Open addressing, NONE = empty
+
+    void rehash(size_t slot_count);
+};
+
+class CompactCommand {
+public:
+    std::string_view rawInput() const { return view(raw_); }
+    std::string_view executable() const { return view(executable_); }
+
+    // Id in the parser's executables(); NONE when there is no executable
+    uint32_t executableId() const { return executable_id_; }
+
+    size_t flagCount() const { return flags_.size(); }
+    std::string_view flag(size_t i) const { return view(flags_[i]); }
+    size_t argCount() const { return args_.size(); }
+    std::string_view arg(size_t i) const { return view(args_[i]); }
+
+    bool isQuestion() const { return is_question_; }
+
+    // Copy into the owning representation used by older callers
+    ParsedCommand toParsedCommand() const;
+
+    // Forget the contents but keep the buffer and list capacity
+    void clear();
+
+private:
+    friend class CommandParser;
+
+    std::string buffer_;
+    TokenSpan raw_;
+    TokenSpan executable_;
+    SpanList flags_;
+    SpanList args_;
+    uint32_t executable_id_ = StringInterner::NONE;
+    bool is_question_ = false;
+
+    std::string_view view(TokenSpan span) const {
+        return std::string_view(buffer_).substr(span.offset, span.length);
+    }
+    TokenSpan append(std::string_view text);
+};
+
+// Commands of one line; clear() keeps every command's storage for reuse
+class CompactCommandList {
+public:
+    CompactCommand& add() {
+        if (size_ == items_.size()) items_.emplace_back();
+        CompactCommand& command = items_[size_++];
+        command.clear();
+        return command;
+    }
+
+    void pop_back() { --size_; }
+    void clear() { size_ = 0; }
+
+    const CompactCommand& operator[](size_t i) const { return items_[i]; }
+    const CompactCommand* begin() const { return items_.data(); }
+    const CompactCommand* end() const { return items_.data() + size_; }
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+private:
+    std::vector<CompactCommand> items_;
+    size_t size_ = 0;
+};
+
+} // namespace tt
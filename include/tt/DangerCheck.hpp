@@ -0,0 +1,44 @@
+/**
+ * DangerCheck.hpp - Detect commands that need confirmation before running
+ */
+
+#pragma once
+
+#include "tt/DangerRules.hpp"
+
+#include <string>
+#include <string_view>
+
+namespace tt {
+
+class ShellAst;
+
+struct RiskAssessment {
+    Severity severity = Severity::NONE;  // Of the most severe finding
+    int score = 0;                       // 0..100; extra findings raise it within the severity band
+    int findings = 0;
+    std::string rule;                    // Most severe finding, e.g. "kubectl delete"
+    std::string source;                  // "builtin" or "<rule file>:<line>"
+
+    bool needsConfirmation() const { return severity >= Severity::MEDIUM; }
+};
+
+// Every command the line would run (including through pipes, lists,
+// substitutions, sudo, xargs, find -exec and sh -c) is matched against the
+// rules, and writes to system paths or devices, fork bombs and downloads
+// piped into a shell are flagged as well.
+RiskAssessment assessRisk(const ShellAst& ast, const DangerRules& rules);
+RiskAssessment assessRisk(const ShellAst& ast);  // DangerRules::active()
+RiskAssessment assessRisk(std::string_view command);
+
+// assessRisk(...).needsConfirmation()
+bool isDangerousCommand(const ShellAst& ast);
+bool isDangerousCommand(std::string_view command);
+
+// A function that calls itself in a pipeline or in the background
+bool containsForkBomb(const ShellAst& ast);
+
+// curl/wget output piped into a shell
+bool pipesDownloadToShell(const ShellAst& ast);
+
+} // namespace tt
@@ -0,0 +1,93 @@
+/**
+ * DangerRules.hpp - Site rule packs for the danger check, compiled to a cached image
+ *
+ * A rule is a severity, a command name and words that must all be present,
+ * one per line in *.rules files:
+ *
+ *     # Kubernetes
+ *     high      kubectl delete
+ *     critical  terraform destroy
+ *     medium    git push --force
+ *
+ * Words match like the builtin blocklist: case-insensitively, and "-f" also
+ * inside bundles such as "-rf". The builtin rules come first, then the files
+ * in /etc/tt/rules.d and $XDG_CONFIG_HOME/tt/rules.d (~/.config/tt/rules.d),
+ * each directory in file name order.
+ *
+ * Rules are compiled into one flat image: an open-addressed table of
+ * command names pointing at their rules and words in a string pool. The
+ * image is written to $XDG_CACHE_HOME/tt (~/.cache/tt) under the hash of
+ * the rule files, so later runs mmap it instead of parsing the rules again.
+ * Rule files with errors are never cached, so their errors are always reported.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace tt {
+
+struct CommandNode;
+
+enum class Severity : uint8_t {
+    NONE,
+    LOW,       // Shown, runs without confirmation
+    MEDIUM,    // Needs confirmation
+    HIGH,
+    CRITICAL
+};
+
+const char* toString(Severity severity);
+std::optional<Severity> parseSeverity(std::string_view text);
+
+struct RuleMatch {
+    Severity severity = Severity::NONE;
+    std::string_view rule;    // "kubectl delete"
+    std::string_view source;  // "builtin" or "<file>:<line>"
+};
+
+struct RuleError {
+    std::string file;
+    int line = 0;
+    std::string message;
+};
+
+class DangerRules {
+public:
+    DangerRules(DangerRules&&) noexcept;
+    DangerRules& operator=(DangerRules&&) noexcept;
+    ~DangerRules();
+
+    // Builtin rules plus the *.rules files in dirs. With a cache_dir the
+    // image is mapped from there when the rule files are unchanged, and
+    // written there otherwise unless they had errors; an empty cache_dir
+    // always compiles.
+    static DangerRules load(const std::vector<std::string>& dirs, const std::string& cache_dir = "");
+
+    // Rules from the default directories, loaded once per process
+    static const DangerRules& active();
+
+    static std::vector<std::string> defaultDirs();
+    static std::string defaultCacheDir();
+
+    // Most severe rule that matches this command, if any
+    std::optional<RuleMatch> match(const CommandNode& cmd) const;
+
+    size_t ruleCount() const;
+    bool fromCache() const;                       // Image was mapped, not compiled
+    const std::vector<std::string>& files() const;  // Rule files read
+    const std::vector<RuleError>& errors() const;   // Lines skipped while compiling
+
+private:
+    DangerRules();
+
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+} // namespace tt
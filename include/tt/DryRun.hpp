@@ -0,0 +1,59 @@
+/**
+ * DryRun.hpp - Run a command in a throwaway sandbox and report its file changes
+ *
+ * The command runs under /bin/sh in new user, mount, PID, IPC and network
+ * namespaces. Each root (the working directory by default) is overlaid with
+ * a tmpfs upper layer; the rest of the filesystem is read-only, /tmp and
+ * /run are empty tmpfs mounts and /dev only holds the null, zero, full,
+ * random and urandom nodes. Once the command exits or times out, every
+ * process left in the sandbox is killed and the upper layers are diffed
+ * against the real roots, so the result lists the files the command really
+ * created, modified or deleted without any of it reaching the disk.
+ *
+ * Needs Linux 5.12+ with unprivileged user namespaces; otherwise the result
+ * carries an error and nothing runs.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace tt {
+
+enum class FileChange : uint8_t {
+    CREATED,
+    MODIFIED,
+    DELETED
+};
+
+struct FileEffect {
+    std::string path;
+    FileChange change;
+};
+
+struct DryRunOptions {
+    std::vector<std::string> roots;  // Writable directories; empty means the working directory
+    std::chrono::milliseconds timeout{5000};
+    size_t max_output = 16 * 1024;   // Bytes of stdout/stderr kept
+};
+
+struct DryRunResult {
+    bool ran = false;                 // Sandbox set up and command started
+    std::string error;                // Why it did not run
+    int exit_status = -1;             // Exit code, or 128 + signal
+    bool timed_out = false;
+    std::string output;               // stdout and stderr, interleaved and truncated
+    std::vector<FileEffect> effects;  // Sorted by path
+    double setup_ms = 0;              // Until the command started
+    double total_ms = 0;
+};
+
+DryRunResult dryRun(const std::string& command, const DryRunOptions& options = {});
+
+const char* toString(FileChange change);
+
+} // namespace tt
@@ -1,14 +1,22 @@
 /**
  * ExplainerEngine.hpp - Command explanation engine with multiple modes
+ *
+ * The *Streaming variants hand each chunk to a callback as the model
+ * produces it, over the same transport as generateContentStreaming, and
+ * record time to first token and total time per request.
  */
 
 #pragma once
 
+#include <atomic>
+#include <functional>
 #include <string>
+#include <vector>
 
 namespace tt {
 
 class GeminiClient;
+class ShellAst;
 
 enum class ExplainMode {
     NORMAL,     // Technical explanation
@@ -16,8 +24,19 @@ enum class ExplainMode {
     DETAILED    // With examples and use cases
 };
 
+const char* toString(ExplainMode mode);
+
+struct StreamTiming {
+    std::string mode;       // "normal", "eli5", "detailed", "fix" or "translate"
+    double ttft_ms = -1;    // Until the first chunk; -1 when none arrived
+    double total_ms = 0;
+    bool cancelled = false;
+};
+
 class ExplainerEngine {
 public:
+    using ChunkCallback = std::function<void(const std::string& chunk)>;
+    
     explicit ExplainerEngine(GeminiClient& gemini);
     ~ExplainerEngine();
     
@@ -25,10 +44,29 @@ public:
     std::string suggestFix(const std::string& failed_command, const std::string& error_msg);
     std::string translateQuestion(const std::string& question);
     
+    // Same answers, streamed; return the full text (what arrived, when
+    // cancelled). Setting *cancel from another thread or a signal handler
+    // stops the request within a second.
+    std::string explainStreaming(const std::string& command, ExplainMode mode, const ChunkCallback& on_chunk,
+                                 const std::atomic<bool>* cancel = nullptr);
+    std::string suggestFixStreaming(const std::string& failed_command, const std::string& error_msg,
+                                    const ChunkCallback& on_chunk, const std::atomic<bool>* cancel = nullptr);
+    std::string translateQuestionStreaming(const std::string& question, const ChunkCallback& on_chunk,
+                                           const std::atomic<bool>* cancel = nullptr);
+    
+    // One entry per streamed request, oldest first
+    const std::vector<StreamTiming>& timings() const { return timings_; }
+    
 private:
     GeminiClient& gemini_;
+    std::vector<StreamTiming> timings_;
+    std::string prompt_;  // Render buffer, reused across requests
     
-    std::string buildExplainPrompt(const std::string& command, ExplainMode mode);
+    const std::string& buildExplainPrompt(const std::string& command, ExplainMode mode);
+    const std::string& buildFixPrompt(const std::string& failed_command, const std::string& error_msg);
+    std::string describeStructure(const ShellAst& ast);
+    std::string stream(const char* mode, const std::string& prompt, const char* error_prefix,
+                       const ChunkCallback& on_chunk, const std::atomic<bool>* cancel);
 };
 
 } // namespace tt
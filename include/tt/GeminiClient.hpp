@@ -4,6 +4,10 @@
 
 #pragma once
 
+#include "tt/TokenUsage.hpp"
+
+#include <atomic>
+#include <cstdint>
 #include <functional>
 #include <memory>
 #include <string>
@@ -15,6 +19,15 @@ struct GeminiResponse {
     std::string content;
     bool success;
     std::string error;
+    TokenUsage usage;  // From usageMetadata; zero when the request failed
+};
+
+// What a client's model requests cost so far
+struct ClientUsage {
+    uint32_t requests = 0;
+    double latency_ms = 0;      // Sum over requests, from sending to the last byte
+    double first_byte_ms = -1;  // Of the last request; -1 when unknown
+    TokenUsage tokens;          // Sum over responses
 };
 
 // Smart response with intent detection
@@ -25,6 +38,7 @@ struct SmartResponse {
     std::string explanation; // If type == EXPLAIN
     std::string error;       // If type == ERROR
     bool success;
+    TokenUsage usage;
 };
 
 class GeminiClient {
@@ -43,8 +57,13 @@ public:
     // Streaming smart query - outputs explanation in real-time
     SmartResponse smartQueryStreaming(const std::string& query, StreamCallback on_chunk);
     
-    // Streaming content generation - plain text, real-time output
-    void generateContentStreaming(const std::string& prompt, StreamCallback on_chunk);
+    // Streaming content generation - plain text, real-time output; the
+    // returned response holds the whole text once the stream ends. Setting
+    // *cancel stops it within a second, with error "Cancelled" and the
+    // text received so far as content. The prompt brings its own language
+    // instruction (languageInstruction()).
+    GeminiResponse generateContentStreaming(const std::string& prompt, StreamCallback on_chunk,
+                                            const std::atomic<bool>* cancel = nullptr);
     
     // Get command for --run mode (returns JSON with command)
     GeminiResponse getCommandForTask(const std::string& task);
@@ -58,12 +77,21 @@ public:
     // Validate API key and model by making a test request
     bool validate(std::string& error_message);
     
-    // Add executed command and its output to session history
-    void addCommandOutput(const std::string& command, const std::string& output);
+    // Add executed command, its output and what it cost to session history
+    void addCommandOutput(const std::string& command, const std::string& output,
+                          const std::string& resources = "");
     
-    // Count tokens in current session, returns -1 on error
+    // Tokens in the current session's history, as of its latest request;
+    // asks the countTokens endpoint only for sessions with no recorded
+    // usage yet. Returns -1 on error
     int countSessionTokens();
     
+    // Requests made through this client, for the metrics store
+    const ClientUsage& usage() const;
+    
+    // "Respond in ...", for the language slot of prompt templates
+    std::string languageInstruction() const;
+    
     // List available sessions in ~/.tt/
     static std::vector<std::string> listSessions();
     
@@ -0,0 +1,72 @@
+/**
+ * HistoryAnalyzer.hpp - Executable and flag usage mined from shell history
+ *
+ * Reads bash, zsh (plain or extended format) and fish history files through
+ * mmap and parses their entries in parallel chunks with CommandParser. The
+ * byte offset reached in each file is persisted with the counts, so later
+ * runs only parse entries appended since; a file that was rewritten
+ * (truncated by HISTSIZE, edited) is detected and counted again from scratch.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace tt {
+
+enum class HistoryFormat {
+    BASH,   // One command per line, optional "#<epoch>" timestamp lines
+    ZSH,    // ": <epoch>:<duration>;command" or plain, '\' continues a line
+    FISH    // "- cmd: command" entries
+};
+
+struct HistorySource {
+    std::string path;
+    HistoryFormat format;
+};
+
+struct HistoryScan {
+    size_t files = 0;            // History files that exist
+    size_t rescanned_files = 0;  // Rewritten since the last run, counted again
+    size_t new_entries = 0;      // Entries parsed by this run
+    size_t new_bytes = 0;
+};
+
+struct UsageCount {
+    std::string name;
+    uint64_t count;
+};
+
+class HistoryAnalyzer {
+public:
+    // path: empty = ~/.tt/history_stats.json
+    explicit HistoryAnalyzer(const std::string& path = "");
+    ~HistoryAnalyzer();
+
+    // Parse entries added since the last run and persist the new counts
+    HistoryScan update();
+    HistoryScan update(const std::vector<HistorySource>& sources);
+
+    uint64_t totalEntries() const;
+    uint64_t executableCount(const std::string& executable) const;
+    uint64_t flagCount(const std::string& executable, const std::string& flag) const;
+
+    // Most used first; ties in name order
+    std::vector<UsageCount> topExecutables(size_t limit) const;
+    std::vector<UsageCount> topFlags(const std::string& executable, size_t limit) const;
+
+    void clear();
+
+    // ~/.bash_history, ~/.zsh_history ($ZDOTDIR) and fish history, when present
+    static std::vector<HistorySource> defaultSources();
+    static std::string getDefaultPath();
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+} // namespace tt
@@ -0,0 +1,58 @@
+/**
+ * IntentRouter.hpp - Local intent classifier that routes obvious inputs
+ *
+ * A linear model over hashed word n-grams and input-shape features decides
+ * whether an input is a request for an explanation, a task that needs a
+ * command, or a shell command pasted as-is. Weights are produced by
+ * tools/train_intent.cpp and compiled in (src/IntentWeights.inc); scoring
+ * never allocates. Inputs below the confidence threshold go to smartQuery.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+
+namespace tt {
+
+enum class Intent : uint8_t {
+    EXPLAIN,   // Greeting or conceptual question: stream an explanation
+    TASK,      // Wants something done: generate a command
+    SHELL      // Already a command line: run it as typed
+};
+
+constexpr size_t INTENT_COUNT = 3;
+
+// Hashed n-gram buckets followed by the fixed shape features
+constexpr size_t INTENT_HASH_BUCKETS = 4096;
+constexpr size_t INTENT_SHAPE_FEATURES = 16;
+constexpr size_t INTENT_FEATURE_COUNT = INTENT_HASH_BUCKETS + INTENT_SHAPE_FEATURES;
+
+struct IntentFeatures {
+    static constexpr size_t MAX_FEATURES = 96;
+    uint16_t index[MAX_FEATURES];
+    size_t count = 0;
+};
+
+struct IntentScore {
+    Intent intent = Intent::EXPLAIN;
+    float confidence = 0.0f;             // Probability of intent
+    float probability[INTENT_COUNT] = {};
+};
+
+constexpr float DEFAULT_ROUTE_CONFIDENCE = 0.9f;
+
+// Feature indices for an input; shared by inference and the trainer
+void extractIntentFeatures(std::string_view input, IntentFeatures& out) noexcept;
+
+IntentScore scoreIntent(std::string_view input) noexcept;
+
+// The intent when the model is at least min_confidence sure, nullopt otherwise
+std::optional<Intent> routeIntent(std::string_view input,
+                                  float min_confidence = DEFAULT_ROUTE_CONFIDENCE) noexcept;
+
+const char* toString(Intent intent);
+
+} // namespace tt
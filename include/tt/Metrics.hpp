@@ -0,0 +1,94 @@
+/**
+ * Metrics.hpp - Local per-request metrics and the tt --stats report
+ *
+ * Every request appends one fixed-size 64-byte record to ~/.tt/metrics.bin
+ * with a single O_APPEND write, so concurrent tt processes never interleave
+ * and a write cut short leaves at most a partial record at the end, which
+ * is skipped. Past MAX_FILE_BYTES the file moves to metrics.bin.1 (one old
+ * generation is kept) and a new one starts.
+ *
+ * summarize() groups the records of a time window by mode and model, with
+ * latency percentiles, token spend and cache hit rate; toPrometheus()
+ * renders the same report for node_exporter's textfile collector.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace tt {
+
+enum class RequestMode : uint8_t { QUERY, RUN, EXPLAIN, ELI5, WHATIF, CONSOLE };
+
+std::string_view toString(RequestMode mode);
+
+struct RequestMetrics {
+    std::chrono::system_clock::time_point time;
+    RequestMode mode = RequestMode::QUERY;
+    std::string model;          // Up to 28 bytes are stored
+    double total_ms = 0;        // Until the answer was complete, as the user waited for it
+    double model_ms = 0;        // Of that, waiting on the API; 0 for cache hits
+    double first_byte_ms = -1;  // Until the first byte of the last answer; -1 when unknown
+    uint32_t input_tokens = 0;
+    uint32_t output_tokens = 0;
+    uint32_t cached_tokens = 0;  // Input tokens served from the prompt cache
+    bool cache_hit = false;     // Answered from a local cache, without the model
+    bool error = false;
+};
+
+class MetricsStore {
+public:
+    // path: empty = ~/.tt/metrics.bin
+    explicit MetricsStore(const std::string& path = "");
+
+    bool append(const RequestMetrics& metrics);
+
+    // Records at or after since, oldest first; the rotated file included
+    std::vector<RequestMetrics> read(std::chrono::system_clock::time_point since = {}) const;
+
+    void clear();
+
+    static std::string getDefaultPath();
+
+    static constexpr size_t MAX_FILE_BYTES = size_t{8} << 20;  // 131072 records
+
+private:
+    std::string path_;
+};
+
+struct MetricsGroup {
+    RequestMode mode = RequestMode::QUERY;
+    std::string model;
+    size_t requests = 0;
+    size_t errors = 0;
+    size_t cache_hits = 0;
+    double p50_ms = 0;  // total_ms percentiles, nearest rank
+    double p95_ms = 0;
+    double p99_ms = 0;
+    double total_ms = 0;  // Sums
+    double model_ms = 0;
+    uint64_t input_tokens = 0;
+    uint64_t output_tokens = 0;
+    uint64_t cached_tokens = 0;
+};
+
+struct MetricsReport {
+    std::vector<MetricsGroup> groups;  // By mode, then model
+    MetricsGroup all;                  // Every record; mode and model unset
+};
+
+MetricsReport summarize(const std::vector<RequestMetrics>& records);
+
+// Gauges over the report's window, labeled by mode and model
+std::string toPrometheus(const MetricsReport& report);
+
+// "30m", "24h", "7d", "2w"; "all" is zero. Nothing for anything else
+std::optional<std::chrono::seconds> parseWindow(std::string_view text);
+
+} // namespace tt
@@ -0,0 +1,192 @@
+/**
+ * PromptTemplate.hpp - Prompts as compile-time text with slots, invariant text first
+ *
+ * A template is a string literal with "{}" slots, split into its static
+ * segments at compile time (a malformed template does not compile). Every
+ * prompt below puts all instructions first and the request-specific parts
+ * (the command, the user's question, local analysis) last, so two requests
+ * of the same kind share the longest possible prefix, which is what
+ * server-side prefix caching keys on. Rendering appends into a caller-owned
+ * buffer that keeps its capacity between calls.
+ */
+
+#pragma once
+
+#include "tt/Trace.hpp"
+
+#include <array>
+#include <cstddef>
+#include <initializer_list>
+#include <string>
+#include <string_view>
+
+namespace tt {
+
+class PromptTemplate {
+public:
+    static constexpr size_t MAX_SLOTS = 8;
+
+    consteval PromptTemplate(std::string_view text) {
+        size_t start = 0;
+        for (size_t slot = text.find("{}"); slot != std::string_view::npos; slot = text.find("{}", start)) {
+            if (slots_ == MAX_SLOTS) throw "PromptTemplate: too many slots";
+            literals_[slots_++] = text.substr(start, slot - start);
+            start = slot + 2;
+        }
+        literals_[slots_] = text.substr(start);
+        for (size_t i = 0; i <= slots_; ++i) static_size_ += literals_[i].size();
+        if (slots_ > 0 && literals_[0].empty()) throw "PromptTemplate: must start with static text";
+    }
+
+    // Static text before the first slot, the same in every rendering
+    constexpr std::string_view prefix() const { return literals_[0]; }
+    constexpr size_t slotCount() const { return slots_; }
+    constexpr size_t staticSize() const { return static_size_; }
+
+    // Replaces out with the template filled in order; missing values are empty
+    void render(std::string& out, std::initializer_list<std::string_view> values) const {
+        trace::Span span("prompt.build", "prompt");
+        size_t size = static_size_;
+        for (auto value : values) size += value.size();
+        out.clear();
+        out.reserve(size);
+        out.append(literals_[0]);
+        auto value = values.begin();
+        for (size_t i = 1; i <= slots_; ++i) {
+            if (value != values.end()) out.append(*value++);
+            out.append(literals_[i]);
+        }
+        span.arg("bytes", static_cast<int64_t>(out.size()));
+    }
+
+    std::string render(std::initializer_list<std::string_view> values) const {
+        std::string out;
+        render(out, values);
+        return out;
+    }
+
+private:
+    std::array<std::string_view, MAX_SLOTS + 1> literals_{};
+    size_t slots_ = 0;
+    size_t static_size_ = 0;
+};
+
+namespace prompts {
+
+// {language instruction} {query}
+inline constexpr PromptTemplate SMART_QUERY{
+    "Classify the user request at the end of this message and answer it:\n"
+    "1. EXECUTE: If user wants to DO something with the system (find files, list processes, check disk, etc.)\n"
+    "2. EXPLAIN: For greetings, questions about concepts, explanations (hi, hello, why, what is, how does X work)\n\n"
+    "Greetings like 'hi', 'hello', 'ola' are ALWAYS type explain.\n"
+    "Only use execute if the user clearly wants to run a shell command.\n\n"
+    "Respond with ONLY valid JSON:\n"
+    "Execute: {\"type\":\"execute\",\"command\":\"shell command\",\"explanation\":\"1-line plain text explanation\"}\n"
+    "Explain: {\"type\":\"explain\",\"response\":\"plain text response\"}\n\n"
+    "CRITICAL: No markdown, no backticks, no asterisks, no formatting. Plain text only.\n"
+    "{}\n\n"
+    "User request: {}"};
+
+// {task}
+inline constexpr PromptTemplate COMMAND_FOR_TASK{
+    "Give the shell command for the task at the end of this message.\n"
+    "Respond with ONLY a JSON object:\n"
+    "{\"command\":\"the shell command\",\"explanation\":\"1-line explanation\"}\n\n"
+    "CRITICAL: Return ONLY valid JSON. No markdown, no text before or after.\n\n"
+    "User wants to: {}"};
+
+// {task}
+inline constexpr PromptTemplate COMMAND_ONLY{
+    "Give the shell command for the task at the end of this message.\n"
+    "Respond with ONLY the exact shell command, nothing else. "
+    "No explanation, no quotes, no backticks. Just the raw command.\n\n"
+    "User wants to: {}"};
+
+// {language instruction} {task}
+inline constexpr PromptTemplate SUGGEST_COMMAND{
+    "Give the exact command for the task at the end of this message, then one sentence explaining it. "
+    "No emojis, no bullet points. Keep it very short. {}\n\n"
+    "User wants to: {}"};
+
+// {language instruction} {command}
+inline constexpr PromptTemplate EXPLAIN_BRIEF{
+    "Explain the command at the end of this message briefly and directly.\n"
+    "Format: One short paragraph with what it does, then each flag explained in one line. "
+    "No emojis, no bullet points, no headers. Keep it under 100 words. {}\n\n"
+    "Command: {}"};
+
+// {locale} {command}
+inline constexpr PromptTemplate ELI5_BRIEF{
+    "Explain the command at the end of this message to a 5-year-old in 2-3 simple sentences "
+    "using a real-world analogy.\n"
+    "No emojis, no bullet points. Very short and simple. "
+    "Respond in the language corresponding to this locale: {}.\n\n"
+    "Command: {}"};
+
+// {language instruction} {command} {context line, may be empty}
+inline constexpr PromptTemplate SIMULATE_BRIEF{
+    "Predict what happens when running the command at the end of this message.\n"
+    "Give a brief prediction: what files are affected, expected output, any risks. "
+    "No emojis, no bullet points. Keep it very short and direct. {}\n\n"
+    "Command: {}\n{}"};
+
+// ExplainerEngine modes: {language instruction} {command} {local structure, may be empty}
+inline constexpr PromptTemplate EXPLAIN_NORMAL{
+    "Voce e um assistente de ensino de CLI. Explique o comando no fim desta mensagem de forma clara e educativa.\n\n"
+    "Forneca:\n"
+    "1. Um resumo breve do que ele faz\n"
+    "2. Explicacao de cada flag/opcao usada\n"
+    "3. Um exemplo pratico de quando usar\n\n"
+    "Mantenha a explicacao concisa mas informativa. {}\n\n"
+    "Comando: {}\n\n{}"};
+
+inline constexpr PromptTemplate EXPLAIN_ELI5{
+    "Voce e um professor muito paciente explicando comandos de terminal para uma crianca de 5 anos. "
+    "Use analogias simples do dia-a-dia, evite jargao tecnico, e seja amigavel.\n\n"
+    "Explique o que o comando no fim desta mensagem faz como se estivesse explicando para uma crianca. "
+    "Use exemplos do mundo real (como organizar brinquedos, encontrar coisas em casa, etc). {}\n\n"
+    "Comando: {}\n\n{}"};
+
+inline constexpr PromptTemplate EXPLAIN_DETAILED{
+    "Voce e um instrutor Linux avancado. Forneca uma explicacao tecnica detalhada do comando no fim desta mensagem.\n\n"
+    "Inclua:\n"
+    "1. Sintaxe completa e todas as opcoes disponiveis\n"
+    "2. Exemplos praticos de uso\n"
+    "3. Comandos relacionados\n"
+    "4. Armadilhas comuns e melhores praticas\n"
+    "5. Como combinar com outros comandos (pipes, redirecionamento)\n\n"
+    "{}\n\n"
+    "Comando: {}\n\n{}"};
+
+// {language instruction} {failed command} {error message}
+inline constexpr PromptTemplate SUGGEST_FIX{
+    "Voce e um assistente de CLI ajudando a corrigir o comando que falhou, descrito no fim desta mensagem.\n\n"
+    "Forneca:\n"
+    "1. O que causou o erro\n"
+    "2. O comando corrigido\n"
+    "3. Uma breve explicacao da correcao\n\n"
+    "Seja direto e pratico. {}\n\n"
+    "Comando que falhou: {}\n"
+    "Mensagem de erro: {}"};
+
+// Simulator: {language instruction} {command} {sandbox observation, may be empty}
+inline constexpr PromptTemplate PREDICTION{
+    "Voce e um simulador de comandos Linux. Preveja o que aconteceria se o comando no fim desta mensagem "
+    "fosse executado.\n\n"
+    "Responda em formato estruturado:\n"
+    "ARQUIVOS_AFETADOS: (liste arquivos/diretorios que seriam modificados, criados ou deletados)\n"
+    "SAIDA_ESPERADA: (o que apareceria no terminal)\n"
+    "RISCOS: (possiveis problemas ou efeitos colaterais)\n"
+    "NIVEL_DESTRUTIVIDADE: (BAIXO, MEDIO, ALTO)\n\n"
+    "Seja preciso e tecnico. {}\n\n"
+    "Comando: {}\n\n{}"};
+
+// {exit status} {" (interrompido por tempo limite)" or empty} {output} {"- file\n" lines}
+inline constexpr PromptTemplate DRY_RUN_OBSERVATION{
+    "O comando foi executado em um sandbox descartavel. Codigo de saida: {}{}\n"
+    "Saida observada:\n{}\n"
+    "Arquivos alterados:\n{}"};
+
+} // namespace prompts
+
+} // namespace tt
@@ -0,0 +1,60 @@
+/**
+ * QueryCache.hpp - Near-duplicate cache for --run tasks
+ *
+ * Maps a natural language task ("find the largest files here") to the
+ * command and explanation Gemini produced for it. Lookups use normalized
+ * text fingerprints, so small rewordings resolve without a model call.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+
+namespace tt {
+
+struct CacheHit {
+    std::string command;
+    std::string explanation;
+    std::string matched_query;  // Query originally stored for this entry
+    double similarity;          // Jaccard similarity of normalized terms, 0..1
+    bool exact;                 // Normalized forms were identical
+};
+
+struct QueryCacheStats {
+    uint64_t lookups = 0;
+    uint64_t hits = 0;
+    uint64_t exact_hits = 0;
+    double similarity_sum = 0.0;  // Sum over hits, for mean hit quality
+    size_t entries = 0;
+};
+
+class QueryCache {
+public:
+    // path: empty = ~/.tt/query_cache.json
+    explicit QueryCache(const std::string& path = "", double threshold = DEFAULT_THRESHOLD);
+    ~QueryCache();
+
+    // Best entry whose similarity reaches the threshold, if any. Scope words
+    // ("all", "old", "except") must match, and commands rated above LOW risk
+    // need the same terms. The returned command is untrusted: callers must
+    // still run danger checks. A miss is not written to disk.
+    std::optional<CacheHit> lookup(const std::string& query);
+
+    void store(const std::string& query, const std::string& command, const std::string& explanation);
+    void clear();
+
+    QueryCacheStats stats() const;
+
+    static std::string getDefaultPath();
+
+    static constexpr double DEFAULT_THRESHOLD = 0.75;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+} // namespace tt
@@ -0,0 +1,44 @@
+/**
+ * QueryNormalizer.hpp - Canonical text and stable keys for natural-language queries
+ *
+ * "Como eu listo arquivos?" and "como eu listo arquivos" should share one
+ * cache entry. normalizeQuery() composes decomposed accents (NFC for the
+ * Latin-1 range), folds case, strips sentence punctuation and leading filler
+ * phrases in pt/en/es ("como eu", "how do i", "por favor"), and collapses
+ * whitespace. Operands that look like paths, flags or quoted text keep their
+ * exact bytes, since "/tmp/Build" and "/tmp/build" are different requests.
+ * queryKey() hashes the result to 128 bits; keys are stable across runs and
+ * platforms and can be persisted.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace tt {
+
+struct QueryKey {
+    uint64_t hi = 0;
+    uint64_t lo = 0;
+
+    bool operator==(const QueryKey&) const = default;
+    std::string hex() const;
+};
+
+void normalizeQuery(std::string_view query, std::string& out);
+std::string normalizeQuery(std::string_view query);
+
+// MurmurHash3 x64/128 of normalizeQuery(query)
+QueryKey queryKey(std::string_view query);
+
+// Same, for text that is already normalized
+QueryKey normalizedKey(std::string_view normalized) noexcept;
+
+// Bytes of leading filler phrases in foldCase()d text, separators included;
+// 0 when nothing would remain after them
+size_t intentPrefixLength(std::string_view folded) noexcept;
+
+} // namespace tt
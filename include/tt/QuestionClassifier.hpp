@@ -0,0 +1,26 @@
+/**
+ * QuestionClassifier.hpp - Tell natural-language questions from shell commands
+ *
+ * Matches whole words against a keyword table (pt/en/es) that is hashed at
+ * compile time. Interrogatives ("how", "qual", "cuándo") count anywhere;
+ * imperatives and auxiliaries ("show", "mostre", "dime", "can") only when
+ * they open the sentence. Classification never allocates.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <span>
+#include <string>
+#include <string_view>
+
+namespace tt {
+
+bool isQuestion(std::string_view input) noexcept;
+
+// Classify inputs[i] into out[i]; out must be at least as long as inputs.
+// Returns how many inputs are questions.
+size_t classifyQuestions(std::span<const std::string_view> inputs, std::span<bool> out) noexcept;
+size_t classifyQuestions(std::span<const std::string> inputs, std::span<bool> out) noexcept;
+
+} // namespace tt
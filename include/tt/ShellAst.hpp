@@ -0,0 +1,205 @@
+/**
+ * ShellAst.hpp - Shell syntax tree built into a per-parse arena
+ *
+ * Covers lists (; & && ||), pipelines, subshells, brace groups, function
+ * definitions, redirections, here-documents and command substitutions.
+ * Commands that run other commands (sudo, xargs, find -exec, sh -c, ...)
+ * expose those as nested commands, so analyses see what actually executes.
+ *
+ * All nodes live in the arena owned by ShellAst and are trivially
+ * destructible; the tree is valid for the lifetime of the ShellAst.
+ */
+
+#pragma once
+
+#include "tt/ShellLexer.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <string_view>
+#include <utility>
+
+namespace tt {
+
+// Bump allocator: one inline block, then heap blocks freed all at once
+class Arena {
+public:
+    Arena();
+    ~Arena();
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    void* allocate(size_t size, size_t align);
+
+    template <typename T, typename... Args>
+    T* make(Args&&... args) {
+        return new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    }
+
+    template <typename T>
+    T* makeArray(const T* values, size_t count) {
+        if (count == 0) return nullptr;
+        T* out = static_cast<T*>(allocate(sizeof(T) * count, alignof(T)));
+        for (size_t i = 0; i < count; ++i) new (out + i) T(values[i]);
+        return out;
+    }
+
+    std::string_view copy(std::string_view text);
+
+    size_t bytesUsed() const { return used_; }
+
+private:
+    static constexpr size_t INLINE_SIZE = 2048;
+    static constexpr size_t BLOCK_SIZE = 8192;
+
+    struct Block {
+        Block* prev;
+        size_t size;
+    };
+
+    alignas(std::max_align_t) char inline_[INLINE_SIZE];
+    char* cursor_;
+    char* limit_;
+    Block* blocks_ = nullptr;
+    size_t used_ = 0;
+};
+
+struct ListNode;
+
+struct Word {
+    std::string_view raw;   // Source text
+    std::string_view text;  // After quote removal; substitutions kept verbatim
+    uint8_t flags = 0;      // TokenFlags
+    const ListNode* substitutions = nullptr;  // Parsed $(...) `...` <(...) bodies, chained by next
+
+    bool has(TokenFlags f) const { return (flags & f) != 0; }
+};
+
+struct Redirect {
+    TokenKind op = TokenKind::GREAT;
+    int fd = -1;                    // Explicit descriptor, -1 for the operator's default
+    Word target;                    // File, descriptor or here-doc delimiter
+    std::string_view heredoc_body;  // For << and <<-
+
+    bool writes() const;            // Creates or modifies its target
+};
+
+enum class NodeKind : uint8_t {
+    LIST,
+    PIPELINE,
+    COMMAND,
+    SUBSHELL,   // ( list )
+    GROUP       // { list; }, also function bodies
+};
+
+struct Node {
+    NodeKind kind;
+    const Node* next = nullptr;  // Sibling in nested-command and substitution chains
+
+    explicit Node(NodeKind k) : kind(k) {}
+};
+
+struct CommandNode : Node {
+    const Word* assignments = nullptr;
+    uint32_t assignment_count = 0;
+    const Word* words = nullptr;
+    uint32_t word_count = 0;
+    const Redirect* redirects = nullptr;
+    uint32_t redirect_count = 0;
+    const Node* nested = nullptr;  // Commands this one runs, chained by next
+    const CommandNode* runner = nullptr;  // Set on nested commands: the sudo/xargs/... running it
+
+    CommandNode() : Node(NodeKind::COMMAND) {}
+
+    // Basename of the first word ("/bin/rm" -> "rm"); empty for bare assignments
+    std::string_view name() const;
+
+    // Short flag, also inside bundles ("-rf" has 'r' and 'f'); letters only
+    bool hasShortFlag(char flag) const;
+    bool hasLongFlag(std::string_view flag) const;
+    bool hasWord(std::string_view text) const;
+};
+
+struct PipelineNode : Node {
+    const Node* const* commands = nullptr;  // CommandNode or CompoundNode
+    uint32_t count = 0;
+    bool negated = false;
+
+    PipelineNode() : Node(NodeKind::PIPELINE) {}
+};
+
+struct ListItem {
+    const PipelineNode* pipeline;
+    TokenKind separator;  // Operator after this item: AND_IF, OR_IF, SEMI, AMP, NEWLINE or END
+};
+
+struct ListNode : Node {
+    const ListItem* items = nullptr;
+    uint32_t count = 0;
+
+    ListNode() : Node(NodeKind::LIST) {}
+};
+
+struct CompoundNode : Node {
+    const ListNode* body = nullptr;
+    const Redirect* redirects = nullptr;
+    uint32_t redirect_count = 0;
+    std::string_view function_name;  // Set when this is a function body
+
+    explicit CompoundNode(NodeKind k) : Node(k) {}
+};
+
+class AstVisitor {
+public:
+    virtual ~AstVisitor() = default;
+
+    virtual void visitList(const ListNode&) {}
+    virtual void visitPipeline(const PipelineNode&) {}
+    virtual void visitCommand(const CommandNode&) {}
+    virtual void visitCompound(const CompoundNode&) {}
+    virtual void visitRedirect(const Redirect&) {}
+    virtual void visitWord(const Word&) {}
+};
+
+// Depth-first walk, including substitutions and nested commands
+void walk(const Node& node, AstVisitor& visitor);
+
+class ShellAst {
+public:
+    explicit ShellAst(std::string_view input);
+    ShellAst(const ShellAst&) = delete;
+    ShellAst& operator=(const ShellAst&) = delete;
+
+    const ListNode& root() const { return *root_; }
+    std::string_view source() const { return source_; }
+
+    // False when the input had a syntax error; the tree is best effort then
+    bool complete() const { return error_ == nullptr; }
+    const char* error() const { return error_; }
+
+    void accept(AstVisitor& visitor) const { walk(*root_, visitor); }
+
+    // Calls fn(const CommandNode&) for every command, nested ones included
+    template <typename Fn>
+    void forEachCommand(Fn&& fn) const {
+        struct Adapter : AstVisitor {
+            Fn& fn;
+            explicit Adapter(Fn& f) : fn(f) {}
+            void visitCommand(const CommandNode& cmd) override { fn(cmd); }
+        } adapter(fn);
+        accept(adapter);
+    }
+
+    size_t arenaBytes() const { return arena_.bytesUsed(); }
+
+private:
+    friend class ShellParser;
+
+    Arena arena_;
+    std::string_view source_;
+    const ListNode* root_ = nullptr;
+    const char* error_ = nullptr;
+};
+
+} // namespace tt
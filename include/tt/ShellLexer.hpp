@@ -0,0 +1,114 @@
+/**
+ * ShellLexer.hpp - Single-pass POSIX shell lexer
+ *
+ * Splits a command line into words and operators following the POSIX
+ * quoting rules (plus the common bash operators). Tokens are views into
+ * the input; nothing is copied or allocated while lexing.
+ */
+
+#pragma once
+
+#include "tt/SmallVector.hpp"
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace tt {
+
+enum class TokenKind : uint8_t {
+    WORD,
+    IO_NUMBER,      // Digits directly before a redirection: the 2 in 2>&1
+    HEREDOC,        // Body of a here-document, delimiter line excluded
+    PIPE,           // |
+    PIPE_AND,       // |&
+    AND_IF,         // &&
+    OR_IF,          // ||
+    SEMI,           // ;
+    DSEMI,          // ;;
+    AMP,            // &
+    NEWLINE,
+    LPAREN,         // (
+    RPAREN,         // )
+    LESS,           // <
+    GREAT,          // >
+    DLESS,          // <<
+    DLESSDASH,      // <<-
+    TLESS,          // <<<
+    DGREAT,         // >>
+    LESSAND,        // <&
+    GREATAND,       // >&
+    LESSGREAT,      // <>
+    CLOBBER,        // >|
+    AND_GREAT,      // &>
+    AND_DGREAT,     // &>>
+    END
+};
+
+// Properties of a WORD token, set while scanning it
+enum TokenFlags : uint8_t {
+    TOKEN_QUOTED        = 1 << 0,  // Contains quotes or backslash escapes
+    TOKEN_SUBSTITUTION  = 1 << 1,  // Contains $(...) or `...`
+    TOKEN_EXPANSION     = 1 << 2,  // Contains $name, ${...} or $((...))
+    TOKEN_GLOB          = 1 << 3,  // Contains unquoted * ? or [
+    TOKEN_UNTERMINATED  = 1 << 4   // A quote or substitution was not closed
+};
+
+struct Token {
+    TokenKind kind = TokenKind::END;
+    uint8_t flags = 0;
+    std::string_view text;  // Raw source text, quotes and escapes included
+
+    bool is(TokenKind k) const { return kind == k; }
+    bool has(TokenFlags f) const { return (flags & f) != 0; }
+    bool isRedirection() const { return kind >= TokenKind::LESS && kind <= TokenKind::AND_DGREAT; }
+    bool isOperator() const { return kind >= TokenKind::PIPE && kind != TokenKind::END; }
+};
+
+using TokenList = SmallVector<Token, 32>;
+
+// Source spelling of an operator ("&&", ">>"); a descriptive name for other kinds
+const char* toString(TokenKind kind);
+
+class ShellLexer {
+public:
+    explicit ShellLexer(std::string_view input);
+
+    // Next token; returns END (repeatedly) once the input is exhausted
+    Token next();
+
+    // Lex the whole input. Does not allocate for up to 32 tokens.
+    static void tokenize(std::string_view input, TokenList& out);
+
+private:
+    std::string_view input_;
+    size_t pos_ = 0;
+
+    // Here-documents whose bodies start after the next newline
+    static constexpr size_t MAX_PENDING_HEREDOCS = 8;
+    std::string_view pending_delims_[MAX_PENDING_HEREDOCS];
+    bool pending_strip_tabs_[MAX_PENDING_HEREDOCS] = {};
+    size_t pending_count_ = 0;
+    size_t pending_next_ = 0;
+    bool expect_delim_ = false;
+    bool expect_strip_tabs_ = false;
+    bool heredoc_ready_ = false;
+
+    Token lexWord();
+    Token lexOperator();
+    Token lexHeredoc();
+};
+
+using SubstitutionList = SmallVector<std::string_view, 4>;
+
+// Bodies of the $(...), `...`, <(...) and >(...) substitutions in a WORD,
+// outermost only, in source order
+void findSubstitutions(std::string_view word, SubstitutionList& out);
+
+// Remove quoting and escapes from a WORD, keeping substitutions verbatim
+std::string unquote(std::string_view word);
+
+// Append the unquoted WORD to out; lets callers reuse one buffer
+void unquoteInto(std::string_view word, std::string& out);
+
+} // namespace tt
@@ -0,0 +1,50 @@
+/**
+ * SimulationCache.hpp - Reuse whatif results while nothing they depend on changed
+ *
+ * Entries are keyed by the canonical command (CommandCanonicalizer), the
+ * working directory and a variant string for everything else the answer
+ * depends on (model, language, dry-run roots). Each entry also records the
+ * paths the command touches: the working directory and its entries, every
+ * operand and redirection target (globs expanded), and every directory below
+ * the blast radius targets. A lookup re-stats those paths and only hits when
+ * inode, size, mode, mtime and ctime all match what was stored.
+ *
+ * Commands whose words need the environment or run substitutions
+ * ($HOME, $(date)) are not cached, and neither are results for which a
+ * tracked path changed while the simulation was running.
+ */
+
+#pragma once
+
+#include "tt/Simulator.hpp"
+
+#include <chrono>
+#include <memory>
+#include <optional>
+#include <string>
+
+namespace tt {
+
+class SimulationCache {
+public:
+    // dir: empty = ~/.tt/simulations; one file per entry
+    explicit SimulationCache(const std::string& dir = "", const std::string& variant = "");
+    ~SimulationCache();
+
+    std::optional<SimulationResult> lookup(const std::string& command, const std::string& cwd);
+
+    // started: when the simulation began. Returns false when the result
+    // was not stored (failed prediction, uncacheable command, racy paths)
+    bool store(const std::string& command, const std::string& cwd, const SimulationResult& result,
+               std::chrono::system_clock::time_point started);
+
+    void clear();
+
+    static std::string getDefaultPath();
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+} // namespace tt
@@ -1,21 +1,50 @@
 /**
  * Simulator.hpp - "What If" command simulation
+ *
+ * A simulation runs in stages: local parse and danger checks, filesystem
+ * probing (blast radius and, when enabled, the dry-run sandbox) and the
+ * model's prediction. The probing runs on its own threads while the model
+ * request is in flight, and each stage is handed to a SimulationObserver as
+ * soon as it is done.
  */
 
 #pragma once
 
+#include "tt/BlastRadius.hpp"
+#include "tt/DryRun.hpp"
+
+#include <optional>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace tt {
 
 class GeminiClient;
+class ShellAst;
 
 struct SimulationResult {
     std::string predicted_output;
     std::vector<std::string> files_affected;
     std::vector<std::string> warnings;
-    bool is_destructive;
+    bool is_destructive = false;
+    bool predicted = false;  // The model answered; predicted_output holds the error otherwise
+    std::optional<DryRunResult> dry_run;  // Set when the command ran in the sandbox
+    std::optional<ImpactReport> impact;   // Set when the command deletes or changes existing files
+};
+
+// Calls are serialized and arrive in declaration order: the local
+// analysis first, then the filesystem stages, then the prediction in
+// chunks. Chunks that arrive while a filesystem stage is still running are
+// held back until it is reported.
+class SimulationObserver {
+public:
+    virtual ~SimulationObserver() = default;
+
+    virtual void onAnalysis(const SimulationResult&) {}  // warnings and is_destructive
+    virtual void onImpact(const ImpactReport&) {}
+    virtual void onDryRun(const DryRunResult&) {}
+    virtual void onPredictionChunk(std::string_view) {}
 };
 
 class Simulator {
@@ -23,13 +52,19 @@ public:
     explicit Simulator(GeminiClient& gemini);
     ~Simulator();
     
+    // Run commands in the dry-run sandbox before asking the model; the
+    // observed file changes then replace the model's guess
+    void enableDryRun(DryRunOptions options);
+    
     SimulationResult simulate(const std::string& command);
+    SimulationResult simulate(const std::string& command, SimulationObserver& observer);
     bool isDangerous(const std::string& command);
+    bool isDangerous(const ShellAst& ast);
     
 private:
     GeminiClient& gemini_;
-    
-    std::vector<std::string> dangerous_patterns_;
+    std::optional<DryRunOptions> dry_run_;
+    std::string prompt_;  // Render buffer, reused across simulations
 };
 
 } // namespace tt
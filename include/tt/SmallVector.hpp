@@ -0,0 +1,115 @@
+/**
+ * SmallVector.hpp - Vector with inline storage for trivially copyable types
+ *
+ * Holds up to N elements without touching the heap; grows into a heap
+ * buffer past that. Used for token and span lists where typical inputs
+ * fit inline.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+
+namespace tt {
+
+template <typename T, size_t N>
+class SmallVector {
+    static_assert(std::is_trivially_copyable_v<T>, "SmallVector requires trivially copyable elements");
+
+public:
+    SmallVector() = default;
+
+    SmallVector(const SmallVector& other) { append(other.data_, other.size_); }
+
+    SmallVector(SmallVector&& other) noexcept { take(other); }
+
+    SmallVector& operator=(const SmallVector& other) {
+        if (this != &other) {
+            size_ = 0;
+            append(other.data_, other.size_);
+        }
+        return *this;
+    }
+
+    SmallVector& operator=(SmallVector&& other) noexcept {
+        if (this != &other) {
+            release();
+            size_ = 0;
+            take(other);
+        }
+        return *this;
+    }
+
+    ~SmallVector() { release(); }
+
+    void push_back(const T& value) {
+        if (size_ == capacity_) grow(capacity_ * 2);
+        data_[size_++] = value;
+    }
+
+    void pop_back() { --size_; }
+    void clear() { size_ = 0; }
+
+    void reserve(size_t capacity) {
+        if (capacity > capacity_) grow(capacity);
+    }
+
+    T& operator[](size_t i) { return data_[i]; }
+    const T& operator[](size_t i) const { return data_[i]; }
+    T& back() { return data_[size_ - 1]; }
+    const T& back() const { return data_[size_ - 1]; }
+
+    T* begin() { return data_; }
+    T* end() { return data_ + size_; }
+    const T* begin() const { return data_; }
+    const T* end() const { return data_ + size_; }
+
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+    // True while no heap buffer has been needed
+    bool isInline() const { return data_ == inline_; }
+
+private:
+    T inline_[N];
+    T* data_ = inline_;
+    size_t size_ = 0;
+    size_t capacity_ = N;
+
+    void take(SmallVector& other) {
+        if (other.isInline()) {
+            append(other.data_, other.size_);
+        } else {
+            data_ = other.data_;
+            capacity_ = other.capacity_;
+            size_ = other.size_;
+            other.data_ = other.inline_;
+            other.capacity_ = N;
+        }
+        other.size_ = 0;
+    }
+
+    void append(const T* values, size_t count) {
+        reserve(size_ + count);
+        if (count) std::memcpy(static_cast<void*>(data_ + size_), values, count * sizeof(T));
+        size_ += count;
+    }
+
+    void grow(size_t capacity) {
+        T* heap = new T[capacity];
+        if (size_) std::memcpy(static_cast<void*>(heap), data_, size_ * sizeof(T));
+        release();
+        data_ = heap;
+        capacity_ = capacity;
+    }
+
+    void release() {
+        if (!isInline()) delete[] data_;
+        data_ = inline_;
+        capacity_ = N;
+    }
+};
+
+} // namespace tt
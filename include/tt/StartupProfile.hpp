@@ -0,0 +1,52 @@
+/**
+ * StartupProfile.hpp - CLOCK_MONOTONIC timestamps of startup phases
+ *
+ * `tt --profile-startup ...` prints, at exit and on stderr, when each phase
+ * was reached: from process start (read from /proc, 10 ms resolution) and
+ * main() through keyring lookups, client setup and prompt building to the
+ * network phases of the first request. One line per phase:
+ *
+ *   <CLOCK_MONOTONIC ns>  <ms since main>  +<ms since previous>  <phase>
+ *
+ * begin() runs first in main() whether or not profiling is on, so the
+ * flag can be parsed later without losing the entry time. While
+ * profiling is off mark() is a load and a branch.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace tt::startup {
+
+namespace detail {
+inline bool enabled = false;
+void record(std::string_view phase, int64_t ns);
+} // namespace detail
+
+inline bool enabled() { return detail::enabled; }
+
+// CLOCK_MONOTONIC in nanoseconds
+int64_t clockNs();
+
+// At main() entry
+void begin();
+
+// Records phases from now on and prints them at exit
+void enable();
+
+// Phase reached now, or at an earlier clockNs() value
+inline void markAt(std::string_view phase, int64_t ns) {
+    if (enabled()) detail::record(phase, ns);
+}
+
+inline void mark(std::string_view phase) {
+    if (enabled()) detail::record(phase, clockNs());
+}
+
+// The lines printed at exit, sorted by time
+std::string report();
+
+} // namespace tt::startup
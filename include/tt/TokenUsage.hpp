@@ -0,0 +1,73 @@
+/**
+ * TokenUsage.hpp - Token counts reported by the API, kept per session and per day
+ *
+ * Gemini returns a usageMetadata block with every response (and with the
+ * final events of a stream), so token use is known without extra
+ * countTokens calls. TokenLedger keeps running totals in ~/.tt/usage.json:
+ * one entry per day (the last MAX_DAYS are kept) and one per named
+ * session, whose last prompt size is how large its history has grown.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <nlohmann/json_fwd.hpp>
+
+namespace tt {
+
+struct TokenUsage {
+    uint32_t prompt = 0;      // Input, history included
+    uint32_t cached = 0;      // Part of the input served from the prompt cache
+    uint32_t candidates = 0;  // Answer text
+    uint32_t thoughts = 0;    // Thinking; billed as output
+
+    uint32_t output() const { return candidates + thoughts; }
+    bool empty() const { return prompt == 0 && candidates == 0 && thoughts == 0; }
+};
+
+// From a response's usageMetadata object; missing counts are zero
+TokenUsage fromUsageMetadata(const nlohmann::json& metadata);
+
+struct TokenTotals {
+    uint64_t requests = 0;
+    uint64_t prompt = 0;
+    uint64_t cached = 0;
+    uint64_t candidates = 0;
+    uint64_t thoughts = 0;
+    uint32_t last_prompt = 0;  // Input of the latest request
+
+    void add(const TokenUsage& usage);
+};
+
+class TokenLedger {
+public:
+    // path: empty = ~/.tt/usage.json
+    explicit TokenLedger(const std::string& path = "");
+
+    // Adds a response's usage to its day and, when named, its session
+    void add(const TokenUsage& usage, const std::string& session = "",
+             std::chrono::system_clock::time_point when = std::chrono::system_clock::now());
+
+    std::optional<TokenTotals> session(const std::string& name) const;
+    void forgetSession(const std::string& name);
+
+    // Local dates ("2026-10-17") with their totals, oldest first
+    std::vector<std::pair<std::string, TokenTotals>> days() const;
+
+    void clear();
+
+    static std::string getDefaultPath();
+
+    static constexpr size_t MAX_DAYS = 90;
+
+private:
+    std::string path_;
+};
+
+} // namespace tt
@@ -0,0 +1,70 @@
+/**
+ * Trace.hpp - Per-request latency spans, written as Chrome trace-event JSON
+ *
+ * Turned on with `tt --trace <file>` or TT_TRACE=<file>; the file opens in
+ * chrome://tracing or ui.perfetto.dev. Spans cover where a request spends
+ * its time: keyring lookups, session load, prompt build, the network
+ * phases (DNS, connect, TLS, time to first byte, body) and SSE parsing and
+ * rendering of a streamed answer.
+ *
+ * While tracing is off a Span costs one load of a global flag and a
+ * branch: no clock read, no allocation. Names and categories must be
+ * string literals; they are stored as pointers.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace tt::trace {
+
+namespace detail {
+inline bool enabled = false;
+} // namespace detail
+
+inline bool enabled() { return detail::enabled; }
+
+// Starts recording; the trace is written to path when the process exits
+void start(const std::string& path);
+
+// Writes what was recorded so far; false when the file cannot be written
+bool flush();
+
+// Writes the trace and stops recording; nothing is written at exit
+bool stop();
+
+// Microseconds since start()
+int64_t now();
+
+// Records a finished span. args is the body of a JSON object
+// ("\"status\":200"), or empty
+void record(const char* name, const char* category, int64_t start_us, int64_t duration_us,
+            std::string args = {});
+
+// Records from construction to destruction
+class Span {
+public:
+    explicit Span(const char* name, const char* category = "tt")
+        : name_(name), category_(category), start_(enabled() ? now() : -1) {}
+
+    ~Span() {
+        if (start_ >= 0) record(name_, category_, start_, now() - start_, std::move(args_));
+    }
+
+    Span(const Span&) = delete;
+    Span& operator=(const Span&) = delete;
+
+    // Shown with the span in the viewer; no-ops while tracing is off
+    void arg(const char* key, std::string_view value);
+    void arg(const char* key, int64_t value);
+
+private:
+    const char* name_;
+    const char* category_;
+    int64_t start_;
+    std::string args_;
+};
+
+} // namespace tt::trace
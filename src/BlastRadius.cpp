@@ -0,0 +1,485 @@
+/**
+ * BlastRadius.cpp - Operand expansion and a parallel directory walk
+ *
+ * Each worker owns a deque of directories: it pops its own from the back
+ * (depth first, so descriptors and dentries stay warm) and steals from the
+ * front of the others when it runs dry, which hands out the large, shallow
+ * subtrees first. A shared counter of queued directories tells idle workers
+ * when the walk is over. Counts are kept per worker and per top-level
+ * directory and only summed at the end.
+ */
+
+#include "tt/BlastRadius.hpp"
+#include "tt/ShellAst.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <glob.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace tt {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// How each destructive command takes its operands
+struct Rule {
+    std::string_view name;
+    std::string_view recursive_flags;  // Short flags that make it walk directories
+    std::string_view value_flags;      // Short flags that take a value
+    bool always_recursive;             // Moves whole trees
+    bool skips_directories;            // Directory operands fail without recursion
+    bool first_is_mode;                // chmod MODE, chown OWNER, chgrp GROUP
+    bool last_is_destination;          // mv SOURCE... DEST
+};
+
+constexpr Rule RULES[] = {
+    {"rm",       "rR", "",   false, true,  false, false},
+    {"shred",    "",   "ns", false, true,  false, false},
+    {"truncate", "",   "sr", false, true,  false, false},
+    {"chmod",    "R",  "",   false, false, true,  false},
+    {"chown",    "R",  "",   false, false, true,  false},
+    {"chgrp",    "R",  "",   false, false, true,  false},
+    {"mv",       "",   "tS", true,  false, false, true},
+};
+
+const Rule* findRule(std::string_view name) {
+    for (const auto& rule : RULES) {
+        if (rule.name == name) return &rule;
+    }
+    return nullptr;
+}
+
+// "-x", "-rw" and friends are chmod modes, not options
+bool isChmodMode(std::string_view word) {
+    return word.size() > 1 && word[0] == '-' &&
+           word.find_first_not_of("rwxXstugoa", 1) == std::string_view::npos;
+}
+
+struct Operands {
+    std::vector<const Word*> words;
+    bool recursive = false;
+};
+
+Operands collectOperands(const CommandNode& cmd, const Rule& rule) {
+    Operands out;
+    bool options_done = false;
+    bool reference = false;   // --reference=FILE replaces the mode
+    bool target_dir = false;  // mv -t DIR: every operand is a source
+
+    for (uint32_t i = 1; i < cmd.word_count; ++i) {
+        const Word& word = cmd.words[i];
+        std::string_view text = word.text;
+
+        if (options_done || text.size() < 2 || text[0] != '-' || (rule.name == "chmod" && isChmodMode(text))) {
+            out.words.push_back(&word);
+            continue;
+        }
+        if (text == "--") {
+            options_done = true;
+            continue;
+        }
+        if (text[1] == '-') {
+            if (text == "--recursive" && !rule.recursive_flags.empty()) out.recursive = true;
+            if (text.rfind("--reference", 0) == 0) reference = true;
+            if (text.rfind("--target-directory", 0) == 0) {
+                target_dir = true;
+                if (text.find('=') == std::string_view::npos) ++i;
+            }
+            continue;
+        }
+        for (size_t j = 1; j < text.size(); ++j) {
+            if (rule.recursive_flags.find(text[j]) != std::string_view::npos) out.recursive = true;
+            if (rule.value_flags.find(text[j]) != std::string_view::npos) {
+                if (rule.last_is_destination && text[j] == 't') target_dir = true;
+                if (j + 1 == text.size()) ++i;  // Value is the next word
+                break;
+            }
+        }
+    }
+
+    if (rule.first_is_mode && !reference && !out.words.empty()) out.words.erase(out.words.begin());
+    if (rule.last_is_destination && !target_dir && !out.words.empty()) out.words.pop_back();
+    return out;
+}
+
+// find ROOT... EXPRESSION: the roots, when the expression deletes
+std::vector<const Word*> findRoots(const CommandNode& cmd) {
+    bool deletes = cmd.hasWord("-delete");
+    for (const Node* nested = cmd.nested; nested && !deletes; nested = nested->next) {
+        if (nested->kind == NodeKind::COMMAND) {
+            std::string_view name = static_cast<const CommandNode*>(nested)->name();
+            deletes = name == "rm" || name == "shred";
+        }
+    }
+    std::vector<const Word*> roots;
+    if (!deletes) return roots;
+
+    uint32_t i = 1;
+    while (i < cmd.word_count && (cmd.words[i].text == "-H" || cmd.words[i].text == "-L" || cmd.words[i].text == "-P")) ++i;
+    for (; i < cmd.word_count; ++i) {
+        std::string_view text = cmd.words[i].text;
+        if (!text.empty() && (text[0] == '-' || text[0] == '(' || text[0] == '!' || text[0] == ')')) break;
+        roots.push_back(&cmd.words[i]);
+    }
+    if (roots.empty()) {
+        static const Word DOT{".", ".", 0, nullptr};
+        roots.push_back(&DOT);
+    }
+    return roots;
+}
+
+std::string absolutePath(const std::string& path) {
+    std::error_code ec;
+    std::filesystem::path absolute = std::filesystem::absolute(path, ec);
+    std::string out = (ec ? std::filesystem::path(path) : absolute).lexically_normal().string();
+    while (out.size() > 1 && out.back() == '/') out.pop_back();
+    return out;
+}
+
+// Glob and tilde expansion, as the shell would do before running the command
+void expandWord(const Word& word, std::vector<std::string>& out, ImpactReport& report) {
+    if (word.has(TOKEN_SUBSTITUTION) || word.has(TOKEN_EXPANSION) || word.has(TOKEN_UNTERMINATED)) {
+        report.unresolved.emplace_back(word.raw);
+        return;
+    }
+
+    std::string text(word.text);
+    if (!word.raw.empty() && word.raw[0] == '~' && (text == "~" || text.rfind("~/", 0) == 0)) {
+        const char* home = std::getenv("HOME");
+        if (home) text.replace(0, 1, home);
+    }
+
+    if (!word.has(TOKEN_GLOB)) {
+        out.push_back(absolutePath(text));
+        return;
+    }
+    glob_t matches{};
+    if (::glob(text.c_str(), GLOB_NOSORT, nullptr, &matches) == 0) {
+        for (size_t i = 0; i < matches.gl_pathc; ++i) {
+            out.push_back(absolutePath(matches.gl_pathv[i]));
+        }
+    }
+    ::globfree(&matches);
+}
+
+bool isInside(const std::string& path, const std::string& root) {
+    return path.size() > root.size() && path.compare(0, root.size(), root) == 0 &&
+           (root == "/" || path[root.size()] == '/');
+}
+
+// ---------------------------------------------------------------------------
+// Walk
+// ---------------------------------------------------------------------------
+
+struct Bucket {
+    std::string path;
+    std::atomic<uint64_t> files{0};
+    std::atomic<uint64_t> bytes{0};
+
+    explicit Bucket(std::string p) : path(std::move(p)) {}
+};
+
+struct Totals {
+    uint64_t files = 0;
+    uint64_t directories = 0;
+    uint64_t bytes = 0;
+    uint64_t unreadable = 0;
+};
+
+struct LinuxDirent64 {
+    uint64_t d_ino;
+    int64_t d_off;
+    unsigned short d_reclen;
+    unsigned char d_type;
+    char d_name[];
+};
+
+class Walker {
+public:
+    Walker(unsigned threads, Clock::time_point deadline)
+        : queues_(std::make_unique<Queue[]>(threads)), threads_(threads), deadline_(deadline) {}
+
+    // A single root is split into one bucket per subdirectory
+    void run(const std::vector<std::string>& roots) {
+        bool split = roots.size() == 1;
+        for (size_t i = 0; i < roots.size(); ++i) {
+            push(i % threads_, {roots[i], newBucket(roots[i]), split});
+        }
+
+        std::vector<Totals> totals(threads_);
+        std::vector<std::thread> workers;
+        for (unsigned i = 1; i < threads_; ++i) {
+            workers.emplace_back([this, &totals, i] { work(i, totals[i]); });
+        }
+        work(0, totals[0]);
+        for (auto& worker : workers) {
+            worker.join();
+        }
+
+        for (const auto& t : totals) {
+            totals_.files += t.files;
+            totals_.directories += t.directories;
+            totals_.bytes += t.bytes;
+            totals_.unreadable += t.unreadable;
+        }
+        totals_.directories += roots.size();
+    }
+
+    const Totals& totals() const { return totals_; }
+    bool expired() const { return expired_.load(std::memory_order_relaxed); }
+    const std::deque<Bucket>& buckets() const { return buckets_; }
+
+private:
+    struct Item {
+        std::string path;
+        Bucket* bucket;
+        bool split;  // Subdirectories get their own bucket
+    };
+
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Item> items;
+    };
+
+    Bucket* newBucket(const std::string& path) {
+        std::lock_guard lock(buckets_mutex_);
+        return &buckets_.emplace_back(path);
+    }
+
+    void push(size_t worker, Item item) {
+        pending_.fetch_add(1, std::memory_order_relaxed);
+        std::lock_guard lock(queues_[worker].mutex);
+        queues_[worker].items.push_back(std::move(item));
+    }
+
+    bool pop(size_t worker, Item& item) {
+        Queue& own = queues_[worker];
+        {
+            std::lock_guard lock(own.mutex);
+            if (!own.items.empty()) {
+                item = std::move(own.items.back());
+                own.items.pop_back();
+                return true;
+            }
+        }
+        for (size_t k = 1; k < threads_; ++k) {
+            Queue& victim = queues_[(worker + k) % threads_];
+            std::lock_guard lock(victim.mutex);
+            if (!victim.items.empty()) {
+                item = std::move(victim.items.front());
+                victim.items.pop_front();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void work(size_t worker, Totals& totals) {
+        std::vector<char> buffer(64 * 1024);
+        Item item;
+        while (pending_.load(std::memory_order_acquire) > 0 && !expired()) {
+            if (!pop(worker, item)) {
+                std::this_thread::yield();
+                continue;
+            }
+            listDirectory(worker, item, buffer, totals);
+            pending_.fetch_sub(1, std::memory_order_acq_rel);
+        }
+    }
+
+    void listDirectory(size_t worker, const Item& item, std::vector<char>& buffer, Totals& totals) {
+        int fd = ::open(item.path.c_str(), O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+        if (fd < 0) {
+            ++totals.unreadable;
+            return;
+        }
+
+        uint64_t files = 0;
+        uint64_t bytes = 0;
+        size_t seen = 0;
+        for (;;) {
+            long n = ::syscall(SYS_getdents64, fd, buffer.data(), buffer.size());
+            if (n <= 0) {
+                if (n < 0) ++totals.unreadable;
+                break;
+            }
+            for (long offset = 0; offset < n;) {
+                auto* entry = reinterpret_cast<const LinuxDirent64*>(buffer.data() + offset);
+                offset += entry->d_reclen;
+                const char* name = entry->d_name;
+                if (name[0] == '.' && (name[1] == 0 || (name[1] == '.' && name[2] == 0))) continue;
+
+                unsigned char type = entry->d_type;
+                struct statx info;
+                bool have_info = false;
+                if (type == DT_UNKNOWN) {
+                    have_info = ::statx(fd, name, AT_SYMLINK_NOFOLLOW | AT_STATX_DONT_SYNC,
+                                        STATX_TYPE | STATX_SIZE, &info) == 0;
+                    if (have_info && S_ISDIR(info.stx_mode)) type = DT_DIR;
+                }
+
+                if (type == DT_DIR) {
+                    ++totals.directories;
+                    std::string child = item.path == "/" ? "/" + std::string(name) : item.path + "/" + name;
+                    Bucket* bucket = item.split ? newBucket(child) : item.bucket;
+                    push(worker, {std::move(child), bucket, false});
+                } else {
+                    if (!have_info) {
+                        have_info = ::statx(fd, name, AT_SYMLINK_NOFOLLOW | AT_STATX_DONT_SYNC, STATX_SIZE, &info) == 0;
+                    }
+                    ++files;
+                    if (have_info) bytes += info.stx_size;
+                }
+
+                if ((++seen & 255) == 0 && Clock::now() >= deadline_) {
+                    expired_.store(true, std::memory_order_relaxed);
+                }
+            }
+            if (expired()) break;
+        }
+        ::close(fd);
+
+        totals.files += files;
+        totals.bytes += bytes;
+        item.bucket->files.fetch_add(files, std::memory_order_relaxed);
+        item.bucket->bytes.fetch_add(bytes, std::memory_order_relaxed);
+        if (Clock::now() >= deadline_) expired_.store(true, std::memory_order_relaxed);
+    }
+
+    std::unique_ptr<Queue[]> queues_;
+    unsigned threads_;
+    Clock::time_point deadline_;
+    std::atomic<int64_t> pending_{0};
+    std::atomic<bool> expired_{false};
+    std::mutex buckets_mutex_;
+    std::deque<Bucket> buckets_;  // Stable addresses for the items pointing at them
+    Totals totals_;
+};
+
+struct Target {
+    std::string path;
+    bool recursive;
+    bool skips_directories;
+};
+
+ImpactReport measure(std::vector<Target> targets, const ImpactOptions& options, Clock::time_point start) {
+    ImpactReport report;
+
+    // Roots first, so anything inside an earlier recursive target is dropped
+    std::sort(targets.begin(), targets.end(), [](const Target& a, const Target& b) { return a.path < b.path; });
+    std::vector<std::string> roots;
+    for (const auto& target : targets) {
+        if (!report.targets.empty() && report.targets.back() == target.path) continue;
+        bool covered = std::any_of(roots.begin(), roots.end(), [&](const std::string& root) {
+            return isInside(target.path, root);
+        });
+        if (covered) continue;
+
+        struct statx info;
+        if (::statx(AT_FDCWD, target.path.c_str(), AT_SYMLINK_NOFOLLOW | AT_STATX_DONT_SYNC,
+                    STATX_TYPE | STATX_SIZE, &info) != 0) {
+            continue;  // rm -f and friends ignore missing operands
+        }
+        report.targets.push_back(target.path);
+
+        if (!S_ISDIR(info.stx_mode)) {
+            ++report.files;
+            report.bytes += info.stx_size;
+        } else if (target.recursive) {
+            roots.push_back(target.path);
+        } else if (!target.skips_directories) {
+            ++report.directories;
+        }
+    }
+
+    if (!roots.empty()) {
+        unsigned threads = options.threads ? options.threads : std::max(1u, std::thread::hardware_concurrency());
+        Walker walker(std::min(threads, 64u), start + options.budget);
+        walker.run(roots);
+
+        const Totals& totals = walker.totals();
+        report.files += totals.files;
+        report.directories += totals.directories;
+        report.bytes += totals.bytes;
+        report.unreadable = totals.unreadable;
+        report.complete = !walker.expired();
+
+        for (const auto& bucket : walker.buckets()) {
+            uint64_t bytes = bucket.bytes.load(std::memory_order_relaxed);
+            uint64_t files = bucket.files.load(std::memory_order_relaxed);
+            if (files > 0) report.top.push_back({bucket.path, files, bytes});
+        }
+        auto by_size = [](const DirectoryImpact& a, const DirectoryImpact& b) {
+            return a.bytes != b.bytes ? a.bytes > b.bytes : a.files > b.files;
+        };
+        size_t keep = std::min(options.top, report.top.size());
+        std::partial_sort(report.top.begin(), report.top.begin() + static_cast<std::ptrdiff_t>(keep), report.top.end(), by_size);
+        report.top.resize(keep);
+    }
+
+    report.elapsed_ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    return report;
+}
+
+} // anonymous namespace
+
+ImpactReport analyzeImpact(const ShellAst& ast, const ImpactOptions& options) {
+    auto start = Clock::now();
+    ImpactReport expansion;
+    std::vector<Target> targets;
+
+    ast.forEachCommand([&](const CommandNode& cmd) {
+        // find and xargs feed their nested commands; find is handled as a whole
+        if (cmd.runner && (cmd.runner->name() == "find" || cmd.runner->name() == "xargs")) return;
+
+        std::vector<std::string> paths;
+        bool recursive = false;
+        bool skips_directories = false;
+        if (cmd.name() == "find") {
+            for (const Word* word : findRoots(cmd)) expandWord(*word, paths, expansion);
+            recursive = true;
+        } else if (const Rule* rule = findRule(cmd.name())) {
+            Operands operands = collectOperands(cmd, *rule);
+            for (const Word* word : operands.words) expandWord(*word, paths, expansion);
+            recursive = rule->always_recursive || operands.recursive;
+            skips_directories = rule->skips_directories;
+        }
+        for (auto& path : paths) {
+            targets.push_back({std::move(path), recursive, skips_directories});
+        }
+    });
+
+    ImpactReport report = measure(std::move(targets), options, start);
+    report.unresolved = std::move(expansion.unresolved);
+    return report;
+}
+
+ImpactReport analyzeImpact(std::string_view command, const ImpactOptions& options) {
+    ShellAst ast(command);
+    return analyzeImpact(ast, options);
+}
+
+ImpactReport measurePaths(const std::vector<std::string>& paths, const ImpactOptions& options) {
+    auto start = Clock::now();
+    std::vector<Target> targets;
+    for (const auto& path : paths) {
+        targets.push_back({absolutePath(path), true, false});
+    }
+    return measure(std::move(targets), options, start);
+}
+
+} // namespace tt
@@ -0,0 +1,206 @@
+/**
+ * CaseFold.cpp - ASCII fast path and two-byte UTF-8 case folding
+ */
+
+#include "tt/CaseFold.hpp"
+
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define TT_CASEFOLD_SSE2 1
+#endif
+
+namespace tt {
+
+namespace {
+
+constexpr uint64_t ONES = 0x0101010101010101ULL;
+constexpr uint64_t HIGH_BITS = 0x8080808080808080ULL;
+
+// Lowercases the ASCII bytes of in[0, size) into out, which may alias in;
+// other bytes are copied. Returns the offset of the first non-ASCII byte.
+size_t lowerAscii(const char* in, char* out, size_t size) noexcept {
+    size_t first = size;
+    size_t i = 0;
+
+#ifdef TT_CASEFOLD_SSE2
+    const __m128i before_a = _mm_set1_epi8('A' - 1);
+    const __m128i after_z = _mm_set1_epi8('Z' + 1);
+    const __m128i bit = _mm_set1_epi8(0x20);
+    for (; i + 16 <= size; i += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        // Signed compares: bytes >= 0x80 are negative and never in range
+        __m128i upper = _mm_and_si128(_mm_cmpgt_epi8(v, before_a), _mm_cmplt_epi8(v, after_z));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_add_epi8(v, _mm_and_si128(upper, bit)));
+        if (first == size) {
+            if (int mask = _mm_movemask_epi8(v)) first = i + static_cast<size_t>(__builtin_ctz(mask));
+        }
+    }
+#endif
+
+    // Eight bytes per step; the 0x7F mask keeps the adds from carrying across bytes
+    for (; i + 8 <= size; i += 8) {
+        uint64_t w;
+        std::memcpy(&w, in + i, 8);
+        uint64_t low = w & ~HIGH_BITS;
+        uint64_t ge_a = low + (0x80 - 'A') * ONES;
+        uint64_t gt_z = low + (0x80 - 'Z' - 1) * ONES;
+        uint64_t upper = ge_a & ~gt_z & ~w & HIGH_BITS;
+        w += upper >> 2;
+        std::memcpy(out + i, &w, 8);
+        if (first == size && (w & HIGH_BITS)) {
+            for (size_t j = i; j < i + 8; ++j) {
+                if (static_cast<unsigned char>(in[j]) >= 0x80) { first = j; break; }
+            }
+        }
+    }
+
+    for (; i < size; ++i) {
+        char c = in[i];
+        out[i] = asciiLower(c);
+        if (first == size && static_cast<unsigned char>(c) >= 0x80) first = i;
+    }
+    return first;
+}
+
+// Simple lowercase mapping for code points encoded in two UTF-8 bytes whose
+// lowercase form is also two bytes; anything else maps to itself
+char32_t lowerTwoByte(char32_t cp) noexcept {
+    // Latin-1: À..Þ except ×
+    if (cp >= 0xC0 && cp <= 0xDE) return cp == 0xD7 ? cp : cp + 0x20;
+
+    // Latin Extended-A: case pairs, uppercase on the even member except in
+    // Ĺ..ň and Ź..ž; İ ı ĸ ŉ ſ have no two-byte pair
+    if (cp >= 0x100 && cp <= 0x17F) {
+        if (cp == 0x130 || cp == 0x131 || cp == 0x138 || cp == 0x149 || cp == 0x17F) return cp;
+        if (cp == 0x178) return 0xFF;  // Ÿ
+        bool odd_upper = (cp >= 0x139 && cp <= 0x148) || (cp >= 0x179 && cp <= 0x17E);
+        return ((cp & 1) != 0) == odd_upper ? cp + 1 : cp;
+    }
+
+    // Greek
+    if (cp >= 0x386 && cp <= 0x3A9) {
+        if (cp == 0x386) return 0x3AC;
+        if (cp >= 0x388 && cp <= 0x38A) return cp + 0x25;
+        if (cp == 0x38C) return 0x3CC;
+        if (cp == 0x38E || cp == 0x38F) return cp + 0x3F;
+        if (cp >= 0x391 && cp != 0x3A2) return cp + 0x20;
+        return cp;
+    }
+
+    // Cyrillic
+    if (cp >= 0x400 && cp <= 0x40F) return cp + 0x50;
+    if (cp >= 0x410 && cp <= 0x42F) return cp + 0x20;
+    if ((cp >= 0x460 && cp <= 0x481) || (cp >= 0x48A && cp <= 0x4BF) || (cp >= 0x4D0 && cp <= 0x52F)) {
+        return (cp & 1) ? cp : cp + 1;
+    }
+    if (cp == 0x4C0) return 0x4CF;
+    if (cp >= 0x4C1 && cp <= 0x4CE) return (cp & 1) ? cp + 1 : cp;
+
+    // Armenian
+    if (cp >= 0x531 && cp <= 0x556) return cp + 0x30;
+
+    return cp;
+}
+
+// Folds the two-byte sequence at p in place
+void foldPair(char* p) noexcept {
+    char32_t cp = (static_cast<char32_t>(p[0] & 0x1F) << 6) | static_cast<char32_t>(p[1] & 0x3F);
+    char32_t lower = lowerTwoByte(cp);
+    p[0] = static_cast<char>(0xC0 | (lower >> 6));
+    p[1] = static_cast<char>(0x80 | (lower & 0x3F));
+}
+
+bool isContinuation(char c) {
+    return (static_cast<unsigned char>(c) & 0xC0) == 0x80;
+}
+
+// Lead bytes of the scripts lowerTwoByte() knows about (U+00C0..U+0556)
+bool isFoldableLead(unsigned char c) {
+    return c >= 0xC3 && c <= 0xD5;
+}
+
+// Slow path from the first non-ASCII byte; ASCII is already lowered
+void foldUtf8(char* data, size_t size, size_t i) noexcept {
+    while (i < size) {
+        auto c = static_cast<unsigned char>(data[i]);
+        if (c < 0x80) {
+            ++i;
+        } else if (isFoldableLead(c) && i + 1 < size && isContinuation(data[i + 1])) {
+            foldPair(data + i);
+            i += 2;
+        } else if (c >= 0xC0) {
+            // Skip a whole sequence so its continuation bytes are never read as leads
+            size_t length = c >= 0xF0 ? 4 : c >= 0xE0 ? 3 : 2;
+            size_t end = i + 1;
+            while (end < size && end < i + length && isContinuation(data[end])) ++end;
+            i = end;
+        } else {
+            ++i;  // Stray continuation byte
+        }
+    }
+}
+
+} // anonymous namespace
+
+size_t asciiPrefixLength(std::string_view text) noexcept {
+    const char* data = text.data();
+    size_t size = text.size();
+    size_t i = 0;
+
+#ifdef TT_CASEFOLD_SSE2
+    for (; i + 16 <= size; i += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        if (int mask = _mm_movemask_epi8(v)) return i + static_cast<size_t>(__builtin_ctz(mask));
+    }
+#endif
+
+    for (; i + 8 <= size; i += 8) {
+        uint64_t w;
+        std::memcpy(&w, data + i, 8);
+        if (w & HIGH_BITS) break;
+    }
+    for (; i < size; ++i) {
+        if (static_cast<unsigned char>(data[i]) >= 0x80) return i;
+    }
+    return size;
+}
+
+void foldCaseInPlace(char* data, size_t size) noexcept {
+    size_t first = lowerAscii(data, data, size);
+    if (first < size) foldUtf8(data, size, first);
+}
+
+void foldCase(std::string_view text, std::string& out) {
+    out.resize(text.size());
+    size_t first = lowerAscii(text.data(), out.data(), text.size());
+    if (first < text.size()) foldUtf8(out.data(), out.size(), first);
+}
+
+std::string foldCase(std::string_view text) {
+    std::string out;
+    foldCase(text, out);
+    return out;
+}
+
+bool equalsFolded(std::string_view text, std::string_view folded) noexcept {
+    if (text.size() != folded.size()) return false;
+    for (size_t i = 0; i < text.size(); ++i) {
+        auto c = static_cast<unsigned char>(text[i]);
+        if (c < 0x80) {
+            if (asciiLower(text[i]) != folded[i]) return false;
+        } else if (isFoldableLead(c) && i + 1 < text.size() && isContinuation(text[i + 1])) {
+            char pair[2] = {text[i], text[i + 1]};
+            foldPair(pair);
+            if (pair[0] != folded[i] || pair[1] != folded[i + 1]) return false;
+            ++i;
+        } else if (text[i] != folded[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace tt
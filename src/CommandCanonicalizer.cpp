@@ -0,0 +1,467 @@
+/**
+ * CommandCanonicalizer.cpp - One spelling for commands that run the same way
+ *
+ * Walks the ShellAst and prints it back. Option reordering assumes GNU
+ * getopt behavior (options may follow operands) and is limited to the
+ * utilities in SPECS; a command using any option that is not listed there,
+ * or run with POSIXLY_CORRECT set, keeps its words in source order. Options
+ * where the last one wins (rm -i/-f, ls -t/-S) keep their relative order.
+ */
+
+#include "tt/CommandCanonicalizer.hpp"
+#include "tt/ShellAst.hpp"
+#include "tt/ShellLexer.hpp"
+#include "tt/SmallVector.hpp"
+
+namespace tt {
+
+namespace {
+
+struct OptionSpec {
+    std::string_view name;
+    std::string_view flags;      // Short options without an argument
+    std::string_view arg_flags;  // Short options that take one
+    std::string_view long_args;  // Long options that take one as the next word, space separated
+    std::string_view ordered;    // Groups of short options that override each other, space separated
+};
+
+constexpr std::string_view GREP_FLAGS = "abcEFGhHiIlLnoPqrRsTUvwxzZ";
+constexpr std::string_view GREP_ARG_FLAGS = "ABCdDefm";
+constexpr std::string_view GREP_LONG_ARGS =
+    "--after-context --before-context --context --regexp --file --max-count --include --exclude "
+    "--exclude-dir --exclude-from --label --devices --directories --binary-files";
+constexpr std::string_view GREP_ORDERED = "EFGP hH cLl rR aI";
+
+constexpr OptionSpec SPECS[] = {
+    {"ls", "1aAbBcCdfFgGhHiklLmnNopqQrRsStuUvxXZ", "ITw",
+     "--block-size --format --hide --ignore --indicator-style --quoting-style --sort --tabsize --time "
+     "--time-style --width",
+     "1Cglmnox cfStuUvX bNqQ hk Fp aA HL"},
+    {"grep", GREP_FLAGS, GREP_ARG_FLAGS, GREP_LONG_ARGS, GREP_ORDERED},
+    {"egrep", GREP_FLAGS, GREP_ARG_FLAGS, GREP_LONG_ARGS, GREP_ORDERED},
+    {"fgrep", GREP_FLAGS, GREP_ARG_FLAGS, GREP_LONG_ARGS, GREP_ORDERED},
+    {"rm", "dfiIrRv", "", "", "fiI"},
+    {"rmdir", "pv", "", "", ""},
+    {"mkdir", "pv", "m", "--mode", ""},
+    {"cp", "abdfHilLnpPrRsTuvx", "St", "--suffix --target-directory", "finu adHLP"},
+    {"mv", "bfinTuv", "St", "--suffix --target-directory", "finu"},
+    {"touch", "acfhm", "drt", "--date --reference --time", ""},
+    {"chmod", "cfvR", "", "", "cv"},
+    {"chown", "cfhvRHLP", "", "--from", "cv HLP"},
+    {"chgrp", "cfhvRHLP", "", "", "cv HLP"},
+    {"du", "0abcDhHklLmsSx", "BdtX",
+     "--block-size --exclude --exclude-from --files0-from --max-depth --threshold --time-style",
+     "bBhkm DHLP"},
+    {"df", "ahHiklPTv", "Btx", "--block-size --exclude-type --type", "BhHk"},
+    {"wc", "clmwL", "", "--files0-from", ""},
+    {"cat", "AbeEnstTuv", "", "", ""},
+    {"head", "qvz", "cn", "--bytes --lines", "cn qv"},
+    {"tail", "fFqvz", "cns", "--bytes --lines --max-unchanged-stats --pid --sleep-interval", "cn qv"},
+    {"sort", "bcCdfghiMmnrRsuVz", "kotST",
+     "--batch-size --buffer-size --compress-program --field-separator --files0-from --key --output "
+     "--parallel --random-source --sort --temporary-directory", ""},
+    {"uniq", "cdDiuz", "fsw", "--check-chars --skip-chars --skip-fields", ""},
+    {"free", "bghklmtw", "cs", "--count --seconds", "bghkmt"},
+    {"uname", "amnoprsvi", "", "", ""},
+    {"ss", "046aAeEhHilmnNoOprsStuwxZz", "fF", "--family --filter --query", ""},
+    {"netstat", "acCeFgilMnNoprstuvwx", "", "", ""},
+};
+
+const OptionSpec* findSpec(std::string_view name) {
+    for (const auto& spec : SPECS) {
+        if (spec.name == name) return &spec;
+    }
+    return nullptr;
+}
+
+// Index of the override group of a short option, -1 when it has none
+int orderedGroup(const OptionSpec& spec, char c) {
+    int group = 0;
+    for (char member : spec.ordered) {
+        if (member == ' ') {
+            ++group;
+        } else if (member == c) {
+            return group;
+        }
+    }
+    return -1;
+}
+
+bool takesLongArg(const OptionSpec& spec, std::string_view option) {
+    std::string_view list = spec.long_args;
+    for (size_t pos = list.find(option); pos != std::string_view::npos; pos = list.find(option, pos + 1)) {
+        size_t end = pos + option.size();
+        if ((pos == 0 || list[pos - 1] == ' ') && (end == list.size() || list[end] == ' ')) return true;
+    }
+    return false;
+}
+
+// Characters that never need quoting
+bool isBareSafe(std::string_view text) {
+    if (text.empty()) return false;
+    for (char c : text) {
+        bool ok = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') ||
+                  c == '_' || c == '@' || c == '%' || c == '+' || c == ':' || c == ',' ||
+                  c == '.' || c == '/' || c == '=' || c == '-';
+        if (!ok) return false;
+    }
+    return true;
+}
+
+// Literal text in the canonical quoting: bare when safe, else single quotes
+void appendText(std::string_view text, std::string& out) {
+    if (isBareSafe(text)) {
+        out.append(text);
+        return;
+    }
+    out += '\'';
+    for (char c : text) {
+        if (c == '\'') {
+            out += "'\\''";
+        } else {
+            out += c;
+        }
+    }
+    out += '\'';
+}
+
+// Words whose meaning depends on how they are quoted keep their source text
+bool isLiteral(const Word& word) {
+    return !word.has(TOKEN_SUBSTITUTION) && !word.has(TOKEN_EXPANSION) &&
+           !word.has(TOKEN_GLOB) && !word.has(TOKEN_UNTERMINATED);
+}
+
+void appendWord(const Word& word, std::string& out, bool command_name = false) {
+    // A quoted "A=1" in command position is a command name, not an assignment
+    if (!word.has(TOKEN_QUOTED) || !isLiteral(word) ||
+        (command_name && word.text.find('=') != std::string_view::npos)) {
+        out.append(word.raw);
+    } else {
+        appendText(word.text, out);
+    }
+}
+
+bool isCompoundKeyword(std::string_view word) {
+    static const char* const KEYWORDS[] = {
+        "if", "then", "else", "elif", "fi", "do", "done", "while", "until", "for",
+        "select", "case", "esac", "function", "coproc", "[["
+    };
+    for (const char* keyword : KEYWORDS) {
+        if (word == keyword) return true;
+    }
+    return false;
+}
+
+// What the AST does not model: the rewrite would drop or reorder it
+bool needsRespaceOnly(const TokenList& tokens) {
+    bool command_start = true;
+    for (const auto& token : tokens) {
+        if (token.is(TokenKind::PIPE_AND)) return true;
+        if (token.is(TokenKind::WORD)) {
+            if (command_start && isCompoundKeyword(token.text)) return true;
+            command_start = false;
+        } else if (!token.isRedirection() && !token.is(TokenKind::IO_NUMBER)) {
+            command_start = true;
+        }
+    }
+    return false;
+}
+
+void respace(const TokenList& tokens, std::string& out) {
+    bool attach = false;
+    for (const auto& token : tokens) {
+        if (!out.empty() && !attach) out += ' ';
+        out.append(token.is(TokenKind::NEWLINE) ? std::string_view("\n") : token.text);
+        attach = token.is(TokenKind::IO_NUMBER);  // "2 >" would make the 2 an argument
+    }
+}
+
+class Printer {
+public:
+    explicit Printer(std::string& out) : out_(out) {}
+
+    // A reserved word ended up in command position, so the output would
+    // parse differently from the input
+    bool failed() const { return failed_; }
+
+    void list(const ListNode& node) {
+        for (uint32_t i = 0; i < node.count; ++i) {
+            const ListItem& item = node.items[i];
+            pipeline(*item.pipeline);
+
+            bool last = i + 1 == node.count;
+            switch (item.separator) {
+                case TokenKind::AND_IF: out_ += last ? " &&" : " && "; break;
+                case TokenKind::OR_IF: out_ += last ? " ||" : " || "; break;
+                case TokenKind::AMP: out_ += last ? " &" : " & "; break;
+                default: if (!last) out_ += "; "; break;
+            }
+        }
+    }
+
+private:
+    static constexpr int LONG_GROUP = 1 << 8;
+
+    struct OptionUnit {
+        uint32_t offset;       // Into scratch_
+        uint32_t length;
+        uint32_t name_length;  // "-n" of "-n 5", "--sort" of "--sort=size"
+        int group;             // Override group, -1 for none
+        uint32_t key_offset = 0;  // Name it sorts by: its own, or its group's first
+        uint32_t key_length = 0;
+    };
+
+    std::string& out_;
+    bool failed_ = false;
+    bool posix_ = false;  // POSIXLY_CORRECT: the first operand ends the options
+    std::string scratch_;
+    SmallVector<OptionUnit, 16> units_;
+    SmallVector<uint32_t, 16> operands_;
+
+    void pipeline(const PipelineNode& node) {
+        if (node.negated) out_ += "! ";
+        for (uint32_t i = 0; i < node.count; ++i) {
+            if (i > 0) out_ += " | ";
+            any(*node.commands[i]);
+        }
+    }
+
+    void any(const Node& node) {
+        if (node.kind == NodeKind::COMMAND) {
+            command(static_cast<const CommandNode&>(node));
+        } else {
+            compound(static_cast<const CompoundNode&>(node));
+        }
+    }
+
+    void compound(const CompoundNode& node) {
+        if (!node.function_name.empty()) {
+            out_.append(node.function_name);
+            out_ += "() ";
+        }
+        if (node.kind == NodeKind::SUBSHELL) {
+            out_ += "( ";
+            list(*node.body);
+            out_ += " )";
+        } else {
+            out_ += "{ ";
+            list(*node.body);
+            out_ += "; }";
+        }
+        for (uint32_t i = 0; i < node.redirect_count; ++i) {
+            out_ += ' ';
+            redirect(node.redirects[i]);
+        }
+    }
+
+    void command(const CommandNode& node) {
+        // "> f { x" runs "{": printed first it would open a group
+        if (node.word_count > 0 && (node.redirect_count > 0 || node.assignment_count > 0)) {
+            std::string_view name = node.words[0].raw;
+            if (name == "{" || name == "}" || name == "!" || isCompoundKeyword(name)) failed_ = true;
+        }
+
+        bool first = true;
+        auto separate = [&] {
+            if (!first) out_ += ' ';
+            first = false;
+        };
+
+        posix_ = false;
+        for (uint32_t i = 0; i < node.assignment_count; ++i) {
+            separate();
+            out_.append(node.assignments[i].raw);
+            if (node.assignments[i].text.rfind("POSIXLY_CORRECT=", 0) == 0) posix_ = true;
+        }
+        if (node.word_count > 0) {
+            separate();
+            words(node);
+        }
+        for (uint32_t i = 0; i < node.redirect_count; ++i) {
+            separate();
+            redirect(node.redirects[i]);
+        }
+    }
+
+    // The command's words, with the command run by sudo/nice/... canonicalized too
+    void words(const CommandNode& node) {
+        const CommandNode* runs = nullptr;
+        if (node.nested && node.nested->kind == NodeKind::COMMAND && !node.nested->next) {
+            const auto* nested = static_cast<const CommandNode*>(node.nested);
+            if (nested->runner == &node && nested->words + nested->word_count == node.words + node.word_count) {
+                runs = nested;
+            }
+        }
+
+        if (runs) {
+            auto prefix = static_cast<uint32_t>(runs->words - node.words);
+            for (uint32_t i = 0; i < prefix; ++i) {
+                appendWord(node.words[i], out_, i == 0);
+                out_ += ' ';
+                if (node.words[i].text.rfind("POSIXLY_CORRECT=", 0) == 0) posix_ = true;
+            }
+            words(*runs);
+            return;
+        }
+
+        const OptionSpec* spec = findSpec(node.name());
+        if (spec && !posix_ && !node.words[0].has(TOKEN_QUOTED) && options(*spec, node)) return;
+
+        for (uint32_t i = 0; i < node.word_count; ++i) {
+            if (i > 0) out_ += ' ';
+            appendWord(node.words[i], out_, i == 0);
+        }
+    }
+
+    // Options split and sorted, then the operands in order. Options of one
+    // override group keep their source order and sort as a block under the
+    // name of the first; a long option may override any of them, so with
+    // one present all grouped options form a single block. False, with
+    // nothing written, when an option is not in the spec.
+    bool options(const OptionSpec& spec, const CommandNode& node) {
+        scratch_.clear();
+        units_.clear();
+        operands_.clear();
+        bool end_of_options = false;
+
+        for (uint32_t i = 1; i < node.word_count; ++i) {
+            const Word& word = node.words[i];
+            std::string_view text = word.text;
+            if (end_of_options || text.size() < 2 || text[0] != '-') {
+                operands_.push_back(i);
+                continue;
+            }
+            if (!isLiteral(word)) return false;
+            if (text == "--") {
+                end_of_options = true;
+                continue;
+            }
+
+            if (text[1] == '-') {
+                auto offset = static_cast<uint32_t>(scratch_.size());
+                size_t eq = text.find('=');
+                std::string_view name = text.substr(0, eq);
+                scratch_.append(name);
+                if (eq != std::string_view::npos) {
+                    scratch_ += '=';
+                    appendText(text.substr(eq + 1), scratch_);
+                } else if (takesLongArg(spec, name)) {
+                    if (++i >= node.word_count) return false;
+                    scratch_ += '=';
+                    appendWord(node.words[i], scratch_);
+                }
+                units_.push_back({offset, static_cast<uint32_t>(scratch_.size() - offset),
+                                  static_cast<uint32_t>(name.size()), LONG_GROUP});
+                continue;
+            }
+
+            for (size_t j = 1; j < text.size(); ++j) {
+                char c = text[j];
+                auto offset = static_cast<uint32_t>(scratch_.size());
+                scratch_ += '-';
+                scratch_ += c;
+                if (spec.arg_flags.find(c) != std::string_view::npos) {
+                    scratch_ += ' ';
+                    if (j + 1 < text.size()) {
+                        appendText(text.substr(j + 1), scratch_);
+                    } else if (++i < node.word_count) {
+                        appendWord(node.words[i], scratch_);
+                    } else {
+                        return false;
+                    }
+                    units_.push_back({offset, static_cast<uint32_t>(scratch_.size() - offset), 2,
+                                      orderedGroup(spec, c)});
+                    break;
+                }
+                if (spec.flags.find(c) == std::string_view::npos) return false;
+                units_.push_back({offset, 2, 2, orderedGroup(spec, c)});
+            }
+        }
+
+        bool has_long = false;
+        for (const auto& unit : units_) has_long |= unit.group == LONG_GROUP;
+        for (size_t i = 0; i < units_.size(); ++i) {
+            OptionUnit& unit = units_[i];
+            if (has_long && unit.group >= 0) unit.group = LONG_GROUP;
+            size_t first = i;
+            for (size_t j = 0; unit.group >= 0 && j < i; ++j) {
+                if (units_[j].group == unit.group) {
+                    first = j;
+                    break;
+                }
+            }
+            unit.key_offset = units_[first].offset;
+            unit.key_length = units_[first].name_length;
+        }
+
+        // Stable, so repeated options (-k2 -k1, -e a -e b) and groups keep their order
+        auto name = [&](const OptionUnit& unit) {
+            return std::string_view(scratch_).substr(unit.key_offset, unit.key_length);
+        };
+        for (size_t i = 1; i < units_.size(); ++i) {
+            OptionUnit unit = units_[i];
+            size_t j = i;
+            for (; j > 0 && name(unit) < name(units_[j - 1]); --j) units_[j] = units_[j - 1];
+            units_[j] = unit;
+        }
+
+        appendWord(node.words[0], out_, true);
+        for (const auto& unit : units_) {
+            out_ += ' ';
+            out_.append(scratch_, unit.offset, unit.length);
+        }
+        if (end_of_options) out_ += " --";
+        for (uint32_t index : operands_) {
+            out_ += ' ';
+            appendWord(node.words[index], out_);
+        }
+        return true;
+    }
+
+    void redirect(const Redirect& r) {
+        if (r.fd >= 0) out_ += std::to_string(r.fd);
+        out_ += toString(r.op);
+        appendWord(r.target, out_);
+    }
+};
+
+} // anonymous namespace
+
+void canonicalizeCommand(std::string_view command, std::string& out) {
+    out.clear();
+
+    TokenList tokens;
+    ShellLexer::tokenize(command, tokens);
+    for (const auto& token : tokens) {
+        // Bodies are line-oriented and the lexer drops their delimiter lines
+        if (token.is(TokenKind::HEREDOC)) {
+            out.assign(command);
+            return;
+        }
+    }
+    if (needsRespaceOnly(tokens)) {
+        respace(tokens, out);
+        return;
+    }
+
+    ShellAst ast(command);
+    if (!ast.complete()) {
+        respace(tokens, out);
+        return;
+    }
+
+    Printer printer(out);
+    printer.list(ast.root());
+    if (printer.failed()) {
+        out.clear();
+        respace(tokens, out);
+    }
+}
+
+std::string canonicalizeCommand(std::string_view command) {
+    std::string out;
+    canonicalizeCommand(command, out);
+    return out;
+}
+
+} // namespace tt
@@ -3,45 +3,51 @@
  */
 
 #include "tt/CommandParser.hpp"
+#include "tt/CaseFold.hpp"
+#include "tt/QueryNormalizer.hpp"
+#include "tt/QuestionClassifier.hpp"
+#include "tt/ShellLexer.hpp"
 
 #include <algorithm>
-#include <regex>
-#include <sstream>
+#include <cctype>
 
 namespace tt {
 
 struct CommandParser::Impl {
-    std::vector<std::string> question_patterns = {
-        "como", "what", "how", "why", "quando", "where", "qual", "quais",
-        "o que", "por que", "porque", "explain", "explique"
-    };
+    StringInterner executables;
     
-    std::vector<std::string> tokenize(const std::string& input) {
-        std::vector<std::string> tokens;
-        std::istringstream iss(input);
-        std::string token;
-        
-        bool in_quotes = false;
-        std::string quoted_token;
-        
-        while (iss >> token) {
-            if (token.front() == '"' || token.front() == '\'') {
-                in_quotes = true;
-                quoted_token = token.substr(1);
-            } else if (in_quotes) {
-                if (token.back() == '"' || token.back() == '\'') {
-                    quoted_token += " " + token.substr(0, token.size() - 1);
-                    tokens.push_back(quoted_token);
-                    in_quotes = false;
-                } else {
-                    quoted_token += " " + token;
-                }
-            } else {
-                tokens.push_back(token);
-            }
+    // Keywords that can precede a command name
+    static bool isReservedWord(std::string_view word) {
+        static const char* const RESERVED[] = {
+            "if", "then", "else", "elif", "fi", "do", "done", "while", "until",
+            "esac", "{", "}", "!", "time"
+        };
+        for (const char* reserved : RESERVED) {
+            if (word == reserved) return true;
         }
-        
-        return tokens;
+        return false;
+    }
+    
+    // Clause headers whose words up to the next separator are not a command
+    static bool isClauseHeader(std::string_view word) {
+        return word == "for" || word == "case" || word == "select";
+    }
+    
+    static bool isAssignment(std::string_view word) {
+        size_t eq = word.find('=');
+        if (eq == 0 || eq == std::string_view::npos) return false;
+        for (size_t i = 0; i < eq; ++i) {
+            char c = word[i];
+            bool ok = c == '_' || std::isalpha(static_cast<unsigned char>(c)) ||
+                      (i > 0 && std::isdigit(static_cast<unsigned char>(c)));
+            if (!ok) return false;
+        }
+        return true;
+    }
+    
+    void setExecutable(CompactCommand& command, TokenSpan span) {
+        command.executable_ = span;
+        command.executable_id_ = executables.intern(command.executable());
     }
 };
 
@@ -50,79 +56,159 @@ CommandParser::CommandParser() : impl_(std::make_unique<Impl>()) {}
 CommandParser::~CommandParser() = default;
 
 ParsedCommand CommandParser::parse(const std::string& input) {
-    ParsedCommand result;
-    result.raw_input = input;
-    result.is_question = isQuestion(input);
-    
-    if (result.is_question) {
-        return result;
-    }
-    
-    auto tokens = impl_->tokenize(input);
+    CompactCommand command;
+    parse(input, command);
+    return command.toParsedCommand();
+}
+
+void CommandParser::parse(std::string_view input, CompactCommand& out) {
+    out.clear();
+    // Unquoting never lengthens a word, so this is the only allocation
+    out.buffer_.reserve(input.size() * 2);
+    out.raw_ = out.append(input);
+    out.is_question_ = tt::isQuestion(input);
     
-    if (tokens.empty()) {
-        return result;
+    if (out.is_question_) {
+        return;
     }
     
-    result.executable = tokens[0];
-    
-    for (size_t i = 1; i < tokens.size(); ++i) {
-        const auto& token = tokens[i];
-        if (token.front() == '-') {
-            result.flags.push_back(token);
+    // Words are unquoted; operators keep their source text
+    bool first = true;
+    ShellLexer lexer(input);
+    for (Token token = lexer.next(); !token.is(TokenKind::END); token = lexer.next()) {
+        if (token.is(TokenKind::NEWLINE) || token.is(TokenKind::HEREDOC)) {
+            continue;
+        }
+        
+        TokenSpan span;
+        if (token.is(TokenKind::WORD)) {
+            span.offset = static_cast<uint32_t>(out.buffer_.size());
+            unquoteInto(token.text, out.buffer_);
+            span.length = static_cast<uint32_t>(out.buffer_.size() - span.offset);
         } else {
-            result.args.push_back(token);
+            span = out.append(token.text);
+        }
+        
+        if (first) {
+            first = false;
+            if (span.length > 0) impl_->setExecutable(out, span);
+        } else if (span.length > 0 && out.buffer_[span.offset] == '-') {
+            out.flags_.push_back(span);
+        } else {
+            out.args_.push_back(span);
         }
     }
-    
-    return result;
 }
 
-bool CommandParser::isQuestion(const std::string& input) {
-    std::string lower = input;
-    std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
+std::vector<ParsedCommand> CommandParser::parseCommands(const std::string& input) {
+    CompactCommandList compact;
+    parseCommands(input, compact);
     
-    // Check for question mark
-    if (lower.find('?') != std::string::npos) {
-        return true;
+    std::vector<ParsedCommand> commands;
+    commands.reserve(compact.size());
+    for (const auto& command : compact) {
+        commands.push_back(command.toParsedCommand());
+        commands.back().raw_input = input;
     }
+    return commands;
+}
+
+void CommandParser::parseCommands(std::string_view input, CompactCommandList& out) {
+    out.clear();
+    CompactCommand* current = nullptr;
+    size_t raw_begin = 0, raw_end = 0;
+    bool skip_target = false;   // Next word is a redirection target
+    bool skip_clause = false;   // Inside "for x in ..." or "case x in"
     
-    // Check for question patterns
-    for (const auto& pattern : impl_->question_patterns) {
-        if (lower.find(pattern) == 0 || lower.find(" " + pattern) != std::string::npos) {
-            return true;
+    auto flush = [&]() {
+        if (current) {
+            if (current->executable_id_ == StringInterner::NONE) {
+                out.pop_back();
+            } else {
+                current->raw_ = current->append(input.substr(raw_begin, raw_end - raw_begin));
+            }
         }
-    }
+        current = nullptr;
+        skip_target = false;
+        skip_clause = false;
+    };
     
-    return false;
+    ShellLexer lexer(input);
+    for (Token token = lexer.next(); !token.is(TokenKind::END); token = lexer.next()) {
+        if (token.is(TokenKind::HEREDOC)) {
+            continue;
+        }
+        if (token.isOperator() && !token.isRedirection()) {
+            flush();
+            continue;
+        }
+        
+        size_t token_begin = static_cast<size_t>(token.text.data() - input.data());
+        if (!current) {
+            current = &out.add();
+            raw_begin = token_begin;
+        }
+        raw_end = token_begin + token.text.size();
+        
+        if (token.isRedirection()) {
+            skip_target = true;
+            continue;
+        }
+        if (token.is(TokenKind::IO_NUMBER)) {
+            continue;
+        }
+        if (skip_target) {
+            skip_target = false;
+            continue;
+        }
+        if (skip_clause) {
+            continue;
+        }
+        
+        TokenSpan span{static_cast<uint32_t>(current->buffer_.size()), 0};
+        unquoteInto(token.text, current->buffer_);
+        span.length = static_cast<uint32_t>(current->buffer_.size() - span.offset);
+        std::string_view word = current->view(span);
+        
+        if (current->executable_id_ == StringInterner::NONE) {
+            if (Impl::isClauseHeader(word)) {
+                skip_clause = true;
+            } else if (!word.empty() && !Impl::isReservedWord(word) && !Impl::isAssignment(word)) {
+                impl_->setExecutable(*current, span);
+                continue;
+            }
+            current->buffer_.resize(span.offset);
+        } else if (word.size() > 1 && word.front() == '-') {
+            current->flags_.push_back(span);
+        } else {
+            current->args_.push_back(span);
+        }
+    }
+    flush();
+}
+
+const StringInterner& CommandParser::executables() const {
+    return impl_->executables;
+}
+
+bool CommandParser::isQuestion(const std::string& input) {
+    return tt::isQuestion(input);
 }
 
 std::string CommandParser::extractIntent(const std::string& question) {
-    // Remove question marks and common prefixes
-    std::string intent = question;
+    std::string_view intent = question;
     
     // Remove trailing punctuation
-    while (!intent.empty() && (intent.back() == '?' || intent.back() == '.')) {
-        intent.pop_back();
+    while (!intent.empty() && (intent.back() == '?' || intent.back() == '.' || intent.back() == '!')) {
+        intent.remove_suffix(1);
     }
     
-    // Remove common prefixes
-    std::vector<std::string> prefixes = {
-        "como eu ", "como posso ", "how do i ", "how can i ",
-        "o que faz ", "what does ", "me explica ", "explain "
-    };
-    
-    std::string lower = intent;
-    std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
-    
-    for (const auto& prefix : prefixes) {
-        if (lower.find(prefix) == 0) {
-            intent = intent.substr(prefix.size());
-            break;
-        }
-    }
+    // Remove leading filler phrases; folding keeps byte offsets
+    std::string folded;
+    foldCase(intent, folded);
+    intent.remove_prefix(intentPrefixLength(folded));
     
-    return intent;
+    return std::string(intent);
 }
 
 } // namespace tt
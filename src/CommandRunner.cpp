@@ -0,0 +1,533 @@
+/**
+ * CommandRunner.cpp - Run a command under /bin/sh, within limits, and account for what it cost
+ *
+ * The shell is forked, parked on a pipe while the parent moves it into a
+ * fresh cgroup and hands it the terminal, and released; nothing it runs
+ * ever executes outside that cgroup. Limits are rlimits and cgroup files
+ * set before exec, so enforcing them costs the parent nothing but a poll()
+ * deadline. Afterwards cpu.stat, memory.peak and io.stat are read and any
+ * process still inside (a backgrounded job) is moved back to the caller's
+ * cgroup so the transient one can be removed.
+ */
+
+#include "tt/CommandRunner.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <optional>
+#include <sstream>
+#include <thread>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <termios.h>
+#include <unistd.h>
+
+namespace tt {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Between SIGTERM and SIGKILL on timeout, and between SIGKILL and giving up
+// on the output pipe (a process that escaped both group and cgroup)
+constexpr std::chrono::milliseconds GRACE{1000};
+
+constexpr int IOPRIO_WHO_PROCESS = 1;
+constexpr int IOPRIO_CLASS_BE = 2;
+constexpr int IOPRIO_CLASS_SHIFT = 13;
+
+void writeAll(int fd, const char* data, size_t size) {
+    while (size > 0) {
+        ssize_t n = ::write(fd, data, size);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return;
+        }
+        data += n;
+        size -= static_cast<size_t>(n);
+    }
+}
+
+bool writeFile(const std::string& path, const std::string& text) {
+    int fd = ::open(path.c_str(), O_WRONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+    ssize_t n = ::write(fd, text.data(), text.size());
+    ::close(fd);
+    return n == static_cast<ssize_t>(text.size());
+}
+
+std::string formatBytes(uint64_t bytes) {
+    const char* units[] = {"B", "KB", "MB", "GB", "TB"};
+    double value = static_cast<double>(bytes);
+    size_t unit = 0;
+    while (value >= 1024 && unit + 1 < std::size(units)) {
+        value /= 1024;
+        ++unit;
+    }
+    char text[32];
+    std::snprintf(text, sizeof(text), unit == 0 ? "%.0f %s" : "%.1f %s", value, units[unit]);
+    return text;
+}
+
+// "2G", "512M", "100k", "4096"
+std::optional<uint64_t> parseSize(std::string_view text) {
+    uint64_t scale = 1;
+    if (!text.empty()) {
+        switch (text.back()) {
+            case 'k': case 'K': scale = 1ull << 10; break;
+            case 'm': case 'M': scale = 1ull << 20; break;
+            case 'g': case 'G': scale = 1ull << 30; break;
+            case 't': case 'T': scale = 1ull << 40; break;
+        }
+        if (scale != 1) text.remove_suffix(1);
+    }
+    if (text.empty() || text.size() > 12) return std::nullopt;
+    uint64_t value = 0;
+    for (char c : text) {
+        if (c < '0' || c > '9') return std::nullopt;
+        value = value * 10 + static_cast<uint64_t>(c - '0');
+    }
+    if (value > UINT64_MAX / scale) return std::nullopt;
+    return value * scale;
+}
+
+// "500ms", "60s", "60", "10m", "1h"
+std::optional<std::chrono::milliseconds> parseDuration(std::string_view text) {
+    uint64_t scale = 1000;
+    if (text.size() > 2 && text.substr(text.size() - 2) == "ms") {
+        scale = 1;
+        text.remove_suffix(2);
+    } else if (!text.empty() && (text.back() == 's' || text.back() == 'm' || text.back() == 'h')) {
+        scale = text.back() == 's' ? 1000 : text.back() == 'm' ? 60000 : 3600000;
+        text.remove_suffix(1);
+    }
+    auto value = parseSize(text);
+    if (!value || text.back() < '0' || text.back() > '9') return std::nullopt;
+    return std::chrono::milliseconds(*value * scale);
+}
+
+std::string sizeText(uint64_t bytes) {
+    if (bytes == 0) return "none";
+    const char* suffixes = "KMGT";
+    int unit = -1;
+    while (unit < 3 && bytes % 1024 == 0) {
+        bytes /= 1024;
+        ++unit;
+    }
+    return std::to_string(bytes) + (unit < 0 ? "" : std::string(1, suffixes[unit]));
+}
+
+std::string durationText(std::chrono::milliseconds duration) {
+    auto ms = static_cast<uint64_t>(duration.count());
+    if (ms == 0) return "none";
+    if (ms % 3600000 == 0) return std::to_string(ms / 3600000) + "h";
+    if (ms % 60000 == 0) return std::to_string(ms / 60000) + "m";
+    if (ms % 1000 == 0) return std::to_string(ms / 1000) + "s";
+    return std::to_string(ms) + "ms";
+}
+
+// ---------------------------------------------------------------------------
+// Transient cgroup
+// ---------------------------------------------------------------------------
+
+// Directory of the caller's cgroup in the cgroup v2 hierarchy, or empty
+std::string ownCgroup() {
+    std::string mount;
+    std::ifstream mounts("/proc/self/mountinfo");
+    std::string line;
+    while (std::getline(mounts, line)) {
+        // <id> <parent> <dev> <root> <mount point> <options> [optional...] - <fstype> ...
+        size_t dash = line.find(" - ");
+        if (dash == std::string::npos || line.compare(dash + 3, 8, "cgroup2 ") != 0) continue;
+        std::istringstream fields(line.substr(0, dash));
+        std::string skip;
+        fields >> skip >> skip >> skip >> skip >> mount;
+        break;
+    }
+    if (mount.empty()) return {};
+
+    std::ifstream cgroups("/proc/self/cgroup");
+    while (std::getline(cgroups, line)) {
+        if (line.rfind("0::", 0) == 0) {
+            std::string path = line.substr(3);
+            if (path == "/") path.clear();
+            return mount + path;
+        }
+    }
+    return {};
+}
+
+class TransientCgroup {
+public:
+    // Empty path() when no cgroup could be created
+    TransientCgroup() {
+        parent_ = ownCgroup();
+        if (parent_.empty()) return;
+        static std::atomic<unsigned> counter{0};
+        std::string dir = parent_ + "/tt-run-" + std::to_string(::getpid()) + "-" + std::to_string(counter++);
+        if (::mkdir(dir.c_str(), 0755) == 0) path_ = dir;
+    }
+
+    ~TransientCgroup() {
+        if (path_.empty()) return;
+        // Jobs left running in the background go back where tt runs
+        std::ifstream procs(path_ + "/cgroup.procs");
+        std::string pid;
+        while (procs >> pid) writeFile(parent_ + "/cgroup.procs", pid);
+        ::rmdir(path_.c_str());
+    }
+
+    TransientCgroup(const TransientCgroup&) = delete;
+    TransientCgroup& operator=(const TransientCgroup&) = delete;
+
+    bool adopt(pid_t pid) const {
+        return !path_.empty() && writeFile(path_ + "/cgroup.procs", std::to_string(pid));
+    }
+
+    // Only when the parent delegates the memory controller; swap is capped
+    // too so the limit is not turned into thrashing
+    bool limitMemory(uint64_t bytes) const {
+        if (path_.empty() || !writeFile(path_ + "/memory.max", std::to_string(bytes))) return false;
+        writeFile(path_ + "/memory.swap.max", "0");
+        return true;
+    }
+
+    // Every process inside, also those that left the process group (5.14+)
+    bool kill() const {
+        return writeFile(path_ + "/cgroup.kill", "1");
+    }
+
+    bool oomKilled() const {
+        std::ifstream events(path_ + "/memory.events");
+        std::string key;
+        uint64_t value = 0;
+        while (events >> key >> value) {
+            if (key == "oom_kill") return value > 0;
+        }
+        return false;
+    }
+
+    // cpu.stat is always there; memory.peak (5.19+) and io.stat only when
+    // the parent delegates those controllers, so rusage fills the gaps
+    void read(ResourceUsage& usage) const {
+        std::ifstream cpu(path_ + "/cpu.stat");
+        std::string key;
+        uint64_t value = 0;
+        while (cpu >> key >> value) {
+            if (key == "user_usec") usage.user_ms = static_cast<double>(value) / 1000;
+            if (key == "system_usec") usage.sys_ms = static_cast<double>(value) / 1000;
+        }
+
+        std::ifstream peak(path_ + "/memory.peak");
+        if (peak >> value) usage.peak_rss = value;
+
+        // <major>:<minor> rbytes=N wbytes=N rios=N ...
+        std::ifstream io(path_ + "/io.stat");
+        if (!io) return;
+        uint64_t read_bytes = 0;
+        uint64_t write_bytes = 0;
+        std::string field;
+        while (io >> field) {
+            if (field.rfind("rbytes=", 0) == 0) read_bytes += std::stoull(field.substr(7));
+            if (field.rfind("wbytes=", 0) == 0) write_bytes += std::stoull(field.substr(7));
+        }
+        usage.read_bytes = read_bytes;
+        usage.write_bytes = write_bytes;
+    }
+
+private:
+    std::string parent_;
+    std::string path_;
+};
+
+double millis(const timeval& tv) {
+    return static_cast<double>(tv.tv_sec) * 1000 + static_cast<double>(tv.tv_usec) / 1000;
+}
+
+// Makes pgid the terminal's foreground process group
+void handTerminal(pid_t pgid) {
+    // tcsetpgrp() from a background group raises SIGTTOU
+    struct sigaction ignore {};
+    struct sigaction previous {};
+    ignore.sa_handler = SIG_IGN;
+    ::sigaction(SIGTTOU, &ignore, &previous);
+    ::tcsetpgrp(STDIN_FILENO, pgid);
+    ::sigaction(SIGTTOU, &previous, nullptr);
+}
+
+void setLimit(int resource, uint64_t soft, uint64_t hard) {
+    rlimit limit{static_cast<rlim_t>(soft), static_cast<rlim_t>(hard)};
+    ::setrlimit(resource, &limit);
+}
+
+// In the child, between fork and exec
+void applyLimits(const RunLimits& limits, bool memory_in_cgroup) {
+    if (limits.cpu_seconds) setLimit(RLIMIT_CPU, limits.cpu_seconds, limits.cpu_seconds + 1);
+    if (limits.memory_bytes && !memory_in_cgroup) setLimit(RLIMIT_AS, limits.memory_bytes, limits.memory_bytes);
+    if (limits.file_bytes) setLimit(RLIMIT_FSIZE, limits.file_bytes, limits.file_bytes);
+    if (limits.nice) {
+        errno = 0;
+        int current = ::getpriority(PRIO_PROCESS, 0);
+        if (errno == 0) ::setpriority(PRIO_PROCESS, 0, current + limits.nice);
+    }
+    if (limits.ionice >= 0) {
+        int priority = (IOPRIO_CLASS_BE << IOPRIO_CLASS_SHIFT) | std::min(limits.ionice, 7);
+        ::syscall(SYS_ioprio_set, IOPRIO_WHO_PROCESS, 0, priority);
+    }
+}
+
+} // anonymous namespace
+
+RunLimits RunLimits::defaults() {
+    RunLimits limits;
+    limits.timeout = std::chrono::minutes(10);
+    limits.output_rate = 8 << 20;
+    limits.nice = 10;
+    limits.ionice = 7;
+    return limits;
+}
+
+std::optional<RunLimits> parseRunLimits(std::string_view spec, std::string& error) {
+    RunLimits limits = RunLimits::defaults();
+    while (!spec.empty()) {
+        size_t comma = spec.find(',');
+        std::string_view item = spec.substr(0, comma);
+        spec = comma == std::string_view::npos ? std::string_view() : spec.substr(comma + 1);
+        if (item.empty()) continue;
+
+        size_t eq = item.find('=');
+        std::string_view key = item.substr(0, eq);
+        std::string_view value = eq == std::string_view::npos ? std::string_view() : item.substr(eq + 1);
+        if (value == "none") value = "0";
+
+        bool ok = true;
+        if (key == "timeout") {
+            auto duration = parseDuration(value);
+            if ((ok = duration.has_value())) limits.timeout = *duration;
+        } else if (key == "cpu") {
+            auto duration = parseDuration(value);
+            if ((ok = duration.has_value())) {
+                limits.cpu_seconds = static_cast<uint64_t>((duration->count() + 999) / 1000);
+            }
+        } else if (key == "memory" || key == "fsize" || key == "output") {
+            auto size = parseSize(value);
+            if ((ok = size.has_value())) {
+                (key == "memory" ? limits.memory_bytes : key == "fsize" ? limits.file_bytes : limits.output_rate) = *size;
+            }
+        } else if (key == "nice" || key == "ionice") {
+            auto level = parseSize(value);
+            ok = level && *level <= (key == "nice" ? 19u : 7u);
+            if (ok) (key == "nice" ? limits.nice : limits.ionice) = static_cast<int>(*level);
+        } else {
+            error = "unknown limit '" + std::string(key) + "'";
+            return std::nullopt;
+        }
+        if (!ok) {
+            error = "invalid value for " + std::string(key) + ": '" + std::string(value) + "'";
+            return std::nullopt;
+        }
+    }
+    return limits;
+}
+
+std::string toString(const RunLimits& limits) {
+    return "timeout=" + durationText(limits.timeout) +
+           ",cpu=" + durationText(std::chrono::seconds(limits.cpu_seconds)) +
+           ",memory=" + sizeText(limits.memory_bytes) +
+           ",fsize=" + sizeText(limits.file_bytes) +
+           ",output=" + sizeText(limits.output_rate) +
+           ",nice=" + std::to_string(limits.nice) +
+           ",ionice=" + (limits.ionice < 0 ? std::string("none") : std::to_string(limits.ionice));
+}
+
+std::string RunResult::outcome(const RunLimits& limits) const {
+    std::string text;
+    switch (stopped) {
+        case StopReason::NONE: break;
+        case StopReason::TIMEOUT: text = "timed out after " + durationText(limits.timeout); break;
+        case StopReason::CPU: text = "exceeded the " + std::to_string(limits.cpu_seconds) + "s CPU limit"; break;
+        case StopReason::MEMORY: text = "exceeded the " + formatBytes(limits.memory_bytes) + " memory limit"; break;
+        case StopReason::FILE_SIZE: text = "exceeded the " + formatBytes(limits.file_bytes) + " file size limit"; break;
+    }
+    if (throttled_ms >= 100) {
+        char throttled[96];
+        std::snprintf(throttled, sizeof(throttled), "output throttled to %s/s for %.1fs",
+                      formatBytes(limits.output_rate).c_str(), throttled_ms / 1000);
+        text += (text.empty() ? "" : "; ") + std::string(throttled);
+    }
+    return text;
+}
+
+std::string ResourceUsage::summary() const {
+    char text[96];
+    std::snprintf(text, sizeof(text), "%.2fs wall, %.2fs user, %.2fs sys", wall_ms / 1000, user_ms / 1000,
+                  sys_ms / 1000);
+    std::string out = text;
+    if (peak_rss) out += ", " + formatBytes(peak_rss) + " peak";
+    if (read_bytes) out += ", " + formatBytes(read_bytes) + " read";
+    if (write_bytes) out += ", " + formatBytes(write_bytes) + " written";
+    out += ", " + std::to_string(voluntary_switches + involuntary_switches) + " ctx switches";
+    if (involuntary_switches) out += " (" + std::to_string(involuntary_switches) + " preempted)";
+    return out;
+}
+
+RunResult runCommand(const std::string& command,
+                     const std::function<void(std::string_view)>& on_output,
+                     const RunOptions& options) {
+    RunResult result;
+    const RunLimits& limits = options.limits;
+    std::optional<TransientCgroup> cgroup;
+    if (options.use_cgroup) cgroup.emplace();
+    bool memory_in_cgroup = cgroup && limits.memory_bytes && cgroup->limitMemory(limits.memory_bytes);
+
+    int out_pipe[2];
+    int start_pipe[2];
+    if (::pipe2(out_pipe, O_CLOEXEC) != 0) {
+        result.error = std::string("pipe: ") + std::strerror(errno);
+        return result;
+    }
+    if (::pipe2(start_pipe, O_CLOEXEC) != 0) {
+        result.error = std::string("pipe: ") + std::strerror(errno);
+        ::close(out_pipe[0]);
+        ::close(out_pipe[1]);
+        return result;
+    }
+
+    bool foreground = ::isatty(STDIN_FILENO) && ::tcgetpgrp(STDIN_FILENO) == ::getpgrp();
+    auto started = Clock::now();
+    pid_t pid = ::fork();
+    if (pid == 0) {
+        ::setpgid(0, 0);
+        // Wait until the parent has placed us in the cgroup and the foreground
+        char go;
+        ::close(start_pipe[1]);
+        while (::read(start_pipe[0], &go, 1) < 0 && errno == EINTR) {}
+        applyLimits(limits, memory_in_cgroup);
+        for (int sig : {SIGINT, SIGQUIT, SIGPIPE, SIGTTOU}) ::signal(sig, SIG_DFL);
+        ::dup2(out_pipe[1], STDOUT_FILENO);
+        ::dup2(out_pipe[1], STDERR_FILENO);
+        ::execl("/bin/sh", "sh", "-c", command.c_str(), static_cast<char*>(nullptr));
+        _exit(127);
+    }
+    ::close(out_pipe[1]);
+    ::close(start_pipe[0]);
+    if (pid < 0) {
+        result.error = std::string("fork: ") + std::strerror(errno);
+        ::close(out_pipe[0]);
+        ::close(start_pipe[1]);
+        return result;
+    }
+
+    ::setpgid(pid, pid);
+    result.usage.cgroup = cgroup && cgroup->adopt(pid);
+    if (foreground) handTerminal(pid);
+    writeAll(start_pipe[1], "g", 1);
+    ::close(start_pipe[1]);
+
+    auto signal = [&](int sig) {
+        if (sig == SIGKILL && result.usage.cgroup && cgroup->kill()) return;
+        ::kill(-pid, sig);
+    };
+
+    // The deadline moves from the timeout to SIGKILL to giving up on the pipe
+    auto never = Clock::time_point::max();
+    auto deadline = limits.timeout.count() > 0 ? started + limits.timeout : never;
+    int signals_sent = 0;
+
+    // Token bucket holding up to one second of output
+    double rate = static_cast<double>(limits.output_rate);
+    double budget = rate;
+    auto refilled = started;
+
+    char buffer[4096];
+    for (;;) {
+        auto now = Clock::now();
+        if (now >= deadline) {
+            if (signals_sent == 2) break;
+            signal(signals_sent == 0 ? SIGTERM : SIGKILL);
+            if (signals_sent++ == 0) result.stopped = StopReason::TIMEOUT;
+            deadline = now + GRACE;
+            continue;
+        }
+
+        size_t want = sizeof(buffer);
+        if (rate > 0) {
+            budget = std::min(rate, budget + rate * std::chrono::duration<double>(now - refilled).count());
+            refilled = now;
+            if (budget < 1) {
+                // Leave the data in the pipe; the command blocks once it fills
+                auto wait = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>((1 - budget) / rate));
+                auto until = std::min(deadline, now + std::max(wait, Clock::duration(std::chrono::milliseconds(1))));
+                std::this_thread::sleep_until(until);
+                result.throttled_ms += std::chrono::duration<double, std::milli>(Clock::now() - now).count();
+                continue;
+            }
+            want = std::min(want, static_cast<size_t>(budget));
+        }
+
+        int wait_ms = -1;
+        if (deadline != never) {
+            auto left = std::chrono::ceil<std::chrono::milliseconds>(deadline - now);
+            wait_ms = static_cast<int>(std::max<int64_t>(0, left.count()));
+        }
+        pollfd entry{out_pipe[0], POLLIN, 0};
+        int ready = ::poll(&entry, 1, wait_ms);
+        if (ready <= 0) continue;
+
+        ssize_t n = ::read(out_pipe[0], buffer, want);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;
+        std::string_view chunk(buffer, static_cast<size_t>(n));
+        budget -= static_cast<double>(n);
+        if (on_output) on_output(chunk);
+        size_t room = options.max_output - std::min(options.max_output, result.output.size());
+        if (chunk.size() > room) result.truncated = true;
+        result.output.append(chunk.substr(0, room));
+    }
+    ::close(out_pipe[0]);
+
+    int status = 0;
+    rusage ru{};
+    while (::wait4(pid, &status, 0, &ru) < 0 && errno == EINTR) {}
+    result.usage.wall_ms = std::chrono::duration<double, std::milli>(Clock::now() - started).count();
+    if (foreground) handTerminal(::getpgrp());
+    if (WIFEXITED(status)) result.exit_code = WEXITSTATUS(status);
+    else if (WIFSIGNALED(status)) result.exit_code = 128 + WTERMSIG(status);
+
+    ResourceUsage& usage = result.usage;
+    usage.user_ms = millis(ru.ru_utime);
+    usage.sys_ms = millis(ru.ru_stime);
+    usage.peak_rss = static_cast<uint64_t>(ru.ru_maxrss) * 1024;
+    usage.read_bytes = static_cast<uint64_t>(ru.ru_inblock) * 512;
+    usage.write_bytes = static_cast<uint64_t>(ru.ru_oublock) * 512;
+    usage.voluntary_switches = static_cast<uint64_t>(ru.ru_nvcsw);
+    usage.involuntary_switches = static_cast<uint64_t>(ru.ru_nivcsw);
+    if (usage.cgroup) cgroup->read(usage);
+
+    // The shell reports a child killed by a signal as 128 + signal too
+    if (result.stopped == StopReason::NONE) {
+        if (memory_in_cgroup && cgroup->oomKilled()) {
+            result.stopped = StopReason::MEMORY;
+        } else if (limits.cpu_seconds && (result.exit_code == 128 + SIGXCPU ||
+                   (result.exit_code == 128 + SIGKILL && usage.user_ms + usage.sys_ms >= limits.cpu_seconds * 1000.0))) {
+            result.stopped = StopReason::CPU;
+        } else if (limits.file_bytes && result.exit_code == 128 + SIGXFSZ) {
+            result.stopped = StopReason::FILE_SIZE;
+        }
+    }
+    return result;
+}
+
+} // namespace tt
@@ -0,0 +1,96 @@
+/**
+ * CompactCommand.cpp - Flat parsed command and executable interning
+ */
+
+#include "tt/CompactCommand.hpp"
+#include "tt/CommandParser.hpp"
+
+namespace tt {
+
+namespace {
+
+uint64_t hashName(std::string_view s) {
+    uint64_t h = 1469598103934665603ULL;
+    for (unsigned char c : s) {
+        h ^= c;
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+} // anonymous namespace
+
+// =============================================================================
+// StringInterner
+// =============================================================================
+
+StringInterner::StringInterner() : slots_(64, NONE) {}
+
+uint32_t StringInterner::find(std::string_view name) const {
+    size_t mask = slots_.size() - 1;
+    for (size_t slot = hashName(name) & mask;; slot = (slot + 1) & mask) {
+        uint32_t id = slots_[slot];
+        if (id == NONE || names_[id] == name) return id;
+    }
+}
+
+uint32_t StringInterner::intern(std::string_view name) {
+    size_t mask = slots_.size() - 1;
+    size_t slot = hashName(name) & mask;
+    for (; slots_[slot] != NONE; slot = (slot + 1) & mask) {
+        if (names_[slots_[slot]] == name) return slots_[slot];
+    }
+
+    auto id = static_cast<uint32_t>(names_.size());
+    names_.push_back(storage_.copy(name));
+    slots_[slot] = id;
+
+    // Keep the load factor under 1/2 so probes stay short
+    if (names_.size() * 2 > slots_.size()) rehash(slots_.size() * 2);
+    return id;
+}
+
+void StringInterner::rehash(size_t slot_count) {
+    slots_.assign(slot_count, NONE);
+    size_t mask = slot_count - 1;
+    for (uint32_t id = 0; id < names_.size(); ++id) {
+        size_t slot = hashName(names_[id]) & mask;
+        while (slots_[slot] != NONE) slot = (slot + 1) & mask;
+        slots_[slot] = id;
+    }
+}
+
+// =============================================================================
+// CompactCommand
+// =============================================================================
+
+TokenSpan CompactCommand::append(std::string_view text) {
+    TokenSpan span{static_cast<uint32_t>(buffer_.size()), static_cast<uint32_t>(text.size())};
+    buffer_.append(text);
+    return span;
+}
+
+void CompactCommand::clear() {
+    buffer_.clear();
+    raw_ = {};
+    executable_ = {};
+    flags_.clear();
+    args_.clear();
+    executable_id_ = StringInterner::NONE;
+    is_question_ = false;
+}
+
+ParsedCommand CompactCommand::toParsedCommand() const {
+    ParsedCommand result;
+    result.executable = executable();
+    result.raw_input = rawInput();
+    result.is_question = is_question_;
+
+    result.flags.reserve(flags_.size());
+    for (const auto& span : flags_) result.flags.emplace_back(view(span));
+    result.args.reserve(args_.size());
+    for (const auto& span : args_) result.args.emplace_back(view(span));
+    return result;
+}
+
+} // namespace tt
@@ -0,0 +1,264 @@
+/**
+ * DangerCheck.cpp - Detect commands that need confirmation before running
+ *
+ * Works on the parsed command line: blocklist rules (DangerRules) are
+ * matched against the name and words of every command that would run, and
+ * redirections are checked by target, so quoting, pipes, sudo or xargs
+ * cannot hide them. Every finding has a severity; the assessment keeps the
+ * most severe one and counts the rest.
+ */
+
+#include "tt/DangerCheck.hpp"
+#include "tt/ShellAst.hpp"
+#include "tt/ShellLexer.hpp"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+namespace tt {
+
+namespace {
+
+// Devices that are safe to write to
+const std::vector<std::string> HARMLESS_TARGETS = {
+    "/dev/null", "/dev/stdout", "/dev/stderr", "/dev/tty"
+};
+
+// Targets that make recursive forced operations wipe everything
+const std::vector<std::string> SWEEPING_TARGETS = {
+    "/", "/*", "~", "~/", "~/*", ".", "./", "..", "*"
+};
+
+bool isHarmlessTarget(std::string_view target) {
+    for (const auto& harmless : HARMLESS_TARGETS) {
+        if (target == harmless) return true;
+    }
+    return target.rfind("/dev/fd/", 0) == 0;
+}
+
+// Name of the command that really runs: sudo rm -> rm
+std::string_view effectiveName(const Node& node) {
+    if (node.kind != NodeKind::COMMAND) return {};
+    const auto& cmd = static_cast<const CommandNode&>(node);
+    if (cmd.nested && cmd.nested->kind == NodeKind::COMMAND && !cmd.nested->next) {
+        return effectiveName(*cmd.nested);
+    }
+    return cmd.name();
+}
+
+bool isShellName(std::string_view name) {
+    return name == "sh" || name == "bash" || name == "zsh" || name == "dash" || name == "ksh";
+}
+
+struct DangerVisitor : AstVisitor {
+    const DangerRules& rules;
+    RiskAssessment risk;
+
+    explicit DangerVisitor(const DangerRules& r) : rules(r) {}
+
+    void flag(Severity severity, std::string_view rule, std::string_view source = "builtin") {
+        ++risk.findings;
+        if (severity > risk.severity) {
+            risk.severity = severity;
+            risk.rule = rule;
+            risk.source = source;
+        }
+    }
+
+    void visitCommand(const CommandNode& cmd) override {
+        if (auto match = rules.match(cmd)) {
+            flag(match->severity, match->rule, match->source);
+        }
+
+        std::string_view name = cmd.name();
+
+        // Overwriting via tee
+        if (name == "tee") {
+            for (uint32_t i = 1; i < cmd.word_count; ++i) {
+                std::string_view arg = cmd.words[i].text;
+                if (!arg.empty() && arg[0] == '/' && !isHarmlessTarget(arg)) {
+                    flag(Severity::MEDIUM, "tee to an absolute path");
+                }
+            }
+        }
+
+        // Moving root
+        if (name == "mv" && (cmd.hasWord("/") || cmd.hasWord("/*"))) {
+            flag(Severity::CRITICAL, "mv /");
+        }
+
+        // Recursive forced operation on /, ~ or the current directory
+        bool recursive = cmd.hasShortFlag('r') || cmd.hasShortFlag('R');
+        if (recursive && cmd.hasShortFlag('f')) {
+            for (const auto& target : SWEEPING_TARGETS) {
+                if (cmd.hasWord(target)) flag(Severity::CRITICAL, "recursive forced operation on " + target);
+            }
+        }
+
+        // Truncating files: cat /dev/null > file
+        if (cmd.hasWord("/dev/null")) {
+            for (uint32_t i = 0; i < cmd.redirect_count; ++i) {
+                if (cmd.redirects[i].writes()) flag(Severity::MEDIUM, "truncation via /dev/null");
+            }
+        }
+    }
+
+    void visitRedirect(const Redirect& redirect) override {
+        // Writing to devices, system configs, boot or any absolute path
+        std::string_view target = redirect.target.text;
+        if (redirect.writes() && !target.empty() && target[0] == '/' && !isHarmlessTarget(target)) {
+            if (target.rfind("/dev/", 0) == 0) {
+                flag(Severity::CRITICAL, "write to a device");
+            } else {
+                flag(Severity::MEDIUM, "write to an absolute path");
+            }
+        }
+    }
+
+    void visitWord(const Word& word) override {
+        // dd from zero/random devices
+        if (word.text.find("/dev/zero") != std::string_view::npos ||
+            word.text.find("/dev/random") != std::string_view::npos) {
+            flag(Severity::HIGH, "reads /dev/zero or /dev/random");
+        }
+    }
+};
+
+// Severity bands of 25 points; each extra finding adds 5, up to the band's top
+int riskScore(Severity severity, int findings) {
+    if (severity == Severity::NONE) return 0;
+    int base = 25 * static_cast<int>(severity);
+    if (severity == Severity::CRITICAL) return base;
+    return base + std::min(20, 5 * (findings - 1));
+}
+
+// Looks for calls to one function inside its own body
+struct RecursionVisitor : AstVisitor {
+    std::string_view function_name;
+    bool found = false;
+
+    bool callsSelf(const PipelineNode& pipeline) const {
+        for (uint32_t i = 0; i < pipeline.count; ++i) {
+            if (effectiveName(*pipeline.commands[i]) == function_name) return true;
+        }
+        return false;
+    }
+
+    void visitPipeline(const PipelineNode& pipeline) override {
+        if (pipeline.count > 1 && callsSelf(pipeline)) found = true;
+    }
+
+    void visitList(const ListNode& list) override {
+        for (uint32_t i = 0; i < list.count; ++i) {
+            if (list.items[i].separator == TokenKind::AMP && callsSelf(*list.items[i].pipeline)) found = true;
+        }
+    }
+};
+
+struct ForkBombVisitor : AstVisitor {
+    bool found = false;
+
+    void visitCompound(const CompoundNode& compound) override {
+        if (compound.function_name.empty() || !compound.body) return;
+        RecursionVisitor recursion;
+        recursion.function_name = compound.function_name;
+        walk(*compound.body, recursion);
+        if (recursion.found) found = true;
+    }
+};
+
+// The same check on the tokens, for definitions the parser rejected
+// ("x :(){ :|:& };:"), however they are spaced; substitutions included
+bool tokensDefineForkBomb(std::string_view source, int depth = 0) {
+    TokenList tokens;
+    ShellLexer::tokenize(source, tokens);
+    auto word = [&](size_t i, std::string_view text) {
+        return i < tokens.size() && tokens[i].is(TokenKind::WORD) && tokens[i].text == text;
+    };
+    auto piped = [&](size_t i) {
+        return i < tokens.size() && (tokens[i].is(TokenKind::PIPE) || tokens[i].is(TokenKind::PIPE_AND));
+    };
+
+    for (size_t i = 0; i < tokens.size(); ++i) {
+        if (!tokens[i].is(TokenKind::WORD)) continue;
+        if (depth < 8 && tokens[i].has(TOKEN_SUBSTITUTION)) {
+            SubstitutionList bodies;
+            findSubstitutions(tokens[i].text, bodies);
+            for (std::string_view body : bodies) {
+                if (tokensDefineForkBomb(body, depth + 1)) return true;
+            }
+        }
+        if (i + 3 >= tokens.size() || !tokens[i + 1].is(TokenKind::LPAREN) ||
+            !tokens[i + 2].is(TokenKind::RPAREN) || !word(i + 3, "{")) {
+            continue;
+        }
+        std::string_view name = tokens[i].text;
+        for (size_t j = i + 4; j < tokens.size() && !word(j, "}"); ++j) {
+            if (!word(j, name)) continue;
+            if (piped(j + 1) || (j > 0 && piped(j - 1)) ||
+                (j + 1 < tokens.size() && tokens[j + 1].is(TokenKind::AMP))) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+struct DownloadToShellVisitor : AstVisitor {
+    bool found = false;
+
+    void visitPipeline(const PipelineNode& pipeline) override {
+        bool downloaded = false;
+        for (uint32_t i = 0; i < pipeline.count; ++i) {
+            std::string_view name = effectiveName(*pipeline.commands[i]);
+            if (downloaded && isShellName(name)) found = true;
+            if (name == "curl" || name == "wget" || name == "fetch") downloaded = true;
+        }
+    }
+};
+
+} // anonymous namespace
+
+bool containsForkBomb(const ShellAst& ast) {
+    ForkBombVisitor visitor;
+    ast.accept(visitor);
+    return visitor.found || tokensDefineForkBomb(ast.source());
+}
+
+bool pipesDownloadToShell(const ShellAst& ast) {
+    DownloadToShellVisitor visitor;
+    ast.accept(visitor);
+    return visitor.found;
+}
+
+RiskAssessment assessRisk(const ShellAst& ast, const DangerRules& rules) {
+    DangerVisitor visitor(rules);
+    ast.accept(visitor);
+    if (containsForkBomb(ast)) visitor.flag(Severity::CRITICAL, "fork bomb");
+    if (pipesDownloadToShell(ast)) visitor.flag(Severity::HIGH, "download piped into a shell");
+
+    RiskAssessment risk = std::move(visitor.risk);
+    risk.score = riskScore(risk.severity, risk.findings);
+    return risk;
+}
+
+RiskAssessment assessRisk(const ShellAst& ast) {
+    return assessRisk(ast, DangerRules::active());
+}
+
+RiskAssessment assessRisk(std::string_view command) {
+    ShellAst ast(command);
+    return assessRisk(ast);
+}
+
+bool isDangerousCommand(const ShellAst& ast) {
+    return assessRisk(ast).needsConfirmation();
+}
+
+bool isDangerousCommand(std::string_view command) {
+    ShellAst ast(command);
+    return isDangerousCommand(ast);
+}
+
+} // namespace tt
@@ -0,0 +1,582 @@
+/**
+ * DangerRules.cpp - Site rule packs for the danger check, compiled to a cached image
+ *
+ * Image layout, all offsets from the start and 4-byte aligned:
+ *
+ *     Header | Bucket[bucket_count] | Rule[rule_count] | Span[word_count] | strings
+ *
+ * Buckets are open-addressed by the FNV-1a hash of the lowercased command
+ * name. A bucket's rules are contiguous and sorted by severity, most severe
+ * first, so a lookup stops at the first rule that matches. Everything is
+ * bounds-checked once when an image is mapped; a cache file that fails the
+ * checks is recompiled and replaced.
+ */
+
+#include "tt/DangerRules.hpp"
+#include "tt/CaseFold.hpp"
+#include "tt/QueryNormalizer.hpp"
+#include "tt/ShellAst.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <sstream>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace tt {
+
+namespace {
+
+// Builtin blocklist, in the rule file format
+const char BUILTIN_RULES[] = R"(
+# File deletion
+medium    rm
+high      rm -r
+medium    rmdir
+medium    unlink
+high      shred
+# System control
+high      shutdown
+high      reboot
+high      poweroff
+high      halt
+high      init
+# Disk/filesystem
+critical  mkfs
+critical  fdisk
+critical  parted
+high      dd
+critical  format
+high      mkswap
+# Package management (can break system)
+medium    apt-get remove
+medium    apt remove
+high      apt-get purge
+high      apt purge
+medium    yum remove
+medium    dnf remove
+medium    pacman -R
+# Permission/ownership
+high      chmod 777
+high      chmod 000
+medium    chmod -R
+medium    chown -R
+medium    chgrp -R
+# Network
+high      iptables -F
+medium    ufw disable
+# Process control
+medium    kill -9
+medium    kill -KILL
+medium    kill -SIGKILL
+medium    killall
+medium    pkill
+# User management
+high      userdel
+high      deluser
+medium    passwd
+# Elevated privileges
+medium    sudo
+)";
+
+constexpr char MAGIC[8] = {'T', 'T', 'R', 'U', 'L', 'E', 'S', '\0'};
+constexpr uint32_t FORMAT_VERSION = 2;  // 2: only rule files without errors are cached
+
+struct Span {
+    uint32_t offset;  // Into the string pool
+    uint32_t length;
+};
+
+struct Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t size;          // Whole image
+    uint64_t key_hi;        // Hash of the rule sources
+    uint64_t key_lo;
+    uint32_t bucket_count;  // Power of two
+    uint32_t buckets;
+    uint32_t rule_count;
+    uint32_t rules;
+    uint32_t word_count;
+    uint32_t words;
+    uint32_t strings;
+    uint32_t strings_size;
+};
+
+struct Bucket {
+    Span name;  // Lowercase; length 0 = empty slot
+    uint32_t first_rule;
+    uint32_t rule_count;
+};
+
+struct Rule {
+    uint32_t first_word;
+    uint32_t word_count;
+    Span text;
+    Span source;
+    uint32_t severity;
+};
+
+static_assert(sizeof(Header) % 8 == 0 && sizeof(Bucket) % 4 == 0 && sizeof(Rule) % 4 == 0);
+
+uint32_t nameHash(std::string_view name) {
+    uint32_t h = 2166136261u;
+    for (char c : name) {
+        h ^= static_cast<unsigned char>(asciiLower(c));
+        h *= 16777619u;
+    }
+    return h;
+}
+
+bool iequals(std::string_view a, std::string_view b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (asciiLower(a[i]) != asciiLower(b[i])) return false;
+    }
+    return true;
+}
+
+bool matchesWord(const CommandNode& cmd, std::string_view required) {
+    bool short_flag = required.size() == 2 && required[0] == '-' &&
+                      ((required[1] >= 'a' && required[1] <= 'z') || (required[1] >= 'A' && required[1] <= 'Z'));
+    if (short_flag && (cmd.hasShortFlag(required[1]) || cmd.hasShortFlag(static_cast<char>(required[1] ^ 0x20)))) {
+        return true;
+    }
+    for (uint32_t i = 1; i < cmd.word_count; ++i) {
+        if (iequals(cmd.words[i].text, required)) return true;
+    }
+    return false;
+}
+
+// ---------------------------------------------------------------------------
+// Parsing
+// ---------------------------------------------------------------------------
+
+struct SourceRule {
+    Severity severity;
+    std::string name;  // Lowercase
+    std::vector<std::string> words;
+    std::string text;
+    std::string source;
+};
+
+void parseRules(std::string_view text, const std::string& file, std::vector<SourceRule>& rules,
+                std::vector<RuleError>& errors) {
+    int line_number = 0;
+    size_t pos = 0;
+    while (pos < text.size()) {
+        size_t end = text.find('\n', pos);
+        if (end == std::string_view::npos) end = text.size();
+        std::string_view line = text.substr(pos, end - pos);
+        pos = end + 1;
+        ++line_number;
+
+        // Comments start a line or follow whitespace, so words can hold '#'
+        for (size_t hash = line.find('#'); hash != std::string_view::npos; hash = line.find('#', hash + 1)) {
+            if (hash == 0 || line[hash - 1] == ' ' || line[hash - 1] == '\t') {
+                line = line.substr(0, hash);
+                break;
+            }
+        }
+
+        std::vector<std::string_view> fields;
+        size_t i = 0;
+        while (i < line.size()) {
+            while (i < line.size() && (line[i] == ' ' || line[i] == '\t' || line[i] == '\r')) ++i;
+            size_t start = i;
+            while (i < line.size() && line[i] != ' ' && line[i] != '\t' && line[i] != '\r') ++i;
+            if (i > start) fields.push_back(line.substr(start, i - start));
+        }
+        if (fields.empty()) continue;
+
+        auto severity = parseSeverity(fields[0]);
+        if (!severity || *severity == Severity::NONE) {
+            errors.push_back({file, line_number, "unknown severity '" + std::string(fields[0]) +
+                                                 "' (low, medium, high, critical)"});
+            continue;
+        }
+        if (fields.size() < 2) {
+            errors.push_back({file, line_number, "missing command name"});
+            continue;
+        }
+
+        SourceRule rule;
+        rule.severity = *severity;
+        for (char c : fields[1]) rule.name += asciiLower(c);
+        rule.text = rule.name;
+        for (size_t f = 2; f < fields.size(); ++f) {
+            rule.words.emplace_back(fields[f]);
+            rule.text += " ";
+            rule.text += fields[f];
+        }
+        rule.source = file == "builtin" ? file : file + ":" + std::to_string(line_number);
+        rules.push_back(std::move(rule));
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Image
+// ---------------------------------------------------------------------------
+
+std::vector<char> compileImage(const std::vector<SourceRule>& rules, const QueryKey& key) {
+    std::map<std::string_view, std::vector<const SourceRule*>> by_name;
+    for (const auto& rule : rules) by_name[rule.name].push_back(&rule);
+
+    uint32_t bucket_count = 8;
+    while (bucket_count < by_name.size() * 2) bucket_count *= 2;
+
+    std::string pool;
+    auto intern = [&](std::string_view text) {
+        Span span{static_cast<uint32_t>(pool.size()), static_cast<uint32_t>(text.size())};
+        pool.append(text);
+        return span;
+    };
+
+    std::vector<Bucket> buckets(bucket_count, Bucket{{0, 0}, 0, 0});
+    std::vector<Rule> packed;
+    std::vector<Span> words;
+    for (auto& [name, group] : by_name) {
+        std::stable_sort(group.begin(), group.end(), [](const SourceRule* a, const SourceRule* b) {
+            return a->severity > b->severity;
+        });
+
+        uint32_t slot = nameHash(name) & (bucket_count - 1);
+        while (buckets[slot].name.length != 0) slot = (slot + 1) & (bucket_count - 1);
+        buckets[slot] = Bucket{intern(name), static_cast<uint32_t>(packed.size()), static_cast<uint32_t>(group.size())};
+
+        for (const SourceRule* rule : group) {
+            Rule out{};
+            out.first_word = static_cast<uint32_t>(words.size());
+            out.word_count = static_cast<uint32_t>(rule->words.size());
+            for (const auto& word : rule->words) words.push_back(intern(word));
+            out.text = intern(rule->text);
+            out.source = intern(rule->source);
+            out.severity = static_cast<uint32_t>(rule->severity);
+            packed.push_back(out);
+        }
+    }
+
+    Header header{};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = FORMAT_VERSION;
+    header.key_hi = key.hi;
+    header.key_lo = key.lo;
+    header.bucket_count = bucket_count;
+    header.buckets = sizeof(Header);
+    header.rule_count = static_cast<uint32_t>(packed.size());
+    header.rules = header.buckets + bucket_count * sizeof(Bucket);
+    header.word_count = static_cast<uint32_t>(words.size());
+    header.words = header.rules + header.rule_count * sizeof(Rule);
+    header.strings = header.words + header.word_count * sizeof(Span);
+    header.strings_size = static_cast<uint32_t>(pool.size());
+    header.size = (header.strings + header.strings_size + 7) & ~7u;
+
+    std::vector<char> image(header.size, 0);
+    std::memcpy(image.data(), &header, sizeof(header));
+    std::memcpy(image.data() + header.buckets, buckets.data(), buckets.size() * sizeof(Bucket));
+    std::memcpy(image.data() + header.rules, packed.data(), packed.size() * sizeof(Rule));
+    std::memcpy(image.data() + header.words, words.data(), words.size() * sizeof(Span));
+    std::memcpy(image.data() + header.strings, pool.data(), pool.size());
+    return image;
+}
+
+// Checks every offset once, so lookups can trust the image
+bool validImage(std::string_view image, const QueryKey& key) {
+    if (image.size() < sizeof(Header)) return false;
+    const auto* header = reinterpret_cast<const Header*>(image.data());
+    if (std::memcmp(header->magic, MAGIC, sizeof(MAGIC)) != 0 || header->version != FORMAT_VERSION) return false;
+    if (header->size != image.size() || header->key_hi != key.hi || header->key_lo != key.lo) return false;
+
+    uint64_t size = image.size();
+    auto section = [&](uint32_t offset, uint64_t count, size_t element) {
+        return offset % 4 == 0 && offset >= sizeof(Header) && offset + count * element <= size;
+    };
+    if (header->bucket_count == 0 || (header->bucket_count & (header->bucket_count - 1)) != 0) return false;
+    if (!section(header->buckets, header->bucket_count, sizeof(Bucket)) ||
+        !section(header->rules, header->rule_count, sizeof(Rule)) ||
+        !section(header->words, header->word_count, sizeof(Span)) ||
+        header->strings + uint64_t{header->strings_size} > size) {
+        return false;
+    }
+
+    auto validSpan = [&](const Span& span) {
+        return uint64_t{span.offset} + span.length <= header->strings_size;
+    };
+    const auto* buckets = reinterpret_cast<const Bucket*>(image.data() + header->buckets);
+    bool has_empty = false;
+    for (uint32_t i = 0; i < header->bucket_count; ++i) {
+        const Bucket& bucket = buckets[i];
+        has_empty = has_empty || bucket.name.length == 0;
+        if (!validSpan(bucket.name) || uint64_t{bucket.first_rule} + bucket.rule_count > header->rule_count) {
+            return false;
+        }
+    }
+    if (!has_empty) return false;  // Lookups of unknown names must terminate
+
+    const auto* rules = reinterpret_cast<const Rule*>(image.data() + header->rules);
+    for (uint32_t i = 0; i < header->rule_count; ++i) {
+        const Rule& rule = rules[i];
+        if (uint64_t{rule.first_word} + rule.word_count > header->word_count || !validSpan(rule.text) ||
+            !validSpan(rule.source) || rule.severity > static_cast<uint32_t>(Severity::CRITICAL)) {
+            return false;
+        }
+    }
+    const auto* words = reinterpret_cast<const Span*>(image.data() + header->words);
+    for (uint32_t i = 0; i < header->word_count; ++i) {
+        if (!validSpan(words[i])) return false;
+    }
+    return true;
+}
+
+std::string readFile(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    std::stringstream content;
+    content << file.rdbuf();
+    return content.str();
+}
+
+// *.rules regular files, each directory in name order
+std::vector<std::string> ruleFiles(const std::vector<std::string>& dirs) {
+    std::vector<std::string> files;
+    for (const auto& dir : dirs) {
+        std::vector<std::string> found;
+        std::error_code ec;
+        for (const auto& entry : std::filesystem::directory_iterator(dir, ec)) {
+            if (entry.path().extension() == ".rules" && entry.is_regular_file(ec)) {
+                found.push_back(entry.path().string());
+            }
+        }
+        std::sort(found.begin(), found.end());
+        files.insert(files.end(), found.begin(), found.end());
+    }
+    return files;
+}
+
+} // anonymous namespace
+
+const char* toString(Severity severity) {
+    switch (severity) {
+        case Severity::NONE: return "none";
+        case Severity::LOW: return "low";
+        case Severity::MEDIUM: return "medium";
+        case Severity::HIGH: return "high";
+        case Severity::CRITICAL: return "critical";
+    }
+    return "none";
+}
+
+std::optional<Severity> parseSeverity(std::string_view text) {
+    for (auto severity : {Severity::NONE, Severity::LOW, Severity::MEDIUM, Severity::HIGH, Severity::CRITICAL}) {
+        if (iequals(text, toString(severity))) return severity;
+    }
+    return std::nullopt;
+}
+
+struct DangerRules::Impl {
+    std::vector<char> owned;  // Compiled in this process
+    void* mapped = nullptr;   // Or mapped from the cache
+    size_t mapped_size = 0;
+    std::string_view image;
+    bool from_cache = false;
+    std::vector<std::string> files;
+    std::vector<RuleError> errors;
+
+    ~Impl() {
+        if (mapped) ::munmap(mapped, mapped_size);
+    }
+
+    const Header& header() const { return *reinterpret_cast<const Header*>(image.data()); }
+
+    std::string_view text(const Span& span) const {
+        return image.substr(header().strings + span.offset, span.length);
+    }
+
+    const Bucket* find(std::string_view name) const {
+        const Header& h = header();
+        const auto* buckets = reinterpret_cast<const Bucket*>(image.data() + h.buckets);
+        uint32_t mask = h.bucket_count - 1;
+        for (uint32_t slot = nameHash(name) & mask;; slot = (slot + 1) & mask) {
+            const Bucket& bucket = buckets[slot];
+            if (bucket.name.length == 0) return nullptr;
+            if (iequals(text(bucket.name), name)) return &bucket;
+        }
+    }
+
+    bool map(const std::string& path, const QueryKey& key) {
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) return false;
+        struct stat st{};
+        void* data = MAP_FAILED;
+        if (::fstat(fd, &st) == 0 && st.st_size >= static_cast<off_t>(sizeof(Header))) {
+            data = ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        }
+        ::close(fd);
+        if (data == MAP_FAILED) return false;
+
+        std::string_view candidate(static_cast<const char*>(data), static_cast<size_t>(st.st_size));
+        if (!validImage(candidate, key)) {
+            ::munmap(data, static_cast<size_t>(st.st_size));
+            return false;
+        }
+        mapped = data;
+        mapped_size = static_cast<size_t>(st.st_size);
+        image = candidate;
+        from_cache = true;
+        return true;
+    }
+
+    // Written next to the final name and renamed, so readers never see half an image
+    void write(const std::filesystem::path& dir, const std::filesystem::path& path) const {
+        std::error_code ec;
+        std::filesystem::create_directories(dir, ec);
+        for (const auto& entry : std::filesystem::directory_iterator(dir, ec)) {
+            std::string name = entry.path().filename().string();
+            if (name.rfind("rules-", 0) == 0 && entry.path() != path) std::filesystem::remove(entry.path(), ec);
+        }
+
+        auto temp = path;
+        temp += ".tmp" + std::to_string(::getpid());
+        {
+            std::ofstream file(temp, std::ios::binary);
+            if (!file.good()) return;
+            file.write(owned.data(), static_cast<std::streamsize>(owned.size()));
+            if (!file.good()) {
+                file.close();
+                std::filesystem::remove(temp, ec);
+                return;
+            }
+        }
+        std::filesystem::rename(temp, path, ec);
+        if (ec) std::filesystem::remove(temp, ec);
+    }
+};
+
+DangerRules::DangerRules() : impl_(std::make_unique<Impl>()) {}
+DangerRules::DangerRules(DangerRules&&) noexcept = default;
+DangerRules& DangerRules::operator=(DangerRules&&) noexcept = default;
+DangerRules::~DangerRules() = default;
+
+DangerRules DangerRules::load(const std::vector<std::string>& dirs, const std::string& cache_dir) {
+    DangerRules rules;
+    Impl& impl = *rules.impl_;
+    impl.files = ruleFiles(dirs);
+
+    std::vector<std::string> contents;
+    std::string sources = std::to_string(FORMAT_VERSION);
+    sources += '\0';
+    sources += BUILTIN_RULES;
+    for (const auto& file : impl.files) {
+        contents.push_back(readFile(file));
+        sources += '\0';
+        sources += file;
+        sources += '\0';
+        sources += contents.back();
+    }
+    QueryKey key = normalizedKey(sources);
+
+    // The builtin rules alone compile in microseconds; only site rules are cached
+    std::filesystem::path cache_path;
+    if (!cache_dir.empty() && !impl.files.empty()) {
+        cache_path = std::filesystem::path(cache_dir) / ("rules-" + key.hex() + ".bin");
+        if (impl.map(cache_path.string(), key)) return rules;
+    }
+
+    std::vector<SourceRule> parsed;
+    parseRules(BUILTIN_RULES, "builtin", parsed, impl.errors);
+    for (size_t i = 0; i < impl.files.size(); ++i) {
+        parseRules(contents[i], impl.files[i], parsed, impl.errors);
+    }
+    impl.owned = compileImage(parsed, key);
+    impl.image = std::string_view(impl.owned.data(), impl.owned.size());
+
+    // A mapped image has no diagnostics, so rule files with errors are
+    // parsed on every load and keep reporting them
+    if (!cache_path.empty() && impl.errors.empty()) impl.write(cache_dir, cache_path);
+    return rules;
+}
+
+const DangerRules& DangerRules::active() {
+    static const DangerRules rules = load(defaultDirs(), defaultCacheDir());
+    return rules;
+}
+
+std::vector<std::string> DangerRules::defaultDirs() {
+    std::vector<std::string> dirs = {"/etc/tt/rules.d"};
+    const char* config_home = std::getenv("XDG_CONFIG_HOME");
+    const char* home = std::getenv("HOME");
+    if (config_home && *config_home) {
+        dirs.push_back(std::string(config_home) + "/tt/rules.d");
+    } else if (home) {
+        dirs.push_back(std::string(home) + "/.config/tt/rules.d");
+    }
+    return dirs;
+}
+
+std::string DangerRules::defaultCacheDir() {
+    const char* cache_home = std::getenv("XDG_CACHE_HOME");
+    if (cache_home && *cache_home) return std::string(cache_home) + "/tt";
+    const char* home = std::getenv("HOME");
+    if (!home) return "";
+    return std::string(home) + "/.cache/tt";
+}
+
+std::optional<RuleMatch> DangerRules::match(const CommandNode& cmd) const {
+    std::string_view name = cmd.name();
+    if (name.empty()) return std::nullopt;
+
+    const Header& header = impl_->header();
+    const auto* rules = reinterpret_cast<const Rule*>(impl_->image.data() + header.rules);
+    const auto* words = reinterpret_cast<const Span*>(impl_->image.data() + header.words);
+
+    std::optional<RuleMatch> best;
+    auto consider = [&](std::string_view candidate) {
+        const Bucket* bucket = impl_->find(candidate);
+        if (!bucket) return;
+        for (uint32_t r = bucket->first_rule; r < bucket->first_rule + bucket->rule_count; ++r) {
+            const Rule& rule = rules[r];
+            auto severity = static_cast<Severity>(rule.severity);
+            if (best && best->severity >= severity) return;
+
+            bool matched = true;
+            for (uint32_t w = rule.first_word; matched && w < rule.first_word + rule.word_count; ++w) {
+                matched = matchesWord(cmd, impl_->text(words[w]));
+            }
+            if (matched) {
+                best = RuleMatch{severity, impl_->text(rule.text), impl_->text(rule.source)};
+                return;
+            }
+        }
+    };
+
+    // mkfs also covers mkfs.ext4 and friends
+    consider(name);
+    for (size_t dot = name.find('.'); dot != std::string_view::npos; dot = name.find('.', dot + 1)) {
+        consider(name.substr(0, dot));
+    }
+    return best;
+}
+
+size_t DangerRules::ruleCount() const {
+    return impl_->header().rule_count;
+}
+
+bool DangerRules::fromCache() const {
+    return impl_->from_cache;
+}
+
+const std::vector<std::string>& DangerRules::files() const {
+    return impl_->files;
+}
+
+const std::vector<RuleError>& DangerRules::errors() const {
+    return impl_->errors;
+}
+
+} // namespace tt
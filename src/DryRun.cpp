@@ -0,0 +1,532 @@
+/**
+ * DryRun.cpp - Namespace and overlayfs sandbox for whatif
+ *
+ * Three processes: the caller collects output and the report; a mediator
+ * enters the namespaces, builds the mounts, waits for the command with the
+ * timeout and diffs the upper layers; the command itself runs as PID 1 of
+ * the new PID namespace with every capability dropped, so it can neither
+ * undo the mounts nor leave processes behind.
+ */
+
+#include "tt/DryRun.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <linux/capability.h>
+#include <poll.h>
+#include <sched.h>
+#include <signal.h>
+#include <sys/mount.h>
+#include <sys/prctl.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <sys/xattr.h>
+#include <unistd.h>
+
+namespace tt {
+
+namespace {
+
+// Mount API syscalls (5.2+, mount_setattr 5.12+); numbers are shared by all architectures
+constexpr long SYSCALL_OPEN_TREE = 428;
+constexpr long SYSCALL_MOVE_MOUNT = 429;
+constexpr long SYSCALL_PIDFD_OPEN = 434;
+constexpr long SYSCALL_MOUNT_SETATTR = 442;
+
+constexpr unsigned TREE_CLONE = 1;
+constexpr unsigned MOVE_FROM_EMPTY_PATH = 0x4;
+constexpr unsigned RECURSIVE = 0x8000;
+constexpr uint64_t ATTR_RDONLY = 0x1;
+constexpr uint64_t ATTR_NOSUID = 0x2;
+
+struct MountAttr {
+    uint64_t attr_set;
+    uint64_t attr_clr;
+    uint64_t propagation;
+    uint64_t userns_fd;
+};
+
+// Where the mediator keeps the overlay layers while it builds the mounts
+constexpr const char* STAGE = "/dev/.tt-dryrun";
+
+// Device nodes the sandbox keeps
+constexpr const char* DEVICES[] = {"null", "zero", "full", "random", "urandom"};
+
+// Report records from the mediator, NUL separated
+enum Record : char {
+    REC_ERROR = 'E',
+    REC_STARTED = 'S',   // steady_clock nanoseconds when the command was forked
+    REC_STATUS = 'X',
+    REC_TIMED_OUT = 'T',
+    REC_CREATED = 'C',
+    REC_MODIFIED = 'M',
+    REC_DELETED = 'D'
+};
+
+int64_t nowNanos() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void writeAll(int fd, const char* data, size_t size) {
+    while (size > 0) {
+        ssize_t n = ::write(fd, data, size);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return;
+        }
+        data += n;
+        size -= static_cast<size_t>(n);
+    }
+}
+
+void writeRecord(int fd, Record kind, const std::string& text = {}) {
+    std::string record(1, static_cast<char>(kind));
+    record += text;
+    writeAll(fd, record.c_str(), record.size() + 1);
+}
+
+bool writeFile(const char* path, const std::string& text) {
+    int fd = ::open(path, O_WRONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+    ssize_t n = ::write(fd, text.data(), text.size());
+    ::close(fd);
+    return n == static_cast<ssize_t>(text.size());
+}
+
+[[noreturn]] void fail(int report_fd, const std::string& what) {
+    int error = errno;
+    writeRecord(report_fd, REC_ERROR, what + ": " + std::strerror(error));
+    _exit(1);
+}
+
+void makeDirs(const std::string& path) {
+    std::error_code ec;
+    std::filesystem::create_directories(path, ec);
+}
+
+// ---------------------------------------------------------------------------
+// Upper layer diff
+// ---------------------------------------------------------------------------
+
+bool isWhiteout(const struct stat& st) {
+    return S_ISCHR(st.st_mode) && st.st_rdev == 0;
+}
+
+bool isOpaque(int dir_fd) {
+    char value = 0;
+    return (::fgetxattr(dir_fd, "user.overlay.opaque", &value, 1) == 1 ||
+            ::fgetxattr(dir_fd, "trusted.overlay.opaque", &value, 1) == 1) && value == 'y';
+}
+
+// Copy-up happens on open for writing; an unchanged copy is not a change
+bool sameFile(int upper_dir, int lower_dir, const char* name, const struct stat& a, const struct stat& b) {
+    if ((a.st_mode & S_IFMT) != (b.st_mode & S_IFMT)) return false;
+    if (a.st_mode != b.st_mode || a.st_uid != b.st_uid || a.st_gid != b.st_gid) return false;
+    if (S_ISLNK(a.st_mode)) {
+        char x[4096];
+        char y[4096];
+        ssize_t nx = ::readlinkat(upper_dir, name, x, sizeof(x));
+        ssize_t ny = ::readlinkat(lower_dir, name, y, sizeof(y));
+        return nx == ny && nx >= 0 && std::memcmp(x, y, static_cast<size_t>(nx)) == 0;
+    }
+    return a.st_size == b.st_size && a.st_mtim.tv_sec == b.st_mtim.tv_sec &&
+           a.st_mtim.tv_nsec == b.st_mtim.tv_nsec;
+}
+
+std::vector<std::string> listDir(int dir_fd) {
+    std::vector<std::string> names;
+    int fd = ::dup(dir_fd);
+    DIR* dir = fd >= 0 ? ::fdopendir(fd) : nullptr;
+    if (!dir) {
+        if (fd >= 0) ::close(fd);
+        return names;
+    }
+    ::rewinddir(dir);
+    while (struct dirent* entry = ::readdir(dir)) {
+        if (std::strcmp(entry->d_name, ".") == 0 || std::strcmp(entry->d_name, "..") == 0) continue;
+        names.emplace_back(entry->d_name);
+    }
+    ::closedir(dir);
+    return names;
+}
+
+// lower_dir is -1 when the directory did not exist below
+void diffLayer(int upper_dir, int lower_dir, const std::string& path, int report_fd) {
+    std::vector<std::string> names = listDir(upper_dir);
+
+    // An opaque directory hides everything below it
+    if (lower_dir >= 0 && isOpaque(upper_dir)) {
+        for (const auto& name : listDir(lower_dir)) {
+            if (std::find(names.begin(), names.end(), name) == names.end()) {
+                writeRecord(report_fd, REC_DELETED, path + "/" + name);
+            }
+        }
+    }
+
+    for (const auto& name : names) {
+        std::string child = path + "/" + name;
+        struct stat st;
+        if (::fstatat(upper_dir, name.c_str(), &st, AT_SYMLINK_NOFOLLOW) != 0) continue;
+        struct stat lower;
+        bool below = lower_dir >= 0 && ::fstatat(lower_dir, name.c_str(), &lower, AT_SYMLINK_NOFOLLOW) == 0;
+
+        if (isWhiteout(st)) {
+            if (below) writeRecord(report_fd, REC_DELETED, child);
+            continue;
+        }
+
+        if (S_ISDIR(st.st_mode)) {
+            bool lower_is_dir = below && S_ISDIR(lower.st_mode);
+            if (!lower_is_dir) {
+                writeRecord(report_fd, below ? REC_MODIFIED : REC_CREATED, child);
+            } else if (st.st_mode != lower.st_mode || st.st_uid != lower.st_uid || st.st_gid != lower.st_gid) {
+                writeRecord(report_fd, REC_MODIFIED, child);
+            }
+            int sub = ::openat(upper_dir, name.c_str(), O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+            if (sub < 0) continue;
+            int lower_sub = lower_is_dir
+                ? ::openat(lower_dir, name.c_str(), O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC)
+                : -1;
+            diffLayer(sub, lower_sub, child, report_fd);
+            if (lower_sub >= 0) ::close(lower_sub);
+            ::close(sub);
+            continue;
+        }
+
+        if (!below) {
+            writeRecord(report_fd, REC_CREATED, child);
+        } else if (!sameFile(upper_dir, lower_dir, name.c_str(), st, lower)) {
+            writeRecord(report_fd, REC_MODIFIED, child);
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Sandbox
+// ---------------------------------------------------------------------------
+
+struct Plan {
+    std::string command;
+    std::vector<std::string> roots;
+    std::string cwd;
+    std::chrono::milliseconds timeout;
+};
+
+void dropCapabilities() {
+    for (int cap = 0; cap < 64; ++cap) {
+        ::prctl(PR_CAPBSET_DROP, cap, 0, 0, 0);
+    }
+    ::prctl(PR_CAP_AMBIENT, PR_CAP_AMBIENT_CLEAR_ALL, 0, 0, 0);
+    __user_cap_header_struct header{_LINUX_CAPABILITY_VERSION_3, 0};
+    __user_cap_data_struct data[2] = {};
+    ::syscall(SYS_capset, &header, data);
+    ::prctl(PR_SET_NO_NEW_PRIVS, 1, 0, 0, 0);
+}
+
+[[noreturn]] void runCommand(const Plan& plan, int out_fd) {
+    // PID 1 of the new namespace; its /proc shows only the sandbox
+    ::mount("proc", "/proc", "proc", MS_NOSUID | MS_NODEV | MS_NOEXEC, nullptr);
+
+    int null_fd = ::open("/dev/null", O_RDONLY);
+    if (null_fd >= 0) ::dup2(null_fd, STDIN_FILENO);
+    ::dup2(out_fd, STDOUT_FILENO);
+    ::dup2(out_fd, STDERR_FILENO);
+
+    // The old working directory is the lower layer; enter the overlay instead.
+    // A working directory under the masked /tmp or /run falls back to the first root.
+    if (::chdir(plan.cwd.c_str()) != 0 && ::chdir(plan.roots.front().c_str()) != 0) _exit(126);
+
+    dropCapabilities();
+    ::execl("/bin/sh", "sh", "-c", plan.command.c_str(), static_cast<char*>(nullptr));
+    _exit(127);
+}
+
+[[noreturn]] void runMediator(const Plan& plan, int out_fd, int report_fd) {
+    uid_t uid = ::getuid();
+    gid_t gid = ::getgid();
+
+    if (::unshare(CLONE_NEWUSER | CLONE_NEWNS | CLONE_NEWPID | CLONE_NEWNET | CLONE_NEWIPC) != 0) {
+        fail(report_fd, "unshare");
+    }
+    writeFile("/proc/self/setgroups", "deny");
+    if (!writeFile("/proc/self/uid_map", std::to_string(uid) + " " + std::to_string(uid) + " 1") ||
+        !writeFile("/proc/self/gid_map", std::to_string(gid) + " " + std::to_string(gid) + " 1")) {
+        fail(report_fd, "id map");
+    }
+
+    // Everything read-only and private to this namespace
+    MountAttr readonly{ATTR_RDONLY | ATTR_NOSUID, 0, MS_PRIVATE, 0};
+    if (::syscall(SYSCALL_MOUNT_SETATTR, AT_FDCWD, "/", RECURSIVE, &readonly, sizeof(readonly)) != 0) {
+        fail(report_fd, "mount_setattr /");
+    }
+
+    // Detached copies of what the masks below would hide
+    std::vector<int> root_trees;
+    for (const auto& root : plan.roots) {
+        int fd = static_cast<int>(::syscall(SYSCALL_OPEN_TREE, AT_FDCWD, root.c_str(), TREE_CLONE | RECURSIVE | O_CLOEXEC));
+        if (fd < 0) fail(report_fd, "open_tree " + root);
+        root_trees.push_back(fd);
+    }
+    std::vector<int> device_trees;
+    for (const char* device : DEVICES) {
+        std::string path = std::string("/dev/") + device;
+        device_trees.push_back(static_cast<int>(::syscall(SYSCALL_OPEN_TREE, AT_FDCWD, path.c_str(), TREE_CLONE | O_CLOEXEC)));
+    }
+
+    // Sockets under /run and /tmp would reach services outside the sandbox
+    if (::mount("tmpfs", "/tmp", "tmpfs", MS_NOSUID | MS_NODEV, "mode=1777") != 0) fail(report_fd, "mount /tmp");
+    if (::access("/run", F_OK) == 0 && ::mount("tmpfs", "/run", "tmpfs", MS_NOSUID | MS_NODEV, "mode=755") != 0) {
+        fail(report_fd, "mount /run");
+    }
+    if (::mount("tmpfs", "/dev", "tmpfs", MS_NOSUID | MS_NOEXEC, "mode=755") != 0) fail(report_fd, "mount /dev");
+    for (size_t i = 0; i < device_trees.size(); ++i) {
+        std::string path = std::string("/dev/") + DEVICES[i];
+        int fd = ::open(path.c_str(), O_CREAT | O_WRONLY | O_CLOEXEC, 0666);
+        if (fd >= 0) ::close(fd);
+        if (device_trees[i] >= 0) {
+            ::syscall(SYSCALL_MOVE_MOUNT, device_trees[i], "", AT_FDCWD, path.c_str(), MOVE_FROM_EMPTY_PATH);
+        }
+    }
+    ::symlink("/proc/self/fd", "/dev/fd");
+    ::symlink("/proc/self/fd/0", "/dev/stdin");
+    ::symlink("/proc/self/fd/1", "/dev/stdout");
+    ::symlink("/proc/self/fd/2", "/dev/stderr");
+    ::mkdir("/dev/shm", 01777);
+
+    // One lower/upper/work triple per root
+    ::mkdir(STAGE, 0700);
+    if (::mount("tmpfs", STAGE, "tmpfs", MS_NOSUID | MS_NODEV, "mode=700") != 0) fail(report_fd, "mount stage");
+    std::vector<int> upper_fds;
+    std::vector<int> lower_fds;
+    for (size_t i = 0; i < plan.roots.size(); ++i) {
+        std::string base = std::string(STAGE) + "/" + std::to_string(i);
+        std::string lower = base + "/lower";
+        std::string upper = base + "/upper";
+        std::string work = base + "/work";
+        makeDirs(lower);
+        makeDirs(upper);
+        makeDirs(work);
+        if (::syscall(SYSCALL_MOVE_MOUNT, root_trees[i], "", AT_FDCWD, lower.c_str(), MOVE_FROM_EMPTY_PATH) != 0) {
+            fail(report_fd, "move_mount " + plan.roots[i]);
+        }
+
+        // Roots under /tmp or /run are gone from the new tmpfs until recreated
+        makeDirs(plan.roots[i]);
+        std::string options = "lowerdir=" + lower + ",upperdir=" + upper + ",workdir=" + work;
+        if (::mount("overlay", plan.roots[i].c_str(), "overlay", 0, (options + ",userxattr").c_str()) != 0 &&
+            ::mount("overlay", plan.roots[i].c_str(), "overlay", 0, options.c_str()) != 0) {
+            fail(report_fd, "overlay " + plan.roots[i]);
+        }
+        upper_fds.push_back(::open(upper.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC));
+        lower_fds.push_back(::open(lower.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC));
+    }
+
+    // The command cannot see the layers; the open descriptors keep them alive
+    ::umount2(STAGE, MNT_DETACH);
+    ::rmdir(STAGE);
+
+    writeRecord(report_fd, REC_STARTED, std::to_string(nowNanos()));
+    pid_t pid = ::fork();
+    if (pid < 0) fail(report_fd, "fork");
+    if (pid == 0) runCommand(plan, out_fd);
+    ::close(out_fd);
+
+    // PID 1 exiting takes every other process in the namespace with it
+    bool timed_out = false;
+    int pidfd = static_cast<int>(::syscall(SYSCALL_PIDFD_OPEN, pid, 0));
+    if (pidfd >= 0) {
+        pollfd waiter{pidfd, POLLIN, 0};
+        int ready;
+        auto deadline = std::chrono::steady_clock::now() + plan.timeout;
+        do {
+            auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+            ready = ::poll(&waiter, 1, static_cast<int>(std::max<int64_t>(0, left.count())));
+        } while (ready < 0 && errno == EINTR);
+        if (ready == 0) {
+            timed_out = true;
+            ::kill(pid, SIGKILL);
+        }
+    }
+    int status = 0;
+    while (::waitpid(pid, &status, 0) < 0 && errno == EINTR) {}
+
+    if (timed_out) writeRecord(report_fd, REC_TIMED_OUT);
+    int code = WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status);
+    writeRecord(report_fd, REC_STATUS, std::to_string(code));
+
+    for (size_t i = 0; i < plan.roots.size(); ++i) {
+        if (upper_fds[i] < 0) continue;
+        diffLayer(upper_fds[i], lower_fds[i], plan.roots[i], report_fd);
+    }
+    _exit(0);
+}
+
+// Absolute, existing, not overlapping, and outside the pseudo filesystems
+bool planRoots(const std::vector<std::string>& requested, Plan& plan, std::string& error) {
+    namespace fs = std::filesystem;
+    std::error_code ec;
+    std::vector<std::string> roots;
+    for (const auto& root : requested) {
+        fs::path path = fs::canonical(root, ec);
+        if (ec || !fs::is_directory(path, ec)) {
+            error = "not a directory: " + root;
+            return false;
+        }
+        std::string text = path.string();
+        if (text == "/") {
+            error = "the filesystem root cannot be a dry-run root";
+            return false;
+        }
+        for (const char* pseudo : {"/dev", "/proc", "/sys"}) {
+            std::string_view prefix = pseudo;
+            if (text.rfind(prefix, 0) == 0 && (text.size() == prefix.size() || text[prefix.size()] == '/')) {
+                error = "cannot overlay " + text;
+                return false;
+            }
+        }
+        roots.push_back(std::move(text));
+    }
+
+    // Parents first, so nested roots are dropped
+    std::sort(roots.begin(), roots.end());
+    for (const auto& root : roots) {
+        bool nested = std::any_of(plan.roots.begin(), plan.roots.end(), [&](const std::string& parent) {
+            return root == parent || (root.rfind(parent, 0) == 0 && root[parent.size()] == '/');
+        });
+        if (!nested) plan.roots.push_back(root);
+    }
+    return true;
+}
+
+void parseReport(const std::string& report, int64_t forked_at, DryRunResult& result) {
+    size_t pos = 0;
+    while (pos < report.size()) {
+        size_t end = report.find('\0', pos);
+        if (end == std::string::npos) end = report.size();
+        std::string_view record(report.data() + pos, end - pos);
+        pos = end + 1;
+        if (record.empty()) continue;
+
+        std::string text(record.substr(1));
+        switch (record[0]) {
+            case REC_ERROR: result.error = text; break;
+            case REC_STARTED:
+                result.ran = true;
+                result.setup_ms = static_cast<double>(std::stoll(text) - forked_at) / 1e6;
+                break;
+            case REC_STATUS: result.exit_status = std::stoi(text); break;
+            case REC_TIMED_OUT: result.timed_out = true; break;
+            case REC_CREATED: result.effects.push_back({text, FileChange::CREATED}); break;
+            case REC_MODIFIED: result.effects.push_back({text, FileChange::MODIFIED}); break;
+            case REC_DELETED: result.effects.push_back({text, FileChange::DELETED}); break;
+        }
+    }
+    std::sort(result.effects.begin(), result.effects.end(),
+              [](const FileEffect& a, const FileEffect& b) { return a.path < b.path; });
+}
+
+} // anonymous namespace
+
+const char* toString(FileChange change) {
+    switch (change) {
+        case FileChange::CREATED: return "created";
+        case FileChange::MODIFIED: return "modified";
+        case FileChange::DELETED: return "deleted";
+    }
+    return "?";
+}
+
+DryRunResult dryRun(const std::string& command, const DryRunOptions& options) {
+    DryRunResult result;
+    int64_t started = nowNanos();
+
+    Plan plan;
+    plan.command = command;
+    plan.timeout = options.timeout;
+    std::error_code ec;
+    plan.cwd = std::filesystem::current_path(ec).string();
+    if (ec) {
+        result.error = "no working directory: " + ec.message();
+        return result;
+    }
+    std::vector<std::string> roots = options.roots;
+    if (roots.empty()) roots.push_back(plan.cwd);
+    if (!planRoots(roots, plan, result.error)) return result;
+
+    int out_pipe[2];
+    int report_pipe[2];
+    if (::pipe2(out_pipe, O_CLOEXEC) != 0) {
+        result.error = std::string("pipe: ") + std::strerror(errno);
+        return result;
+    }
+    if (::pipe2(report_pipe, O_CLOEXEC) != 0) {
+        result.error = std::string("pipe: ") + std::strerror(errno);
+        ::close(out_pipe[0]);
+        ::close(out_pipe[1]);
+        return result;
+    }
+
+    pid_t pid = ::fork();
+    if (pid == 0) {
+        ::close(out_pipe[0]);
+        ::close(report_pipe[0]);
+        runMediator(plan, out_pipe[1], report_pipe[1]);
+    }
+    ::close(out_pipe[1]);
+    ::close(report_pipe[1]);
+    if (pid < 0) {
+        result.error = std::string("fork: ") + std::strerror(errno);
+        ::close(out_pipe[0]);
+        ::close(report_pipe[0]);
+        return result;
+    }
+
+    // Drain both pipes until the mediator and the command are gone. The
+    // mediator enforces the timeout; this deadline only covers a stuck mediator.
+    std::string report;
+    pollfd fds[2] = {{out_pipe[0], POLLIN, 0}, {report_pipe[0], POLLIN, 0}};
+    auto deadline = std::chrono::steady_clock::now() + options.timeout + std::chrono::seconds(5);
+    char buffer[4096];
+    while (fds[0].fd >= 0 || fds[1].fd >= 0) {
+        auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+        int ready = ::poll(fds, 2, static_cast<int>(std::max<int64_t>(0, left.count())));
+        if (ready < 0 && errno == EINTR) continue;
+        if (ready <= 0) {
+            ::kill(pid, SIGKILL);
+            result.timed_out = true;
+            break;
+        }
+        for (auto& entry : fds) {
+            if (entry.fd < 0 || !(entry.revents & (POLLIN | POLLHUP | POLLERR))) continue;
+            ssize_t n = ::read(entry.fd, buffer, sizeof(buffer));
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) {
+                ::close(entry.fd);
+                entry.fd = -1;
+            } else if (entry.fd == out_pipe[0]) {
+                size_t room = options.max_output - std::min(options.max_output, result.output.size());
+                result.output.append(buffer, std::min(room, static_cast<size_t>(n)));
+            } else {
+                report.append(buffer, static_cast<size_t>(n));
+            }
+        }
+    }
+    for (auto& entry : fds) {
+        if (entry.fd >= 0) ::close(entry.fd);
+    }
+    while (::waitpid(pid, nullptr, 0) < 0 && errno == EINTR) {}
+
+    parseReport(report, started, result);
+    if (!result.error.empty()) result.ran = false;
+    result.total_ms = static_cast<double>(nowNanos() - started) / 1e6;
+    return result;
+}
+
+} // namespace tt
@@ -4,57 +4,126 @@
 
 #include "tt/ExplainerEngine.hpp"
 #include "tt/GeminiClient.hpp"
+#include "tt/PromptTemplate.hpp"
+#include "tt/ShellAst.hpp"
 
+#include <chrono>
 #include <sstream>
 
 namespace tt {
 
+namespace {
+
+// Collects the structure worth pointing out to the model
+struct StructureVisitor : AstVisitor {
+    std::ostringstream out;
+    bool interesting = false;
+
+    void visitList(const ListNode& list) override {
+        for (uint32_t i = 0; i < list.count; ++i) {
+            TokenKind sep = list.items[i].separator;
+            if (sep == TokenKind::AND_IF || sep == TokenKind::OR_IF || sep == TokenKind::AMP ||
+                (sep == TokenKind::SEMI && i + 1 < list.count)) {
+                out << "- Lista de comandos com '" << toString(sep) << "'\n";
+                interesting = true;
+            }
+        }
+    }
+
+    void visitPipeline(const PipelineNode& pipeline) override {
+        if (pipeline.count < 2) return;
+        out << "- Pipeline de " << pipeline.count << " etapas:";
+        for (uint32_t i = 0; i < pipeline.count; ++i) {
+            const Node* stage = pipeline.commands[i];
+            out << (i ? " | " : " ");
+            if (stage->kind == NodeKind::COMMAND) {
+                out << static_cast<const CommandNode*>(stage)->name();
+            } else {
+                out << "(...)";
+            }
+        }
+        out << "\n";
+        interesting = true;
+    }
+
+    void visitCommand(const CommandNode& cmd) override {
+        if (cmd.runner && cmd.word_count > 0) {
+            out << "- '" << cmd.name() << "' e executado indiretamente via '" << cmd.runner->name() << "'\n";
+            interesting = true;
+        }
+    }
+
+    void visitCompound(const CompoundNode& compound) override {
+        if (!compound.function_name.empty()) {
+            out << "- Define a funcao '" << compound.function_name << "'\n";
+        } else {
+            out << (compound.kind == NodeKind::SUBSHELL ? "- Subshell ( ... )\n" : "- Grupo { ...; }\n");
+        }
+        interesting = true;
+    }
+
+    void visitRedirect(const Redirect& redirect) override {
+        out << "- Redirecionamento: ";
+        if (redirect.fd >= 0) out << redirect.fd;
+        out << toString(redirect.op) << " " << redirect.target.text << "\n";
+        interesting = true;
+    }
+
+    void visitWord(const Word& word) override {
+        if (word.substitutions) {
+            out << "- Substituicao de comando: " << word.raw << "\n";
+            interesting = true;
+        }
+    }
+};
+
+} // anonymous namespace
+
+const char* toString(ExplainMode mode) {
+    switch (mode) {
+        case ExplainMode::NORMAL: return "normal";
+        case ExplainMode::ELI5: return "eli5";
+        case ExplainMode::DETAILED: return "detailed";
+    }
+    return "?";
+}
+
 ExplainerEngine::ExplainerEngine(GeminiClient& gemini)
     : gemini_(gemini) {}
 
 ExplainerEngine::~ExplainerEngine() = default;
 
-std::string ExplainerEngine::buildExplainPrompt(const std::string& command, ExplainMode mode) {
-    std::ostringstream prompt;
+std::string ExplainerEngine::describeStructure(const ShellAst& ast) {
+    StructureVisitor visitor;
+    ast.accept(visitor);
+    return visitor.interesting ? visitor.out.str() : "";
+}
+
+const std::string& ExplainerEngine::buildExplainPrompt(const std::string& command, ExplainMode mode) {
+    ShellAst ast(command);
+    std::string structure = describeStructure(ast);
+    if (!structure.empty()) {
+        structure = "Estrutura do comando (analisada localmente):\n" + structure;
+    }
     
+    std::string language = gemini_.languageInstruction();
     switch (mode) {
         case ExplainMode::ELI5:
-            prompt << "Voce e um professor muito paciente explicando comandos de terminal para uma crianca de 5 anos. "
-                   << "Use analogias simples do dia-a-dia, evite jargao tecnico, e seja amigavel.\n\n"
-                   << "Comando: " << command << "\n\n"
-                   << "Explique o que esse comando faz como se estivesse explicando para uma crianca. "
-                   << "Use exemplos do mundo real (como organizar brinquedos, encontrar coisas em casa, etc).";
+            prompts::EXPLAIN_ELI5.render(prompt_, {language, command, structure});
             break;
-            
         case ExplainMode::DETAILED:
-            prompt << "Voce e um instrutor Linux avancado. Forneca uma explicacao tecnica detalhada.\n\n"
-                   << "Comando: " << command << "\n\n"
-                   << "Inclua:\n"
-                   << "1. Sintaxe completa e todas as opcoes disponiveis\n"
-                   << "2. Exemplos praticos de uso\n"
-                   << "3. Comandos relacionados\n"
-                   << "4. Armadilhas comuns e melhores praticas\n"
-                   << "5. Como combinar com outros comandos (pipes, redirecionamento)\n\n"
-                   << "Responda em Portugues (Brasil).";
+            prompts::EXPLAIN_DETAILED.render(prompt_, {language, command, structure});
             break;
-            
         case ExplainMode::NORMAL:
         default:
-            prompt << "Voce e um assistente de ensino de CLI. Explique o seguinte comando de forma clara e educativa.\n\n"
-                   << "Comando: " << command << "\n\n"
-                   << "Forneca:\n"
-                   << "1. Um resumo breve do que ele faz\n"
-                   << "2. Explicacao de cada flag/opcao usada\n"
-                   << "3. Um exemplo pratico de quando usar\n\n"
-                   << "Mantenha a explicacao concisa mas informativa. Responda em Portugues (Brasil).";
+            prompts::EXPLAIN_NORMAL.render(prompt_, {language, command, structure});
             break;
     }
-    
-    return prompt.str();
+    return prompt_;
 }
 
 std::string ExplainerEngine::explain(const std::string& command, ExplainMode mode) {
-    std::string prompt = buildExplainPrompt(command, mode);
+    const std::string& prompt = buildExplainPrompt(command, mode);
     auto response = gemini_.generateContent(prompt);
     
     if (!response.success) {
@@ -64,18 +133,13 @@ std::string ExplainerEngine::explain(const std::string& command, ExplainMode mod
     return response.content;
 }
 
+const std::string& ExplainerEngine::buildFixPrompt(const std::string& failed_command, const std::string& error_msg) {
+    prompts::SUGGEST_FIX.render(prompt_, {gemini_.languageInstruction(), failed_command, error_msg});
+    return prompt_;
+}
+
 std::string ExplainerEngine::suggestFix(const std::string& failed_command, const std::string& error_msg) {
-    std::ostringstream prompt;
-    prompt << "Voce e um assistente de CLI ajudando a corrigir um comando que falhou.\n\n"
-           << "Comando que falhou: " << failed_command << "\n"
-           << "Mensagem de erro: " << error_msg << "\n\n"
-           << "Forneca:\n"
-           << "1. O que causou o erro\n"
-           << "2. O comando corrigido\n"
-           << "3. Uma breve explicacao da correcao\n\n"
-           << "Responda em Portugues (Brasil). Seja direto e pratico.";
-    
-    auto response = gemini_.generateContent(prompt.str());
+    auto response = gemini_.generateContent(buildFixPrompt(failed_command, error_msg));
     
     if (!response.success) {
         return "Erro ao gerar sugestao: " + response.error;
@@ -94,4 +158,45 @@ std::string ExplainerEngine::translateQuestion(const std::string& question) {
     return response.content;
 }
 
+std::string ExplainerEngine::stream(const char* mode, const std::string& prompt, const char* error_prefix,
+                                    const ChunkCallback& on_chunk, const std::atomic<bool>* cancel) {
+    using Clock = std::chrono::steady_clock;
+    StreamTiming timing;
+    timing.mode = mode;
+    auto start = Clock::now();
+    
+    auto response = gemini_.generateContentStreaming(prompt, [&](const std::string& chunk) {
+        if (timing.ttft_ms < 0) {
+            timing.ttft_ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        }
+        if (on_chunk) on_chunk(chunk);
+    }, cancel);
+    
+    timing.total_ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    timing.cancelled = cancel && cancel->load();
+    timings_.push_back(std::move(timing));
+    
+    if (!response.success && !timings_.back().cancelled) {
+        return error_prefix + response.error;
+    }
+    return response.content;
+}
+
+std::string ExplainerEngine::explainStreaming(const std::string& command, ExplainMode mode,
+                                              const ChunkCallback& on_chunk, const std::atomic<bool>* cancel) {
+    return stream(toString(mode), buildExplainPrompt(command, mode), "Erro ao gerar explicacao: ", on_chunk, cancel);
+}
+
+std::string ExplainerEngine::suggestFixStreaming(const std::string& failed_command, const std::string& error_msg,
+                                                 const ChunkCallback& on_chunk, const std::atomic<bool>* cancel) {
+    return stream("fix", buildFixPrompt(failed_command, error_msg), "Erro ao gerar sugestao: ", on_chunk, cancel);
+}
+
+std::string ExplainerEngine::translateQuestionStreaming(const std::string& question, const ChunkCallback& on_chunk,
+                                                        const std::atomic<bool>* cancel) {
+    // The prompt of GeminiClient::suggestCommand
+    prompts::SUGGEST_COMMAND.render(prompt_, {gemini_.languageInstruction(), question});
+    return stream("translate", prompt_, "Erro ao processar pergunta: ", on_chunk, cancel);
+}
+
 } // namespace tt
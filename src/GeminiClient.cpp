@@ -3,15 +3,24 @@
  * 
  * Uses cpp-httplib for HTTPS requests to Gemini API.
  * Supports optional multi-turn conversations with named sessions.
+ *
+ * Constructing a client does no I/O: the HTTP transport (and its TLS
+ * context) is created by the first request that needs it, and the session
+ * file is read on first use of the history and its directory created on
+ * first save.
  */
 
 #include "tt/GeminiClient.hpp"
+#include "tt/PromptTemplate.hpp"
+#include "tt/StartupProfile.hpp"
+#include "tt/Trace.hpp"
 
+#include <atomic>
+#include <chrono>
 #include <cstdlib>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
-#include <sstream>
 
 #include <curl/curl.h>
 #include <httplib.h>
@@ -21,53 +30,89 @@ using json = nlohmann::json;
 
 namespace tt {
 
-static const std::string GEMINI_API_BASE = "generativelanguage.googleapis.com";
+static const std::string GEMINI_API_BASE = "https://generativelanguage.googleapis.com";
 static const std::string DEFAULT_MODEL = "gemini-3-flash-preview";
 static const std::string DEFAULT_LANGUAGE = "en-us";
 static const size_t MAX_HISTORY_TURNS = 10;
 
+// TT_API_BASE ("http://127.0.0.1:8080") points tt at a mock server, e.g.
+// for bench_startup
+static std::string apiBase() {
+    const char* base = std::getenv("TT_API_BASE");
+    return base && *base ? base : GEMINI_API_BASE;
+}
+
 std::string getSessionDir() {
     const char* home = std::getenv("HOME");
     if (!home) return "";
     return std::string(home) + "/.tt";
 }
 
+static void account(ClientUsage& usage, double latency_ms, double first_byte_ms) {
+    usage.requests++;
+    usage.latency_ms += latency_ms;
+    usage.first_byte_ms = first_byte_ms;
+}
+
 struct GeminiClient::Impl {
     std::string api_key;
     std::string model;
     std::string language;
+    std::string session_name;
     std::string session_path; // empty = no persistence
-    std::unique_ptr<httplib::SSLClient> client;
-    json history;
+    std::unique_ptr<httplib::Client> client;  // See http()
+    json history;                             // See conversation()
+    bool history_loaded = false;
+    std::string prompt;  // Render buffer for prompt templates, reused across calls
+    int64_t socket_opened = -1;  // Trace clock when httplib last opened a connection
+    ClientUsage usage;
+    TokenLedger ledger;
     
     Impl(const std::string& key, const std::string& model_name, 
-         const std::string& lang, const std::string& session_name) 
+         const std::string& lang, const std::string& name) 
         : api_key(key), 
           model(model_name.empty() ? DEFAULT_MODEL : model_name),
-          language(lang.empty() ? DEFAULT_LANGUAGE : lang) {
+          language(lang.empty() ? DEFAULT_LANGUAGE : lang),
+          session_name(name) {
         
-        // Set up session path if name provided
+        // Set up session path if name provided; the directory is made on first save
         if (!session_name.empty()) {
             std::string dir = getSessionDir();
             if (!dir.empty()) {
-                std::filesystem::create_directories(dir);
-                std::filesystem::permissions(dir, std::filesystem::perms::owner_all, 
-                                            std::filesystem::perm_options::replace);
                 session_path = dir + "/" + session_name + ".json";
             }
         }
-        
-        client = std::make_unique<httplib::SSLClient>(GEMINI_API_BASE);
+    }
+    
+    // The transport for non-streaming requests, created on first use
+    httplib::Client& http() {
+        if (client) return *client;
+        client = std::make_unique<httplib::Client>(apiBase());
         client->set_connection_timeout(30);
         client->set_read_timeout(60);
         client->set_write_timeout(30);
-        
-        loadSession();
+        if (trace::enabled() || startup::enabled()) {
+            // httplib reports no phase timings; a new socket marks the end of name resolution
+            client->set_socket_options([this](auto) {
+                if (trace::enabled()) socket_opened = trace::now();
+                startup::mark("socket opened (name resolved)");
+            });
+        }
+        startup::mark("HTTP client ready");
+        return *client;
+    }
+    
+    // Session history, read from disk on first use
+    json& conversation() {
+        if (!history_loaded) loadSession();
+        return history;
     }
     
     void loadSession() {
         history = json::array();
+        history_loaded = true;
         if (session_path.empty()) return;
+        trace::Span span("session.load", "session");
         
         std::ifstream file(session_path);
         if (file.good()) {
@@ -80,10 +125,13 @@ struct GeminiClient::Impl {
                 history = json::array();
             }
         }
+        span.arg("turns", static_cast<int64_t>(history.size()));
+        startup::mark("session loaded");
     }
     
     void saveSession() {
         if (session_path.empty()) return;
+        trace::Span span("session.save", "session");
         
         // Trim history if too long
         while (history.size() > MAX_HISTORY_TURNS * 2) {
@@ -91,6 +139,13 @@ struct GeminiClient::Impl {
             history.erase(history.begin());
         }
         
+        std::error_code ec;
+        std::filesystem::path dir = std::filesystem::path(session_path).parent_path();
+        if (std::filesystem::create_directories(dir, ec)) {
+            std::filesystem::permissions(dir, std::filesystem::perms::owner_all,
+                                         std::filesystem::perm_options::replace, ec);
+        }
+        
         std::ofstream file(session_path);
         file << history.dump(2);
         file.close();
@@ -102,14 +157,14 @@ struct GeminiClient::Impl {
     void addToHistory(const std::string& role, const std::string& text) {
         if (session_path.empty()) return;
         
-        history.push_back({
+        conversation().push_back({
             {"role", role},
             {"parts", {{{"text", text}}}}
         });
         saveSession();
     }
     
-    std::string getLanguageInstruction() {
+    std::string getLanguageInstruction() const {
         if (language == "en-us" || language == "en") {
             return "Respond in English.";
         } else if (language == "pt-br" || language == "pt") {
@@ -125,13 +180,35 @@ struct GeminiClient::Impl {
         return "/v1beta/models/" + model + ":generateContent?key=" + api_key;
     }
     
+    // Totals for this client, its session and today
+    void accountTokens(const TokenUsage& tokens) {
+        if (tokens.empty()) return;
+        usage.tokens.prompt += tokens.prompt;
+        usage.tokens.cached += tokens.cached;
+        usage.tokens.candidates += tokens.candidates;
+        usage.tokens.thoughts += tokens.thoughts;
+        ledger.add(tokens, session_path.empty() ? "" : session_name);
+    }
+    
+    // A reused connection has no resolve span; connect, TLS, waiting and
+    // the body are one span, httplib does not tell them apart
+    void traceExchange(int64_t sent, int status, size_t received) {
+        int64_t exchange_start = sent;
+        if (socket_opened >= sent) {
+            trace::record("dns", "http", sent, socket_opened - sent);
+            exchange_start = socket_opened;
+        }
+        trace::record("http.exchange", "http", exchange_start, trace::now() - exchange_start,
+                      "\"status\":" + std::to_string(status) + ",\"bytes\":" + std::to_string(received));
+    }
+    
     GeminiResponse sendRequest(const std::string& prompt, bool use_history = true) {
         GeminiResponse response;
         
         json contents = json::array();
         
         // Include history only if session is active
-        if (use_history && !session_path.empty() && !history.empty()) {
+        if (use_history && !session_path.empty() && !conversation().empty()) {
             contents = history;
         }
         
@@ -141,8 +218,23 @@ struct GeminiClient::Impl {
         });
         
         json request_body = {{"contents", contents}};
+        std::string body;
+        {
+            trace::Span span("request.encode", "http");
+            body = request_body.dump();
+            span.arg("bytes", static_cast<int64_t>(body.size()));
+        }
         
-        auto res = client->Post(buildEndpoint(), request_body.dump(), "application/json");
+        int64_t sent = trace::enabled() ? trace::now() : 0;
+        socket_opened = -1;
+        auto started = std::chrono::steady_clock::now();
+        startup::mark("request start");
+        auto res = http().Post(buildEndpoint(), body, "application/json");
+        startup::mark("response complete");
+        account(usage, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count(), -1);
+        if (trace::enabled()) {
+            traceExchange(sent, res ? res->status : 0, res ? res->body.size() : 0);
+        }
         
         if (!res) {
             response.success = false;
@@ -163,7 +255,12 @@ struct GeminiClient::Impl {
         }
         
         try {
+            trace::Span span("response.parse", "http");
             json res_json = json::parse(res->body);
+            if (res_json.contains("usageMetadata")) {
+                response.usage = fromUsageMetadata(res_json["usageMetadata"]);
+                accountTokens(response.usage);
+            }
             
             if (res_json.contains("candidates") && 
                 !res_json["candidates"].empty() &&
@@ -176,7 +273,7 @@ struct GeminiClient::Impl {
                 
                 // Save to history only if session is active
                 if (use_history && !session_path.empty()) {
-                    history.push_back({
+                    conversation().push_back({
                         {"role", "user"},
                         {"parts", {{{"text", prompt}}}}
                     });
@@ -237,27 +334,44 @@ bool GeminiClient::validate(std::string& error_message) {
     return true;
 }
 
-void GeminiClient::addCommandOutput(const std::string& command, const std::string& output) {
+void GeminiClient::addCommandOutput(const std::string& command, const std::string& output,
+                                    const std::string& resources) {
     // Add as a "user" message showing what command was executed and its output
-    // This gives the model context for follow-up questions
+    // This gives the model context for follow-up questions, including why it was slow
     std::string context = "I executed: " + command + "\n\nOutput:\n" + output;
+    if (!resources.empty()) {
+        context += "\n\nResources used: " + resources;
+    }
     impl_->addToHistory("user", context);
     impl_->addToHistory("model", "Got it. I'll remember this output for context.");
 }
 
+const ClientUsage& GeminiClient::usage() const {
+    return impl_->usage;
+}
+
+std::string GeminiClient::languageInstruction() const {
+    return impl_->getLanguageInstruction();
+}
+
 int GeminiClient::countSessionTokens() {
     // If no session, return 0
-    if (impl_->session_path.empty() || impl_->history.empty()) {
+    if (impl_->session_path.empty() || impl_->conversation().empty()) {
         return 0;
     }
     
+    // Every response reports its input size, history included
+    if (auto totals = impl_->ledger.session(impl_->session_name); totals && totals->last_prompt > 0) {
+        return static_cast<int>(totals->last_prompt);
+    }
+    
     // Build request body with session contents
     nlohmann::json request_body;
     request_body["contents"] = impl_->history;
     
     std::string path = "/v1beta/models/" + impl_->model + ":countTokens?key=" + impl_->api_key;
     
-    httplib::SSLClient client("generativelanguage.googleapis.com");
+    httplib::Client client(apiBase());
     client.set_connection_timeout(10);
     client.set_read_timeout(10);
     
@@ -281,20 +395,10 @@ SmartResponse GeminiClient::smartQuery(const std::string& query) {
     SmartResponse result;
     result.success = false;
     
-    std::ostringstream prompt;
-    prompt << "User request: " << query << "\n\n"
-           << "Analyze the request:\n"
-           << "1. EXECUTE: If user wants to DO something with the system (find files, list processes, check disk, etc.)\n"
-           << "2. EXPLAIN: For greetings, questions about concepts, explanations (hi, hello, why, what is, how does X work)\n\n"
-           << "Greetings like 'hi', 'hello', 'ola' are ALWAYS type explain.\n"
-           << "Only use execute if the user clearly wants to run a shell command.\n\n"
-           << "Respond with ONLY valid JSON:\n"
-           << "Execute: {\"type\":\"execute\",\"command\":\"shell command\",\"explanation\":\"1-line plain text explanation\"}\n"
-           << "Explain: {\"type\":\"explain\",\"response\":\"plain text response\"}\n\n"
-           << "CRITICAL: No markdown, no backticks, no asterisks, no formatting. Plain text only.\n"
-           << impl_->getLanguageInstruction();
-    
-    auto response = impl_->sendRequest(prompt.str());
+    prompts::SMART_QUERY.render(impl_->prompt, {impl_->getLanguageInstruction(), query});
+    
+    auto response = impl_->sendRequest(impl_->prompt);
+    result.usage = response.usage;
     
     if (!response.success) {
         result.type = SmartResponse::Type::ERROR;
@@ -347,14 +451,29 @@ SmartResponse GeminiClient::smartQuery(const std::string& query) {
 struct CurlStreamContext {
     std::string buffer;
     std::string accumulated;
+    std::string other;  // Lines that are not SSE events, e.g. a JSON error body
     GeminiClient::StreamCallback callback;
+    const std::atomic<bool>* cancel = nullptr;
     bool type_determined = false;
     std::string type;
+    TokenUsage usage;  // From the latest event that carried usageMetadata
 };
 
+// Aborts the transfer once the caller asks; libcurl calls this at least
+// once a second, also while waiting for the first byte
+static int curlCancelCallback(void* userdata, curl_off_t, curl_off_t, curl_off_t, curl_off_t) {
+    auto* ctx = static_cast<CurlStreamContext*>(userdata);
+    return ctx->cancel && ctx->cancel->load(std::memory_order_relaxed) ? 1 : 0;
+}
+
 static size_t curlWriteCallback(char* ptr, size_t size, size_t nmemb, void* userdata) {
     auto* ctx = static_cast<CurlStreamContext*>(userdata);
     size_t total = size * nmemb;
+    if (ctx->cancel && ctx->cancel->load(std::memory_order_relaxed)) {
+        return 0;  // Aborts with CURLE_WRITE_ERROR
+    }
+    trace::Span span("sse.parse", "stream");
+    span.arg("bytes", static_cast<int64_t>(total));
     ctx->buffer.append(ptr, total);
     
     // Parse SSE events as they arrive
@@ -372,6 +491,10 @@ static size_t curlWriteCallback(char* ptr, size_t size, size_t nmemb, void* user
             std::string json_str = line.substr(6);
             try {
                 auto json_event = nlohmann::json::parse(json_str);
+                // Counts grow over the stream; the last event has the totals
+                if (json_event.contains("usageMetadata")) {
+                    ctx->usage = fromUsageMetadata(json_event["usageMetadata"]);
+                }
                 if (json_event.contains("candidates") && 
                     !json_event["candidates"].empty() &&
                     json_event["candidates"][0].contains("content") &&
@@ -383,48 +506,85 @@ static size_t curlWriteCallback(char* ptr, size_t size, size_t nmemb, void* user
                     
                     // Stream output immediately for visual feedback
                     if (ctx->callback) {
+                        trace::Span render("render", "stream");
                         ctx->callback(chunk);
                     }
                 }
             } catch (...) {}
+        } else if (!line.empty()) {
+            ctx->other += line;
         }
     }
     
     return total;
 }
 
+// Splits a finished transfer into its phases. libcurl's timers count
+// microseconds from the start of curl_easy_perform() (started); a reused
+// connection has no resolve, connect or TLS phase
+static void traceCurlPhases(CURL* curl, int64_t started) {
+    curl_off_t resolved = 0, connected = 0, secured = 0, sent = 0, first_byte = 0, total = 0;
+    curl_easy_getinfo(curl, CURLINFO_NAMELOOKUP_TIME_T, &resolved);
+    curl_easy_getinfo(curl, CURLINFO_CONNECT_TIME_T, &connected);
+    curl_easy_getinfo(curl, CURLINFO_APPCONNECT_TIME_T, &secured);
+    curl_easy_getinfo(curl, CURLINFO_PRETRANSFER_TIME_T, &sent);
+    curl_easy_getinfo(curl, CURLINFO_STARTTRANSFER_TIME_T, &first_byte);
+    curl_easy_getinfo(curl, CURLINFO_TOTAL_TIME_T, &total);
+    
+    if (resolved > 0) trace::record("dns", "http", started, resolved);
+    if (connected > resolved) trace::record("connect", "http", started + resolved, connected - resolved);
+    if (secured > connected) trace::record("tls", "http", started + connected, secured - connected);
+    if (first_byte > sent) trace::record("ttfb", "http", started + sent, first_byte - sent);
+    if (total > first_byte) trace::record("body", "http", started + first_byte, total - first_byte);
+}
+
+// The same phases as CLOCK_MONOTONIC marks for --profile-startup
+static void profileCurlPhases(CURL* curl, int64_t started_ns) {
+    const std::pair<CURLINFO, const char*> phases[] = {
+        {CURLINFO_NAMELOOKUP_TIME_T, "name resolved"},
+        {CURLINFO_CONNECT_TIME_T, "connected"},
+        {CURLINFO_APPCONNECT_TIME_T, "TLS established"},
+        {CURLINFO_PRETRANSFER_TIME_T, "first request byte"},
+        {CURLINFO_STARTTRANSFER_TIME_T, "first response byte"},
+        {CURLINFO_TOTAL_TIME_T, "response complete"},
+    };
+    for (const auto& [info, phase] : phases) {
+        curl_off_t us = 0;
+        if (curl_easy_getinfo(curl, info, &us) == CURLE_OK && us > 0) {
+            startup::markAt(phase, started_ns + static_cast<int64_t>(us) * 1000);
+        }
+    }
+}
+
+// Latency and time to first byte of a finished transfer
+static void accountCurl(ClientUsage& usage, CURL* curl) {
+    curl_off_t first_byte = 0, total = 0;
+    curl_easy_getinfo(curl, CURLINFO_STARTTRANSFER_TIME_T, &first_byte);
+    curl_easy_getinfo(curl, CURLINFO_TOTAL_TIME_T, &total);
+    account(usage, static_cast<double>(total) / 1000, first_byte > 0 ? static_cast<double>(first_byte) / 1000 : -1);
+}
+
 SmartResponse GeminiClient::smartQueryStreaming(const std::string& query, StreamCallback on_chunk) {
     SmartResponse result;
     result.success = false;
     
-    std::ostringstream prompt;
-    prompt << "User request: " << query << "\n\n"
-           << "Analyze the request:\n"
-           << "1. EXECUTE: If user wants to DO something with the system (find files, list processes, check disk, etc.)\n"
-           << "2. EXPLAIN: For greetings, questions about concepts, explanations (hi, hello, why, what is, how does X work)\n\n"
-           << "Greetings like 'hi', 'hello', 'ola' are ALWAYS type explain.\n"
-           << "Only use execute if the user clearly wants to run a shell command.\n\n"
-           << "Respond with ONLY valid JSON:\n"
-           << "Execute: {\"type\":\"execute\",\"command\":\"shell command\",\"explanation\":\"1-line plain text explanation\"}\n"
-           << "Explain: {\"type\":\"explain\",\"response\":\"plain text response\"}\n\n"
-           << "CRITICAL: No markdown, no backticks, no asterisks, no formatting. Plain text only.\n"
-           << impl_->getLanguageInstruction();
+    prompts::SMART_QUERY.render(impl_->prompt, {impl_->getLanguageInstruction(), query});
     
     // Build request body
     nlohmann::json contents = nlohmann::json::array();
-    if (!impl_->session_path.empty() && !impl_->history.empty()) {
+    if (!impl_->session_path.empty() && !impl_->conversation().empty()) {
         contents = impl_->history;
     }
     contents.push_back({
         {"role", "user"},
-        {"parts", {{{"text", prompt.str()}}}}
+        {"parts", {{{"text", impl_->prompt}}}}
     });
     
     nlohmann::json request_body = {{"contents", contents}};
     std::string body = request_body.dump();
     
     // Build URL
-    std::string url = "https://generativelanguage.googleapis.com/v1beta/models/" + 
+    std::string url = apiBase() + "/v1beta/models/" + 
                       impl_->model + ":streamGenerateContent?alt=sse&key=" + impl_->api_key;
     
     // Setup curl
@@ -454,7 +614,15 @@ SmartResponse GeminiClient::smartQueryStreaming(const std::string& query, Stream
     curl_easy_setopt(curl, CURLOPT_TCP_NODELAY, 1L);
     curl_easy_setopt(curl, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_1_1);
     
+    int64_t started = trace::enabled() ? trace::now() : 0;
+    int64_t started_ns = startup::enabled() ? startup::clockNs() : 0;
+    startup::markAt("request start", started_ns);
     CURLcode res = curl_easy_perform(curl);
+    if (trace::enabled()) traceCurlPhases(curl, started);
+    if (startup::enabled()) profileCurlPhases(curl, started_ns);
+    accountCurl(impl_->usage, curl);
+    impl_->accountTokens(ctx.usage);
+    result.usage = ctx.usage;
     
     curl_slist_free_all(headers);
     curl_easy_cleanup(curl);
@@ -497,15 +665,16 @@ SmartResponse GeminiClient::smartQueryStreaming(const std::string& query, Stream
     return result;
 }
 
-void GeminiClient::generateContentStreaming(const std::string& prompt, StreamCallback on_chunk) {
+GeminiResponse GeminiClient::generateContentStreaming(const std::string& prompt, StreamCallback on_chunk,
+                                                      const std::atomic<bool>* cancel) {
     // Build request body with plain text prompt
     nlohmann::json contents = nlohmann::json::array();
-    if (!impl_->session_path.empty() && !impl_->history.empty()) {
+    if (!impl_->session_path.empty() && !impl_->conversation().empty()) {
         contents = impl_->history;
     }
     
-    std::string full_prompt = prompt + "\n\n" + impl_->getLanguageInstruction() + 
-                              "\n\nCRITICAL: Respond in plain text only. No markdown, no formatting.";
+    // The language comes with the prompt: templates have a slot for it
+    std::string full_prompt = prompt + "\n\nCRITICAL: Respond in plain text only. No markdown, no formatting.";
     
     contents.push_back({
         {"role", "user"},
@@ -515,14 +684,21 @@ void GeminiClient::generateContentStreaming(const std::string& prompt, StreamCal
     nlohmann::json request_body = {{"contents", contents}};
     std::string body = request_body.dump();
     
-    std::string url = "https://generativelanguage.googleapis.com/v1beta/models/" + 
+    std::string url = apiBase() + "/v1beta/models/" + 
                       impl_->model + ":streamGenerateContent?alt=sse&key=" + impl_->api_key;
     
+    GeminiResponse result;
+    result.success = false;
+    
     CURL* curl = curl_easy_init();
-    if (!curl) return;
+    if (!curl) {
+        result.error = "Curl init failed";
+        return result;
+    }
     
     CurlStreamContext ctx;
     ctx.callback = on_chunk;
+    ctx.cancel = cancel;
     
     struct curl_slist* headers = nullptr;
     headers = curl_slist_append(headers, "Content-Type: application/json");
@@ -533,31 +709,69 @@ void GeminiClient::generateContentStreaming(const std::string& prompt, StreamCal
     curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
     curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, curlWriteCallback);
     curl_easy_setopt(curl, CURLOPT_WRITEDATA, &ctx);
+    if (cancel) {
+        curl_easy_setopt(curl, CURLOPT_XFERINFOFUNCTION, curlCancelCallback);
+        curl_easy_setopt(curl, CURLOPT_XFERINFODATA, &ctx);
+        curl_easy_setopt(curl, CURLOPT_NOPROGRESS, 0L);
+    }
     curl_easy_setopt(curl, CURLOPT_TIMEOUT, 120L);
     curl_easy_setopt(curl, CURLOPT_BUFFERSIZE, 1024L);
     curl_easy_setopt(curl, CURLOPT_TCP_NODELAY, 1L);
     
-    curl_easy_perform(curl);
+    int64_t started = trace::enabled() ? trace::now() : 0;
+    int64_t started_ns = startup::enabled() ? startup::clockNs() : 0;
+    startup::markAt("request start", started_ns);
+    CURLcode res = curl_easy_perform(curl);
+    if (trace::enabled()) traceCurlPhases(curl, started);
+    if (startup::enabled()) profileCurlPhases(curl, started_ns);
+    accountCurl(impl_->usage, curl);
+    // A cancelled stream was still billed for what it generated
+    impl_->accountTokens(ctx.usage);
+    result.usage = ctx.usage;
+    long status = 0;
+    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &status);
     curl_slist_free_all(headers);
     curl_easy_cleanup(curl);
     
+    if (cancel && cancel->load()) {
+        // Keep what arrived; a cut-off answer stays out of the session
+        result.error = "Cancelled";
+        result.content = std::move(ctx.accumulated);
+        return result;
+    }
+    if (res != CURLE_OK) {
+        result.error = std::string("Curl error: ") + curl_easy_strerror(res);
+        return result;
+    }
+    if (status != 200) {
+        // Errors come as a plain JSON body, not as SSE events
+        result.error = "API error: HTTP " + std::to_string(status);
+        try {
+            auto error_json = nlohmann::json::parse(ctx.other + ctx.buffer);
+            if (error_json.contains("error")) {
+                result.error += " - " + error_json["error"]["message"].get<std::string>();
+            }
+        } catch (...) {}
+        return result;
+    }
+    
     // Add to session history
     if (!impl_->session_path.empty()) {
         impl_->addToHistory("user", prompt);
         impl_->addToHistory("model", ctx.accumulated);
     }
+    
+    result.content = std::move(ctx.accumulated);
+    result.success = true;
+    return result;
 }
 
 GeminiResponse GeminiClient::getCommandForTask(const std::string& task) {
     GeminiResponse result;
     
-    std::ostringstream prompt;
-    prompt << "User wants to: " << task << "\n\n"
-           << "Respond with ONLY a JSON object:\n"
-           << "{\"command\":\"the shell command\",\"explanation\":\"1-line explanation\"}\n\n"
-           << "CRITICAL: Return ONLY valid JSON. No markdown, no text before or after.";
-    
-    auto response = impl_->sendRequest(prompt.str());
+    prompts::COMMAND_FOR_TASK.render(impl_->prompt, {task});
+    auto response = impl_->sendRequest(impl_->prompt);
+    result.usage = response.usage;
     
     if (!response.success) {
         return response;
@@ -586,47 +800,24 @@ GeminiResponse GeminiClient::generateContent(const std::string& prompt) {
 }
 
 GeminiResponse GeminiClient::explainCommand(const std::string& command) {
-    std::ostringstream prompt;
-    prompt << "Explain this command briefly and directly: " << command << "\n\n"
-           << "Format: One short paragraph with what it does, then each flag explained in one line. "
-           << "No emojis, no bullet points, no headers. Keep it under 100 words. "
-           << impl_->getLanguageInstruction();
-    
-    return impl_->sendRequest(prompt.str());
+    prompts::EXPLAIN_BRIEF.render(impl_->prompt, {impl_->getLanguageInstruction(), command});
+    return impl_->sendRequest(impl_->prompt);
 }
 
 GeminiResponse GeminiClient::suggestCommand(const std::string& task_description) {
-    std::ostringstream prompt;
-    prompt << "User wants to: " << task_description << "\n\n"
-           << "Give the exact command, then one sentence explaining it. "
-           << "No emojis, no bullet points. Keep it very short. "
-           << impl_->getLanguageInstruction();
-    
-    return impl_->sendRequest(prompt.str());
+    prompts::SUGGEST_COMMAND.render(impl_->prompt, {impl_->getLanguageInstruction(), task_description});
+    return impl_->sendRequest(impl_->prompt);
 }
 
 GeminiResponse GeminiClient::getCommandOnly(const std::string& task_description) {
-    std::ostringstream prompt;
-    prompt << "User wants to: " << task_description << "\n\n"
-           << "Respond with ONLY the exact shell command, nothing else. "
-           << "No explanation, no quotes, no backticks. Just the raw command.";
-    
-    return impl_->sendRequest(prompt.str()); // Uses history for context
+    prompts::COMMAND_ONLY.render(impl_->prompt, {task_description});
+    return impl_->sendRequest(impl_->prompt); // Uses history for context
 }
 
 GeminiResponse GeminiClient::simulateCommand(const std::string& command, const std::string& context) {
-    std::ostringstream prompt;
-    prompt << "Predict what happens when running: " << command << "\n";
-    
-    if (!context.empty()) {
-        prompt << "Context: " << context << "\n";
-    }
-    
-    prompt << "\nGive a brief prediction: what files are affected, expected output, any risks. "
-           << "No emojis, no bullet points. Keep it very short and direct. "
-           << impl_->getLanguageInstruction();
-    
-    return impl_->sendRequest(prompt.str());
+    std::string context_line = context.empty() ? "" : "Context: " + context + "\n";
+    prompts::SIMULATE_BRIEF.render(impl_->prompt, {impl_->getLanguageInstruction(), command, context_line});
+    return impl_->sendRequest(impl_->prompt);
 }
 
 } // namespace tt
@@ -0,0 +1,543 @@
+/**
+ * HistoryAnalyzer.cpp - Executable and flag usage mined from shell history
+ *
+ * Each file is mapped read-only and only the bytes past its saved offset are
+ * parsed. That range is cut at entry boundaries into chunks of at least
+ * MIN_CHUNK_BYTES, one thread per chunk, each with its own CommandParser and
+ * counts; the counts are merged once all threads finish. Counts are kept per
+ * history file so a rewritten file can be dropped and counted again.
+ */
+
+#include "tt/HistoryAnalyzer.hpp"
+#include "tt/CommandParser.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <nlohmann/json.hpp>
+
+using json = nlohmann::json;
+
+namespace tt {
+
+static const size_t MIN_CHUNK_BYTES = 256 * 1024;
+static const size_t HEAD_BYTES = 256;
+static const size_t MAX_FLAGS_PER_EXECUTABLE = 256;
+
+namespace {
+
+// Lets the flag tables be searched with string_views
+struct StringHash {
+    using is_transparent = void;
+    size_t operator()(std::string_view s) const { return std::hash<std::string_view>{}(s); }
+};
+
+struct ExecutableUsage {
+    uint64_t count = 0;
+    std::unordered_map<std::string, uint64_t, StringHash, std::equal_to<>> flags;
+};
+
+using UsageTable = std::unordered_map<std::string, ExecutableUsage>;
+
+struct FileState {
+    uint64_t offset = 0;       // End of the last complete entry parsed
+    uint64_t head_length = 0;  // Prefix fingerprint, to detect rewrites
+    uint64_t head_hash = 0;
+    uint64_t entries = 0;
+    UsageTable usage;
+};
+
+struct ChunkResult {
+    uint64_t entries = 0;
+    UsageTable usage;
+};
+
+uint64_t fnv1a(std::string_view s) {
+    uint64_t h = 0xcbf29ce484222325ULL;
+    for (unsigned char c : s) {
+        h ^= c;
+        h *= 0x100000001b3ULL;
+    }
+    return h;
+}
+
+// Read-only mapping of a whole file; empty view for missing or empty files
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& path) {
+        int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) return;
+        struct stat st;
+        if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode)) {
+            exists_ = true;
+            size_ = static_cast<size_t>(st.st_size);
+            if (size_ > 0) {
+                void* data = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (data != MAP_FAILED) {
+                    data_ = data;
+                    madvise(data_, size_, MADV_WILLNEED);
+                } else {
+                    size_ = 0;
+                }
+            }
+        }
+        close(fd);
+    }
+
+    ~MappedFile() {
+        if (data_) munmap(data_, size_);
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool exists() const { return exists_; }
+    std::string_view view() const {
+        return data_ ? std::string_view(static_cast<const char*>(data_), size_) : std::string_view();
+    }
+
+private:
+    void* data_ = nullptr;
+    size_t size_ = 0;
+    bool exists_ = false;
+};
+
+bool continuesLine(std::string_view data, size_t newline, HistoryFormat format) {
+    return format == HistoryFormat::ZSH && newline > 0 && data[newline - 1] == '\\';
+}
+
+// Byte after the last complete entry; a partially written tail waits for the next run
+size_t completeEnd(std::string_view data, HistoryFormat format) {
+    size_t newline = data.rfind('\n');
+    while (newline != std::string_view::npos && continuesLine(data, newline, format)) {
+        newline = newline > 0 ? data.rfind('\n', newline - 1) : std::string_view::npos;
+    }
+    return newline == std::string_view::npos ? 0 : newline + 1;
+}
+
+// First entry that starts at or after pos
+size_t nextEntryStart(std::string_view data, size_t pos, HistoryFormat format) {
+    if (pos == 0) return 0;
+    size_t newline = data.find('\n', pos - 1);
+    while (newline != std::string_view::npos) {
+        size_t start = newline + 1;
+        bool valid = !continuesLine(data, newline, format);
+        if (format == HistoryFormat::FISH) {
+            valid = data.compare(start, 6, "- cmd:") == 0;
+        }
+        if (valid) return start;
+        newline = data.find('\n', start);
+    }
+    return data.size();
+}
+
+bool isTimestampLine(std::string_view line) {
+    if (line.size() < 2 || line[0] != '#') return false;
+    return std::all_of(line.begin() + 1, line.end(), [](char c) { return c >= '0' && c <= '9'; });
+}
+
+// zsh stores bytes 0x83..0x9F as 0x83 followed by the byte xor 32
+void unmetafy(std::string& text) {
+    size_t out = 0;
+    for (size_t i = 0; i < text.size(); ++i) {
+        if (static_cast<unsigned char>(text[i]) == 0x83 && i + 1 < text.size()) {
+            text[out++] = static_cast<char>(text[++i] ^ 32);
+        } else {
+            text[out++] = text[i];
+        }
+    }
+    text.resize(out);
+}
+
+// fish escapes newlines and backslashes in cmd values
+void unescapeFish(std::string_view value, std::string& out) {
+    out.clear();
+    for (size_t i = 0; i < value.size(); ++i) {
+        if (value[i] == '\\' && i + 1 < value.size()) {
+            char next = value[++i];
+            out += next == 'n' ? '\n' : next;
+        } else {
+            out += value[i];
+        }
+    }
+}
+
+void addFlag(ExecutableUsage& usage, std::string_view flag, uint64_t count) {
+    auto it = usage.flags.find(flag);
+    if (it != usage.flags.end()) {
+        it->second += count;
+    } else if (usage.flags.size() < MAX_FLAGS_PER_EXECUTABLE) {
+        usage.flags.emplace(flag, count);
+    }
+}
+
+void mergeUsage(UsageTable& into, const UsageTable& from) {
+    for (const auto& [name, usage] : from) {
+        auto& target = into[name];
+        target.count += usage.count;
+        for (const auto& [flag, count] : usage.flags) {
+            addFlag(target, flag, count);
+        }
+    }
+}
+
+class ChunkParser {
+public:
+    explicit ChunkParser(ChunkResult& result) : result_(result) {}
+
+    void parse(std::string_view chunk, HistoryFormat format) {
+        size_t pos = 0;
+        while (pos < chunk.size()) {
+            size_t newline = chunk.find('\n', pos);
+            if (newline == std::string_view::npos) newline = chunk.size();
+            std::string_view line = chunk.substr(pos, newline - pos);
+            pos = newline + 1;
+
+            switch (format) {
+                case HistoryFormat::BASH:
+                    if (!line.empty() && !isTimestampLine(line)) count(line);
+                    break;
+
+                case HistoryFormat::ZSH: {
+                    entry_.assign(line);
+                    while (!entry_.empty() && entry_.back() == '\\' && pos < chunk.size()) {
+                        newline = chunk.find('\n', pos);
+                        if (newline == std::string_view::npos) newline = chunk.size();
+                        entry_.back() = '\n';
+                        entry_.append(chunk.substr(pos, newline - pos));
+                        pos = newline + 1;
+                    }
+                    unmetafy(entry_);
+                    // Extended format: ": <epoch>:<duration>;command"
+                    if (entry_.rfind(": ", 0) == 0) {
+                        size_t semi = entry_.find(';');
+                        entry_.erase(0, semi == std::string::npos ? entry_.size() : semi + 1);
+                    }
+                    if (!entry_.empty()) count(entry_);
+                    break;
+                }
+
+                case HistoryFormat::FISH:
+                    if (line.rfind("- cmd: ", 0) == 0) {
+                        unescapeFish(line.substr(7), entry_);
+                        if (!entry_.empty()) count(entry_);
+                    }
+                    break;
+            }
+        }
+    }
+
+private:
+    void count(std::string_view entry) {
+        ++result_.entries;
+        parser_.parseCommands(entry, commands_);
+        for (const auto& command : commands_) {
+            ExecutableUsage* usage = usageFor(command.executableId());
+            if (!usage) continue;
+
+            ++usage->count;
+            for (size_t i = 0; i < command.flagCount(); ++i) {
+                // --color=auto counts as --color
+                std::string_view flag = command.flag(i);
+                if (flag.rfind("--", 0) == 0) flag = flag.substr(0, flag.find('='));
+                addFlag(*usage, flag, 1);
+            }
+        }
+    }
+
+    // Counts for an interned executable, looked up by basename once per id;
+    // null for names that are not counted ("$EDITOR", "dir/")
+    ExecutableUsage* usageFor(uint32_t id) {
+        while (by_id_.size() <= id) {
+            std::string_view name = parser_.executables().name(static_cast<uint32_t>(by_id_.size()));
+            name = name.substr(name.rfind('/') + 1);
+            by_id_.push_back(name.empty() || name[0] == '$' ? nullptr : &result_.usage[std::string(name)]);
+        }
+        return by_id_[id];
+    }
+
+    ChunkResult& result_;
+    CommandParser parser_;
+    CompactCommandList commands_;
+    std::vector<ExecutableUsage*> by_id_;  // Indexed by parser_ executable id
+    std::string entry_;
+};
+
+ChunkResult parseParallel(std::string_view data, HistoryFormat format) {
+    unsigned hardware = std::max(1u, std::thread::hardware_concurrency());
+    size_t workers = std::clamp<size_t>(data.size() / MIN_CHUNK_BYTES, 1, hardware);
+
+    std::vector<size_t> bounds(workers + 1, data.size());
+    bounds[0] = 0;
+    for (size_t i = 1; i < workers; ++i) {
+        bounds[i] = std::max(bounds[i - 1], nextEntryStart(data, data.size() * i / workers, format));
+    }
+
+    std::vector<ChunkResult> results(workers);
+    std::vector<std::thread> threads;
+    auto run = [&](size_t i) {
+        ChunkParser(results[i]).parse(data.substr(bounds[i], bounds[i + 1] - bounds[i]), format);
+    };
+    for (size_t i = 1; i < workers; ++i) {
+        threads.emplace_back(run, i);
+    }
+    run(0);
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    for (size_t i = 1; i < workers; ++i) {
+        results[0].entries += results[i].entries;
+        mergeUsage(results[0].usage, results[i].usage);
+    }
+    return std::move(results[0]);
+}
+
+json usageToJson(const UsageTable& usage) {
+    json out = json::object();
+    for (const auto& [name, entry] : usage) {
+        out[name] = {{"count", entry.count}, {"flags", entry.flags}};
+    }
+    return out;
+}
+
+UsageTable usageFromJson(const json& data) {
+    UsageTable usage;
+    for (const auto& [name, entry] : data.items()) {
+        auto& target = usage[name];
+        target.count = entry.value("count", uint64_t{0});
+        json flags = entry.value("flags", json::object());
+        for (const auto& [flag, count] : flags.items()) {
+            target.flags[flag] = count.get<uint64_t>();
+        }
+    }
+    return usage;
+}
+
+std::vector<UsageCount> topCounts(std::vector<UsageCount> counts, size_t limit) {
+    auto order = [](const UsageCount& a, const UsageCount& b) {
+        return a.count != b.count ? a.count > b.count : a.name < b.name;
+    };
+    limit = std::min(limit, counts.size());
+    std::partial_sort(counts.begin(), counts.begin() + limit, counts.end(), order);
+    counts.resize(limit);
+    return counts;
+}
+
+} // anonymous namespace
+
+struct HistoryAnalyzer::Impl {
+    std::string path;
+    bool loaded = false;
+    std::map<std::string, FileState> files;
+
+    // Sum over files, rebuilt after load and update
+    UsageTable usage;
+    uint64_t entries = 0;
+
+    explicit Impl(const std::string& stats_path)
+        : path(stats_path.empty() ? HistoryAnalyzer::getDefaultPath() : stats_path) {}
+
+    void load() {
+        if (loaded) return;
+        loaded = true;
+        if (path.empty()) return;
+
+        std::ifstream file(path);
+        if (!file.good()) return;
+
+        try {
+            json data;
+            file >> data;
+            json saved = data.value("files", json::object());
+            for (const auto& [name, entry] : saved.items()) {
+                FileState state;
+                state.offset = entry.value("offset", uint64_t{0});
+                state.head_length = entry.value("head_length", uint64_t{0});
+                state.head_hash = entry.value("head_hash", uint64_t{0});
+                state.entries = entry.value("entries", uint64_t{0});
+                state.usage = usageFromJson(entry.value("executables", json::object()));
+                files[name] = std::move(state);
+            }
+        } catch (...) {
+            files.clear();
+        }
+        aggregate();
+    }
+
+    void save() {
+        if (path.empty()) return;
+
+        json data;
+        data["version"] = 1;
+        json list = json::object();
+        for (const auto& [name, state] : files) {
+            list[name] = {
+                {"offset", state.offset},
+                {"head_length", state.head_length},
+                {"head_hash", state.head_hash},
+                {"entries", state.entries},
+                {"executables", usageToJson(state.usage)}
+            };
+        }
+        data["files"] = std::move(list);
+
+        std::error_code ec;
+        std::filesystem::create_directories(std::filesystem::path(path).parent_path(), ec);
+        std::ofstream file(path);
+        if (!file.good()) return;
+        file << data.dump();
+        file.close();
+        std::filesystem::permissions(path,
+            std::filesystem::perms::owner_read | std::filesystem::perms::owner_write,
+            std::filesystem::perm_options::replace, ec);
+    }
+
+    void aggregate() {
+        usage.clear();
+        entries = 0;
+        for (const auto& [name, state] : files) {
+            mergeUsage(usage, state.usage);
+            entries += state.entries;
+        }
+    }
+
+    HistoryScan update(const std::vector<HistorySource>& sources) {
+        load();
+        HistoryScan scan;
+
+        for (const auto& source : sources) {
+            MappedFile file(source.path);
+            if (!file.exists()) continue;
+            ++scan.files;
+
+            std::string_view data = file.view();
+            FileState& state = files[source.path];
+
+            // Truncated or edited since the last run: its counts are stale
+            bool rewritten = data.size() < state.offset ||
+                (state.head_length > 0 && fnv1a(data.substr(0, state.head_length)) != state.head_hash);
+            if (rewritten) {
+                state = FileState{};
+                ++scan.rescanned_files;
+            }
+
+            size_t end = completeEnd(data, source.format);
+            if (end <= state.offset) continue;
+
+            std::string_view pending = data.substr(state.offset, end - state.offset);
+            ChunkResult result = parseParallel(pending, source.format);
+            mergeUsage(state.usage, result.usage);
+            state.entries += result.entries;
+            state.offset = end;
+            state.head_length = std::min<uint64_t>(HEAD_BYTES, end);
+            state.head_hash = fnv1a(data.substr(0, state.head_length));
+
+            scan.new_entries += result.entries;
+            scan.new_bytes += pending.size();
+        }
+
+        aggregate();
+        save();
+        return scan;
+    }
+};
+
+HistoryAnalyzer::HistoryAnalyzer(const std::string& path)
+    : impl_(std::make_unique<Impl>(path)) {}
+
+HistoryAnalyzer::~HistoryAnalyzer() = default;
+
+std::string HistoryAnalyzer::getDefaultPath() {
+    const char* home = std::getenv("HOME");
+    if (!home) return "";
+    return std::string(home) + "/.tt/history_stats.json";
+}
+
+std::vector<HistorySource> HistoryAnalyzer::defaultSources() {
+    std::vector<HistorySource> sources;
+    const char* home = std::getenv("HOME");
+    if (!home) return sources;
+    std::string home_dir = home;
+
+    sources.push_back({home_dir + "/.bash_history", HistoryFormat::BASH});
+
+    const char* zdotdir = std::getenv("ZDOTDIR");
+    std::string zsh_dir = zdotdir && *zdotdir ? zdotdir : home_dir;
+    sources.push_back({zsh_dir + "/.zsh_history", HistoryFormat::ZSH});
+
+    const char* data_home = std::getenv("XDG_DATA_HOME");
+    std::string fish_dir = data_home && *data_home ? data_home : home_dir + "/.local/share";
+    sources.push_back({fish_dir + "/fish/fish_history", HistoryFormat::FISH});
+
+    return sources;
+}
+
+HistoryScan HistoryAnalyzer::update() {
+    return impl_->update(defaultSources());
+}
+
+HistoryScan HistoryAnalyzer::update(const std::vector<HistorySource>& sources) {
+    return impl_->update(sources);
+}
+
+uint64_t HistoryAnalyzer::totalEntries() const {
+    impl_->load();
+    return impl_->entries;
+}
+
+uint64_t HistoryAnalyzer::executableCount(const std::string& executable) const {
+    impl_->load();
+    auto it = impl_->usage.find(executable);
+    return it == impl_->usage.end() ? 0 : it->second.count;
+}
+
+uint64_t HistoryAnalyzer::flagCount(const std::string& executable, const std::string& flag) const {
+    impl_->load();
+    auto it = impl_->usage.find(executable);
+    if (it == impl_->usage.end()) return 0;
+    auto fit = it->second.flags.find(flag);
+    return fit == it->second.flags.end() ? 0 : fit->second;
+}
+
+std::vector<UsageCount> HistoryAnalyzer::topExecutables(size_t limit) const {
+    impl_->load();
+    std::vector<UsageCount> counts;
+    counts.reserve(impl_->usage.size());
+    for (const auto& [name, usage] : impl_->usage) {
+        counts.push_back({name, usage.count});
+    }
+    return topCounts(std::move(counts), limit);
+}
+
+std::vector<UsageCount> HistoryAnalyzer::topFlags(const std::string& executable, size_t limit) const {
+    impl_->load();
+    std::vector<UsageCount> counts;
+    auto it = impl_->usage.find(executable);
+    if (it != impl_->usage.end()) {
+        for (const auto& [flag, count] : it->second.flags) {
+            counts.push_back({flag, count});
+        }
+    }
+    return topCounts(std::move(counts), limit);
+}
+
+void HistoryAnalyzer::clear() {
+    impl_->loaded = true;
+    impl_->files.clear();
+    impl_->aggregate();
+    impl_->save();
+}
+
+} // namespace tt
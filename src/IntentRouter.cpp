@@ -0,0 +1,249 @@
+/**
+ * IntentRouter.cpp - Local intent classifier that routes obvious inputs
+ */
+
+#include "tt/IntentRouter.hpp"
+#include "tt/CaseFold.hpp"
+#include "tt/QuestionClassifier.hpp"
+#include "tt/ShellLexer.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+namespace tt {
+
+namespace {
+
+struct IntentWeight {
+    uint16_t index;
+    float weight[INTENT_COUNT];
+};
+
+#include "IntentWeights.inc"
+
+// Expand the sparse generated table into one row per feature at compile time
+constexpr auto expandWeights() {
+    std::array<std::array<float, INTENT_COUNT>, INTENT_FEATURE_COUNT> dense{};
+    for (const auto& entry : INTENT_WEIGHTS) {
+        for (size_t c = 0; c < INTENT_COUNT; ++c) {
+            dense[entry.index][c] = entry.weight[c];
+        }
+    }
+    return dense;
+}
+
+constexpr auto WEIGHTS = expandWeights();
+
+enum ShapeFeature : uint16_t {
+    SHAPE_BIAS,
+    SHAPE_QUESTION_MARK,   // Ends with '?'
+    SHAPE_INTERROGATIVE,   // isQuestion() keywords
+    SHAPE_OPERATOR,        // | && ; > and friends
+    SHAPE_FLAG,            // -x or --long
+    SHAPE_PATH,            // Word with '/' or starting with ~ or .
+    SHAPE_EXPANSION,       // $var, $(...), globs
+    SHAPE_QUOTED,
+    SHAPE_ONE_WORD,
+    SHAPE_FEW_WORDS,       // 2-3
+    SHAPE_SOME_WORDS,      // 4-7
+    SHAPE_MANY_WORDS,      // 8+
+    SHAPE_ACCENTED,        // Non-ASCII letters: almost always prose
+    SHAPE_NUMBER,          // Word made of digits
+    SHAPE_ASSIGNMENT,      // NAME=value
+    SHAPE_SENTENCE_END     // Ends with '.' or '!'
+};
+
+static_assert(SHAPE_SENTENCE_END + 1 == INTENT_SHAPE_FEATURES);
+
+// Feature kinds are hashed in as a tag so "ls" as a word and as the first
+// token land in different buckets
+enum HashTag : uint8_t {
+    TAG_WORD = 'w',
+    TAG_BIGRAM = 'b',
+    TAG_FIRST_TOKEN = 'f'
+};
+
+constexpr size_t MAX_WORD_LENGTH = 24;
+
+uint32_t hashText(uint8_t tag, std::string_view text, uint32_t h = 2166136261u) {
+    h = (h ^ tag) * 16777619u;
+    for (char c : text) {
+        h = (h ^ static_cast<unsigned char>(c)) * 16777619u;
+    }
+    return h;
+}
+
+void addBucket(IntentFeatures& out, uint32_t hash) {
+    if (out.count < IntentFeatures::MAX_FEATURES) {
+        out.index[out.count++] = static_cast<uint16_t>(hash % INTENT_HASH_BUCKETS);
+    }
+}
+
+void addShape(IntentFeatures& out, ShapeFeature feature) {
+    if (out.count < IntentFeatures::MAX_FEATURES) {
+        out.index[out.count++] = static_cast<uint16_t>(INTENT_HASH_BUCKETS + feature);
+    }
+}
+
+bool isDigits(std::string_view text) {
+    if (text.empty()) return false;
+    for (char c : text) {
+        if (c < '0' || c > '9') return false;
+    }
+    return true;
+}
+
+bool isAssignment(std::string_view text) {
+    size_t eq = text.find('=');
+    if (eq == 0 || eq == std::string_view::npos) return false;
+    for (size_t i = 0; i < eq; ++i) {
+        char c = text[i];
+        bool ok = c == '_' || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (i > 0 && c >= '0' && c <= '9');
+        if (!ok) return false;
+    }
+    return true;
+}
+
+// Shape features from the shell's view of the input
+void addShapeFeatures(std::string_view input, IntentFeatures& out) {
+    bool flag = false, path = false, expansion = false, quoted = false;
+    bool number = false, assignment = false, op = false;
+    size_t words = 0;
+
+    ShellLexer lexer(input);
+    for (Token token = lexer.next(); !token.is(TokenKind::END); token = lexer.next()) {
+        if (token.isOperator()) {
+            if (!token.is(TokenKind::NEWLINE)) op = true;
+            continue;
+        }
+        if (!token.is(TokenKind::WORD)) continue;
+
+        std::string_view text = token.text;
+        ++words;
+        if (text.size() > 1 && text[0] == '-' && text[1] != ' ') flag = true;
+        if (text.find('/') != std::string_view::npos || text[0] == '~' ||
+            (text[0] == '.' && text.size() > 1)) path = true;
+        // A closing '?' is punctuation, not a glob
+        bool glob = token.has(TOKEN_GLOB) && text.back() != '?';
+        if (token.has(TOKEN_EXPANSION) || token.has(TOKEN_SUBSTITUTION) || glob) expansion = true;
+        if (token.has(TOKEN_QUOTED)) quoted = true;
+        if (isDigits(text)) number = true;
+        if (isAssignment(text)) assignment = true;
+    }
+
+    addShape(out, SHAPE_BIAS);
+    if (!input.empty() && input.back() == '?') addShape(out, SHAPE_QUESTION_MARK);
+    if (isQuestion(input)) addShape(out, SHAPE_INTERROGATIVE);
+    if (op) addShape(out, SHAPE_OPERATOR);
+    if (flag) addShape(out, SHAPE_FLAG);
+    if (path) addShape(out, SHAPE_PATH);
+    if (expansion) addShape(out, SHAPE_EXPANSION);
+    if (quoted) addShape(out, SHAPE_QUOTED);
+    if (number) addShape(out, SHAPE_NUMBER);
+    if (assignment) addShape(out, SHAPE_ASSIGNMENT);
+    if (!input.empty() && (input.back() == '.' || input.back() == '!')) addShape(out, SHAPE_SENTENCE_END);
+
+    for (char c : input) {
+        if (static_cast<unsigned char>(c) >= 0x80) {
+            addShape(out, SHAPE_ACCENTED);
+            break;
+        }
+    }
+
+    if (words <= 1) addShape(out, SHAPE_ONE_WORD);
+    else if (words <= 3) addShape(out, SHAPE_FEW_WORDS);
+    else if (words <= 7) addShape(out, SHAPE_SOME_WORDS);
+    else addShape(out, SHAPE_MANY_WORDS);
+}
+
+} // anonymous namespace
+
+void extractIntentFeatures(std::string_view input, IntentFeatures& out) noexcept {
+    out.count = 0;
+
+    while (!input.empty() && (input.front() == ' ' || input.front() == '\t')) input.remove_prefix(1);
+    while (!input.empty() && (input.back() == ' ' || input.back() == '\t' ||
+                              input.back() == '\n' || input.back() == '\r')) input.remove_suffix(1);
+
+    addShapeFeatures(input, out);
+
+    // First token verbatim: command names are the strongest SHELL signal
+    size_t first_end = input.find_first_of(" \t");
+    addBucket(out, hashText(TAG_FIRST_TOKEN, input.substr(0, first_end)));
+
+    // Folded letter words and their bigrams
+    char word[MAX_WORD_LENGTH];
+    size_t length = 0;
+    uint32_t previous = 0;
+
+    auto finishWord = [&]() {
+        if (length == 0) return;
+        std::string_view text(word, length);
+        uint32_t current = hashText(TAG_WORD, text);
+        addBucket(out, current);
+        if (previous) addBucket(out, hashText(TAG_BIGRAM, text, previous));
+        previous = current;
+        length = 0;
+    };
+
+    for (size_t i = 0; i < input.size(); ++i) {
+        unsigned char c = input[i];
+        FoldedLetter folded = foldLetter(input, i);
+        if (folded.letter) {
+            if (length < MAX_WORD_LENGTH) word[length++] = folded.letter;
+            i += folded.length - 1;
+        } else if (c >= 0x80 && c != 0xC3) {
+            continue;  // Other scripts stay inside the current word
+        } else {
+            finishWord();
+        }
+    }
+    finishWord();
+}
+
+IntentScore scoreIntent(std::string_view input) noexcept {
+    IntentFeatures features;
+    extractIntentFeatures(input, features);
+
+    float logits[INTENT_COUNT] = {};
+    for (size_t i = 0; i < features.count; ++i) {
+        const auto& row = WEIGHTS[features.index[i]];
+        for (size_t c = 0; c < INTENT_COUNT; ++c) logits[c] += row[c];
+    }
+
+    float max_logit = logits[0];
+    for (size_t c = 1; c < INTENT_COUNT; ++c) max_logit = std::max(max_logit, logits[c]);
+
+    IntentScore score;
+    float sum = 0.0f;
+    for (size_t c = 0; c < INTENT_COUNT; ++c) {
+        score.probability[c] = std::exp(logits[c] - max_logit);
+        sum += score.probability[c];
+    }
+    for (size_t c = 0; c < INTENT_COUNT; ++c) {
+        score.probability[c] /= sum;
+        if (score.probability[c] > score.confidence) {
+            score.confidence = score.probability[c];
+            score.intent = static_cast<Intent>(c);
+        }
+    }
+    return score;
+}
+
+std::optional<Intent> routeIntent(std::string_view input, float min_confidence) noexcept {
+    IntentScore score = scoreIntent(input);
+    if (score.confidence < min_confidence) return std::nullopt;
+    return score.intent;
+}
+
+const char* toString(Intent intent) {
+    switch (intent) {
+        case Intent::EXPLAIN: return "explain";
+        case Intent::TASK:    return "task";
+        case Intent::SHELL:   return "shell";
+    }
+    return "unknown";
+}
+
+} // namespace tt
@@ -0,0 +1,287 @@
+/**
+ * Metrics.cpp - Append-only metrics file, percentiles and Prometheus export
+ */
+
+#include "tt/Metrics.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <tuple>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace tt {
+
+namespace {
+
+constexpr uint8_t RECORD_VERSION = 1;
+
+enum : uint8_t { FLAG_CACHE_HIT = 1, FLAG_ERROR = 2 };
+
+// On disk, in host byte order
+struct Record {
+    int64_t time_ms;  // Unix time
+    float total_ms;
+    float model_ms;
+    float first_byte_ms;
+    uint32_t input_tokens;
+    uint32_t output_tokens;
+    uint32_t cached_tokens;
+    uint8_t version;
+    uint8_t mode;
+    uint8_t flags;
+    uint8_t model_length;
+    char model[28];
+};
+static_assert(sizeof(Record) == 64, "metrics records are 64 bytes");
+
+constexpr RequestMode MODES[] = {RequestMode::QUERY, RequestMode::RUN,    RequestMode::EXPLAIN,
+                                 RequestMode::ELI5,  RequestMode::WHATIF, RequestMode::CONSOLE};
+
+Record encode(const RequestMetrics& metrics) {
+    Record record{};
+    record.time_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        metrics.time.time_since_epoch()).count();
+    record.total_ms = static_cast<float>(metrics.total_ms);
+    record.model_ms = static_cast<float>(metrics.model_ms);
+    record.first_byte_ms = static_cast<float>(metrics.first_byte_ms);
+    record.input_tokens = metrics.input_tokens;
+    record.output_tokens = metrics.output_tokens;
+    record.cached_tokens = metrics.cached_tokens;
+    record.version = RECORD_VERSION;
+    record.mode = static_cast<uint8_t>(metrics.mode);
+    record.flags = static_cast<uint8_t>((metrics.cache_hit ? FLAG_CACHE_HIT : 0) | (metrics.error ? FLAG_ERROR : 0));
+    record.model_length = static_cast<uint8_t>(std::min(metrics.model.size(), sizeof(record.model)));
+    std::memcpy(record.model, metrics.model.data(), record.model_length);
+    return record;
+}
+
+std::optional<RequestMetrics> decode(const Record& record) {
+    if (record.version != RECORD_VERSION || record.mode >= std::size(MODES) ||
+        record.model_length > sizeof(record.model)) {
+        return std::nullopt;
+    }
+    RequestMetrics metrics;
+    metrics.time = std::chrono::system_clock::time_point(std::chrono::milliseconds(record.time_ms));
+    metrics.mode = MODES[record.mode];
+    metrics.model.assign(record.model, record.model_length);
+    metrics.total_ms = record.total_ms;
+    metrics.model_ms = record.model_ms;
+    metrics.first_byte_ms = record.first_byte_ms;
+    metrics.input_tokens = record.input_tokens;
+    metrics.output_tokens = record.output_tokens;
+    metrics.cached_tokens = record.cached_tokens;
+    metrics.cache_hit = record.flags & FLAG_CACHE_HIT;
+    metrics.error = record.flags & FLAG_ERROR;
+    return metrics;
+}
+
+void readFile(const std::string& path, int64_t since_ms, std::vector<RequestMetrics>& out) {
+    std::ifstream file(path, std::ios::binary);
+    Record record;
+    // A trailing partial record (a write cut short) fails the read and ends the loop
+    while (file.read(reinterpret_cast<char*>(&record), sizeof(record))) {
+        if (record.time_ms < since_ms) continue;
+        if (auto metrics = decode(record)) out.push_back(std::move(*metrics));
+    }
+}
+
+// Nearest rank over sorted values
+double percentile(const std::vector<double>& sorted, double p) {
+    if (sorted.empty()) return 0;
+    size_t rank = static_cast<size_t>(std::ceil(p * static_cast<double>(sorted.size())));
+    return sorted[std::clamp<size_t>(rank, 1, sorted.size()) - 1];
+}
+
+void add(MetricsGroup& group, const RequestMetrics& metrics) {
+    group.requests++;
+    group.errors += metrics.error;
+    group.cache_hits += metrics.cache_hit;
+    group.total_ms += metrics.total_ms;
+    group.model_ms += metrics.model_ms;
+    group.input_tokens += metrics.input_tokens;
+    group.output_tokens += metrics.output_tokens;
+    group.cached_tokens += metrics.cached_tokens;
+}
+
+void setPercentiles(MetricsGroup& group, std::vector<double>& latencies) {
+    std::sort(latencies.begin(), latencies.end());
+    group.p50_ms = percentile(latencies, 0.50);
+    group.p95_ms = percentile(latencies, 0.95);
+    group.p99_ms = percentile(latencies, 0.99);
+}
+
+std::string labelValue(std::string_view value) {
+    std::string out;
+    for (char c : value) {
+        if (c == '\\' || c == '"') out += '\\';
+        if (c == '\n') {
+            out += "\\n";
+            continue;
+        }
+        out += c;
+    }
+    return out;
+}
+
+std::string number(double value) {
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%.6g", value);
+    return buffer;
+}
+
+} // anonymous namespace
+
+std::string_view toString(RequestMode mode) {
+    switch (mode) {
+        case RequestMode::QUERY: return "query";
+        case RequestMode::RUN: return "run";
+        case RequestMode::EXPLAIN: return "explain";
+        case RequestMode::ELI5: return "eli5";
+        case RequestMode::WHATIF: return "whatif";
+        case RequestMode::CONSOLE: return "console";
+    }
+    return "unknown";
+}
+
+MetricsStore::MetricsStore(const std::string& path)
+    : path_(path.empty() ? getDefaultPath() : path) {}
+
+std::string MetricsStore::getDefaultPath() {
+    const char* home = std::getenv("HOME");
+    if (!home) return "";
+    return std::string(home) + "/.tt/metrics.bin";
+}
+
+bool MetricsStore::append(const RequestMetrics& metrics) {
+    if (path_.empty()) return false;
+    std::error_code ec;
+    std::filesystem::create_directories(std::filesystem::path(path_).parent_path(), ec);
+
+    struct stat st {};
+    if (::stat(path_.c_str(), &st) == 0 && static_cast<size_t>(st.st_size) >= MAX_FILE_BYTES) {
+        // Another process may have rotated it first; then this rename fails harmlessly
+        std::rename(path_.c_str(), (path_ + ".1").c_str());
+    }
+
+    int fd = ::open(path_.c_str(), O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0600);
+    if (fd < 0) return false;
+    Record record = encode(metrics);
+    bool ok = ::write(fd, &record, sizeof(record)) == static_cast<ssize_t>(sizeof(record));
+    ::close(fd);
+    return ok;
+}
+
+std::vector<RequestMetrics> MetricsStore::read(std::chrono::system_clock::time_point since) const {
+    std::vector<RequestMetrics> out;
+    if (path_.empty()) return out;
+    int64_t since_ms = std::chrono::duration_cast<std::chrono::milliseconds>(since.time_since_epoch()).count();
+    readFile(path_ + ".1", since_ms, out);
+    readFile(path_, since_ms, out);
+    return out;
+}
+
+void MetricsStore::clear() {
+    if (path_.empty()) return;
+    std::error_code ec;
+    std::filesystem::remove(path_, ec);
+    std::filesystem::remove(path_ + ".1", ec);
+}
+
+MetricsReport summarize(const std::vector<RequestMetrics>& records) {
+    using Key = std::tuple<uint8_t, std::string>;
+    std::map<Key, std::pair<MetricsGroup, std::vector<double>>> groups;
+    std::vector<double> all_latencies;
+    MetricsReport report;
+
+    for (const auto& metrics : records) {
+        auto& [group, latencies] = groups[Key{static_cast<uint8_t>(metrics.mode), metrics.model}];
+        group.mode = metrics.mode;
+        group.model = metrics.model;
+        add(group, metrics);
+        latencies.push_back(metrics.total_ms);
+        add(report.all, metrics);
+        all_latencies.push_back(metrics.total_ms);
+    }
+
+    for (auto& [key, entry] : groups) {
+        setPercentiles(entry.first, entry.second);
+        report.groups.push_back(std::move(entry.first));
+    }
+    setPercentiles(report.all, all_latencies);
+    return report;
+}
+
+std::string toPrometheus(const MetricsReport& report) {
+    std::string out;
+    auto family = [&](const char* name, const char* help, auto&& value_of) {
+        out += "# HELP ";
+        out += name;
+        out += " ";
+        out += help;
+        out += "\n# TYPE ";
+        out += name;
+        out += " gauge\n";
+        for (const auto& group : report.groups) {
+            std::string labels = "mode=\"" + std::string(toString(group.mode)) + "\",model=\"" +
+                                 labelValue(group.model) + "\"";
+            value_of(group, [&](const std::string& extra, double value) {
+                out += name;
+                out += "{" + labels + extra + "} " + number(value) + "\n";
+            });
+        }
+    };
+
+    family("tt_requests", "Requests in the window", [](const MetricsGroup& g, auto&& emit) {
+        emit("", static_cast<double>(g.requests));
+    });
+    family("tt_request_errors", "Requests that failed in the window", [](const MetricsGroup& g, auto&& emit) {
+        emit("", static_cast<double>(g.errors));
+    });
+    family("tt_cache_hits", "Requests answered from a local cache in the window",
+           [](const MetricsGroup& g, auto&& emit) { emit("", static_cast<double>(g.cache_hits)); });
+    family("tt_request_latency_seconds", "Request latency percentiles in the window",
+           [](const MetricsGroup& g, auto&& emit) {
+               emit(",quantile=\"0.5\"", g.p50_ms / 1000);
+               emit(",quantile=\"0.95\"", g.p95_ms / 1000);
+               emit(",quantile=\"0.99\"", g.p99_ms / 1000);
+           });
+    family("tt_model_seconds", "Time spent waiting on the API in the window",
+           [](const MetricsGroup& g, auto&& emit) { emit("", g.model_ms / 1000); });
+    family("tt_tokens", "Tokens spent in the window", [](const MetricsGroup& g, auto&& emit) {
+        emit(",type=\"input\"", static_cast<double>(g.input_tokens));
+        emit(",type=\"cached\"", static_cast<double>(g.cached_tokens));
+        emit(",type=\"output\"", static_cast<double>(g.output_tokens));
+    });
+    return out;
+}
+
+std::optional<std::chrono::seconds> parseWindow(std::string_view text) {
+    if (text == "all") return std::chrono::seconds(0);
+    if (text.size() < 2) return std::nullopt;
+    int64_t unit = 0;
+    switch (text.back()) {
+        case 'm': unit = 60; break;
+        case 'h': unit = 3600; break;
+        case 'd': unit = 86400; break;
+        case 'w': unit = 7 * 86400; break;
+        default: return std::nullopt;
+    }
+    int64_t count = 0;
+    for (char c : text.substr(0, text.size() - 1)) {
+        if (c < '0' || c > '9' || count > 1000000) return std::nullopt;
+        count = count * 10 + (c - '0');
+    }
+    if (count == 0) return std::nullopt;
+    return std::chrono::seconds(count * unit);
+}
+
+} // namespace tt
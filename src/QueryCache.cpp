@@ -0,0 +1,491 @@
+/**
+ * QueryCache.cpp - Near-duplicate cache for --run tasks
+ *
+ * Queries are reduced to a set of canonical terms (case and accent folded,
+ * stopwords dropped, common pt/en/es task words mapped to one concept) plus
+ * an ordered list of literal operands (paths, numbers, globs). Words that
+ * change a task's scope ("all", "old", "only", "except") are kept as
+ * qualifiers. An entry hits when literals and qualifiers are identical and
+ * the Jaccard similarity of the term sets reaches the threshold; a command
+ * that needs more than a LOW risk rating only comes back for the same term
+ * set. A 64-bit SimHash of the terms is kept per entry as a cheap
+ * prefilter before the exact set comparison.
+ *
+ * Each entry also carries the 128-bit key of its normalized text
+ * (QueryNormalizer), which is checked first: rewordings that only differ in
+ * case, punctuation or filler phrases hit exactly, including queries that
+ * have no canonical terms at all ("ls -la ~/src").
+ */
+
+#include "tt/QueryCache.hpp"
+#include "tt/CaseFold.hpp"
+#include "tt/DangerCheck.hpp"
+#include "tt/QueryNormalizer.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include <unistd.h>
+
+#include <nlohmann/json.hpp>
+
+using json = nlohmann::json;
+
+namespace tt {
+
+static const size_t MAX_ENTRIES = 500;
+static const int SIMHASH_MAX_DISTANCE = 24;
+
+namespace {
+
+uint64_t fnv1a(std::string_view s) {
+    uint64_t h = 0xcbf29ce484222325ULL;
+    for (unsigned char c : s) {
+        h ^= c;
+        h *= 0x100000001b3ULL;
+    }
+    return h;
+}
+
+const std::unordered_set<std::string_view> STOPWORDS = {
+    // en
+    "the", "a", "an", "here", "this", "that", "these", "those", "in", "on", "of", "to",
+    "for", "me", "my", "i", "please", "how", "do", "can", "could", "what", "is",
+    "are", "with", "from", "by", "and", "some", "current", "now", "just",
+    // pt
+    "o", "os", "as", "um", "uma", "de", "do", "da", "dos", "das", "no", "na", "nos",
+    "nas", "em", "aqui", "para", "pra", "por", "favor", "meu", "minha", "meus", "minhas",
+    "eu", "como", "que", "e", "com", "posso", "quero", "esse", "essa",
+    "este", "esta", "atual", "agora",
+    // es
+    "el", "la", "los", "las", "una", "del", "aqui", "mi", "mis", "yo", "y", "con",
+    "puedo", "quiero", "ese", "esa", "este", "esta", "actual", "ahora"
+};
+
+// Common task vocabulary mapped to one concept across pt/en/es
+const std::unordered_map<std::string_view, std::string_view> SYNONYMS = {
+    {"find", "find"}, {"search", "find"}, {"locate", "find"}, {"achar", "find"},
+    {"encontrar", "find"}, {"encontre", "find"}, {"procurar", "find"}, {"buscar", "find"},
+    {"ache", "find"}, {"busca", "find"}, {"busque", "find"},
+    {"big", "large"}, {"bigger", "large"}, {"biggest", "large"}, {"large", "large"},
+    {"larger", "large"}, {"largest", "large"}, {"huge", "large"}, {"maior", "large"},
+    {"maiores", "large"}, {"grande", "large"}, {"grandes", "large"}, {"mayor", "large"},
+    {"mayores", "large"},
+    {"small", "small"}, {"smaller", "small"}, {"smallest", "small"}, {"menor", "small"},
+    {"menores", "small"}, {"pequeno", "small"}, {"pequenos", "small"},
+    {"file", "file"}, {"files", "file"}, {"arquivo", "file"}, {"arquivos", "file"},
+    {"archivo", "file"}, {"archivos", "file"},
+    {"directory", "dir"}, {"directories", "dir"}, {"dir", "dir"}, {"dirs", "dir"},
+    {"folder", "dir"}, {"folders", "dir"}, {"pasta", "dir"}, {"pastas", "dir"},
+    {"diretorio", "dir"}, {"diretorios", "dir"}, {"carpeta", "dir"}, {"carpetas", "dir"},
+    {"directorio", "dir"}, {"directorios", "dir"},
+    {"list", "list"}, {"listar", "list"}, {"liste", "list"}, {"lista", "list"},
+    {"show", "list"}, {"display", "list"}, {"mostrar", "list"}, {"mostre", "list"},
+    {"mostra", "list"}, {"exibir", "list"}, {"ver", "list"},
+    {"delete", "delete"}, {"remove", "delete"}, {"erase", "delete"}, {"apagar", "delete"},
+    {"apague", "delete"}, {"remover", "delete"}, {"remova", "delete"}, {"deletar", "delete"},
+    {"borrar", "delete"}, {"eliminar", "delete"},
+    {"count", "count"}, {"contar", "count"}, {"conte", "count"}, {"quantos", "count"},
+    {"cuantos", "count"},
+    {"process", "process"}, {"processes", "process"}, {"processo", "process"},
+    {"processos", "process"}, {"proceso", "process"}, {"procesos", "process"},
+    {"disk", "disk"}, {"disco", "disk"}, {"space", "space"}, {"espaco", "space"},
+    {"espacio", "space"}, {"usage", "usage"}, {"uso", "usage"},
+    {"hidden", "hidden"}, {"oculto", "hidden"}, {"ocultos", "hidden"},
+    {"escondido", "hidden"}, {"escondidos", "hidden"},
+    {"recent", "recent"}, {"newest", "recent"}, {"latest", "recent"},
+    {"recentes", "recent"}, {"recientes", "recent"},
+    {"memory", "memory"}, {"memoria", "memory"}, {"ram", "memory"},
+    {"port", "port"}, {"ports", "port"}, {"porta", "port"}, {"portas", "port"},
+    {"puerto", "port"}, {"puertos", "port"},
+    {"size", "size"}, {"tamanho", "size"}, {"tamano", "size"}
+};
+
+// Words that change which things a task touches, mapped to one qualifier
+// across pt/en/es. They count as terms and must also match exactly:
+// "delete old log files" is not "delete log files"
+const std::unordered_map<std::string_view, std::string_view> QUALIFIERS = {
+    {"all", "all"}, {"every", "all"}, {"each", "all"}, {"any", "all"}, {"everything", "all"},
+    {"todo", "all"}, {"toda", "all"}, {"todos", "all"}, {"todas", "all"}, {"cada", "all"},
+    {"qualquer", "all"}, {"tudo", "all"},
+    {"only", "only"}, {"apenas", "only"}, {"somente", "only"}, {"so", "only"},
+    {"solo", "only"}, {"solamente", "only"},
+    {"old", "old"}, {"older", "old"}, {"oldest", "old"}, {"stale", "old"},
+    {"antigo", "old"}, {"antigos", "old"}, {"antiga", "old"}, {"antigas", "old"},
+    {"velho", "old"}, {"velhos", "old"}, {"velha", "old"}, {"velhas", "old"},
+    {"viejo", "old"}, {"viejos", "old"}, {"vieja", "old"}, {"viejas", "old"},
+    {"antiguo", "old"}, {"antiguos", "old"},
+    {"new", "new"}, {"newer", "new"}, {"novo", "new"}, {"novos", "new"}, {"nova", "new"},
+    {"novas", "new"}, {"nuevo", "new"}, {"nuevos", "new"}, {"nueva", "new"}, {"nuevas", "new"},
+    {"recursive", "recursive"}, {"recursively", "recursive"}, {"recursivo", "recursive"},
+    {"recursivamente", "recursive"},
+    {"empty", "empty"}, {"vazio", "empty"}, {"vazios", "empty"}, {"vazia", "empty"},
+    {"vazias", "empty"}, {"vacio", "empty"}, {"vacios", "empty"},
+    {"not", "not"}, {"except", "not"}, {"excluding", "not"}, {"without", "not"},
+    {"nao", "not"}, {"exceto", "not"}, {"sem", "not"}, {"excepto", "not"}, {"sin", "not"}
+};
+
+struct Fingerprint {
+    std::vector<uint64_t> terms;               // Sorted, unique term hashes
+    std::vector<std::string> literals;         // Operands that must match verbatim
+    std::vector<std::string_view> qualifiers;  // Sorted, unique scope words (QUALIFIERS)
+    uint64_t simhash = 0;
+    QueryKey key;                              // Hash of the normalized query
+    bool blank = true;                         // Nothing left after normalization
+};
+
+bool isLiteral(std::string_view token) {
+    if (token.front() == '-' || token.front() == '~') return true;
+    for (char c : token) {
+        if ((c >= '0' && c <= '9') || c == '/' || c == '.' || c == '*' ||
+            c == '_' || c == '=' || c == '$') {
+            return true;
+        }
+    }
+    return false;
+}
+
+std::string foldWord(std::string_view word) {
+    std::string out;
+    out.reserve(word.size());
+    for (size_t i = 0; i < word.size();) {
+        FoldedLetter folded = foldLetter(word, i);
+        out += folded.letter ? folded.letter : word[i];
+        i += folded.length;
+    }
+    return out;
+}
+
+std::string_view canonicalTerm(const std::string& word) {
+    auto it = SYNONYMS.find(word);
+    if (it != SYNONYMS.end()) return it->second;
+
+    // Light plural stripping for words outside the lexicon
+    if (word.size() > 3 && word.back() == 's' && word[word.size() - 2] != 's') {
+        std::string_view singular(word.data(), word.size() - 1);
+        auto sit = SYNONYMS.find(singular);
+        if (sit != SYNONYMS.end()) return sit->second;
+        return singular;
+    }
+    return word;
+}
+
+Fingerprint fingerprint(const std::string& query) {
+    Fingerprint fp;
+    int weights[64] = {0};
+
+    std::string normalized;
+    normalizeQuery(query, normalized);
+    fp.blank = normalized.empty();
+    fp.key = normalizedKey(normalized);
+
+    size_t i = 0;
+    while (i < query.size()) {
+        // Quoted text is always a literal operand
+        if (query[i] == '"' || query[i] == '\'') {
+            char quote = query[i];
+            size_t end = query.find(quote, i + 1);
+            if (end == std::string::npos) end = query.size();
+            fp.literals.emplace_back(query, i + 1, end - i - 1);
+            i = end + 1;
+            continue;
+        }
+
+        size_t end = query.find_first_of(" \t\n\r,;:!?()\"'", i);
+        if (end == std::string::npos) end = query.size();
+        std::string_view token(query.data() + i, end - i);
+        i = end + 1;
+
+        // Trailing sentence punctuation is not part of a path
+        while (!token.empty() && token.back() == '.') token.remove_suffix(1);
+        if (token.empty()) continue;
+
+        if (isLiteral(token)) {
+            fp.literals.emplace_back(token);
+            continue;
+        }
+
+        std::string word = foldWord(token);
+        if (STOPWORDS.count(word)) continue;
+
+        if (auto qualifier = QUALIFIERS.find(word); qualifier != QUALIFIERS.end()) {
+            fp.qualifiers.push_back(qualifier->second);
+            fp.terms.push_back(fnv1a(qualifier->second));
+            continue;
+        }
+
+        uint64_t h = fnv1a(canonicalTerm(word));
+        fp.terms.push_back(h);
+    }
+
+    std::sort(fp.terms.begin(), fp.terms.end());
+    fp.terms.erase(std::unique(fp.terms.begin(), fp.terms.end()), fp.terms.end());
+    std::sort(fp.qualifiers.begin(), fp.qualifiers.end());
+    fp.qualifiers.erase(std::unique(fp.qualifiers.begin(), fp.qualifiers.end()), fp.qualifiers.end());
+
+    for (uint64_t h : fp.terms) {
+        for (int bit = 0; bit < 64; ++bit) {
+            weights[bit] += ((h >> bit) & 1) ? 1 : -1;
+        }
+    }
+    for (int bit = 0; bit < 64; ++bit) {
+        if (weights[bit] > 0) fp.simhash |= (1ULL << bit);
+    }
+
+    return fp;
+}
+
+double jaccard(const std::vector<uint64_t>& a, const std::vector<uint64_t>& b) {
+    if (a.empty() && b.empty()) return 0.0;
+    size_t common = 0;
+    auto ia = a.begin();
+    auto ib = b.begin();
+    while (ia != a.end() && ib != b.end()) {
+        if (*ia < *ib) {
+            ++ia;
+        } else if (*ib < *ia) {
+            ++ib;
+        } else {
+            ++common;
+            ++ia;
+            ++ib;
+        }
+    }
+    return static_cast<double>(common) / static_cast<double>(a.size() + b.size() - common);
+}
+
+int64_t nowSeconds() {
+    return std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+} // anonymous namespace
+
+struct QueryCache::Impl {
+    struct Entry {
+        std::string query;
+        std::string command;
+        std::string explanation;
+        int64_t last_used = 0;
+        uint64_t hits = 0;
+        Fingerprint fp;
+    };
+
+    std::string path;
+    double threshold;
+    bool loaded = false;
+    std::vector<Entry> entries;
+    QueryCacheStats stats;
+
+    Impl(const std::string& cache_path, double similarity_threshold)
+        : path(cache_path.empty() ? QueryCache::getDefaultPath() : cache_path),
+          threshold(similarity_threshold) {}
+
+    void load() {
+        if (loaded) return;
+        loaded = true;
+        if (path.empty()) return;
+
+        std::ifstream file(path);
+        if (!file.good()) return;
+
+        try {
+            json data;
+            file >> data;
+            if (data.contains("stats")) {
+                const auto& s = data["stats"];
+                stats.lookups = s.value("lookups", uint64_t{0});
+                stats.hits = s.value("hits", uint64_t{0});
+                stats.exact_hits = s.value("exact_hits", uint64_t{0});
+                stats.similarity_sum = s.value("similarity_sum", 0.0);
+            }
+            for (const auto& e : data.value("entries", json::array())) {
+                Entry entry;
+                entry.query = e.value("query", "");
+                entry.command = e.value("command", "");
+                entry.explanation = e.value("explanation", "");
+                entry.last_used = e.value("last_used", int64_t{0});
+                entry.hits = e.value("hits", uint64_t{0});
+                if (entry.query.empty() || entry.command.empty()) continue;
+                entry.fp = fingerprint(entry.query);
+                entries.push_back(std::move(entry));
+            }
+        } catch (...) {
+            entries.clear();
+            stats = QueryCacheStats{};
+        }
+    }
+
+    void save() {
+        if (path.empty()) return;
+
+        json data;
+        data["version"] = 1;
+        data["stats"] = {
+            {"lookups", stats.lookups},
+            {"hits", stats.hits},
+            {"exact_hits", stats.exact_hits},
+            {"similarity_sum", stats.similarity_sum}
+        };
+        json list = json::array();
+        for (const auto& e : entries) {
+            list.push_back({
+                {"query", e.query},
+                {"command", e.command},
+                {"explanation", e.explanation},
+                {"last_used", e.last_used},
+                {"hits", e.hits}
+            });
+        }
+        data["entries"] = std::move(list);
+
+        // Written aside and renamed over the cache, so a crash or a
+        // concurrent tt never leaves a truncated file behind
+        std::error_code ec;
+        std::filesystem::create_directories(std::filesystem::path(path).parent_path(), ec);
+        std::string partial = path + ".tmp" + std::to_string(getpid());
+        {
+            std::ofstream file(partial);
+            if (!file.good()) return;
+            std::filesystem::permissions(partial,
+                std::filesystem::perms::owner_read | std::filesystem::perms::owner_write,
+                std::filesystem::perm_options::replace, ec);
+            file << data.dump();
+            if (!file) {
+                file.close();
+                std::filesystem::remove(partial, ec);
+                return;
+            }
+        }
+        if (std::rename(partial.c_str(), path.c_str()) != 0) {
+            std::filesystem::remove(partial, ec);
+        }
+    }
+};
+
+QueryCache::QueryCache(const std::string& path, double threshold)
+    : impl_(std::make_unique<Impl>(path, threshold)) {}
+
+QueryCache::~QueryCache() = default;
+
+std::string QueryCache::getDefaultPath() {
+    const char* home = std::getenv("HOME");
+    if (!home) return "";
+    return std::string(home) + "/.tt/query_cache.json";
+}
+
+std::optional<CacheHit> QueryCache::lookup(const std::string& query) {
+    impl_->load();
+    impl_->stats.lookups++;
+
+    Fingerprint fp = fingerprint(query);
+    Impl::Entry* best = nullptr;
+    double best_similarity = 0.0;
+
+    // Same normalized text: exact, whatever the term sets say
+    if (!fp.blank) {
+        for (auto& entry : impl_->entries) {
+            if (entry.fp.key == fp.key) {
+                best = &entry;
+                best_similarity = 1.0;
+                break;
+            }
+        }
+    }
+
+    if (!best && !fp.terms.empty()) {
+        for (auto& entry : impl_->entries) {
+            if (std::popcount(fp.simhash ^ entry.fp.simhash) > SIMHASH_MAX_DISTANCE) continue;
+            if (entry.fp.literals != fp.literals || entry.fp.qualifiers != fp.qualifiers) continue;
+
+            double similarity = jaccard(fp.terms, entry.fp.terms);
+            if (similarity > best_similarity) {
+                best_similarity = similarity;
+                best = &entry;
+            }
+        }
+    }
+
+    // Misses are counted in memory and written with the next store or hit
+    if (!best || best_similarity < impl_->threshold) {
+        return std::nullopt;
+    }
+
+    // A reworded task may aim a destructive command at other things
+    if (best_similarity < 1.0 && assessRisk(best->command).severity > Severity::LOW) {
+        return std::nullopt;
+    }
+
+    best->last_used = nowSeconds();
+    best->hits++;
+
+    CacheHit hit;
+    hit.command = best->command;
+    hit.explanation = best->explanation;
+    hit.matched_query = best->query;
+    hit.similarity = best_similarity;
+    hit.exact = best_similarity >= 1.0;
+
+    impl_->stats.hits++;
+    if (hit.exact) impl_->stats.exact_hits++;
+    impl_->stats.similarity_sum += best_similarity;
+    impl_->save();
+
+    return hit;
+}
+
+void QueryCache::store(const std::string& query, const std::string& command, const std::string& explanation) {
+    impl_->load();
+
+    Fingerprint fp = fingerprint(query);
+    if (fp.blank || command.empty()) return;
+
+    auto& entries = impl_->entries;
+
+    // Replace an entry with the same normalized form
+    entries.erase(std::remove_if(entries.begin(), entries.end(), [&](const Impl::Entry& e) {
+        return e.fp.key == fp.key || (!fp.terms.empty() && e.fp.terms == fp.terms && e.fp.literals == fp.literals);
+    }), entries.end());
+
+    // Evict least recently used entries
+    while (entries.size() >= MAX_ENTRIES) {
+        auto oldest = std::min_element(entries.begin(), entries.end(),
+            [](const Impl::Entry& a, const Impl::Entry& b) { return a.last_used < b.last_used; });
+        entries.erase(oldest);
+    }
+
+    Impl::Entry entry;
+    entry.query = query;
+    entry.command = command;
+    entry.explanation = explanation;
+    entry.last_used = nowSeconds();
+    entry.fp = std::move(fp);
+    entries.push_back(std::move(entry));
+
+    impl_->save();
+}
+
+void QueryCache::clear() {
+    impl_->loaded = true;
+    impl_->entries.clear();
+    impl_->stats = QueryCacheStats{};
+    impl_->save();
+}
+
+QueryCacheStats QueryCache::stats() const {
+    impl_->load();
+    QueryCacheStats result = impl_->stats;
+    result.entries = impl_->entries.size();
+    return result;
+}
+
+} // namespace tt
@@ -0,0 +1,310 @@
+/**
+ * QueryNormalizer.cpp - Canonical text and stable keys for natural-language queries
+ */
+
+#include "tt/QueryNormalizer.hpp"
+#include "tt/CaseFold.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <iterator>
+
+namespace tt {
+
+namespace {
+
+// Leading filler phrases, case folded. The longest match wins, so
+// "como faço para" is stripped whole rather than as "como".
+constexpr std::string_view PREFIXES[] = {
+    // en
+    "please", "can you", "could you", "tell me how to", "show me how to",
+    "how do i", "how can i", "how do you", "how to", "what does", "what is the command to",
+    "what's the command to", "explain", "i want to", "i need to",
+    // pt
+    "por favor", "como", "como eu", "como posso", "como faço", "como faço para",
+    "como faço pra", "como faco", "como faco para", "como faco pra", "como eu faço para",
+    "o que faz", "o que é", "o que e", "me explica", "me explique", "explique", "explica",
+    "você pode", "voce pode", "eu quero", "quero", "preciso",
+    // es
+    "cómo", "cómo puedo", "como puedo", "cómo hago para", "qué hace", "que hace",
+    "explícame", "explicame", "puedes", "quiero", "necesito"
+};
+
+static_assert(std::size(PREFIXES) <= 64, "prefix sets are 64-bit masks");
+
+// Prefixes by first byte, so a scan only compares plausible candidates
+constexpr auto PREFIXES_BY_BYTE = [] {
+    std::array<uint64_t, 256> masks{};
+    for (size_t i = 0; i < std::size(PREFIXES); ++i) {
+        masks[static_cast<unsigned char>(PREFIXES[i][0])] |= uint64_t{1} << i;
+    }
+    return masks;
+}();
+
+// Latin-1 results of a lowercase ASCII base followed by a combining mark
+// U+03xx, encoded as the second UTF-8 byte of the mark (0xCC xx)
+struct Composition {
+    unsigned char mark;
+    std::string_view bases;
+    unsigned char composed[6];
+};
+
+constexpr Composition COMPOSITIONS[] = {
+    {0x80, "aeiou",  {0xE0, 0xE8, 0xEC, 0xF2, 0xF9}},        // grave
+    {0x81, "aeiouy", {0xE1, 0xE9, 0xED, 0xF3, 0xFA, 0xFD}},  // acute
+    {0x82, "aeiou",  {0xE2, 0xEA, 0xEE, 0xF4, 0xFB}},        // circumflex
+    {0x83, "ano",    {0xE3, 0xF1, 0xF5}},                    // tilde
+    {0x88, "aeiouy", {0xE4, 0xEB, 0xEF, 0xF6, 0xFC, 0xFF}},  // diaeresis
+    {0xA7, "c",      {0xE7}},                                // cedilla
+};
+
+bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v';
+}
+
+// Codepoint U+00xx composed from base + mark, or 0
+unsigned char compose(char base, unsigned char mark) {
+    for (const auto& entry : COMPOSITIONS) {
+        if (entry.mark != mark) continue;
+        size_t i = entry.bases.find(base);
+        return i == std::string_view::npos ? 0 : entry.composed[i];
+    }
+    return 0;
+}
+
+// Writes a word in NFC, case folded; never longer than the input
+char* foldWord(std::string_view word, char* out) {
+    char* start = out;
+    bool ascii = true;
+    for (size_t i = 0; i < word.size(); ++i) {
+        auto c = static_cast<unsigned char>(word[i]);
+        if (c < 0x80) {
+            char base = asciiLower(static_cast<char>(c));
+            if (i + 2 < word.size() && static_cast<unsigned char>(word[i + 1]) == 0xCC) {
+                if (unsigned char cp = compose(base, static_cast<unsigned char>(word[i + 2]))) {
+                    *out++ = static_cast<char>(0xC3);
+                    *out++ = static_cast<char>(0x80 | (cp & 0x3F));
+                    i += 2;
+                    continue;
+                }
+            }
+            *out++ = base;
+        } else {
+            *out++ = static_cast<char>(c);
+            ascii = false;
+        }
+    }
+    if (!ascii) foldCaseInPlace(start, static_cast<size_t>(out - start));
+    return out;
+}
+
+// Paths, flags, variables, globs and camelCase names are kept verbatim
+bool isOperand(std::string_view word) {
+    if (word.front() == '-' || word.front() == '~') return true;
+    for (size_t i = 0; i < word.size(); ++i) {
+        char c = word[i];
+        if (c == '/' || c == '.' || c == '$' || c == '=' || c == '*' || c == '\\' || c == '@') return true;
+        if (i > 0 && c >= 'A' && c <= 'Z' && word[i - 1] >= 'a' && word[i - 1] <= 'z') return true;
+    }
+    return false;
+}
+
+std::string_view trimPunctuation(std::string_view word) {
+    for (;;) {
+        if (word.empty()) return word;
+        char c = word.front();
+        if (c == '(' || c == ',' || c == '"' || c == '\'') {
+            word.remove_prefix(1);
+        } else if (word.size() >= 2 && c == '\xC2' && (word[1] == '\xBF' || word[1] == '\xA1')) {
+            word.remove_prefix(2);  // ¿ ¡
+        } else {
+            break;
+        }
+    }
+    while (!word.empty()) {
+        char c = word.back();
+        if (c == '?' || c == '!' || c == ',' || c == ';' || c == ':' || c == ')' || c == '"' || c == '\'') {
+            word.remove_suffix(1);
+        } else if (c == '.' && word.find_first_not_of('.') != std::string_view::npos) {
+            word.remove_suffix(1);  // Sentence end, but "." and ".." are paths
+        } else {
+            break;
+        }
+    }
+    return word;
+}
+
+uint64_t rotl64(uint64_t x, int r) {
+    return (x << r) | (x >> (64 - r));
+}
+
+uint64_t fmix64(uint64_t k) {
+    k ^= k >> 33;
+    k *= 0xff51afd7ed558ccdULL;
+    k ^= k >> 33;
+    k *= 0xc4ceb9fe1a85ec53ULL;
+    k ^= k >> 33;
+    return k;
+}
+
+// Little-endian regardless of the host, so keys can be persisted
+uint64_t load64(const unsigned char* p) {
+    uint64_t v = 0;
+    for (int i = 7; i >= 0; --i) v = (v << 8) | p[i];
+    return v;
+}
+
+QueryKey murmur3_128(std::string_view data, uint64_t seed) noexcept {
+    const auto* bytes = reinterpret_cast<const unsigned char*>(data.data());
+    const size_t len = data.size();
+    const uint64_t c1 = 0x87c37b91114253d5ULL;
+    const uint64_t c2 = 0x4cf5ad432745937fULL;
+    uint64_t h1 = seed;
+    uint64_t h2 = seed;
+
+    size_t blocks = len / 16;
+    for (size_t i = 0; i < blocks; ++i) {
+        uint64_t k1 = load64(bytes + i * 16);
+        uint64_t k2 = load64(bytes + i * 16 + 8);
+
+        k1 *= c1; k1 = rotl64(k1, 31); k1 *= c2; h1 ^= k1;
+        h1 = rotl64(h1, 27); h1 += h2; h1 = h1 * 5 + 0x52dce729;
+        k2 *= c2; k2 = rotl64(k2, 33); k2 *= c1; h2 ^= k2;
+        h2 = rotl64(h2, 31); h2 += h1; h2 = h2 * 5 + 0x38495ab5;
+    }
+
+    const unsigned char* tail = bytes + blocks * 16;
+    size_t rest = len & 15;
+    uint64_t k1 = 0;
+    uint64_t k2 = 0;
+    for (size_t i = rest; i > 8; --i) k2 ^= static_cast<uint64_t>(tail[i - 1]) << ((i - 9) * 8);
+    if (rest > 8) {
+        k2 *= c2; k2 = rotl64(k2, 33); k2 *= c1; h2 ^= k2;
+    }
+    for (size_t i = std::min<size_t>(rest, 8); i > 0; --i) k1 ^= static_cast<uint64_t>(tail[i - 1]) << ((i - 1) * 8);
+    if (rest > 0) {
+        k1 *= c1; k1 = rotl64(k1, 31); k1 *= c2; h1 ^= k1;
+    }
+
+    h1 ^= len;
+    h2 ^= len;
+    h1 += h2;
+    h2 += h1;
+    h1 = fmix64(h1);
+    h2 = fmix64(h2);
+    h1 += h2;
+    h2 += h1;
+    return QueryKey{h2, h1};
+}
+
+} // anonymous namespace
+
+std::string QueryKey::hex() const {
+    static const char DIGITS[] = "0123456789abcdef";
+    std::string out(32, '0');
+    for (int i = 0; i < 16; ++i) {
+        out[15 - i] = DIGITS[(hi >> (i * 4)) & 0xF];
+        out[31 - i] = DIGITS[(lo >> (i * 4)) & 0xF];
+    }
+    return out;
+}
+
+size_t intentPrefixLength(std::string_view folded) noexcept {
+    auto skipSeparators = [&](size_t pos) {
+        for (;;) {
+            if (pos < folded.size() && (isSpace(folded[pos]) || folded[pos] == ',')) {
+                ++pos;
+            } else if (pos + 1 < folded.size() && folded[pos] == '\xC2' &&
+                       (folded[pos + 1] == '\xBF' || folded[pos + 1] == '\xA1')) {
+                pos += 2;  // ¿ ¡
+            } else {
+                return pos;
+            }
+        }
+    };
+
+    size_t pos = skipSeparators(0);
+    size_t start = pos;
+    while (pos < folded.size()) {
+        size_t best = 0;
+        for (uint64_t candidates = PREFIXES_BY_BYTE[static_cast<unsigned char>(folded[pos])]; candidates;
+             candidates &= candidates - 1) {
+            std::string_view prefix = PREFIXES[std::countr_zero(candidates)];
+            if (prefix.size() <= best || folded.substr(pos, prefix.size()) != prefix) continue;
+            size_t end = pos + prefix.size();
+            if (end == folded.size() || isSpace(folded[end]) || folded[end] == ',') best = prefix.size();
+        }
+        if (best == 0) break;
+        pos = skipSeparators(pos + best);
+    }
+
+    if (pos == folded.size()) return 0;
+    return pos == start ? 0 : pos;
+}
+
+void normalizeQuery(std::string_view query, std::string& out) {
+    // Words only shrink; the worst case is back-to-back quoted operands,
+    // which gain a separator ('''' becomes "" "")
+    out.resize(query.size() * 2);
+    char* const begin = out.data();
+    char* cursor = begin;
+
+    size_t i = 0;
+    while (i < query.size()) {
+        if (isSpace(query[i])) {
+            ++i;
+            continue;
+        }
+
+        // Quoted text is one operand, kept verbatim; double quotes unless
+        // the text itself contains one
+        if (query[i] == '"' || query[i] == '\'') {
+            size_t close = query.find(query[i], i + 1);
+            if (close != std::string_view::npos) {
+                std::string_view text = query.substr(i + 1, close - i - 1);
+                if (cursor != begin) *cursor++ = ' ';
+                char quote = text.find('"') == std::string_view::npos ? '"' : '\'';
+                *cursor++ = quote;
+                cursor = std::copy(text.begin(), text.end(), cursor);
+                *cursor++ = quote;
+                i = close + 1;
+                continue;
+            }
+        }
+
+        size_t end = i;
+        while (end < query.size() && !isSpace(query[end])) ++end;
+        std::string_view word = trimPunctuation(query.substr(i, end - i));
+        i = end;
+        if (word.empty()) continue;
+
+        if (cursor != begin) *cursor++ = ' ';
+        if (isOperand(word)) {
+            cursor = std::copy(word.begin(), word.end(), cursor);
+        } else {
+            cursor = foldWord(word, cursor);
+        }
+    }
+
+    out.resize(static_cast<size_t>(cursor - begin));
+    out.erase(0, intentPrefixLength(out));
+}
+
+std::string normalizeQuery(std::string_view query) {
+    std::string out;
+    normalizeQuery(query, out);
+    return out;
+}
+
+QueryKey queryKey(std::string_view query) {
+    thread_local std::string scratch;
+    normalizeQuery(query, scratch);
+    return normalizedKey(scratch);
+}
+
+QueryKey normalizedKey(std::string_view normalized) noexcept {
+    return murmur3_128(normalized, 0);
+}
+
+} // namespace tt
@@ -0,0 +1,216 @@
+/**
+ * QuestionClassifier.cpp - Tell natural-language questions from shell commands
+ */
+
+#include "tt/QuestionClassifier.hpp"
+#include "tt/CaseFold.hpp"
+
+#include <array>
+#include <cstdint>
+
+namespace tt {
+
+namespace {
+
+enum KeywordRole : uint8_t {
+    ANYWHERE  = 1 << 0,  // Interrogative: a question wherever it appears
+    LEADING   = 1 << 1,  // Imperative or auxiliary: only as the first word
+    FILLER    = 1 << 2,  // Courtesy words allowed before a LEADING word
+    QUE_HEAD  = 1 << 3,  // Turns a following "que" into a question (o que, por que)
+    QUE       = 1 << 4   // "que"/"qué": a question after QUE_HEAD or as the first word
+};
+
+struct Keyword {
+    std::string_view word;  // Lowercase ASCII, accents folded
+    uint8_t roles;
+};
+
+constexpr Keyword KEYWORDS[] = {
+    // en
+    {"what", ANYWHERE}, {"how", ANYWHERE}, {"why", ANYWHERE}, {"where", ANYWHERE},
+    {"when", ANYWHERE}, {"explain", ANYWHERE},
+    {"show", LEADING}, {"tell", LEADING}, {"describe", LEADING},
+    {"is", LEADING}, {"are", LEADING}, {"do", LEADING}, {"does", LEADING},
+    {"can", LEADING}, {"could", LEADING}, {"should", LEADING},
+    {"please", FILLER}, {"hey", FILLER},
+    // pt
+    {"como", ANYWHERE}, {"quando", ANYWHERE}, {"onde", ANYWHERE}, {"qual", ANYWHERE},
+    {"quais", ANYWHERE}, {"porque", ANYWHERE}, {"quanto", ANYWHERE}, {"quantos", ANYWHERE},
+    {"quantas", ANYWHERE}, {"explique", ANYWHERE}, {"explica", ANYWHERE},
+    {"mostre", LEADING}, {"mostra", LEADING}, {"diga", LEADING}, {"descreva", LEADING},
+    {"pode", LEADING}, {"posso", LEADING}, {"existe", LEADING},
+    {"me", FILLER}, {"oi", FILLER}, {"favor", FILLER},
+    {"o", QUE_HEAD}, {"para", QUE_HEAD}, {"pra", QUE_HEAD},
+    {"por", QUE_HEAD | FILLER}, {"que", QUE},
+    // es
+    {"cuando", ANYWHERE}, {"donde", ANYWHERE}, {"cual", ANYWHERE}, {"cuales", ANYWHERE},
+    {"cuanto", ANYWHERE}, {"cuantos", ANYWHERE}, {"cuantas", ANYWHERE},
+    {"explicame", ANYWHERE},
+    {"muestra", LEADING}, {"muestrame", LEADING}, {"dime", LEADING}, {"puedo", LEADING},
+    {"puede", LEADING}, {"hay", LEADING},
+    {"hola", FILLER},
+};
+
+constexpr size_t KEYWORD_COUNT = sizeof(KEYWORDS) / sizeof(KEYWORDS[0]);
+constexpr size_t MAX_KEYWORD_LENGTH = 16;
+
+constexpr uint32_t hashWord(std::string_view word, uint32_t seed) {
+    uint32_t h = 2166136261u ^ seed;
+    for (char c : word) {
+        h ^= static_cast<unsigned char>(c);
+        h *= 16777619u;
+    }
+    return h ^ (h >> 15);
+}
+
+// Collision-free table: the seed is searched at compile time so every
+// keyword owns its slot and a lookup is one hash plus one compare
+struct PerfectHash {
+    static constexpr size_t SIZE = 256;
+    static constexpr uint8_t EMPTY = 0xFF;
+
+    uint32_t seed = 0;
+    std::array<uint8_t, SIZE> slots{};
+
+    constexpr bool build(uint32_t candidate) {
+        seed = candidate;
+        for (auto& slot : slots) slot = EMPTY;
+        for (size_t i = 0; i < KEYWORD_COUNT; ++i) {
+            auto& slot = slots[hashWord(KEYWORDS[i].word, seed) % SIZE];
+            if (slot != EMPTY) return false;
+            slot = static_cast<uint8_t>(i);
+        }
+        return true;
+    }
+
+    constexpr uint8_t roles(std::string_view word) const {
+        uint8_t index = slots[hashWord(word, seed) % SIZE];
+        return (index != EMPTY && KEYWORDS[index].word == word) ? KEYWORDS[index].roles : 0;
+    }
+};
+
+constexpr PerfectHash buildTable() {
+    PerfectHash table;
+    for (uint32_t seed = 0; seed < 100000; ++seed) {
+        if (table.build(seed)) return table;
+    }
+    table.seed = ~0u;
+    return table;
+}
+
+constexpr PerfectHash TABLE = buildTable();
+
+static_assert(TABLE.seed != ~0u, "no collision-free seed for the keyword table");
+static_assert(KEYWORD_COUNT < PerfectHash::EMPTY, "keyword index must fit a slot");
+static_assert(TABLE.roles("somewhat") == 0 && TABLE.roles("what") == ANYWHERE);
+
+constexpr bool validKeywords() {
+    for (const auto& keyword : KEYWORDS) {
+        if (keyword.word.size() > MAX_KEYWORD_LENGTH) return false;
+        for (char c : keyword.word) {
+            if (c < 'a' || c > 'z') return false;
+        }
+    }
+    return true;
+}
+
+static_assert(validKeywords(), "keywords must be folded lowercase ASCII");
+
+bool isAsciiWordChar(unsigned char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+}
+
+// A '?' ends a question when it closes a word, not inside globs like file?.txt
+bool isQuestionMark(std::string_view input, size_t i) {
+    if (i + 1 == input.size()) return true;
+    char next = input[i + 1];
+    return next == ' ' || next == '\t' || next == '\n' || next == '"' || next == '\'' || next == '?';
+}
+
+} // anonymous namespace
+
+bool isQuestion(std::string_view input) noexcept {
+    char word[MAX_KEYWORD_LENGTH];
+    size_t length = 0;
+    bool matchable = true;    // Word so far is foldable and short enough
+    bool leading = true;      // Only FILLER words seen so far
+    bool que_allowed = true;  // "que" here would be a question
+
+    // Flushes the current word; true when it makes the input a question
+    auto finishWord = [&]() {
+        if (length == 0 && matchable) return false;
+        uint8_t roles = matchable ? TABLE.roles(std::string_view(word, length)) : 0;
+        length = 0;
+        matchable = true;
+
+        if (roles & ANYWHERE) return true;
+        if ((roles & LEADING) && leading) return true;
+        if ((roles & QUE) && que_allowed) return true;
+        que_allowed = (roles & QUE_HEAD) != 0;
+        leading = leading && (roles & FILLER) != 0;
+        return false;
+    };
+
+    for (size_t i = 0; i < input.size(); ++i) {
+        unsigned char c = input[i];
+
+        if (isAsciiWordChar(c)) {
+            if (length < MAX_KEYWORD_LENGTH) {
+                word[length++] = asciiLower(static_cast<char>(c));
+            } else {
+                matchable = false;
+            }
+            continue;
+        }
+
+        if (c == 0xC3 && i + 1 < input.size()) {
+            unsigned char next = input[i + 1];
+            char folded = (next >= 0x80 && next <= 0xBF) ? LATIN1_BASE_LETTER[next - 0x80] : 0;
+            if (folded) {
+                if (length < MAX_KEYWORD_LENGTH) word[length++] = folded;
+                else matchable = false;
+                ++i;
+                continue;
+            }
+        }
+
+        // ¿ opens a Spanish question; other Latin-1 punctuation separates words
+        if (c == 0xC2 && i + 1 < input.size()) {
+            if (static_cast<unsigned char>(input[i + 1]) == 0xBF) return true;
+            if (finishWord()) return true;
+            ++i;
+            continue;
+        }
+
+        // Letters outside Latin-1 stay part of the word but never match
+        if (c >= 0x80) {
+            matchable = false;
+            continue;
+        }
+
+        if (c == '?' && isQuestionMark(input, i)) return true;
+        if (finishWord()) return true;
+    }
+
+    return finishWord();
+}
+
+size_t classifyQuestions(std::span<const std::string_view> inputs, std::span<bool> out) noexcept {
+    size_t questions = 0;
+    for (size_t i = 0; i < inputs.size() && i < out.size(); ++i) {
+        out[i] = isQuestion(inputs[i]);
+        questions += out[i];
+    }
+    return questions;
+}
+
+size_t classifyQuestions(std::span<const std::string> inputs, std::span<bool> out) noexcept {
+    size_t questions = 0;
+    for (size_t i = 0; i < inputs.size() && i < out.size(); ++i) {
+        out[i] = isQuestion(inputs[i]);
+        questions += out[i];
+    }
+    return questions;
+}
+
+} // namespace tt
@@ -0,0 +1,702 @@
+/**
+ * ShellAst.cpp - Shell syntax tree built into a per-parse arena
+ *
+ * Recursive descent over ShellLexer tokens. Reserved words of compound
+ * commands (if/then/do/...) are skipped at command position rather than
+ * modeled, so loops and conditionals still expose the commands they run.
+ */
+
+#include "tt/ShellAst.hpp"
+
+#include <cstring>
+#include <string>
+
+namespace tt {
+
+// =============================================================================
+// Arena
+// =============================================================================
+
+Arena::Arena() : cursor_(inline_), limit_(inline_ + INLINE_SIZE) {}
+
+Arena::~Arena() {
+    while (blocks_) {
+        Block* prev = blocks_->prev;
+        delete[] reinterpret_cast<char*>(blocks_);
+        blocks_ = prev;
+    }
+}
+
+void* Arena::allocate(size_t size, size_t align) {
+    auto alignUp = [align](char* p) {
+        auto addr = reinterpret_cast<uintptr_t>(p);
+        return reinterpret_cast<char*>((addr + align - 1) & ~(uintptr_t)(align - 1));
+    };
+
+    char* p = alignUp(cursor_);
+    if (p + size > limit_) {
+        size_t block_size = sizeof(Block) + size + align;
+        if (block_size < BLOCK_SIZE) block_size = BLOCK_SIZE;
+
+        char* raw = new char[block_size];
+        Block* block = reinterpret_cast<Block*>(raw);
+        block->prev = blocks_;
+        block->size = block_size;
+        blocks_ = block;
+
+        cursor_ = raw + sizeof(Block);
+        limit_ = raw + block_size;
+        p = alignUp(cursor_);
+    }
+
+    cursor_ = p + size;
+    used_ += size;
+    return p;
+}
+
+std::string_view Arena::copy(std::string_view text) {
+    if (text.empty()) return {};
+    char* p = static_cast<char*>(allocate(text.size(), 1));
+    std::memcpy(p, text.data(), text.size());
+    return std::string_view(p, text.size());
+}
+
+// =============================================================================
+// Node helpers
+// =============================================================================
+
+bool Redirect::writes() const {
+    switch (op) {
+        case TokenKind::GREAT:
+        case TokenKind::DGREAT:
+        case TokenKind::CLOBBER:
+        case TokenKind::AND_GREAT:
+        case TokenKind::AND_DGREAT:
+        case TokenKind::LESSGREAT:
+            return true;
+        case TokenKind::GREATAND: {
+            // >&2 duplicates a descriptor; >&file (bash) writes a file
+            if (target.text.empty() || target.text == "-") return false;
+            for (char c : target.text) {
+                if (c < '0' || c > '9') return true;
+            }
+            return false;
+        }
+        default:
+            return false;
+    }
+}
+
+std::string_view CommandNode::name() const {
+    if (word_count == 0) return {};
+    std::string_view first = words[0].text;
+    size_t slash = first.rfind('/');
+    if (slash != std::string_view::npos && slash + 1 < first.size()) {
+        first.remove_prefix(slash + 1);
+    }
+    return first;
+}
+
+bool CommandNode::hasShortFlag(char flag) const {
+    for (uint32_t i = 1; i < word_count; ++i) {
+        std::string_view w = words[i].text;
+        if (w == "--") break;
+        if (w.size() < 2 || w[0] != '-' || w[1] == '-') continue;
+        for (size_t j = 1; j < w.size(); ++j) {
+            char c = w[j];
+            bool letter = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+            if (!letter) break;
+            if (c == flag) return true;
+        }
+    }
+    return false;
+}
+
+bool CommandNode::hasLongFlag(std::string_view flag) const {
+    for (uint32_t i = 1; i < word_count; ++i) {
+        std::string_view w = words[i].text;
+        if (w == "--") break;
+        if (w == flag) return true;
+        if (w.size() > flag.size() && w.substr(0, flag.size()) == flag && w[flag.size()] == '=') return true;
+    }
+    return false;
+}
+
+bool CommandNode::hasWord(std::string_view text) const {
+    for (uint32_t i = 1; i < word_count; ++i) {
+        if (words[i].text == text) return true;
+    }
+    return false;
+}
+
+// =============================================================================
+// Walk
+// =============================================================================
+
+static void walkWord(const Word& word, AstVisitor& visitor) {
+    visitor.visitWord(word);
+    for (const Node* sub = word.substitutions; sub; sub = sub->next) {
+        walk(*sub, visitor);
+    }
+}
+
+static void walkRedirects(const Redirect* redirects, uint32_t count, AstVisitor& visitor) {
+    for (uint32_t i = 0; i < count; ++i) {
+        visitor.visitRedirect(redirects[i]);
+        walkWord(redirects[i].target, visitor);
+    }
+}
+
+void walk(const Node& node, AstVisitor& visitor) {
+    switch (node.kind) {
+        case NodeKind::LIST: {
+            const auto& list = static_cast<const ListNode&>(node);
+            visitor.visitList(list);
+            for (uint32_t i = 0; i < list.count; ++i) {
+                walk(*list.items[i].pipeline, visitor);
+            }
+            break;
+        }
+        case NodeKind::PIPELINE: {
+            const auto& pipeline = static_cast<const PipelineNode&>(node);
+            visitor.visitPipeline(pipeline);
+            for (uint32_t i = 0; i < pipeline.count; ++i) {
+                walk(*pipeline.commands[i], visitor);
+            }
+            break;
+        }
+        case NodeKind::COMMAND: {
+            const auto& cmd = static_cast<const CommandNode&>(node);
+            visitor.visitCommand(cmd);
+            // Nested commands share their runner's words; visit those once
+            if (!cmd.runner) {
+                walkRedirects(cmd.redirects, cmd.redirect_count, visitor);
+                for (uint32_t i = 0; i < cmd.assignment_count; ++i) walkWord(cmd.assignments[i], visitor);
+                for (uint32_t i = 0; i < cmd.word_count; ++i) walkWord(cmd.words[i], visitor);
+            }
+            for (const Node* nested = cmd.nested; nested; nested = nested->next) {
+                walk(*nested, visitor);
+            }
+            break;
+        }
+        case NodeKind::SUBSHELL:
+        case NodeKind::GROUP: {
+            const auto& compound = static_cast<const CompoundNode&>(node);
+            visitor.visitCompound(compound);
+            if (compound.body) walk(*compound.body, visitor);
+            walkRedirects(compound.redirects, compound.redirect_count, visitor);
+            break;
+        }
+    }
+}
+
+// =============================================================================
+// Parser
+// =============================================================================
+
+namespace {
+
+const int MAX_DEPTH = 16;
+
+bool isReservedPrefix(std::string_view w) {
+    return w == "if" || w == "then" || w == "else" || w == "elif" || w == "do" ||
+           w == "while" || w == "until" || w == "fi" || w == "done" || w == "esac" ||
+           w == "time" || w == "!";
+}
+
+bool isAssignment(std::string_view w) {
+    size_t eq = w.find('=');
+    if (eq == std::string_view::npos || eq == 0) return false;
+    for (size_t i = 0; i < eq; ++i) {
+        char c = w[i];
+        bool ok = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_' || (i > 0 && c >= '0' && c <= '9');
+        if (!ok) return w[i] == '+' && i + 1 == eq;  // NAME+=value
+    }
+    return true;
+}
+
+bool isShell(std::string_view name) {
+    return name == "sh" || name == "bash" || name == "zsh" || name == "dash" || name == "ksh" ||
+           name == "ash" || name == "busybox";
+}
+
+// Index of the first word after the options of a wrapper command.
+// opts_with_arg lists the short options that consume the following word.
+uint32_t skipOptions(const Word* words, uint32_t count, uint32_t start, std::string_view opts_with_arg) {
+    uint32_t i = start;
+    while (i < count) {
+        std::string_view w = words[i].text;
+        if (w == "--") return i + 1;
+        if (w.size() < 2 || w[0] != '-') return i;
+        if (w[1] != '-' && w.size() == 2 && opts_with_arg.find(w[1]) != std::string_view::npos) {
+            i += 2;
+        } else {
+            ++i;
+        }
+    }
+    return i;
+}
+
+} // anonymous namespace
+
+class ShellParser {
+public:
+    explicit ShellParser(ShellAst& ast) : ast_(ast), arena_(ast.arena_) {}
+
+    ListNode* parseProgram(std::string_view src, int depth) {
+        State st;
+        st.depth = depth;
+
+        ShellLexer lexer(src);
+        for (Token t = lexer.next(); !t.is(TokenKind::END); t = lexer.next()) {
+            if (t.is(TokenKind::HEREDOC)) {
+                st.heredocs.push_back(t.text);
+                if (t.has(TOKEN_UNTERMINATED)) fail("unterminated here-document");
+            } else {
+                st.tokens.push_back(t);
+            }
+        }
+
+        ListNode* list = parseList(st, Closer::NONE);
+        while (!atEnd(st)) {
+            // Stray closers at top level; skip and keep parsing
+            fail("unexpected token");
+            ++st.pos;
+            ListNode* rest = parseList(st, Closer::NONE);
+            list = concat(list, rest);
+        }
+        return list;
+    }
+
+private:
+    enum class Closer { NONE, PAREN, BRACE };
+
+    struct State {
+        TokenList tokens;
+        SmallVector<std::string_view, 4> heredocs;
+        size_t pos = 0;
+        size_t next_heredoc = 0;
+        int depth = 0;
+    };
+
+    ShellAst& ast_;
+    Arena& arena_;
+    std::string scratch_;
+
+    void fail(const char* message) {
+        if (!ast_.error_) ast_.error_ = message;
+    }
+
+    static bool atEnd(const State& st) { return st.pos >= st.tokens.size(); }
+    static const Token& peek(const State& st) { return st.tokens[st.pos]; }
+
+    static bool peekIs(const State& st, TokenKind kind) {
+        return !atEnd(st) && peek(st).kind == kind;
+    }
+
+    static bool peekWord(const State& st, std::string_view text) {
+        return peekIs(st, TokenKind::WORD) && peek(st).text == text;
+    }
+
+    static void skipNewlines(State& st) {
+        while (peekIs(st, TokenKind::NEWLINE)) ++st.pos;
+    }
+
+    static bool atCloser(const State& st, Closer closer) {
+        if (closer == Closer::PAREN) return peekIs(st, TokenKind::RPAREN);
+        if (closer == Closer::BRACE) return peekWord(st, "}");
+        return false;
+    }
+
+    ListNode* concat(ListNode* a, ListNode* b) {
+        SmallVector<ListItem, 8> items;
+        for (uint32_t i = 0; i < a->count; ++i) items.push_back(a->items[i]);
+        for (uint32_t i = 0; i < b->count; ++i) items.push_back(b->items[i]);
+        ListNode* list = arena_.make<ListNode>();
+        list->items = arena_.makeArray(items.begin(), items.size());
+        list->count = static_cast<uint32_t>(items.size());
+        return list;
+    }
+
+    ListNode* parseList(State& st, Closer closer) {
+        SmallVector<ListItem, 8> items;
+
+        while (true) {
+            while (peekIs(st, TokenKind::NEWLINE) || peekIs(st, TokenKind::SEMI)) ++st.pos;
+            if (atEnd(st) || atCloser(st, closer)) break;
+
+            size_t before = st.pos;
+            const PipelineNode* pipeline = parsePipeline(st);
+            if (!pipeline) {
+                if (st.pos != before) continue;  // Only reserved words, e.g. "done"
+                // Operator where a command should start
+                if (peekIs(st, TokenKind::RPAREN) || (closer == Closer::NONE && peekWord(st, "}"))) break;
+                fail("unexpected token");
+                ++st.pos;
+                continue;
+            }
+
+            TokenKind separator = TokenKind::END;
+            if (!atEnd(st)) {
+                TokenKind k = peek(st).kind;
+                if (k == TokenKind::AND_IF || k == TokenKind::OR_IF || k == TokenKind::SEMI ||
+                    k == TokenKind::AMP || k == TokenKind::NEWLINE || k == TokenKind::DSEMI) {
+                    separator = (k == TokenKind::DSEMI) ? TokenKind::SEMI : k;
+                    ++st.pos;
+                }
+            }
+            items.push_back(ListItem{pipeline, separator});
+
+            if (separator == TokenKind::AND_IF || separator == TokenKind::OR_IF) {
+                skipNewlines(st);
+                if (atEnd(st)) fail("missing command after operator");
+            } else if (separator == TokenKind::END) {
+                break;
+            }
+        }
+
+        ListNode* list = arena_.make<ListNode>();
+        list->items = arena_.makeArray(items.begin(), items.size());
+        list->count = static_cast<uint32_t>(items.size());
+        return list;
+    }
+
+    const PipelineNode* parsePipeline(State& st) {
+        bool negated = false;
+        if (peekWord(st, "!")) {
+            negated = true;
+            ++st.pos;
+        }
+
+        SmallVector<const Node*, 8> commands;
+        while (true) {
+            const Node* cmd = parseCommand(st);
+            if (!cmd) {
+                if (!commands.empty()) fail("missing command after pipe");
+                break;
+            }
+            commands.push_back(cmd);
+
+            if (peekIs(st, TokenKind::PIPE) || peekIs(st, TokenKind::PIPE_AND)) {
+                ++st.pos;
+                skipNewlines(st);
+                continue;
+            }
+            break;
+        }
+
+        if (commands.empty()) return nullptr;
+
+        PipelineNode* pipeline = arena_.make<PipelineNode>();
+        pipeline->commands = arena_.makeArray(commands.begin(), commands.size());
+        pipeline->count = static_cast<uint32_t>(commands.size());
+        pipeline->negated = negated;
+        return pipeline;
+    }
+
+    const Node* parseCommand(State& st) {
+        if (atEnd(st)) return nullptr;
+
+        // Function definition: name ( ) compound-command
+        if (peekIs(st, TokenKind::WORD) && st.pos + 2 < st.tokens.size() &&
+            st.tokens[st.pos + 1].is(TokenKind::LPAREN) && st.tokens[st.pos + 2].is(TokenKind::RPAREN)) {
+            std::string_view function_name = arena_.copy(peek(st).text);
+            st.pos += 3;
+            skipNewlines(st);
+            CompoundNode* body = parseCompound(st);
+            if (!body) {
+                fail("missing function body");
+                return nullptr;
+            }
+            body->function_name = function_name;
+            return body;
+        }
+
+        if (peekIs(st, TokenKind::LPAREN) || peekWord(st, "{")) {
+            return parseCompound(st);
+        }
+
+        return parseSimple(st);
+    }
+
+    CompoundNode* parseCompound(State& st) {
+        if (st.depth >= MAX_DEPTH) {
+            fail("nesting too deep");
+            return nullptr;
+        }
+
+        CompoundNode* node;
+        if (peekIs(st, TokenKind::LPAREN)) {
+            ++st.pos;
+            node = arena_.make<CompoundNode>(NodeKind::SUBSHELL);
+            ++st.depth;
+            node->body = parseList(st, Closer::PAREN);
+            --st.depth;
+            if (peekIs(st, TokenKind::RPAREN)) {
+                ++st.pos;
+            } else {
+                fail("missing )");
+            }
+        } else if (peekWord(st, "{")) {
+            ++st.pos;
+            node = arena_.make<CompoundNode>(NodeKind::GROUP);
+            ++st.depth;
+            node->body = parseList(st, Closer::BRACE);
+            --st.depth;
+            if (peekWord(st, "}")) {
+                ++st.pos;
+            } else {
+                fail("missing }");
+            }
+        } else {
+            return nullptr;
+        }
+
+        SmallVector<Redirect, 4> redirects;
+        while (!atEnd(st) && (peek(st).isRedirection() || peekIs(st, TokenKind::IO_NUMBER))) {
+            parseRedirect(st, redirects);
+        }
+        node->redirects = arena_.makeArray(redirects.begin(), redirects.size());
+        node->redirect_count = static_cast<uint32_t>(redirects.size());
+        return node;
+    }
+
+    const CommandNode* parseSimple(State& st) {
+        SmallVector<Word, 4> assignments;
+        SmallVector<Word, 16> words;
+        SmallVector<Redirect, 4> redirects;
+
+        while (!atEnd(st)) {
+            const Token& tok = peek(st);
+
+            if (tok.is(TokenKind::IO_NUMBER) || tok.isRedirection()) {
+                parseRedirect(st, redirects);
+            } else if (tok.is(TokenKind::WORD)) {
+                if (words.empty() && assignments.empty() && isReservedPrefix(tok.text)) {
+                    ++st.pos;
+                    continue;
+                }
+                if (words.empty() && isAssignment(tok.text)) {
+                    assignments.push_back(makeWord(st, tok));
+                } else {
+                    words.push_back(makeWord(st, tok));
+                }
+                ++st.pos;
+            } else {
+                break;
+            }
+        }
+
+        if (words.empty() && assignments.empty() && redirects.empty()) return nullptr;
+
+        CommandNode* cmd = arena_.make<CommandNode>();
+        cmd->assignments = arena_.makeArray(assignments.begin(), assignments.size());
+        cmd->assignment_count = static_cast<uint32_t>(assignments.size());
+        cmd->words = arena_.makeArray(words.begin(), words.size());
+        cmd->word_count = static_cast<uint32_t>(words.size());
+        cmd->redirects = arena_.makeArray(redirects.begin(), redirects.size());
+        cmd->redirect_count = static_cast<uint32_t>(redirects.size());
+        cmd->nested = findNested(*cmd, st.depth);
+        return cmd;
+    }
+
+    void parseRedirect(State& st, SmallVector<Redirect, 4>& out) {
+        Redirect redirect;
+
+        if (peekIs(st, TokenKind::IO_NUMBER)) {
+            int fd = 0;
+            for (char c : peek(st).text) {
+                fd = fd * 10 + (c - '0');
+                if (fd > 9999) break;
+            }
+            redirect.fd = fd;
+            ++st.pos;
+            if (atEnd(st) || !peek(st).isRedirection()) {
+                fail("missing redirection operator");
+                return;
+            }
+        }
+
+        redirect.op = peek(st).kind;
+        ++st.pos;
+
+        if (!peekIs(st, TokenKind::WORD)) {
+            fail("missing redirection target");
+            return;
+        }
+        redirect.target = makeWord(st, peek(st));
+        ++st.pos;
+
+        if (redirect.op == TokenKind::DLESS || redirect.op == TokenKind::DLESSDASH) {
+            if (st.next_heredoc < st.heredocs.size()) {
+                redirect.heredoc_body = st.heredocs[st.next_heredoc++];
+            }
+        }
+
+        out.push_back(redirect);
+    }
+
+    Word makeWord(State& st, const Token& tok) {
+        Word word;
+        word.raw = tok.text;
+        word.flags = tok.flags;
+
+        if (tok.has(TOKEN_UNTERMINATED)) fail("unterminated quote or substitution");
+
+        if (tok.flags & (TOKEN_QUOTED | TOKEN_SUBSTITUTION | TOKEN_EXPANSION)) {
+            scratch_.clear();
+            unquoteInto(tok.text, scratch_);
+            word.text = (scratch_ == tok.text) ? tok.text : arena_.copy(scratch_);
+        } else {
+            word.text = tok.text;
+        }
+
+        if (tok.has(TOKEN_SUBSTITUTION)) {
+            if (st.depth >= MAX_DEPTH) {
+                fail("nesting too deep");
+                return word;
+            }
+            SubstitutionList bodies;
+            findSubstitutions(tok.text, bodies);
+            ListNode* head = nullptr;
+            ListNode* tail = nullptr;
+            for (std::string_view body : bodies) {
+                ListNode* list = parseProgram(body, st.depth + 1);
+                if (tail) {
+                    tail->next = list;
+                } else {
+                    head = list;
+                }
+                tail = list;
+            }
+            word.substitutions = head;
+        }
+
+        return word;
+    }
+
+    // View over words[start, count) of a runner command
+    CommandNode* makeView(const CommandNode& runner, uint32_t start, uint32_t end, int depth) {
+        CommandNode* view = arena_.make<CommandNode>();
+        view->words = runner.words + start;
+        view->word_count = end - start;
+        view->runner = &runner;
+        view->nested = findNested(*view, depth + 1);
+        return view;
+    }
+
+    // Parse text that a command hands to a shell (sh -c, eval, watch)
+    const Node* parseScript(std::string_view script, int depth) {
+        if (depth >= MAX_DEPTH) {
+            fail("nesting too deep");
+            return nullptr;
+        }
+        return parseProgram(arena_.copy(script), depth + 1);
+    }
+
+    std::string_view joinWords(const Word* words, uint32_t start, uint32_t end) {
+        scratch_.clear();
+        for (uint32_t i = start; i < end; ++i) {
+            if (i > start) scratch_ += ' ';
+            scratch_.append(words[i].text);
+        }
+        return scratch_;
+    }
+
+    const Node* findNested(const CommandNode& cmd, int depth) {
+        if (depth >= MAX_DEPTH || cmd.word_count < 2) return nullptr;
+
+        std::string_view name = cmd.name();
+        const Word* w = cmd.words;
+        uint32_t n = cmd.word_count;
+        uint32_t start = n;
+
+        if (name == "sudo") {
+            start = skipOptions(w, n, 1, "ugpCDhrtUT");
+            while (start < n && isAssignment(w[start].text)) ++start;
+        } else if (name == "doas") {
+            start = skipOptions(w, n, 1, "uC");
+        } else if (name == "env") {
+            start = skipOptions(w, n, 1, "uCS");
+            while (start < n && isAssignment(w[start].text)) ++start;
+        } else if (name == "nice") {
+            start = skipOptions(w, n, 1, "n");
+        } else if (name == "nohup" || name == "builtin" || name == "unbuffer" || name == "torsocks") {
+            start = skipOptions(w, n, 1, "");
+        } else if (name == "time") {
+            start = skipOptions(w, n, 1, "fo");
+        } else if (name == "timeout") {
+            start = skipOptions(w, n, 1, "sk") + 1;  // DURATION
+        } else if (name == "stdbuf") {
+            start = skipOptions(w, n, 1, "ioe");
+        } else if (name == "ionice") {
+            start = skipOptions(w, n, 1, "cnpPu");
+        } else if (name == "chroot") {
+            start = skipOptions(w, n, 1, "") + 1;  // NEWROOT
+        } else if (name == "exec") {
+            start = skipOptions(w, n, 1, "a");
+        } else if (name == "command") {
+            if (cmd.hasShortFlag('v') || cmd.hasShortFlag('V')) return nullptr;
+            start = skipOptions(w, n, 1, "");
+        } else if (name == "xargs") {
+            start = skipOptions(w, n, 1, "IEadnLPs");
+        } else if (name == "find") {
+            return findExecs(cmd, depth);
+        } else if (isShell(name)) {
+            for (uint32_t i = 1; i + 1 < n; ++i) {
+                std::string_view opt = w[i].text;
+                if (opt.size() >= 2 && opt[0] == '-' && opt[1] != '-' && opt.find('c') != std::string_view::npos) {
+                    return parseScript(w[i + 1].text, depth);
+                }
+            }
+            return nullptr;
+        } else if (name == "eval") {
+            return parseScript(joinWords(w, 1, n), depth);
+        } else if (name == "watch") {
+            start = skipOptions(w, n, 1, "nq");
+            if (start >= n) return nullptr;
+            return parseScript(joinWords(w, start, n), depth);
+        } else {
+            return nullptr;
+        }
+
+        if (start >= n) return nullptr;
+        return makeView(cmd, start, n, depth);
+    }
+
+    // Each -exec/-execdir/-ok/-okdir clause of find runs a command
+    const Node* findExecs(const CommandNode& cmd, int depth) {
+        Node* head = nullptr;
+        Node* tail = nullptr;
+        uint32_t i = 1;
+        while (i < cmd.word_count) {
+            std::string_view t = cmd.words[i].text;
+            if (t != "-exec" && t != "-execdir" && t != "-ok" && t != "-okdir") {
+                ++i;
+                continue;
+            }
+            uint32_t start = i + 1;
+            uint32_t end = start;
+            while (end < cmd.word_count && cmd.words[end].text != ";" && cmd.words[end].text != "+") ++end;
+            if (end > start) {
+                CommandNode* view = makeView(cmd, start, end, depth);
+                if (tail) {
+                    tail->next = view;
+                } else {
+                    head = view;
+                }
+                tail = view;
+            }
+            i = end + 1;
+        }
+        return head;
+    }
+};
+
+ShellAst::ShellAst(std::string_view input) {
+    source_ = arena_.copy(input);
+    ShellParser parser(*this);
+    root_ = parser.parseProgram(source_, 0);
+}
+
+} // namespace tt
@@ -0,0 +1,541 @@
+/**
+ * ShellLexer.cpp - Single-pass POSIX shell lexer
+ */
+
+#include "tt/ShellLexer.hpp"
+
+namespace tt {
+
+namespace {
+
+bool isBlank(char c) {
+    return c == ' ' || c == '\t';
+}
+
+bool isOperatorChar(char c) {
+    return c == '|' || c == '&' || c == ';' || c == '<' || c == '>' || c == '(' || c == ')';
+}
+
+bool isNameChar(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+}
+
+bool isSpecialParam(char c) {
+    return c == '@' || c == '*' || c == '#' || c == '?' || c == '$' || c == '!' || c == '-' ||
+           (c >= '0' && c <= '9');
+}
+
+size_t skipDollar(std::string_view s, size_t pos, uint8_t& flags);
+size_t skipDoubleQuoted(std::string_view s, size_t pos, uint8_t& flags);
+
+// pos is at the opening quote; returns the position past the closing one
+size_t skipSingleQuoted(std::string_view s, size_t pos, uint8_t& flags) {
+    flags |= TOKEN_QUOTED;
+    size_t end = s.find('\'', pos + 1);
+    if (end == std::string_view::npos) {
+        flags |= TOKEN_UNTERMINATED;
+        return s.size();
+    }
+    return end + 1;
+}
+
+// $'...' allows \' inside, unlike plain single quotes
+size_t skipAnsiQuoted(std::string_view s, size_t pos, uint8_t& flags) {
+    flags |= TOKEN_QUOTED;
+    for (size_t i = pos + 1; i < s.size(); ++i) {
+        if (s[i] == '\\') {
+            ++i;
+        } else if (s[i] == '\'') {
+            return i + 1;
+        }
+    }
+    flags |= TOKEN_UNTERMINATED;
+    return s.size();
+}
+
+size_t skipBackquoted(std::string_view s, size_t pos, uint8_t& flags) {
+    flags |= TOKEN_SUBSTITUTION;
+    for (size_t i = pos + 1; i < s.size(); ++i) {
+        if (s[i] == '\\') {
+            ++i;
+        } else if (s[i] == '`') {
+            return i + 1;
+        }
+    }
+    flags |= TOKEN_UNTERMINATED;
+    return s.size();
+}
+
+// pos is at the opening bracket; nested brackets and quotes are honored
+size_t skipBracketed(std::string_view s, size_t pos, char open, char close, uint8_t& flags) {
+    int depth = 0;
+    size_t i = pos;
+    while (i < s.size()) {
+        char c = s[i];
+        if (c == open) {
+            ++depth;
+            ++i;
+        } else if (c == close) {
+            if (--depth == 0) return i + 1;
+            ++i;
+        } else if (c == '\\') {
+            i += 2;
+        } else if (c == '\'') {
+            uint8_t inner = 0;
+            i = skipSingleQuoted(s, i, inner);
+        } else if (c == '"') {
+            i = skipDoubleQuoted(s, i, flags);
+        } else if (c == '`') {
+            i = skipBackquoted(s, i, flags);
+        } else if (c == '$') {
+            i = skipDollar(s, i, flags);
+        } else {
+            ++i;
+        }
+    }
+    flags |= TOKEN_UNTERMINATED;
+    return s.size();
+}
+
+size_t skipDoubleQuoted(std::string_view s, size_t pos, uint8_t& flags) {
+    flags |= TOKEN_QUOTED;
+    size_t i = pos + 1;
+    while (i < s.size()) {
+        char c = s[i];
+        if (c == '\\') {
+            i += 2;
+        } else if (c == '"') {
+            return i + 1;
+        } else if (c == '$') {
+            i = skipDollar(s, i, flags);
+        } else if (c == '`') {
+            i = skipBackquoted(s, i, flags);
+        } else {
+            ++i;
+        }
+    }
+    flags |= TOKEN_UNTERMINATED;
+    return s.size();
+}
+
+// pos is at '$'; returns the position past the expansion
+size_t skipDollar(std::string_view s, size_t pos, uint8_t& flags) {
+    if (pos + 1 >= s.size()) return pos + 1;
+
+    char c = s[pos + 1];
+    if (c == '(') {
+        bool arithmetic = pos + 2 < s.size() && s[pos + 2] == '(';
+        flags |= arithmetic ? TOKEN_EXPANSION : TOKEN_SUBSTITUTION;
+        return skipBracketed(s, pos + 1, '(', ')', flags);
+    }
+    if (c == '{') {
+        flags |= TOKEN_EXPANSION;
+        return skipBracketed(s, pos + 1, '{', '}', flags);
+    }
+    if (c == '\'') {
+        return skipAnsiQuoted(s, pos + 1, flags);
+    }
+    if (c == '"') {
+        return skipDoubleQuoted(s, pos + 1, flags);
+    }
+    if (isSpecialParam(c)) {
+        flags |= TOKEN_EXPANSION;
+        return pos + 2;
+    }
+    if (isNameChar(c)) {
+        flags |= TOKEN_EXPANSION;
+        size_t i = pos + 1;
+        while (i < s.size() && isNameChar(s[i])) ++i;
+        return i;
+    }
+    return pos + 1;  // Lone '$' is literal
+}
+
+// Compare a here-document line with its (possibly quoted) delimiter word
+bool matchesDelimiter(std::string_view line, std::string_view delim) {
+    size_t li = 0;
+    for (size_t di = 0; di < delim.size(); ++di) {
+        char c = delim[di];
+        if (c == '\'' || c == '"') continue;
+        if (c == '\\' && di + 1 < delim.size()) c = delim[++di];
+        if (li >= line.size() || line[li] != c) return false;
+        ++li;
+    }
+    return li == line.size();
+}
+
+void appendAnsiEscape(char c, std::string& out) {
+    switch (c) {
+        case 'n': out += '\n'; break;
+        case 't': out += '\t'; break;
+        case 'r': out += '\r'; break;
+        case 'a': out += '\a'; break;
+        case 'b': out += '\b'; break;
+        case 'e': case 'E': out += '\033'; break;
+        case 'f': out += '\f'; break;
+        case 'v': out += '\v'; break;
+        case '0': out += '\0'; break;
+        default: out += c; break;
+    }
+}
+
+} // anonymous namespace
+
+const char* toString(TokenKind kind) {
+    switch (kind) {
+        case TokenKind::WORD: return "word";
+        case TokenKind::IO_NUMBER: return "io-number";
+        case TokenKind::HEREDOC: return "heredoc";
+        case TokenKind::PIPE: return "|";
+        case TokenKind::PIPE_AND: return "|&";
+        case TokenKind::AND_IF: return "&&";
+        case TokenKind::OR_IF: return "||";
+        case TokenKind::SEMI: return ";";
+        case TokenKind::DSEMI: return ";;";
+        case TokenKind::AMP: return "&";
+        case TokenKind::NEWLINE: return "newline";
+        case TokenKind::LPAREN: return "(";
+        case TokenKind::RPAREN: return ")";
+        case TokenKind::LESS: return "<";
+        case TokenKind::GREAT: return ">";
+        case TokenKind::DLESS: return "<<";
+        case TokenKind::DLESSDASH: return "<<-";
+        case TokenKind::TLESS: return "<<<";
+        case TokenKind::DGREAT: return ">>";
+        case TokenKind::LESSAND: return "<&";
+        case TokenKind::GREATAND: return ">&";
+        case TokenKind::LESSGREAT: return "<>";
+        case TokenKind::CLOBBER: return ">|";
+        case TokenKind::AND_GREAT: return "&>";
+        case TokenKind::AND_DGREAT: return "&>>";
+        case TokenKind::END: return "end";
+    }
+    return "?";
+}
+
+ShellLexer::ShellLexer(std::string_view input) : input_(input) {}
+
+Token ShellLexer::next() {
+    if (heredoc_ready_) {
+        return lexHeredoc();
+    }
+
+    // Skip blanks and line continuations
+    while (pos_ < input_.size()) {
+        char c = input_[pos_];
+        if (isBlank(c)) {
+            ++pos_;
+        } else if (c == '\\' && pos_ + 1 < input_.size() && input_[pos_ + 1] == '\n') {
+            pos_ += 2;
+        } else {
+            break;
+        }
+    }
+
+    // Comments run to the end of the line
+    if (pos_ < input_.size() && input_[pos_] == '#') {
+        size_t end = input_.find('\n', pos_);
+        pos_ = (end == std::string_view::npos) ? input_.size() : end;
+    }
+
+    if (pos_ >= input_.size()) {
+        return Token{};
+    }
+
+    char c = input_[pos_];
+
+    if (c == '\n') {
+        Token token{TokenKind::NEWLINE, 0, input_.substr(pos_, 1)};
+        ++pos_;
+        if (pending_next_ < pending_count_) {
+            heredoc_ready_ = true;
+        }
+        return token;
+    }
+
+    // <(...) and >(...) are process substitutions, part of a word
+    bool process_subst = (c == '<' || c == '>') && pos_ + 1 < input_.size() && input_[pos_ + 1] == '(';
+    if (isOperatorChar(c) && !process_subst) {
+        return lexOperator();
+    }
+
+    Token token = lexWord();
+    if (expect_delim_ && token.kind == TokenKind::WORD) {
+        expect_delim_ = false;
+        if (pending_count_ < MAX_PENDING_HEREDOCS) {
+            pending_strip_tabs_[pending_count_] = expect_strip_tabs_;
+            pending_delims_[pending_count_++] = token.text;
+        }
+    }
+    return token;
+}
+
+Token ShellLexer::lexWord() {
+    size_t start = pos_;
+    uint8_t flags = 0;
+    size_t i = pos_;
+    const std::string_view s = input_;
+
+    while (i < s.size()) {
+        char c = s[i];
+        if (isBlank(c) || c == '\n') break;
+        if ((c == '<' || c == '>') && i + 1 < s.size() && s[i + 1] == '(') {
+            flags |= TOKEN_SUBSTITUTION;
+            i = skipBracketed(s, i + 1, '(', ')', flags);
+            continue;
+        }
+        if (isOperatorChar(c)) break;
+
+        switch (c) {
+            case '\\':
+                flags |= TOKEN_QUOTED;
+                i += (i + 1 < s.size()) ? 2 : 1;
+                break;
+            case '\'':
+                i = skipSingleQuoted(s, i, flags);
+                break;
+            case '"':
+                i = skipDoubleQuoted(s, i, flags);
+                break;
+            case '`':
+                i = skipBackquoted(s, i, flags);
+                break;
+            case '$':
+                i = skipDollar(s, i, flags);
+                break;
+            case '*':
+            case '?':
+            case '[':
+                flags |= TOKEN_GLOB;
+                ++i;
+                break;
+            default:
+                ++i;
+                break;
+        }
+    }
+
+    if (i > s.size()) i = s.size();
+    pos_ = i;
+
+    Token token{TokenKind::WORD, flags, s.substr(start, i - start)};
+
+    // All-digit words glued to a redirection are file descriptor numbers
+    if (flags == 0 && i < s.size() && (s[i] == '<' || s[i] == '>')) {
+        bool digits = true;
+        for (char d : token.text) {
+            if (d < '0' || d > '9') {
+                digits = false;
+                break;
+            }
+        }
+        if (digits) token.kind = TokenKind::IO_NUMBER;
+    }
+
+    return token;
+}
+
+Token ShellLexer::lexOperator() {
+    const std::string_view s = input_;
+    size_t start = pos_;
+    char c = s[pos_];
+    char n1 = pos_ + 1 < s.size() ? s[pos_ + 1] : '\0';
+    char n2 = pos_ + 2 < s.size() ? s[pos_ + 2] : '\0';
+
+    TokenKind kind;
+    size_t len = 1;
+
+    switch (c) {
+        case '|':
+            if (n1 == '|') { kind = TokenKind::OR_IF; len = 2; }
+            else if (n1 == '&') { kind = TokenKind::PIPE_AND; len = 2; }
+            else kind = TokenKind::PIPE;
+            break;
+        case '&':
+            if (n1 == '&') { kind = TokenKind::AND_IF; len = 2; }
+            else if (n1 == '>' && n2 == '>') { kind = TokenKind::AND_DGREAT; len = 3; }
+            else if (n1 == '>') { kind = TokenKind::AND_GREAT; len = 2; }
+            else kind = TokenKind::AMP;
+            break;
+        case ';':
+            if (n1 == ';') { kind = TokenKind::DSEMI; len = 2; }
+            else kind = TokenKind::SEMI;
+            break;
+        case '<':
+            if (n1 == '<' && n2 == '<') { kind = TokenKind::TLESS; len = 3; }
+            else if (n1 == '<' && n2 == '-') { kind = TokenKind::DLESSDASH; len = 3; }
+            else if (n1 == '<') { kind = TokenKind::DLESS; len = 2; }
+            else if (n1 == '&') { kind = TokenKind::LESSAND; len = 2; }
+            else if (n1 == '>') { kind = TokenKind::LESSGREAT; len = 2; }
+            else kind = TokenKind::LESS;
+            break;
+        case '>':
+            if (n1 == '>') { kind = TokenKind::DGREAT; len = 2; }
+            else if (n1 == '&') { kind = TokenKind::GREATAND; len = 2; }
+            else if (n1 == '|') { kind = TokenKind::CLOBBER; len = 2; }
+            else kind = TokenKind::GREAT;
+            break;
+        case '(':
+            kind = TokenKind::LPAREN;
+            break;
+        default:
+            kind = TokenKind::RPAREN;
+            break;
+    }
+
+    pos_ += len;
+
+    if (kind == TokenKind::DLESS || kind == TokenKind::DLESSDASH) {
+        expect_delim_ = true;
+        expect_strip_tabs_ = (kind == TokenKind::DLESSDASH);
+    }
+
+    return Token{kind, 0, s.substr(start, len)};
+}
+
+Token ShellLexer::lexHeredoc() {
+    const std::string_view s = input_;
+    std::string_view delim = pending_delims_[pending_next_];
+    bool strip_tabs = pending_strip_tabs_[pending_next_];
+    ++pending_next_;
+    if (pending_next_ >= pending_count_) {
+        heredoc_ready_ = false;
+        pending_count_ = 0;
+        pending_next_ = 0;
+    }
+
+    size_t body_start = pos_;
+    size_t line_start = pos_;
+    while (line_start < s.size()) {
+        size_t line_end = s.find('\n', line_start);
+        if (line_end == std::string_view::npos) line_end = s.size();
+
+        std::string_view line = s.substr(line_start, line_end - line_start);
+        if (strip_tabs) {
+            while (!line.empty() && line.front() == '\t') line.remove_prefix(1);
+        }
+
+        if (matchesDelimiter(line, delim)) {
+            pos_ = (line_end < s.size()) ? line_end + 1 : line_end;
+            return Token{TokenKind::HEREDOC, 0, s.substr(body_start, line_start - body_start)};
+        }
+        line_start = line_end + 1;
+    }
+
+    pos_ = s.size();
+    return Token{TokenKind::HEREDOC, TOKEN_UNTERMINATED, s.substr(body_start)};
+}
+
+void ShellLexer::tokenize(std::string_view input, TokenList& out) {
+    ShellLexer lexer(input);
+    for (Token token = lexer.next(); token.kind != TokenKind::END; token = lexer.next()) {
+        out.push_back(token);
+    }
+}
+
+void unquoteInto(std::string_view word, std::string& out) {
+    size_t i = 0;
+    while (i < word.size()) {
+        char c = word[i];
+
+        if (c == '\\') {
+            if (i + 1 < word.size() && word[i + 1] != '\n') out += word[i + 1];
+            i += 2;
+        } else if (c == '\'') {
+            size_t end = word.find('\'', i + 1);
+            if (end == std::string_view::npos) end = word.size();
+            out.append(word.substr(i + 1, end - i - 1));
+            i = end + 1;
+        } else if (c == '"') {
+            ++i;
+            while (i < word.size() && word[i] != '"') {
+                char d = word[i];
+                if (d == '\\' && i + 1 < word.size()) {
+                    char e = word[i + 1];
+                    if (e == '$' || e == '`' || e == '"' || e == '\\') {
+                        out += e;
+                    } else if (e != '\n') {
+                        out += d;
+                        out += e;
+                    }
+                    i += 2;
+                } else if (d == '$' || d == '`') {
+                    uint8_t flags = 0;
+                    size_t end = (d == '$') ? skipDollar(word, i, flags) : skipBackquoted(word, i, flags);
+                    out.append(word.substr(i, end - i));
+                    i = end;
+                } else {
+                    out += d;
+                    ++i;
+                }
+            }
+            ++i;
+        } else if (c == '$' && i + 1 < word.size() && word[i + 1] == '\'') {
+            i += 2;
+            while (i < word.size() && word[i] != '\'') {
+                if (word[i] == '\\' && i + 1 < word.size()) {
+                    appendAnsiEscape(word[i + 1], out);
+                    i += 2;
+                } else {
+                    out += word[i++];
+                }
+            }
+            ++i;
+        } else if (c == '$' || c == '`') {
+            uint8_t flags = 0;
+            size_t end = (c == '$') ? skipDollar(word, i, flags) : skipBackquoted(word, i, flags);
+            out.append(word.substr(i, end - i));
+            i = end;
+        } else {
+            out += c;
+            ++i;
+        }
+    }
+}
+
+void findSubstitutions(std::string_view word, SubstitutionList& out) {
+    size_t i = 0;
+    bool in_double = false;
+    while (i < word.size()) {
+        char c = word[i];
+        uint8_t flags = 0;
+
+        if (c == '\\') {
+            i += 2;
+        } else if (c == '\'' && !in_double) {
+            i = skipSingleQuoted(word, i, flags);
+        } else if (c == '"') {
+            in_double = !in_double;
+            ++i;
+        } else if (c == '`') {
+            size_t end = skipBackquoted(word, i, flags);
+            size_t body_end = (flags & TOKEN_UNTERMINATED) ? end : end - 1;
+            out.push_back(word.substr(i + 1, body_end - i - 1));
+            i = end;
+        } else if (c == '$' && i + 1 < word.size() && word[i + 1] == '(' &&
+                   !(i + 2 < word.size() && word[i + 2] == '(')) {
+            size_t end = skipBracketed(word, i + 1, '(', ')', flags);
+            size_t body_end = (flags & TOKEN_UNTERMINATED) ? end : end - 1;
+            out.push_back(word.substr(i + 2, body_end - i - 2));
+            i = end;
+        } else if ((c == '<' || c == '>') && !in_double && i + 1 < word.size() && word[i + 1] == '(') {
+            size_t end = skipBracketed(word, i + 1, '(', ')', flags);
+            size_t body_end = (flags & TOKEN_UNTERMINATED) ? end : end - 1;
+            out.push_back(word.substr(i + 2, body_end - i - 2));
+            i = end;
+        } else if (c == '$') {
+            i = skipDollar(word, i, flags);
+        } else {
+            ++i;
+        }
+    }
+}
+
+std::string unquote(std::string_view word) {
+    std::string out;
+    out.reserve(word.size());
+    unquoteInto(word, out);
+    return out;
+}
+
+} // namespace tt
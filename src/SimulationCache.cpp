@@ -0,0 +1,461 @@
+/**
+ * SimulationCache.cpp - Reuse whatif results while nothing they depend on changed
+ *
+ * One JSON file per entry, named after the 128-bit key of command, cwd and
+ * variant, so a lookup reads a few kilobytes instead of the whole cache.
+ * The stored paths are re-stat'ed with statx and hashed; the entry hits
+ * only if the hash matches the one taken when it was stored. Directory
+ * mtimes cover entries being added, removed or renamed, so tracking every
+ * directory below a recursive target is enough to see the tree change
+ * shape without visiting its files.
+ *
+ * Timestamps that fall inside the simulation (minus a window for coarse
+ * clocks and 2-second filesystems) mean the result may describe an older
+ * state than the one hashed, so such results are not stored, like git's
+ * racily clean index entries.
+ */
+
+#include "tt/SimulationCache.hpp"
+#include "tt/CommandCanonicalizer.hpp"
+#include "tt/QueryNormalizer.hpp"
+#include "tt/ShellAst.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <string_view>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <glob.h>
+#include <sys/stat.h>
+
+#include <nlohmann/json.hpp>
+
+using json = nlohmann::json;
+
+namespace tt {
+
+static const size_t MAX_ENTRIES = 200;
+static const size_t MAX_PATHS = 4096;
+static constexpr std::chrono::seconds RACY_WINDOW{2};
+
+namespace {
+
+// ---------------------------------------------------------------------------
+// Tracked paths
+// ---------------------------------------------------------------------------
+
+struct Tracked {
+    std::vector<std::string> paths;
+    bool cacheable = true;
+
+    void add(std::string path) {
+        if (paths.size() >= MAX_PATHS) {
+            cacheable = false;
+            return;
+        }
+        paths.push_back(std::move(path));
+    }
+};
+
+bool needsEnvironment(const Word& word) {
+    return word.has(TOKEN_SUBSTITUTION) || word.has(TOKEN_EXPANSION) || word.has(TOKEN_UNTERMINATED);
+}
+
+std::string parentOf(const std::string& path) {
+    size_t slash = path.find_last_of('/');
+    if (slash == std::string::npos) return ".";
+    return slash == 0 ? "/" : path.substr(0, slash);
+}
+
+// Operands, command paths and redirection targets, resolved against cwd
+class PathCollector : public AstVisitor {
+public:
+    PathCollector(const std::string& cwd, Tracked& tracked) : cwd_(cwd), tracked_(tracked) {}
+
+    void visitCommand(const CommandNode& cmd) override {
+        for (uint32_t i = 0; i < cmd.assignment_count; ++i) {
+            if (needsEnvironment(cmd.assignments[i])) tracked_.cacheable = false;
+        }
+        for (uint32_t i = 0; i < cmd.word_count; ++i) {
+            const Word& word = cmd.words[i];
+            if (needsEnvironment(word)) {
+                tracked_.cacheable = false;
+                return;
+            }
+            std::string_view text = word.text;
+            if (i == 0 && text.find('/') == std::string_view::npos) continue;  // Looked up in PATH
+            if (text.empty() || text[0] == '-') continue;
+            addWord(word);
+        }
+    }
+
+    void visitRedirect(const Redirect& redirect) override {
+        if (redirect.op == TokenKind::DLESS || redirect.op == TokenKind::DLESSDASH) return;
+        if (needsEnvironment(redirect.target)) {
+            tracked_.cacheable = false;
+            return;
+        }
+        addWord(redirect.target);
+    }
+
+private:
+    std::string resolve(std::string_view raw, std::string_view text) const {
+        std::string path(text);
+        if (!raw.empty() && raw[0] == '~' && (path == "~" || path.rfind("~/", 0) == 0)) {
+            const char* home = std::getenv("HOME");
+            if (home) path.replace(0, 1, home);
+        }
+        if (path.empty() || path[0] != '/') path = cwd_ + "/" + path;
+        return path;
+    }
+
+    void addWord(const Word& word) {
+        std::string path = resolve(word.raw, word.text);
+        if (!word.has(TOKEN_GLOB)) {
+            tracked_.add(std::move(path));
+            return;
+        }
+
+        // A pattern is decided by the listing of the directory it matches in;
+        // patterns spanning several levels would need every level tracked
+        std::string dir = parentOf(path);
+        if (dir.find_first_of("*?[") != std::string::npos) {
+            tracked_.cacheable = false;
+            return;
+        }
+        tracked_.add(dir);
+        glob_t matches{};
+        if (::glob(path.c_str(), GLOB_NOSORT, nullptr, &matches) == 0) {
+            for (size_t i = 0; i < matches.gl_pathc; ++i) {
+                tracked_.add(matches.gl_pathv[i]);
+            }
+        }
+        ::globfree(&matches);
+    }
+
+    const std::string& cwd_;
+    Tracked& tracked_;
+};
+
+void addEntries(const std::string& dir, Tracked& tracked) {
+    DIR* handle = ::opendir(dir.c_str());
+    if (!handle) return;
+    while (dirent* entry = ::readdir(handle)) {
+        std::string_view name = entry->d_name;
+        if (name == "." || name == "..") continue;
+        tracked.add(dir + "/" + std::string(name));
+        if (!tracked.cacheable) break;
+    }
+    ::closedir(handle);
+}
+
+// Every directory below root, root included
+void addDirectories(const std::string& root, Tracked& tracked) {
+    std::vector<std::string> pending{root};
+    while (!pending.empty() && tracked.cacheable) {
+        std::string dir = std::move(pending.back());
+        pending.pop_back();
+
+        struct stat st{};
+        if (::lstat(dir.c_str(), &st) != 0 || !S_ISDIR(st.st_mode)) continue;
+        tracked.add(dir);
+
+        DIR* handle = ::opendir(dir.c_str());
+        if (!handle) continue;
+        while (dirent* entry = ::readdir(handle)) {
+            std::string_view name = entry->d_name;
+            if (name == "." || name == "..") continue;
+            if (entry->d_type == DT_DIR || entry->d_type == DT_UNKNOWN) {
+                pending.push_back(dir + "/" + std::string(name));
+            }
+        }
+        ::closedir(handle);
+    }
+}
+
+Tracked trackedPaths(const std::string& command, const std::string& cwd, const SimulationResult& result) {
+    Tracked tracked;
+    ShellAst ast(command);
+    PathCollector collector(cwd, tracked);
+    ast.accept(collector);
+    if (!tracked.cacheable) return tracked;
+
+    // Scripts and build files the command may read
+    tracked.add(cwd);
+    addEntries(cwd, tracked);
+
+    if (result.impact) {
+        for (const auto& target : result.impact->targets) {
+            addDirectories(target[0] == '/' ? target : cwd + "/" + target, tracked);
+        }
+    }
+
+    std::sort(tracked.paths.begin(), tracked.paths.end());
+    tracked.paths.erase(std::unique(tracked.paths.begin(), tracked.paths.end()), tracked.paths.end());
+    return tracked;
+}
+
+// ---------------------------------------------------------------------------
+// Stamps
+// ---------------------------------------------------------------------------
+
+void appendInt(std::string& out, int64_t value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+int64_t nanoseconds(const statx_timestamp& ts) {
+    return static_cast<int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+// Hash of what statx reports for each path, missing paths included;
+// newest_ns gets the latest mtime or ctime seen
+std::string stampPaths(const std::vector<std::string>& paths, int64_t* newest_ns = nullptr) {
+    std::string buffer;
+    buffer.reserve(paths.size() * 64);
+    int64_t newest = 0;
+
+    for (const auto& path : paths) {
+        struct statx stx{};
+        if (::statx(AT_FDCWD, path.c_str(), AT_SYMLINK_NOFOLLOW, STATX_BASIC_STATS, &stx) != 0) {
+            appendInt(buffer, -errno);
+            continue;
+        }
+        appendInt(buffer, stx.stx_dev_major);
+        appendInt(buffer, stx.stx_dev_minor);
+        appendInt(buffer, static_cast<int64_t>(stx.stx_ino));
+        appendInt(buffer, stx.stx_mode);
+        appendInt(buffer, static_cast<int64_t>(stx.stx_size));
+        appendInt(buffer, nanoseconds(stx.stx_mtime));
+        appendInt(buffer, nanoseconds(stx.stx_ctime));
+        newest = std::max({newest, nanoseconds(stx.stx_mtime), nanoseconds(stx.stx_ctime)});
+    }
+
+    if (newest_ns) *newest_ns = newest;
+    return normalizedKey(buffer).hex();
+}
+
+// ---------------------------------------------------------------------------
+// Serialization
+// ---------------------------------------------------------------------------
+
+json toJson(const SimulationResult& result) {
+    json data = {
+        {"predicted_output", result.predicted_output},
+        {"files_affected", result.files_affected},
+        {"warnings", result.warnings},
+        {"is_destructive", result.is_destructive}
+    };
+    if (result.dry_run) {
+        const auto& dry_run = *result.dry_run;
+        json effects = json::array();
+        for (const auto& effect : dry_run.effects) {
+            effects.push_back({{"path", effect.path}, {"change", static_cast<int>(effect.change)}});
+        }
+        data["dry_run"] = {
+            {"exit_status", dry_run.exit_status},
+            {"timed_out", dry_run.timed_out},
+            {"output", dry_run.output},
+            {"effects", std::move(effects)},
+            {"setup_ms", dry_run.setup_ms},
+            {"total_ms", dry_run.total_ms}
+        };
+    }
+    if (result.impact) {
+        const auto& impact = *result.impact;
+        json top = json::array();
+        for (const auto& dir : impact.top) {
+            top.push_back({{"path", dir.path}, {"files", dir.files}, {"bytes", dir.bytes}});
+        }
+        data["impact"] = {
+            {"files", impact.files},
+            {"directories", impact.directories},
+            {"bytes", impact.bytes},
+            {"unreadable", impact.unreadable},
+            {"targets", impact.targets},
+            {"unresolved", impact.unresolved},
+            {"top", std::move(top)},
+            {"complete", impact.complete},
+            {"elapsed_ms", impact.elapsed_ms}
+        };
+    }
+    return data;
+}
+
+SimulationResult fromJson(const json& data) {
+    SimulationResult result;
+    result.predicted = true;
+    result.predicted_output = data.value("predicted_output", "");
+    result.files_affected = data.value("files_affected", std::vector<std::string>{});
+    result.warnings = data.value("warnings", std::vector<std::string>{});
+    result.is_destructive = data.value("is_destructive", false);
+
+    if (data.contains("dry_run")) {
+        const auto& d = data["dry_run"];
+        DryRunResult dry_run;
+        dry_run.ran = true;
+        dry_run.exit_status = d.value("exit_status", -1);
+        dry_run.timed_out = d.value("timed_out", false);
+        dry_run.output = d.value("output", "");
+        for (const auto& e : d.value("effects", json::array())) {
+            int change = e.value("change", 0);
+            if (change < 0 || change > static_cast<int>(FileChange::DELETED)) continue;
+            dry_run.effects.push_back({e.value("path", ""), static_cast<FileChange>(change)});
+        }
+        dry_run.setup_ms = d.value("setup_ms", 0.0);
+        dry_run.total_ms = d.value("total_ms", 0.0);
+        result.dry_run = std::move(dry_run);
+    }
+    if (data.contains("impact")) {
+        const auto& d = data["impact"];
+        ImpactReport impact;
+        impact.files = d.value("files", uint64_t{0});
+        impact.directories = d.value("directories", uint64_t{0});
+        impact.bytes = d.value("bytes", uint64_t{0});
+        impact.unreadable = d.value("unreadable", uint64_t{0});
+        impact.targets = d.value("targets", std::vector<std::string>{});
+        impact.unresolved = d.value("unresolved", std::vector<std::string>{});
+        for (const auto& t : d.value("top", json::array())) {
+            impact.top.push_back({t.value("path", ""), t.value("files", uint64_t{0}), t.value("bytes", uint64_t{0})});
+        }
+        impact.complete = d.value("complete", true);
+        impact.elapsed_ms = d.value("elapsed_ms", 0.0);
+        result.impact = std::move(impact);
+    }
+    return result;
+}
+
+} // anonymous namespace
+
+struct SimulationCache::Impl {
+    std::filesystem::path dir;
+    std::string variant;
+
+    Impl(const std::string& cache_dir, const std::string& variant_key)
+        : dir(cache_dir.empty() ? SimulationCache::getDefaultPath() : cache_dir), variant(variant_key) {}
+
+    std::filesystem::path entryPath(const std::string& canonical, const std::string& cwd) const {
+        std::string key = canonical;
+        key += '\0';
+        key += cwd;
+        key += '\0';
+        key += variant;
+        return dir / (normalizedKey(key).hex() + ".json");
+    }
+
+    // Drops the least recently used entries beyond MAX_ENTRIES
+    void evict() {
+        std::error_code ec;
+        std::vector<std::pair<std::filesystem::file_time_type, std::filesystem::path>> files;
+        for (const auto& entry : std::filesystem::directory_iterator(dir, ec)) {
+            if (entry.path().extension() != ".json") continue;
+            files.emplace_back(entry.last_write_time(ec), entry.path());
+        }
+        if (files.size() <= MAX_ENTRIES) return;
+        std::sort(files.begin(), files.end());
+        for (size_t i = 0; i < files.size() - MAX_ENTRIES; ++i) {
+            std::filesystem::remove(files[i].second, ec);
+        }
+    }
+};
+
+SimulationCache::SimulationCache(const std::string& dir, const std::string& variant)
+    : impl_(std::make_unique<Impl>(dir, variant)) {}
+
+SimulationCache::~SimulationCache() = default;
+
+std::string SimulationCache::getDefaultPath() {
+    const char* home = std::getenv("HOME");
+    if (!home) return "";
+    return std::string(home) + "/.tt/simulations";
+}
+
+std::optional<SimulationResult> SimulationCache::lookup(const std::string& command, const std::string& cwd) {
+    if (impl_->dir.empty()) return std::nullopt;
+
+    std::string canonical = canonicalizeCommand(command);
+    auto path = impl_->entryPath(canonical, cwd);
+    std::ifstream file(path);
+    if (!file.good()) return std::nullopt;
+
+    try {
+        json data;
+        file >> data;
+        file.close();
+        if (data.value("command", "") != canonical || data.value("cwd", "") != cwd ||
+            data.value("variant", "") != impl_->variant) {
+            return std::nullopt;
+        }
+
+        auto paths = data.value("paths", std::vector<std::string>{});
+        std::error_code ec;
+        if (stampPaths(paths) != data.value("stamp", "")) {
+            std::filesystem::remove(path, ec);
+            return std::nullopt;
+        }
+
+        std::filesystem::last_write_time(path, std::filesystem::file_time_type::clock::now(), ec);
+        return fromJson(data["result"]);
+    } catch (...) {
+        return std::nullopt;
+    }
+}
+
+bool SimulationCache::store(const std::string& command, const std::string& cwd, const SimulationResult& result,
+                            std::chrono::system_clock::time_point started) {
+    if (impl_->dir.empty() || !result.predicted) return false;
+
+    Tracked tracked = trackedPaths(command, cwd, result);
+    if (!tracked.cacheable) return false;
+
+    int64_t newest_ns = 0;
+    std::string stamp = stampPaths(tracked.paths, &newest_ns);
+    auto racy = std::chrono::duration_cast<std::chrono::nanoseconds>((started - RACY_WINDOW).time_since_epoch());
+    if (newest_ns >= racy.count()) return false;
+
+    std::string canonical = canonicalizeCommand(command);
+    json data = {
+        {"version", 1},
+        {"command", canonical},
+        {"cwd", cwd},
+        {"variant", impl_->variant},
+        {"paths", tracked.paths},
+        {"stamp", stamp},
+        {"result", toJson(result)}
+    };
+
+    std::error_code ec;
+    std::filesystem::create_directories(impl_->dir, ec);
+    auto path = impl_->entryPath(canonical, cwd);
+    auto temp = path;
+    temp += ".tmp";
+    {
+        std::ofstream file(temp);
+        if (!file.good()) return false;
+        file << data.dump();
+        if (!file.good()) return false;
+    }
+    std::filesystem::permissions(temp,
+        std::filesystem::perms::owner_read | std::filesystem::perms::owner_write,
+        std::filesystem::perm_options::replace, ec);
+    std::filesystem::rename(temp, path, ec);
+    if (ec) {
+        std::filesystem::remove(temp, ec);
+        return false;
+    }
+
+    impl_->evict();
+    return true;
+}
+
+void SimulationCache::clear() {
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator(impl_->dir, ec)) {
+        std::filesystem::remove(entry.path(), ec);
+    }
+}
+
+} // namespace tt
@@ -3,106 +3,247 @@
  */
 
 #include "tt/Simulator.hpp"
+#include "tt/BlastRadius.hpp"
+#include "tt/DangerCheck.hpp"
 #include "tt/GeminiClient.hpp"
+#include "tt/PromptTemplate.hpp"
+#include "tt/ShellAst.hpp"
 
-#include <algorithm>
-#include <regex>
+#include <future>
+#include <mutex>
 #include <sstream>
 
 namespace tt {
 
-Simulator::Simulator(GeminiClient& gemini) : gemini_(gemini) {
-    // Initialize dangerous patterns
-    dangerous_patterns_ = {
-        "rm -rf",
-        "rm -r /",
-        "rm -rf /",
-        "rm -rf ~",
-        "rm -rf *",
-        "> /dev/sda",
-        "dd if=",
-        "mkfs.",
-        ":(){:|:&};:",   // fork bomb
-        "chmod -R 777 /",
-        "chown -R",
-        "sudo rm",
-        "mv /* ",
-        "wget.*|.*sh",
-        "curl.*|.*bash"
-    };
+namespace {
+
+bool isRecursive(const CommandNode& cmd) {
+    return cmd.hasShortFlag('r') || cmd.hasShortFlag('R') || cmd.hasLongFlag("--recursive");
 }
 
-Simulator::~Simulator() = default;
+bool isBlockDevice(std::string_view path) {
+    return path.rfind("/dev/sd", 0) == 0 || path.rfind("/dev/hd", 0) == 0 ||
+           path.rfind("/dev/vd", 0) == 0 || path.rfind("/dev/xvd", 0) == 0 ||
+           path.rfind("/dev/nvme", 0) == 0 || path.rfind("/dev/mmcblk", 0) == 0 ||
+           path.rfind("/dev/disk", 0) == 0;
+}
 
-bool Simulator::isDangerous(const std::string& command) {
-    std::string lower = command;
-    std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
-    
-    for (const auto& pattern : dangerous_patterns_) {
-        if (lower.find(pattern) != std::string::npos) {
-            return true;
+// Commands that destroy data or the system, as opposed to merely needing care
+struct DestructiveVisitor : AstVisitor {
+    bool destructive = false;
+
+    void visitCommand(const CommandNode& cmd) override {
+        std::string_view name = cmd.name();
+        bool mkfs = name.rfind("mkfs", 0) == 0;
+
+        if (name == "rm" && isRecursive(cmd)) destructive = true;
+        if (mkfs) destructive = true;
+        if (name == "chown" && isRecursive(cmd)) destructive = true;
+        if (name == "chmod" && isRecursive(cmd) && (cmd.hasWord("777") || cmd.hasWord("/"))) destructive = true;
+        if (name == "mv" && (cmd.hasWord("/*") || cmd.hasWord("/"))) destructive = true;
+
+        if (name == "dd") {
+            for (uint32_t i = 1; i < cmd.word_count; ++i) {
+                std::string_view arg = cmd.words[i].text;
+                if (arg.rfind("if=", 0) == 0 || arg.rfind("of=", 0) == 0) destructive = true;
+            }
         }
-    }
-    
-    // Check for sudo with modifying commands
-    if (lower.find("sudo") != std::string::npos) {
-        std::vector<std::string> dangerous_with_sudo = {
-            "rm", "dd", "mkfs", "chmod", "chown", "mv", "cp"
-        };
-        for (const auto& cmd : dangerous_with_sudo) {
-            if (lower.find(cmd) != std::string::npos) {
-                return true;
+
+        // Modifying commands under elevated privileges
+        if (cmd.runner && (cmd.runner->name() == "sudo" || cmd.runner->name() == "doas")) {
+            if (name == "rm" || name == "dd" || mkfs || name == "chmod" || name == "chown" ||
+                name == "mv" || name == "cp") {
+                destructive = true;
             }
         }
     }
+
+    void visitRedirect(const Redirect& redirect) override {
+        if (redirect.writes() && isBlockDevice(redirect.target.text)) destructive = true;
+    }
+};
+
+bool isDestructive(const ShellAst& ast) {
+    if (containsForkBomb(ast) || pipesDownloadToShell(ast)) {
+        return true;
+    }
     
-    return false;
+    DestructiveVisitor visitor;
+    ast.accept(visitor);
+    return visitor.destructive;
 }
 
-SimulationResult Simulator::simulate(const std::string& command) {
-    SimulationResult result;
-    result.is_destructive = isDangerous(command);
+// Warnings that need only the parsed command
+void addLocalWarnings(const ShellAst& ast, SimulationResult& result) {
+    result.is_destructive = isDestructive(ast);
     
     // Add immediate warnings for dangerous commands
     if (result.is_destructive) {
         result.warnings.push_back("ATENCAO: Este comando e potencialmente destrutivo!");
     }
     
-    // Check for specific dangerous patterns and add targeted warnings
-    if (command.find("rm") != std::string::npos) {
-        if (command.find("-rf") != std::string::npos || command.find("-r") != std::string::npos) {
-            result.warnings.push_back("Este comando remove arquivos/diretorios recursivamente.");
+    // Check the parsed commands for specific risks and add targeted warnings
+    bool recursive_rm = false;
+    bool wildcard_rm = false;
+    bool chmod_777 = false;
+    ast.forEachCommand([&](const CommandNode& cmd) {
+        if (cmd.name() == "rm") {
+            recursive_rm = recursive_rm || isRecursive(cmd);
+            for (uint32_t i = 1; i < cmd.word_count; ++i) {
+                wildcard_rm = wildcard_rm || cmd.words[i].has(TOKEN_GLOB);
+            }
         }
-        if (command.find("*") != std::string::npos) {
-            result.warnings.push_back("O uso de wildcard (*) pode afetar mais arquivos do que o esperado.");
+        if (cmd.name() == "chmod" && cmd.hasWord("777")) {
+            chmod_777 = true;
         }
-    }
+    });
     
-    if (command.find("chmod") != std::string::npos && command.find("777") != std::string::npos) {
+    if (recursive_rm) {
+        result.warnings.push_back("Este comando remove arquivos/diretorios recursivamente.");
+    }
+    if (wildcard_rm) {
+        result.warnings.push_back("O uso de wildcard (*) pode afetar mais arquivos do que o esperado.");
+    }
+    if (chmod_777) {
         result.warnings.push_back("chmod 777 remove todas as restricoes de seguranca do arquivo.");
     }
     
-    // Generate prediction via Gemini
-    std::ostringstream prompt;
-    prompt << "Voce e um simulador de comandos Linux. Preveja o que aconteceria se o seguinte comando fosse executado.\n\n"
-           << "Comando: " << command << "\n\n"
-           << "Responda em formato estruturado:\n"
-           << "ARQUIVOS_AFETADOS: (liste arquivos/diretorios que seriam modificados, criados ou deletados)\n"
-           << "SAIDA_ESPERADA: (o que apareceria no terminal)\n"
-           << "RISCOS: (possiveis problemas ou efeitos colaterais)\n"
-           << "NIVEL_DESTRUTIVIDADE: (BAIXO, MEDIO, ALTO)\n\n"
-           << "Responda em Portugues (Brasil). Seja preciso e tecnico.";
+    // Site rules know commands the builtin checks above do not
+    RiskAssessment risk = assessRisk(ast);
+    if (risk.needsConfirmation() && risk.source != "builtin" && !risk.source.empty()) {
+        result.warnings.push_back("Regra local " + risk.source + ": " + risk.rule + " (" +
+                                  toString(risk.severity) + ")");
+    }
+}
+
+// Renders into prompt, which keeps its capacity between simulations
+void predictionPrompt(const std::string& language, const std::string& command, const SimulationResult& result,
+                      std::string& prompt) {
+    std::string observed;
+    if (result.dry_run) {
+        // Ground the prediction on what the sandbox observed
+        const auto& dry_run = *result.dry_run;
+        std::string files;
+        for (const auto& file : result.files_affected) {
+            files += "- " + file + "\n";
+        }
+        prompts::DRY_RUN_OBSERVATION.render(observed, {std::to_string(dry_run.exit_status),
+                                                       dry_run.timed_out ? " (interrompido por tempo limite)" : "",
+                                                       dry_run.output, files});
+    }
+    prompts::PREDICTION.render(prompt, {language, command, observed});
+}
+
+// Serializes observer calls from the probing threads and the model stream.
+// Prediction chunks that arrive before the blast radius is known are held
+// and flushed right after it, so the facts never land mid-prediction.
+class StageGate {
+public:
+    explicit StageGate(SimulationObserver& observer) : observer_(observer) {}
+    
+    void impact(const std::optional<ImpactReport>& impact) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (impact) observer_.onImpact(*impact);
+        if (!held_.empty()) observer_.onPredictionChunk(held_);
+        held_.clear();
+        open_ = true;
+    }
+    
+    void dryRun(const DryRunResult& dry_run) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        observer_.onDryRun(dry_run);
+    }
+    
+    void chunk(std::string_view chunk) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (open_) {
+            observer_.onPredictionChunk(chunk);
+        } else {
+            held_.append(chunk);
+        }
+    }
+    
+private:
+    SimulationObserver& observer_;
+    std::mutex mutex_;
+    std::string held_;
+    bool open_ = false;
+};
+
+} // anonymous namespace
+
+Simulator::Simulator(GeminiClient& gemini) : gemini_(gemini) {}
+
+Simulator::~Simulator() = default;
+
+void Simulator::enableDryRun(DryRunOptions options) {
+    dry_run_ = std::move(options);
+}
+
+bool Simulator::isDangerous(const std::string& command) {
+    ShellAst ast(command);
+    return isDangerous(ast);
+}
+
+bool Simulator::isDangerous(const ShellAst& ast) {
+    return isDestructive(ast);
+}
+
+SimulationResult Simulator::simulate(const std::string& command) {
+    SimulationObserver ignore;
+    return simulate(command, ignore);
+}
+
+SimulationResult Simulator::simulate(const std::string& command, SimulationObserver& observer) {
+    SimulationResult result;
+    ShellAst ast(command);
+    addLocalWarnings(ast, result);
+    observer.onAnalysis(result);
+    
+    StageGate gate(observer);
+    
+    // Filesystem probing runs while the model request is in flight
+    auto impact = std::async(std::launch::async, [&] {
+        std::optional<ImpactReport> found;
+        ImpactReport report = analyzeImpact(ast);
+        if (!report.empty() || !report.unresolved.empty()) {
+            found = std::move(report);
+        }
+        gate.impact(found);
+        return found;
+    });
+    std::future<DryRunResult> sandbox;
+    if (dry_run_) {
+        sandbox = std::async(std::launch::async, [&] { return dryRun(command, *dry_run_); });
+    }
+    
+    // What the sandbox observed grounds the prompt, so the model waits for it
+    if (sandbox.valid()) {
+        DryRunResult dry_run = sandbox.get();
+        gate.dryRun(dry_run);
+        if (dry_run.ran) {
+            for (const auto& effect : dry_run.effects) {
+                result.files_affected.push_back(std::string(toString(effect.change)) + ": " + effect.path);
+            }
+            result.dry_run = std::move(dry_run);
+        } else {
+            result.warnings.push_back("Dry run indisponivel: " + dry_run.error);
+        }
+    }
     
-    auto response = gemini_.generateContent(prompt.str());
+    predictionPrompt(gemini_.languageInstruction(), command, result, prompt_);
+    auto response = gemini_.generateContentStreaming(prompt_, [&](const std::string& chunk) { gate.chunk(chunk); });
+    result.impact = impact.get();
     
     if (response.success) {
+        result.predicted = true;
         result.predicted_output = response.content;
         
         // Parse the response to extract structured data
         std::istringstream iss(response.content);
         std::string line;
         while (std::getline(iss, line)) {
-            if (line.find("ARQUIVOS_AFETADOS:") != std::string::npos) {
+            if (!result.dry_run && line.find("ARQUIVOS_AFETADOS:") != std::string::npos) {
                 std::string files = line.substr(line.find(":") + 1);
                 // Simple parsing - split by comma
                 std::istringstream files_stream(files);
@@ -0,0 +1,116 @@
+/**
+ * StartupProfile.cpp - Phase timestamps, process start time and the report
+ */
+
+#include "tt/StartupProfile.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <utility>
+#include <vector>
+
+#include <time.h>
+#include <unistd.h>
+
+namespace tt::startup {
+
+namespace {
+
+struct Profile {
+    int64_t main_ns = 0;
+    int64_t main_boot_ns = 0;  // CLOCK_BOOTTIME at main(), to place the process start
+    std::vector<std::pair<int64_t, std::string>> phases;
+    bool exit_hook = false;
+};
+
+Profile& profile() {
+    static Profile instance;
+    return instance;
+}
+
+int64_t readClock(clockid_t clock) {
+    timespec ts{};
+    clock_gettime(clock, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+// Process start on CLOCK_BOOTTIME, from field 22 of /proc/self/stat (clock
+// ticks since boot); -1 when unavailable
+int64_t processStartBootNs() {
+    std::ifstream file("/proc/self/stat");
+    std::string stat((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    size_t comm_end = stat.rfind(')');  // The command name may contain spaces
+    if (comm_end == std::string::npos) return -1;
+    std::istringstream fields(stat.substr(comm_end + 2));
+    std::string field;
+    // Field 3 (state) is the first after the name; starttime is field 22
+    for (int i = 3; i <= 22 && fields >> field; ++i) {
+        if (i == 22) {
+            long ticks = sysconf(_SC_CLK_TCK);
+            if (ticks <= 0) return -1;
+            return static_cast<int64_t>(std::strtoull(field.c_str(), nullptr, 10)) * 1000000000 / ticks;
+        }
+    }
+    return -1;
+}
+
+void printAtExit() {
+    std::cerr << report();
+}
+
+} // anonymous namespace
+
+int64_t clockNs() {
+    return readClock(CLOCK_MONOTONIC);
+}
+
+void begin() {
+    auto& p = profile();
+    p.main_ns = clockNs();
+    p.main_boot_ns = readClock(CLOCK_BOOTTIME);
+}
+
+void enable() {
+    auto& p = profile();
+    if (p.main_ns == 0) begin();
+    if (!p.exit_hook) {
+        p.exit_hook = true;
+        std::atexit(printAtExit);
+    }
+    detail::enabled = true;
+}
+
+void detail::record(std::string_view phase, int64_t ns) {
+    profile().phases.emplace_back(ns, std::string(phase));
+}
+
+std::string report() {
+    const auto& p = profile();
+    std::vector<std::pair<int64_t, std::string>> phases = p.phases;
+    int64_t start_boot_ns = processStartBootNs();
+    if (start_boot_ns > 0 && p.main_boot_ns > 0) {
+        phases.emplace_back(p.main_ns - (p.main_boot_ns - start_boot_ns), "process start (10 ms resolution)");
+    }
+    phases.emplace_back(p.main_ns, "main");
+    std::stable_sort(phases.begin(), phases.end(),
+                     [](const auto& a, const auto& b) { return a.first < b.first; });
+
+    std::string out = "startup profile: CLOCK_MONOTONIC ns, ms since main, ms since previous phase\n";
+    int64_t previous = phases.front().first;
+    for (const auto& [ns, phase] : phases) {
+        char line[64];
+        std::snprintf(line, sizeof(line), "  %lld %9.3f %+9.3f  ", static_cast<long long>(ns),
+                      static_cast<double>(ns - p.main_ns) / 1e6, static_cast<double>(ns - previous) / 1e6);
+        out += line;
+        out += phase;
+        out += "\n";
+        previous = ns;
+    }
+    return out;
+}
+
+} // namespace tt::startup
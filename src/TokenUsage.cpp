@@ -0,0 +1,176 @@
+/**
+ * TokenUsage.cpp - usageMetadata parsing and the per-day/per-session ledger
+ *
+ * The ledger is a small JSON file rewritten through a temporary file and a
+ * rename, so a reader never sees it half written. Two tt processes adding
+ * at the same moment can lose one of the updates; the totals are for
+ * budgeting, not billing.
+ */
+
+#include "tt/TokenUsage.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+
+#include <nlohmann/json.hpp>
+
+using json = nlohmann::json;
+
+namespace tt {
+
+namespace {
+
+uint32_t count(const json& metadata, const char* key) {
+    auto it = metadata.find(key);
+    if (it == metadata.end() || !it->is_number_unsigned()) return 0;
+    return it->get<uint32_t>();
+}
+
+json toJson(const TokenTotals& totals) {
+    return {{"requests", totals.requests},     {"prompt", totals.prompt},
+            {"cached", totals.cached},         {"candidates", totals.candidates},
+            {"thoughts", totals.thoughts},     {"last_prompt", totals.last_prompt}};
+}
+
+TokenTotals fromJson(const json& entry) {
+    TokenTotals totals;
+    totals.requests = entry.value("requests", uint64_t{0});
+    totals.prompt = entry.value("prompt", uint64_t{0});
+    totals.cached = entry.value("cached", uint64_t{0});
+    totals.candidates = entry.value("candidates", uint64_t{0});
+    totals.thoughts = entry.value("thoughts", uint64_t{0});
+    totals.last_prompt = entry.value("last_prompt", uint32_t{0});
+    return totals;
+}
+
+std::string localDate(std::chrono::system_clock::time_point when) {
+    std::time_t time = std::chrono::system_clock::to_time_t(when);
+    std::tm local{};
+    localtime_r(&time, &local);
+    char buffer[16];
+    std::strftime(buffer, sizeof(buffer), "%Y-%m-%d", &local);
+    return buffer;
+}
+
+json load(const std::string& path) {
+    std::ifstream file(path);
+    if (file.good()) {
+        try {
+            json data = json::parse(file);
+            if (data.is_object()) return data;
+        } catch (...) {}
+    }
+    return json::object();
+}
+
+void save(const std::string& path, const json& data) {
+    std::error_code ec;
+    std::filesystem::create_directories(std::filesystem::path(path).parent_path(), ec);
+    std::string partial = path + ".tmp";
+    {
+        std::ofstream file(partial);
+        file << data.dump();
+        if (!file) return;
+    }
+    std::filesystem::permissions(partial, std::filesystem::perms::owner_read | std::filesystem::perms::owner_write,
+                                 std::filesystem::perm_options::replace, ec);
+    std::rename(partial.c_str(), path.c_str());
+}
+
+} // anonymous namespace
+
+TokenUsage fromUsageMetadata(const json& metadata) {
+    TokenUsage usage;
+    if (!metadata.is_object()) return usage;
+    usage.prompt = count(metadata, "promptTokenCount");
+    usage.cached = count(metadata, "cachedContentTokenCount");
+    usage.candidates = count(metadata, "candidatesTokenCount");
+    usage.thoughts = count(metadata, "thoughtsTokenCount");
+    return usage;
+}
+
+void TokenTotals::add(const TokenUsage& usage) {
+    requests++;
+    prompt += usage.prompt;
+    cached += usage.cached;
+    candidates += usage.candidates;
+    thoughts += usage.thoughts;
+    last_prompt = usage.prompt;
+}
+
+TokenLedger::TokenLedger(const std::string& path)
+    : path_(path.empty() ? getDefaultPath() : path) {}
+
+std::string TokenLedger::getDefaultPath() {
+    const char* home = std::getenv("HOME");
+    if (!home) return "";
+    return std::string(home) + "/.tt/usage.json";
+}
+
+void TokenLedger::add(const TokenUsage& usage, const std::string& session,
+                      std::chrono::system_clock::time_point when) {
+    if (path_.empty() || usage.empty()) return;
+    json data = load(path_);
+
+    json& days = data["days"];
+    if (!days.is_object()) days = json::object();
+    std::string date = localDate(when);
+    TokenTotals day = days.contains(date) ? fromJson(days[date]) : TokenTotals{};
+    day.add(usage);
+    days[date] = toJson(day);
+    // Dates sort as text; drop the oldest
+    while (days.size() > MAX_DAYS) {
+        days.erase(days.begin());
+    }
+
+    if (!session.empty()) {
+        json& sessions = data["sessions"];
+        if (!sessions.is_object()) sessions = json::object();
+        TokenTotals totals = sessions.contains(session) ? fromJson(sessions[session]) : TokenTotals{};
+        totals.add(usage);
+        sessions[session] = toJson(totals);
+    }
+    save(path_, data);
+}
+
+std::optional<TokenTotals> TokenLedger::session(const std::string& name) const {
+    if (path_.empty()) return std::nullopt;
+    json data = load(path_);
+    auto sessions = data.find("sessions");
+    if (sessions == data.end() || !sessions->is_object() || !sessions->contains(name)) {
+        return std::nullopt;
+    }
+    return fromJson((*sessions)[name]);
+}
+
+std::vector<std::pair<std::string, TokenTotals>> TokenLedger::days() const {
+    std::vector<std::pair<std::string, TokenTotals>> out;
+    if (path_.empty()) return out;
+    json data = load(path_);
+    auto days = data.find("days");
+    if (days == data.end() || !days->is_object()) return out;
+    for (auto it = days->begin(); it != days->end(); ++it) {
+        out.emplace_back(it.key(), fromJson(it.value()));
+    }
+    return out;
+}
+
+void TokenLedger::forgetSession(const std::string& name) {
+    if (path_.empty()) return;
+    json data = load(path_);
+    auto sessions = data.find("sessions");
+    if (sessions == data.end() || !sessions->is_object() || !sessions->contains(name)) return;
+    sessions->erase(name);
+    save(path_, data);
+}
+
+void TokenLedger::clear() {
+    if (path_.empty()) return;
+    std::error_code ec;
+    std::filesystem::remove(path_, ec);
+}
+
+} // namespace tt
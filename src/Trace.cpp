@@ -0,0 +1,168 @@
+/**
+ * Trace.cpp - Span buffer and Chrome trace-event JSON writer
+ *
+ * Spans are kept in memory as complete ("X") events and written once, at
+ * exit, so recording never touches the disk while a request is timed.
+ * Timestamps come from steady_clock, relative to start().
+ */
+
+#include "tt/Trace.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <vector>
+
+#include <unistd.h>
+
+namespace tt::trace {
+
+namespace {
+
+struct Event {
+    const char* name;
+    const char* category;
+    int64_t start_us;
+    int64_t duration_us;
+    uint32_t tid;
+    std::string args;
+};
+
+struct Recorder {
+    std::mutex mutex;
+    std::string path;
+    std::vector<Event> events;
+    std::chrono::steady_clock::time_point origin = std::chrono::steady_clock::now();
+    bool exit_hook = false;
+};
+
+Recorder& recorder() {
+    static Recorder instance;
+    return instance;
+}
+
+uint32_t threadId() {
+    static std::atomic<uint32_t> next{1};
+    thread_local uint32_t id = next.fetch_add(1, std::memory_order_relaxed);
+    return id;
+}
+
+void appendEscaped(std::string& out, std::string_view text) {
+    for (char c : text) {
+        switch (c) {
+            case '"':  out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char escaped[8];
+                    std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                    out += escaped;
+                } else {
+                    out += c;
+                }
+        }
+    }
+}
+
+void appendKey(std::string& args, const char* key) {
+    if (!args.empty()) args += ',';
+    args += '"';
+    appendEscaped(args, key);
+    args += "\":";
+}
+
+void flushAtExit() {
+    if (!enabled()) return;
+    if (!flush()) {
+        std::cerr << "tt: could not write the trace to " << recorder().path << "\n";
+    }
+}
+
+} // anonymous namespace
+
+void start(const std::string& path) {
+    auto& r = recorder();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    r.path = path;
+    r.events.reserve(256);
+    if (!r.exit_hook) {
+        r.exit_hook = true;
+        std::atexit(flushAtExit);
+    }
+    detail::enabled = true;
+}
+
+int64_t now() {
+    auto elapsed = std::chrono::steady_clock::now() - recorder().origin;
+    return std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+}
+
+void record(const char* name, const char* category, int64_t start_us, int64_t duration_us, std::string args) {
+    if (!enabled()) return;
+    auto& r = recorder();
+    uint32_t tid = threadId();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    r.events.push_back({name, category, start_us, duration_us < 0 ? 0 : duration_us, tid, std::move(args)});
+}
+
+bool flush() {
+    auto& r = recorder();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    if (r.path.empty()) return false;
+
+    long pid = static_cast<long>(getpid());
+    std::string out = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    out += "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" + std::to_string(pid) +
+           ",\"tid\":1,\"args\":{\"name\":\"tt\"}}";
+    for (const auto& event : r.events) {
+        out += ",\n{\"name\":\"";
+        appendEscaped(out, event.name);
+        out += "\",\"cat\":\"";
+        appendEscaped(out, event.category);
+        out += "\",\"ph\":\"X\",\"ts\":" + std::to_string(event.start_us) +
+               ",\"dur\":" + std::to_string(event.duration_us) +
+               ",\"pid\":" + std::to_string(pid) + ",\"tid\":" + std::to_string(event.tid);
+        if (!event.args.empty()) {
+            out += ",\"args\":{" + event.args + "}";
+        }
+        out += "}";
+    }
+    out += "\n]}\n";
+
+    FILE* file = std::fopen(r.path.c_str(), "w");
+    if (!file) return false;
+    bool ok = std::fwrite(out.data(), 1, out.size(), file) == out.size();
+    return std::fclose(file) == 0 && ok;
+}
+
+bool stop() {
+    bool written = flush();
+    auto& r = recorder();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    detail::enabled = false;
+    r.events.clear();
+    r.path.clear();
+    return written;
+}
+
+void Span::arg(const char* key, std::string_view value) {
+    if (start_ < 0) return;
+    appendKey(args_, key);
+    args_ += '"';
+    appendEscaped(args_, value);
+    args_ += '"';
+}
+
+void Span::arg(const char* key, int64_t value) {
+    if (start_ < 0) return;
+    appendKey(args_, key);
+    args_ += std::to_string(value);
+}
+
+} // namespace tt::trace
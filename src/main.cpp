@@ -4,31 +4,51 @@
  * Usage:
  *   tt "como eu encontro arquivos grandes?"     # Natural language query
  *   tt explain "find . -type f -size +100M"     # Explain command
+ *   tt explain --detailed "tar -xzf a.tgz"      # In depth, streamed
  *   tt eli5 "grep -rn pattern ."                # Explain Like I'm 5
  *   tt whatif "rm -rf ./build"                  # Simulate command
+ *   tt whatif --dry-run "make clean"            # Run in a sandbox, list real changes
  *   tt auth <api_key>                           # Store API key securely
+ *   tt --trace trace.json "query"               # Record latency spans (or TT_TRACE=)
+ *   tt --profile-startup explain ls             # Time each startup phase
  */
 
-#include "tt/CommandParser.hpp"
+#include "tt/BlastRadius.hpp"
+#include "tt/CommandRunner.hpp"
+#include "tt/DangerCheck.hpp"
+#include "tt/DangerRules.hpp"
 #include "tt/GeminiClient.hpp"
 #include "tt/ExplainerEngine.hpp"
+#include "tt/HistoryAnalyzer.hpp"
+#include "tt/IntentRouter.hpp"
+#include "tt/Metrics.hpp"
+#include "tt/PromptTemplate.hpp"
+#include "tt/QueryCache.hpp"
+#include "tt/SimulationCache.hpp"
 #include "tt/Simulator.hpp"
+#include "tt/StartupProfile.hpp"
+#include "tt/TokenUsage.hpp"
+#include "tt/Trace.hpp"
 
-#include <algorithm>
-#include <array>
+#include <atomic>
+#include <cctype>
+#include <csignal>
+#include <chrono>
 #include <cstdlib>
 #include <cstring>
 #include <filesystem>
 #include <fstream>
 #include <iomanip>
 #include <iostream>
+#include <optional>
+#include <sstream>
 #include <string>
 #include <termios.h>
 #include <unistd.h>
 #include <vector>
-#include <sys/wait.h>
 
 #include <libsecret/secret.h>
+#include <nlohmann/json.hpp>
 
 namespace {
 
@@ -39,86 +59,71 @@ const std::string GREEN = "\033[32m";
 const std::string RED = "\033[31m";
 const std::string CYAN = "\033[36m";
 
-// Dangerous commands that require confirmation
-const std::vector<std::string> DANGEROUS_COMMANDS = {
-    // File deletion
-    "rm", "rmdir", "unlink", "shred",
-    // System control
-    "shutdown", "reboot", "poweroff", "halt", "init",
-    // Disk/filesystem
-    "mkfs", "fdisk", "parted", "dd", "format", "mkswap",
-    // Package management (can break system)
-    "apt-get remove", "apt remove", "apt-get purge", "apt purge",
-    "yum remove", "dnf remove", "pacman -R",
-    // Permission/ownership
-    "chmod 777", "chmod -R", "chown -R", "chgrp -R",
-    // Network
-    "iptables -F", "ufw disable",
-    // Process control
-    "kill -9", "killall", "pkill",
-    // Dangerous patterns
-    ":(){", "fork bomb",
-    // User management
-    "userdel", "deluser", "passwd",
-    // Elevated privileges
-    "sudo",
-};
+std::string formatBytes(uint64_t bytes) {
+    const char* units[] = {"B", "KB", "MB", "GB", "TB"};
+    double value = static_cast<double>(bytes);
+    size_t unit = 0;
+    while (value >= 1024 && unit + 1 < std::size(units)) {
+        value /= 1024;
+        ++unit;
+    }
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(unit == 0 ? 0 : 1) << value << " " << units[unit];
+    return out.str();
+}
 
-// Dangerous patterns (regex-like checks)
-const std::vector<std::string> DANGEROUS_PATTERNS = {
-    "> /dev/",      // Writing to devices
-    ">/dev/",
-    "> /etc/",      // Overwriting system configs
-    ">/etc/",
-    "> /boot/",     // Overwriting boot
-    ">/boot/",
-    "| rm",         // Piping to rm
-    "|rm",
-    "| dd",         // Piping to dd
-    "|dd",
-    "rf /",         // rm -rf /
-    "rf ~/",        // rm -rf home
-    "rf ~",
-    "rf .",         // rm -rf current dir
-    "mv /* ",       // Moving root
-    "mv / ",
-    "> /",          // Overwriting files with redirect
-    "| tee /",      // Overwriting via tee
-    "|tee /",
-    "chmod 000",    // Removing all permissions
-    ":(){ :",       // Fork bomb
-    "/dev/null >",  // Redirecting to null
-    "/dev/zero",    // dd from zero
-    "/dev/random",
-};
+// What the command would touch, from a bounded walk of its expanded operands
+void printImpact(const tt::ImpactReport& impact) {
+    if (!impact.empty()) {
+        std::cout << RED << "Affects " << (impact.complete ? "" : "at least ") << impact.files << " file(s)";
+        if (impact.directories > 0) {
+            std::cout << " in " << impact.directories << " director" << (impact.directories == 1 ? "y" : "ies");
+        }
+        std::cout << ", " << formatBytes(impact.bytes) << RESET;
+        if (!impact.complete) {
+            std::cout << " (partial: stopped after " << static_cast<long>(impact.elapsed_ms) << " ms)";
+        }
+        std::cout << "\n";
+        for (const auto& dir : impact.top) {
+            std::cout << "  " << std::setw(10) << formatBytes(dir.bytes) << "  " << dir.path
+                      << " (" << dir.files << " files)\n";
+        }
+        if (impact.unreadable > 0) {
+            std::cout << "  " << impact.unreadable << " director" << (impact.unreadable == 1 ? "y" : "ies")
+                      << " could not be read\n";
+        }
+    }
+    for (const auto& word : impact.unresolved) {
+        std::cout << "  Not expanded: " << word << "\n";
+    }
+}
 
-bool isDangerousCommand(const std::string& cmd) {
-    std::string lower_cmd = cmd;
-    std::transform(lower_cmd.begin(), lower_cmd.end(), lower_cmd.begin(), ::tolower);
-    
-    // Check exact command matches (at start or after pipe/sudo)
-    for (const auto& dangerous : DANGEROUS_COMMANDS) {
-        // Check if command starts with dangerous command
-        if (lower_cmd.find(dangerous) == 0) return true;
-        // Check after pipe
-        if (lower_cmd.find("| " + dangerous) != std::string::npos) return true;
-        if (lower_cmd.find("|" + dangerous) != std::string::npos) return true;
-        // Check after sudo
-        if (lower_cmd.find("sudo " + dangerous) != std::string::npos) return true;
+void printBlastRadius(const std::string& cmd) {
+    tt::ImpactReport impact = tt::analyzeImpact(cmd);
+    if (impact.empty() && impact.unresolved.empty()) {
+        return;
     }
-    
-    // Check patterns
-    for (const auto& pattern : DANGEROUS_PATTERNS) {
-        if (lower_cmd.find(pattern) != std::string::npos) return true;
+    printImpact(impact);
+    std::cout << "\n";
+}
+
+void printRisk(const tt::RiskAssessment& risk) {
+    std::string severity = tt::toString(risk.severity);
+    for (auto& c : severity) c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+    std::cout << "Risk: " << BOLD << severity << RESET << " (" << risk.score << "/100)";
+    if (!risk.rule.empty()) {
+        std::cout << " — " << risk.rule << " (" << risk.source << ")";
     }
-    
-    return false;
+    std::cout << "\n";
 }
 
-bool askDangerousConfirmation(const std::string& cmd) {
+bool askDangerousConfirmation(const std::string& cmd, const tt::RiskAssessment& risk) {
     std::cout << "\n" << RED << BOLD << "⚠️  WARNING: POTENTIALLY DANGEROUS COMMAND!" << RESET << "\n";
     std::cout << RED << "This command may cause irreversible damage to your system or data." << RESET << "\n";
-    std::cout << "Command: " << BOLD << cmd << RESET << "\n\n";
+    std::cout << "Command: " << BOLD << cmd << RESET << "\n";
+    printRisk(risk);
+    std::cout << "\n";
+    printBlastRadius(cmd);
     std::cout << YELLOW << "Type 'yes' to confirm execution: " << RESET;
     std::cout.flush();
     
@@ -127,6 +132,19 @@ bool askDangerousConfirmation(const std::string& cmd) {
     return (response == "yes");
 }
 
+// Asks for confirmation at MEDIUM and above; LOW findings are only shown
+bool confirmRisk(const std::string& cmd) {
+    tt::RiskAssessment risk = tt::assessRisk(cmd);
+    if (risk.needsConfirmation()) {
+        return askDangerousConfirmation(cmd, risk);
+    }
+    if (risk.severity == tt::Severity::LOW) {
+        std::cout << YELLOW << "Note: " << RESET;
+        printRisk(risk);
+    }
+    return true;
+}
+
 // libsecret schema for storing the API key
 const SecretSchema TT_API_SCHEMA = {
     "com.terminaltutor.credentials",
@@ -137,7 +155,10 @@ const SecretSchema TT_API_SCHEMA = {
     }
 };
 
-std::string getFromKeyring(const std::string& type) {
+// failed (optional) is set when the keyring could not be asked, as opposed to having no value
+std::string getFromKeyring(const std::string& type, bool* failed_out = nullptr) {
+    tt::trace::Span span("keyring.lookup", "config");
+    span.arg("type", type);
     GError* error = nullptr;
     gchar* value = secret_password_lookup_sync(
         &TT_API_SCHEMA,
@@ -147,20 +168,89 @@ std::string getFromKeyring(const std::string& type) {
         NULL
     );
     
-    if (error != nullptr) {
+    bool failed = error != nullptr;
+    std::string result;
+    if (failed) {
         g_error_free(error);
-        return "";
+    } else if (value != nullptr) {
+        result = value;
+        secret_password_free(value);
     }
     
-    if (value == nullptr) {
-        return "";
+    // The label is only built while profiling
+    if (tt::startup::enabled()) {
+        tt::startup::mark((failed ? "keyring lookup failed: " : "keyring lookup: ") + type);
     }
-    
-    std::string result(value);
-    secret_password_free(value);
+    if (failed_out) *failed_out = failed;
     return result;
 }
 
+// Settings that are not secret are mirrored into ~/.config/tt/settings.json
+// whenever tt stores them, and read from there, so paths that never call the
+// API (cache hits) need no D-Bus round trip. A missing mirror is rebuilt from
+// the keyring once. The API key stays in the keyring only.
+const char* const MIRRORED_SETTINGS[] = {"model", "language", "dryrun_roots", "run_limits"};
+
+std::filesystem::path settingsMirrorPath() {
+    const char* home = std::getenv("HOME");
+    if (!home) return {};
+    return std::filesystem::path(home) / ".config" / "tt" / "settings.json";
+}
+
+void saveSettingsMirror(const nlohmann::json& settings) {
+    std::filesystem::path path = settingsMirrorPath();
+    if (path.empty()) return;
+    std::error_code ec;
+    std::filesystem::create_directories(path.parent_path(), ec);
+    std::string partial = path.string() + ".tmp" + std::to_string(getpid());
+    {
+        std::ofstream file(partial);
+        if (!file.good()) return;
+        std::filesystem::permissions(partial, std::filesystem::perms::owner_read | std::filesystem::perms::owner_write,
+                                     std::filesystem::perm_options::replace, ec);
+        file << settings.dump(2);
+        if (!file) {
+            file.close();
+            std::filesystem::remove(partial, ec);
+            return;
+        }
+    }
+    if (std::rename(partial.c_str(), path.c_str()) != 0) {
+        std::filesystem::remove(partial, ec);
+    }
+}
+
+nlohmann::json& settingsMirror() {
+    static std::optional<nlohmann::json> mirror;
+    if (mirror) return *mirror;
+    
+    std::ifstream file(settingsMirrorPath());
+    if (file.good()) {
+        try {
+            nlohmann::json data = nlohmann::json::parse(file);
+            if (data.is_object()) return *(mirror = std::move(data));
+        } catch (...) {}
+    }
+    
+    // Kept only when every lookup reached the keyring, else a locked
+    // keyring would be remembered as empty settings
+    mirror = nlohmann::json::object();
+    bool complete = true;
+    for (const char* type : MIRRORED_SETTINGS) {
+        bool failed = false;
+        (*mirror)[type] = getFromKeyring(type, &failed);
+        complete = complete && !failed;
+    }
+    if (complete) saveSettingsMirror(*mirror);
+    return *mirror;
+}
+
+std::string getSetting(const char* type) {
+    const nlohmann::json& settings = settingsMirror();
+    auto it = settings.find(type);
+    return it != settings.end() && it->is_string() ? it->get<std::string>() : "";
+}
+
 bool storeInKeyring(const std::string& type, const std::string& value, const std::string& label) {
     GError* error = nullptr;
     gboolean success = secret_password_store_sync(
@@ -179,8 +269,15 @@ bool storeInKeyring(const std::string& type, const std::string& value, const std
         g_error_free(error);
         return false;
     }
+    if (success != TRUE) return false;
     
-    return success == TRUE;
+    for (const char* mirrored : MIRRORED_SETTINGS) {
+        if (type == mirrored) {
+            settingsMirror()[type] = value;
+            saveSettingsMirror(settingsMirror());
+        }
+    }
+    return true;
 }
 
 std::string getApiKey() {
@@ -210,7 +307,7 @@ std::string getApiKey() {
 }
 
 std::string getModel() {
-    std::string model = getFromKeyring("model");
+    std::string model = getSetting("model");
     if (!model.empty()) {
         return model;
     }
@@ -218,30 +315,67 @@ std::string getModel() {
 }
 
 std::string getLanguage() {
-    std::string lang = getFromKeyring("language");
+    std::string lang = getSetting("language");
     if (!lang.empty()) {
         return lang;
     }
     return tt::GeminiClient::getDefaultLanguage();
 }
 
+// Extra writable directories for whatif --dry-run, ':'-separated
+std::string getDryRunRoots() {
+    return getSetting("dryrun_roots");
+}
+
+// Execution policy for commands suggested by the model, see parseRunLimits()
+tt::RunLimits getRunLimits() {
+    std::string error;
+    auto limits = tt::parseRunLimits(getSetting("run_limits"), error);
+    return limits ? *limits : tt::RunLimits::defaults();
+}
+
+std::vector<std::string> splitRoots(const std::string& roots) {
+    std::vector<std::string> out;
+    size_t start = 0;
+    while (start <= roots.size()) {
+        size_t end = roots.find(':', start);
+        if (end == std::string::npos) end = roots.size();
+        if (end > start) out.push_back(roots.substr(start, end - start));
+        start = end + 1;
+    }
+    return out;
+}
+
 void printUsage() {
     std::cout << BOLD << "TerminalTutor" << RESET << " - CLI tutor that lives in your shell\n\n"
               << BOLD << "Usage:" << RESET << "\n"
               << "  tt \"your question\"               Ask anything (streaming)\n"
               << "  tt --run \"task\"                  Execute a command for the task\n"
               << "  tt explain <command>            Explain the command\n"
+              << "  tt explain --detailed <command> In depth, with examples (streamed)\n"
               << "  tt eli5 <command>               Explain like I'm 5\n"
               << "  tt whatif <command>             Simulate what would happen\n"
+              << "  tt whatif --dry-run <command>   Run it in a sandbox and list real file changes\n"
               << "  tt --console                    Interactive console mode\n"
               << "  tt --auth                       Store API key securely\n"
               << "  tt --config list                Show current configuration\n"
               << "  tt --config reset               Reset to defaults\n"
               << "  tt --config model=<name>        Set Gemini model\n"
               << "  tt --config language=<lang>     Set response language\n"
+              << "  tt --config dryrun-roots=<a:b>  Extra writable dirs for whatif --dry-run\n"
+              << "  tt --config limits=<spec>       Limits for --run commands (timeout=,cpu=,memory=,...)\n"
               << "  tt --session <name> \"query\"     Persistent conversation\n"
               << "  tt --session list               List sessions\n"
               << "  tt --session delete <name>      Delete session\n"
+              << "  tt --cache stats                Show --run cache hit quality\n"
+              << "  tt --cache clear                Clear the --run and whatif caches\n"
+              << "  tt --rules check                List danger rule files and errors\n"
+              << "  tt --history report             Most used commands and flags\n"
+              << "  tt --history clear              Forget history statistics\n"
+              << "  tt --stats [7d|24h|all]         Latency percentiles, tokens and cache hits\n"
+              << "  tt --stats --prometheus [file]  Same, as a node_exporter textfile\n"
+              << "  tt --trace <file> ...           Write latency spans as Chrome trace JSON\n"
+              << "  tt --profile-startup ...        Print when each startup phase was reached\n"
               << "  tt --help                       Show this help\n\n"
               << BOLD << "Examples:" << RESET << "\n"
               << "  tt \"what is a process?\"                     # streaming explanation\n"
@@ -261,29 +395,137 @@ void printExplanation(const std::string& content) {
     std::cout << "\n" << CYAN << "📖" << RESET << " " << content << "\n";
 }
 
+// Set by Ctrl-C while an answer streams
+std::atomic<bool> stream_cancelled{false};
+
+void cancelStream(int) {
+    stream_cancelled.store(true);
+}
+
+// In-depth explanation, printed as it arrives; Ctrl-C stops the answer, not tt
+int streamDetailedExplanation(tt::GeminiClient& gemini, const std::string& command) {
+    tt::ExplainerEngine explainer(gemini);
+    struct sigaction on_interrupt {};
+    struct sigaction previous {};
+    on_interrupt.sa_handler = cancelStream;
+    sigaction(SIGINT, &on_interrupt, &previous);
+    
+    std::cout << "\n" << CYAN << "📖" << RESET << " ";
+    std::cout.flush();
+    bool streamed = false;
+    std::string text = explainer.explainStreaming(command, tt::ExplainMode::DETAILED, [&](const std::string& chunk) {
+        std::cout << chunk;
+        std::cout.flush();
+        streamed = true;
+    }, &stream_cancelled);
+    sigaction(SIGINT, &previous, nullptr);
+    
+    const tt::StreamTiming& timing = explainer.timings().back();
+    if (!streamed && !timing.cancelled) {
+        std::cerr << RED << text << RESET << "\n";
+        return 1;
+    }
+    
+    std::cout << "\n\n" << CYAN << "⏱  ";
+    if (timing.ttft_ms >= 0) {
+        std::cout << "first token " << static_cast<long>(timing.ttft_ms) << " ms, ";
+    }
+    std::cout << "total " << static_cast<long>(timing.total_ms) << " ms" << (timing.cancelled ? " (cancelled)" : "")
+              << RESET << "\n";
+    return 0;
+}
+
 void printWarning(const std::string& content) {
     std::cout << "\n" << RED << "⚠️  " << BOLD << content << RESET << "\n";
 }
 
-void printSimulation(const tt::SimulationResult& result) {
-    if (result.is_destructive) {
-        printWarning("POTENTIALLY DESTRUCTIVE COMMAND!");
+// Renders each whatif stage as the simulator reports it
+class SimulationPrinter : public tt::SimulationObserver {
+public:
+    void onAnalysis(const tt::SimulationResult& result) override {
+        local_destructive_ = result.is_destructive;
+        if (result.is_destructive) {
+            printWarning("POTENTIALLY DESTRUCTIVE COMMAND!");
+        }
+        for (const auto& warning : result.warnings) {
+            std::cout << RED << "⚠️  " << warning << RESET << "\n";
+        }
+        std::cout.flush();
     }
     
-    for (const auto& warning : result.warnings) {
-        std::cout << RED << "⚠️  " << warning << RESET << "\n";
+    void onImpact(const tt::ImpactReport& impact) override {
+        std::cout << "\n" << CYAN << "📂 Blast radius" << RESET << "\n";
+        printImpact(impact);
+        std::cout.flush();
     }
     
-    std::cout << "\n" << CYAN << "🔮 Simulation:" << RESET << "\n";
-    std::cout << result.predicted_output << "\n";
+    void onDryRun(const tt::DryRunResult& dry_run) override {
+        if (!dry_run.ran) {
+            std::cout << RED << "⚠️  Dry run unavailable: " << dry_run.error << RESET << "\n";
+            return;
+        }
+        std::cout << "\n" << CYAN << "🧪 Dry run" << RESET << " (sandbox, " << static_cast<long>(dry_run.total_ms)
+                  << " ms): exit " << dry_run.exit_status << (dry_run.timed_out ? ", timed out" : "") << "\n";
+        if (!dry_run.output.empty()) {
+            std::cout << dry_run.output << (dry_run.output.back() == '\n' ? "" : "\n");
+        }
+        
+        constexpr size_t MAX_LISTED = 50;
+        for (size_t i = 0; i < dry_run.effects.size() && i < MAX_LISTED; ++i) {
+            const auto& effect = dry_run.effects[i];
+            if (effect.change == tt::FileChange::CREATED) std::cout << GREEN << "  + ";
+            else if (effect.change == tt::FileChange::DELETED) std::cout << RED << "  - ";
+            else std::cout << YELLOW << "  ~ ";
+            std::cout << effect.path << RESET << "\n";
+        }
+        if (dry_run.effects.size() > MAX_LISTED) {
+            std::cout << "  ... " << dry_run.effects.size() - MAX_LISTED << " more\n";
+        }
+        if (dry_run.effects.empty()) {
+            std::cout << "  (no files changed)\n";
+        }
+        std::cout.flush();
+    }
     
-    if (!result.files_affected.empty()) {
-        std::cout << "\n" << BOLD << "Files affected:" << RESET << "\n";
-        for (const auto& file : result.files_affected) {
-            std::cout << "  - " << file << "\n";
+    void onPredictionChunk(std::string_view chunk) override {
+        if (!streamed_) {
+            std::cout << "\n" << CYAN << "🔮 Simulation:" << RESET << "\n";
+            streamed_ = true;
         }
+        std::cout << chunk;
+        std::cout.flush();
     }
-}
+    
+    // A cached result, stage by stage
+    void replay(const tt::SimulationResult& result) {
+        onAnalysis(result);
+        if (result.impact) onImpact(*result.impact);
+        if (result.dry_run) onDryRun(*result.dry_run);
+        finish(result);
+    }
+    
+    // What only the complete prediction tells
+    void finish(const tt::SimulationResult& result) {
+        if (!streamed_) {
+            std::cout << "\n" << CYAN << "🔮 Simulation:" << RESET << "\n" << result.predicted_output;
+        }
+        std::cout << "\n";
+        
+        if (result.is_destructive && !local_destructive_) {
+            printWarning("POTENTIALLY DESTRUCTIVE COMMAND!");
+        }
+        if (!result.dry_run && !result.files_affected.empty()) {
+            std::cout << "\n" << BOLD << "Files affected:" << RESET << "\n";
+            for (const auto& file : result.files_affected) {
+                std::cout << "  - " << file << "\n";
+            }
+        }
+    }
+    
+private:
+    bool local_destructive_ = false;
+    bool streamed_ = false;
+};
 
 bool askConfirmation(const std::string& command) {
     std::cout << "\n" << GREEN << "Execute? [y/N] " << RESET;
@@ -296,39 +538,304 @@ int executeCommand(const std::string& command) {
     return std::system(command.c_str());
 }
 
-// Execute command and capture output (for session context)
-std::pair<int, std::string> executeAndCapture(const std::string& command) {
-    std::string output;
-    std::array<char, 256> buffer;
+// Execute command, streaming its output, and report what it cost. The
+// output kept for session context is limited to the first 2000 chars.
+tt::RunResult executeAndCapture(const std::string& command, const tt::RunLimits& limits) {
+    bool at_line_start = true;
+    tt::RunOptions options;
+    options.limits = limits;
+    tt::RunResult result = tt::runCommand(command, [&](std::string_view chunk) {
+        std::cout << chunk;
+        std::cout.flush();
+        at_line_start = chunk.back() == '\n';
+    }, options);
+    if (!result.error.empty()) {
+        result.output = "Failed to execute command: " + result.error;
+        std::cerr << RED << result.output << RESET << "\n";
+        return result;
+    }
+    if (result.truncated) {
+        result.output += "\n... [output truncated]";
+    }
     
-    // Redirect stderr to stdout to capture all output
-    std::string cmd = command + " 2>&1";
-    FILE* pipe = popen(cmd.c_str(), "r");
-    if (!pipe) {
-        return {-1, "Failed to execute command"};
+    std::cout << (at_line_start ? "" : "\n") << CYAN << "⏱  " << result.usage.summary() << RESET << "\n";
+    std::string outcome = result.outcome(options.limits);
+    if (!outcome.empty()) {
+        std::cout << YELLOW << "⛔ " << outcome << " (tt --config limits=...)" << RESET << "\n";
+    }
+    return result;
+}
+
+// What a run cost and which limit it hit, for the session context
+std::string runReport(const tt::RunResult& run, const tt::RunLimits& limits) {
+    std::string report = run.usage.summary() + "; exit code " + std::to_string(run.exit_code);
+    std::string outcome = run.outcome(limits);
+    if (!outcome.empty()) {
+        report += "; stopped by tt's execution policy: " + outcome;
     }
+    return report;
+}
+
+// Settings and the API client, read and built on first use so answers from
+// the local caches need no keyring, session or TLS setup
+class Backend {
+public:
+    explicit Backend(const std::string& session_name) : session_name_(session_name) {}
     
-    while (fgets(buffer.data(), buffer.size(), pipe) != nullptr) {
-        std::string chunk = buffer.data();
-        output += chunk;
-        std::cout << chunk; // Also print to terminal in real-time
-        std::cout.flush();
+    const std::string& model() {
+        if (!model_) model_ = getModel();
+        return *model_;
+    }
+    
+    const std::string& language() {
+        if (!language_) language_ = getLanguage();
+        return *language_;
+    }
+    
+    const tt::RunLimits& runLimits() {
+        if (!run_limits_) run_limits_ = getRunLimits();
+        return *run_limits_;
+    }
+    
+    // nullptr, with the error printed, when no API key is configured
+    tt::GeminiClient* client() {
+        if (!client_) {
+            std::string api_key = getApiKey();
+            if (api_key.empty()) {
+                std::cerr << RED << "Error: API key not configured." << RESET << "\n";
+                std::cerr << "Configure with: tt auth\n";
+                return nullptr;
+            }
+            client_.emplace(api_key, model(), language(), session_name_);
+            tt::startup::mark("API client ready");
+        }
+        return &*client_;
+    }
+    
+    // The model for the metrics store; "local" when no answer needed one
+    std::string meteredModel() const { return model_ ? *model_ : "local"; }
+    
+    tt::ClientUsage usage() const { return client_ ? client_->usage() : tt::ClientUsage{}; }
+    
+private:
+    std::string session_name_;
+    std::optional<std::string> model_;
+    std::optional<std::string> language_;
+    std::optional<tt::RunLimits> run_limits_;
+    std::optional<tt::GeminiClient> client_;
+};
+
+// Records one request in the metrics store when it goes out of scope
+class RequestMeter {
+public:
+    RequestMeter(tt::RequestMode mode, const Backend& backend)
+        : backend_(backend), before_(backend.usage()), started_(std::chrono::steady_clock::now()) {
+        metrics_.time = std::chrono::system_clock::now();
+        metrics_.mode = mode;
+    }
+    
+    ~RequestMeter() {
+        if (!answered_) answered();
+        tt::ClientUsage usage = backend_.usage();
+        metrics_.model = backend_.meteredModel();
+        metrics_.model_ms = usage.latency_ms - before_.latency_ms;
+        if (usage.requests > before_.requests) {
+            metrics_.first_byte_ms = usage.first_byte_ms;
+        }
+        metrics_.input_tokens = usage.tokens.prompt - before_.tokens.prompt;
+        metrics_.cached_tokens = usage.tokens.cached - before_.tokens.cached;
+        metrics_.output_tokens = usage.tokens.output() - before_.tokens.output();
+        tt::MetricsStore().append(metrics_);
+    }
+    
+    RequestMeter(const RequestMeter&) = delete;
+    RequestMeter& operator=(const RequestMeter&) = delete;
+    
+    // The answer is complete; confirmation and running the command are not latency
+    void answered() {
+        metrics_.total_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started_).count();
+        answered_ = true;
+    }
+    
+    void cacheHit() { metrics_.cache_hit = true; }
+    void failed() { metrics_.error = true; }
+    
+private:
+    const Backend& backend_;
+    tt::ClientUsage before_;
+    std::chrono::steady_clock::time_point started_;
+    tt::RequestMetrics metrics_;
+    bool answered_ = false;
+};
+
+std::string formatSeconds(double ms) {
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(2) << ms / 1000 << "s";
+    return out.str();
+}
+
+// tt --stats [window] [--prometheus [file]] | clear
+int runStats(const std::vector<std::string>& args) {
+    const char* usage = "Usage: tt --stats [30m|24h|7d|2w|all] [--prometheus [file]] | tt --stats clear";
+    tt::MetricsStore store;
+    if (args.size() == 1 && args[0] == "clear") {
+        store.clear();
+        std::cout << GREEN << "Metrics cleared." << RESET << "\n";
+        return 0;
+    }
+    
+    std::string window_text = "7d";
+    bool prometheus = false;
+    std::string output;  // Prometheus textfile; stdout when empty
+    for (size_t i = 0; i < args.size(); ++i) {
+        if (args[i] == "--prometheus") {
+            prometheus = true;
+            if (i + 1 < args.size()) output = args[++i];
+        } else {
+            window_text = args[i];
+        }
+    }
+    auto window = tt::parseWindow(window_text);
+    if (!window) {
+        std::cerr << RED << usage << RESET << "\n";
+        return 1;
+    }
+    
+    std::chrono::system_clock::time_point since{};
+    if (window->count() > 0) since = std::chrono::system_clock::now() - *window;
+    tt::MetricsReport report = tt::summarize(store.read(since));
+    
+    if (prometheus) {
+        std::string text = tt::toPrometheus(report);
+        if (output.empty()) {
+            std::cout << text;
+            return 0;
+        }
+        // node_exporter may read the file at any time: write aside, then rename;
+        // the pid keeps concurrent exports (cron, a timer) off each other's file
+        std::string partial = output + ".tmp" + std::to_string(getpid());
+        std::ofstream file(partial);
+        file << text;
+        file.close();
+        if (!file || std::rename(partial.c_str(), output.c_str()) != 0) {
+            std::error_code ec;
+            std::filesystem::remove(partial, ec);
+            std::cerr << RED << "Error: could not write " << output << RESET << "\n";
+            return 1;
+        }
+        return 0;
     }
     
-    int status = pclose(pipe);
-    int exit_code = WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+    const tt::MetricsGroup& all = report.all;
+    std::string label = window->count() > 0 ? "last " + window_text : "all time";
+    std::cout << BOLD << "Requests (" << label << "):" << RESET << " " << all.requests;
+    if (all.requests == 0) {
+        std::cout << "\n";
+        return 0;
+    }
+    std::cout << ", " << all.errors << " failed, " << all.cache_hits << " from cache (" << std::fixed
+              << std::setprecision(1) << 100.0 * all.cache_hits / all.requests << "%)\n"
+              << "  Latency: p50 " << formatSeconds(all.p50_ms) << ", p95 " << formatSeconds(all.p95_ms)
+              << ", p99 " << formatSeconds(all.p99_ms) << "; " << formatSeconds(all.model_ms) << " waiting on the model\n"
+              << "  Tokens:  " << all.input_tokens << " input (" << all.cached_tokens << " cached), "
+              << all.output_tokens << " output\n\n";
     
-    // Limit output size for history (first 2000 chars)
-    if (output.size() > 2000) {
-        output = output.substr(0, 2000) + "\n... [output truncated]";
+    std::cout << BOLD << std::left << std::setw(9) << "mode" << std::setw(26) << "model" << std::right
+              << std::setw(6) << "reqs" << std::setw(6) << "err" << std::setw(8) << "cache" << std::setw(9) << "p50"
+              << std::setw(9) << "p95" << std::setw(9) << "p99" << std::setw(10) << "tokens" << RESET << "\n";
+    for (const auto& group : report.groups) {
+        std::ostringstream hit_rate;
+        hit_rate << std::fixed << std::setprecision(1) << 100.0 * group.cache_hits / group.requests << "%";
+        std::cout << std::left << std::setw(9) << tt::toString(group.mode) << std::setw(26) << group.model
+                  << std::right << std::setw(6) << group.requests << std::setw(6) << group.errors
+                  << std::setw(8) << hit_rate.str() << std::setw(9) << formatSeconds(group.p50_ms)
+                  << std::setw(9) << formatSeconds(group.p95_ms) << std::setw(9) << formatSeconds(group.p99_ms)
+                  << std::setw(10) << group.input_tokens + group.output_tokens << "\n";
     }
     
-    return {exit_code, output};
+    // Daily totals come from the token ledger, which every response updates
+    auto days = tt::TokenLedger().days();
+    constexpr size_t SHOWN_DAYS = 7;
+    if (!days.empty()) {
+        std::cout << "\n" << BOLD << std::left << std::setw(12) << "day" << std::right << std::setw(6) << "reqs"
+                  << std::setw(11) << "input" << std::setw(11) << "cached" << std::setw(11) << "output"
+                  << std::setw(11) << "thinking" << RESET << "\n";
+    }
+    for (size_t i = days.size() > SHOWN_DAYS ? days.size() - SHOWN_DAYS : 0; i < days.size(); ++i) {
+        const auto& [date, totals] = days[i];
+        std::cout << std::left << std::setw(12) << date << std::right << std::setw(6) << totals.requests
+                  << std::setw(11) << totals.prompt << std::setw(11) << totals.cached << std::setw(11)
+                  << totals.candidates << std::setw(11) << totals.thoughts << "\n";
+    }
+    return 0;
+}
+
+// True when the first word of a command line is an executable on PATH
+bool startsWithExecutable(const std::string& line) {
+    std::string name = line.substr(0, line.find_first_of(" \t"));
+    if (name.empty()) return false;
+    if (name.find('/') != std::string::npos) {
+        return access(name.c_str(), X_OK) == 0;
+    }
+    
+    const char* path_env = std::getenv("PATH");
+    if (!path_env) return false;
+    
+    std::string path = path_env;
+    size_t start = 0;
+    while (start <= path.size()) {
+        size_t end = path.find(':', start);
+        if (end == std::string::npos) end = path.size();
+        std::string dir = path.substr(start, end - start);
+        if (!dir.empty() && access((dir + "/" + name).c_str(), X_OK) == 0) {
+            return true;
+        }
+        start = end + 1;
+    }
+    return false;
+}
+
+// Routes obvious inputs locally; returns false when smartQuery must decide
+bool routeLocally(tt::GeminiClient& gemini, const std::string& line, tt::SmartResponse& smart) {
+    auto intent = tt::routeIntent(line);
+    if (!intent) return false;
+    
+    switch (*intent) {
+        case tt::Intent::EXPLAIN:
+            smart.type = tt::SmartResponse::Type::EXPLAIN;
+            smart.success = true;
+            return true;
+        
+        case tt::Intent::SHELL:
+            // Only lines that start with a real program run as typed
+            if (!startsWithExecutable(line)) return false;
+            smart.type = tt::SmartResponse::Type::EXECUTE;
+            smart.command = line;
+            smart.success = true;
+            return true;
+        
+        case tt::Intent::TASK: {
+            auto response = gemini.getCommandForTask(line);
+            smart.success = response.success;
+            if (!response.success) {
+                smart.type = tt::SmartResponse::Type::ERROR;
+                smart.error = response.error;
+                return true;
+            }
+            // Explanation is stored in error field from getCommandForTask
+            smart.type = tt::SmartResponse::Type::EXECUTE;
+            smart.command = response.content;
+            smart.explanation = response.error;
+            return true;
+        }
+    }
+    return false;
 }
 
 } // anonymous namespace
 
 int main(int argc, char* argv[]) {
+    tt::startup::begin();
     if (argc < 2) {
         printUsage();
         return 0;
@@ -341,6 +848,10 @@ int main(int argc, char* argv[]) {
         return 0;
     }
     
+    if (const char* trace_path = std::getenv("TT_TRACE"); trace_path && *trace_path) {
+        tt::trace::start(trace_path);
+    }
+    
     // Parse all flags first (in any order)
     std::string session_name;
     bool run_mode = false;
@@ -363,8 +874,15 @@ int main(int argc, char* argv[]) {
                     std::cout << "No sessions found.\n";
                 } else {
                     std::cout << BOLD << "Available sessions:" << RESET << "\n";
+                    tt::TokenLedger ledger;
                     for (const auto& s : sessions) {
-                        std::cout << "  " << s << "\n";
+                        std::cout << "  " << std::left << std::setw(20) << s << std::right;
+                        if (auto totals = ledger.session(s)) {
+                            std::cout << " " << totals->last_prompt << " tokens of history, "
+                                      << totals->prompt + totals->candidates + totals->thoughts << " spent in "
+                                      << totals->requests << " requests";
+                        }
+                        std::cout << "\n";
                     }
                 }
                 return 0;
@@ -378,6 +896,7 @@ int main(int argc, char* argv[]) {
                 }
                 std::string to_delete = std::string(std::getenv("HOME")) + "/.tt/" + argv[arg_idx] + ".json";
                 if (std::remove(to_delete.c_str()) == 0) {
+                    tt::TokenLedger().forgetSession(argv[arg_idx]);
                     std::cout << GREEN << "Session '" << argv[arg_idx] << "' deleted." << RESET << "\n";
                 } else {
                     std::cerr << RED << "Session not found." << RESET << "\n";
@@ -389,6 +908,110 @@ int main(int argc, char* argv[]) {
             session_name = session_arg;
             arg_idx++;
         }
+        else if (arg == "--cache") {
+            // --cache must be standalone (only with its own argument)
+            if (argc != 3) {
+                std::cerr << RED << "Usage: tt --cache stats|clear" << RESET << "\n";
+                return 1;
+            }
+            std::string cache_arg = argv[arg_idx + 1];
+            tt::QueryCache query_cache;
+            
+            if (cache_arg == "stats") {
+                auto stats = query_cache.stats();
+                double hit_rate = stats.lookups ? 100.0 * stats.hits / stats.lookups : 0.0;
+                double mean_similarity = stats.hits ? 100.0 * stats.similarity_sum / stats.hits : 0.0;
+                std::cout << BOLD << "Query cache:" << RESET << "\n"
+                          << "  Entries:         " << stats.entries << "\n"
+                          << "  Lookups:         " << stats.lookups << "\n"
+                          << "  Hits:            " << stats.hits << " (" << std::fixed << std::setprecision(1)
+                          << hit_rate << "%)\n"
+                          << "  Exact hits:      " << stats.exact_hits << "\n"
+                          << "  Mean similarity: " << mean_similarity << "%\n";
+                return 0;
+            }
+            
+            if (cache_arg == "clear") {
+                query_cache.clear();
+                tt::SimulationCache().clear();
+                std::cout << GREEN << "Query and whatif caches cleared." << RESET << "\n";
+                return 0;
+            }
+            
+            std::cerr << RED << "Usage: tt --cache stats|clear" << RESET << "\n";
+            return 1;
+        }
+        else if (arg == "--rules") {
+            // --rules must be standalone (only with its own argument)
+            if (argc != 3 || std::string(argv[arg_idx + 1]) != "check") {
+                std::cerr << RED << "Usage: tt --rules check" << RESET << "\n";
+                return 1;
+            }
+            const tt::DangerRules& rules = tt::DangerRules::active();
+            std::cout << BOLD << "Danger rules:" << RESET << "\n"
+                      << "  Rules:  " << rules.ruleCount() << (rules.fromCache() ? " (cached image)" : "") << "\n";
+            for (const auto& dir : tt::DangerRules::defaultDirs()) {
+                std::cout << "  Dir:    " << dir << "\n";
+            }
+            for (const auto& file : rules.files()) {
+                std::cout << "  File:   " << file << "\n";
+            }
+            for (const auto& error : rules.errors()) {
+                std::cerr << RED << "  " << error.file << ":" << error.line << ": " << error.message << RESET << "\n";
+            }
+            return rules.errors().empty() ? 0 : 1;
+        }
+        else if (arg == "--history") {
+            // --history must be standalone (only with its own argument)
+            if (argc != 3) {
+                std::cerr << RED << "Usage: tt --history report|clear" << RESET << "\n";
+                return 1;
+            }
+            std::string history_arg = argv[arg_idx + 1];
+            tt::HistoryAnalyzer history;
+            
+            if (history_arg == "report") {
+                auto scan = history.update();
+                std::cout << BOLD << "Shell history:" << RESET << "\n"
+                          << "  Files:    " << scan.files << "\n"
+                          << "  Entries:  " << history.totalEntries()
+                          << " (" << scan.new_entries << " new)\n";
+                if (scan.rescanned_files > 0) {
+                    std::cout << "  Rescanned " << scan.rescanned_files << " rewritten file(s)\n";
+                }
+                
+                auto top = history.topExecutables(15);
+                if (!top.empty()) {
+                    std::cout << "\n" << BOLD << "Most used commands:" << RESET << "\n";
+                }
+                for (const auto& executable : top) {
+                    std::cout << "  " << CYAN << std::left << std::setw(14) << executable.name << RESET
+                              << std::right << std::setw(7) << executable.count;
+                    auto flags = history.topFlags(executable.name, 4);
+                    if (!flags.empty()) {
+                        std::cout << "   ";
+                        for (const auto& flag : flags) {
+                            std::cout << " " << flag.name << " (" << flag.count << ")";
+                        }
+                    }
+                    std::cout << "\n";
+                }
+                return 0;
+            }
+            
+            if (history_arg == "clear") {
+                history.clear();
+                std::cout << GREEN << "History statistics cleared." << RESET << "\n";
+                return 0;
+            }
+            
+            std::cerr << RED << "Usage: tt --history report|clear" << RESET << "\n";
+            return 1;
+        }
+        else if (arg == "--stats") {
+            // --stats must be standalone (only with its own arguments)
+            return runStats(std::vector<std::string>(argv + arg_idx + 1, argv + argc));
+        }
         else if (arg == "--auth") {
             // --auth must be standalone with no other arguments
             if (argc != 2) {
@@ -437,7 +1060,7 @@ int main(int argc, char* argv[]) {
             // --config must be standalone (only with its own argument)
             if (argc != 3) {
                 std::cerr << RED << "Error: --config must be used alone with its argument." << RESET << "\n";
-                std::cerr << "Usage: tt --config list|reset|model=<name>|language=<lang>\n";
+                std::cerr << "Usage: tt --config list|reset|model=<name>|language=<lang>|dryrun-roots=<a:b>|limits=<spec>\n";
                 return 1;
             }
             
@@ -446,9 +1069,13 @@ int main(int argc, char* argv[]) {
             
             // Handle --config list
             if (config_arg == "list") {
+                Backend settings("");
+                std::string roots = getDryRunRoots();
                 std::cout << BOLD << "Current Configuration:" << RESET << "\n"
-                          << "  Model:    " << getModel() << "\n"
-                          << "  Language: " << getLanguage() << "\n";
+                          << "  Model:    " << settings.model() << "\n"
+                          << "  Language: " << settings.language() << "\n"
+                          << "  Dry-run roots: " << (roots.empty() ? "(cwd only)" : roots) << "\n"
+                          << "  Run limits: " << tt::toString(settings.runLimits()) << "\n";
                 return 0;
             }
             
@@ -501,6 +1128,36 @@ int main(int argc, char* argv[]) {
                 } else {
                     return 1;
                 }
+            } else if (config_arg.rfind("dryrun-roots=", 0) == 0) {
+                std::string roots = config_arg.substr(13);
+                for (const auto& root : splitRoots(roots)) {
+                    if (!std::filesystem::is_directory(root)) {
+                        std::cerr << RED << "Error: Not a directory: " << root << RESET << "\n";
+                        return 1;
+                    }
+                }
+                
+                if (storeInKeyring("dryrun_roots", roots, "TerminalTutor Dry-run Roots")) {
+                    std::cout << GREEN << "Dry-run roots set: " << (roots.empty() ? "(cwd only)" : roots) << RESET << "\n";
+                    return 0;
+                } else {
+                    return 1;
+                }
+            } else if (config_arg.rfind("limits=", 0) == 0) {
+                std::string spec = config_arg.substr(7);
+                std::string error;
+                auto limits = tt::parseRunLimits(spec, error);
+                if (!limits) {
+                    std::cerr << RED << "Error: " << error << RESET << "\n";
+                    return 1;
+                }
+                
+                if (storeInKeyring("run_limits", spec, "TerminalTutor Run Limits")) {
+                    std::cout << GREEN << "Run limits set: " << tt::toString(*limits) << RESET << "\n";
+                    return 0;
+                } else {
+                    return 1;
+                }
             } else {
                 std::cerr << RED << "Unknown config. Use: tt --config model=<name> or tt --config language=<lang>" << RESET << "\n";
                 return 1;
@@ -510,18 +1167,10 @@ int main(int argc, char* argv[]) {
             // Interactive console mode
             arg_idx++;
             
-            // Get API key first
-            std::string api_key = getApiKey();
-            if (api_key.empty()) {
-                std::cerr << RED << "Error: API key not configured." << RESET << "\n";
-                std::cerr << "Configure with: tt --auth\n";
-                return 1;
-            }
-            
-            // Initialize Gemini client (session may already be set from earlier --session flag)
-            std::string model = getModel();
-            std::string language = getLanguage();
-            tt::GeminiClient gemini(api_key, model, language, session_name);
+            // Check the API key up front (session may already be set from earlier --session flag)
+            Backend backend(session_name);
+            if (!backend.client()) return 1;
+            tt::GeminiClient& gemini = *backend.client();
             
             std::cout << BOLD << "TerminalTutor Interactive Console" << RESET << "\n";
             if (!session_name.empty()) {
@@ -555,13 +1204,30 @@ int main(int argc, char* argv[]) {
                     continue;
                 }
                 
-                // Process query with smart query
-                auto smart = gemini.smartQuery(line);
+                RequestMeter meter(tt::RequestMode::CONSOLE, backend);
+                
+                // Obvious inputs skip the smartQuery round trip
+                tt::SmartResponse smart{};
+                if (!routeLocally(gemini, line, smart)) {
+                    smart = gemini.smartQuery(line);
+                } else if (smart.success && smart.type == tt::SmartResponse::Type::EXPLAIN) {
+                    std::cout << "\n" << YELLOW << "💡 " << RESET;
+                    std::string prompt = line + "\n\n" + gemini.languageInstruction();
+                    auto response = gemini.generateContentStreaming(prompt, [](const std::string& chunk) {
+                        std::cout << chunk;
+                        std::cout.flush();
+                    });
+                    if (!response.success) meter.failed();
+                    std::cout << "\n\n";
+                    continue;
+                }
                 
                 if (!smart.success) {
+                    meter.failed();
                     std::cerr << RED << "Error: " << smart.error << RESET << "\n";
                     continue;
                 }
+                meter.answered();
                 
                 if (smart.type == tt::SmartResponse::Type::EXECUTE) {
                     std::string cmd = smart.command;
@@ -574,19 +1240,18 @@ int main(int argc, char* argv[]) {
                     }
                     
                     // Check dangerous
-                    if (isDangerousCommand(cmd)) {
-                        if (!askDangerousConfirmation(cmd)) {
-                            std::cout << "Aborted.\n\n";
-                            continue;
-                        }
+                    if (!confirmRisk(cmd)) {
+                        std::cout << "Aborted.\n\n";
+                        continue;
                     }
                     
                     std::cout << CYAN << "$ " << cmd << RESET << "\n\n";
                     
-                    auto [exit_code, output] = executeAndCapture(cmd);
+                    const tt::RunLimits& limits = backend.runLimits();
+                    auto run = executeAndCapture(cmd, limits);
                     
                     if (!session_name.empty()) {
-                        gemini.addCommandOutput(cmd, output);
+                        gemini.addCommandOutput(cmd, run.output, runReport(run, limits));
                     }
                     
                     std::cout << "\n";
@@ -597,6 +1262,19 @@ int main(int argc, char* argv[]) {
             
             return 0;
         }
+        else if (arg == "--profile-startup") {
+            tt::startup::enable();
+            arg_idx++;
+        }
+        else if (arg == "--trace") {
+            // --trace <file>: spans go to file at exit, see Trace.hpp
+            if (arg_idx + 1 >= argc) {
+                std::cerr << RED << "Usage: tt --trace <file> <command or query>" << RESET << "\n";
+                return 1;
+            }
+            tt::trace::start(argv[arg_idx + 1]);
+            arg_idx += 2;
+        }
         else if (arg == "--run") {
             // --run flag sets run_mode, requires a query
             run_mode = true;
@@ -606,7 +1284,7 @@ int main(int argc, char* argv[]) {
         else if (arg.rfind("--", 0) == 0) {
             // Unknown flag starting with --
             std::cerr << RED << "Error: Unknown flag '" << arg << "'" << RESET << "\n";
-            std::cerr << "Valid flags: --run, --session, --config, --auth, --console, --help\n";
+            std::cerr << "Valid flags: --run, --session, --trace, --profile-startup, --cache, --history, --stats, --rules, --config, --auth, --console, --help\n";
             return 1;
         }
         else {
@@ -624,26 +1302,19 @@ int main(int argc, char* argv[]) {
     
     first_arg = argv[arg_idx];
     int arg_offset = arg_idx;
+    tt::startup::mark("flags parsed");
+    tt::trace::Span request_span("request", "tt");
+    request_span.arg("mode", run_mode ? "run" : first_arg);
 
     
-    // Get API key
-    std::string api_key = getApiKey();
-    if (api_key.empty()) {
-        std::cerr << RED << "Error: API key not configured." << RESET << "\n";
-        std::cerr << "Configure with: tt auth\n";
-        return 1;
-    }
-    
-    // Initialize components with configured model, language, and optional session
-    std::string model = getModel();
-    std::string language = getLanguage();
-    tt::GeminiClient gemini(api_key, model, language, session_name);
-    tt::CommandParser parser;
-    tt::Simulator simulator(gemini);
+    // Settings, API key and client are read or built where a path first needs them
+    Backend backend(session_name);
     
     // Check session token usage if using a session
     if (!session_name.empty()) {
-        int tokens = gemini.countSessionTokens();
+        tt::GeminiClient* gemini = backend.client();
+        if (!gemini) return 1;
+        int tokens = gemini->countSessionTokens();
         if (tokens >= 0) {
             const int TOKEN_LIMIT = 1000000;
             double usage = (double)tokens / TOKEN_LIMIT * 100.0;
@@ -666,17 +1337,30 @@ int main(int argc, char* argv[]) {
     
     // Determine mode and process
     if (first_arg == "explain" && argc > arg_offset + 1) {
-        // Explain mode: tt explain <command>
+        // Explain mode: tt explain [--detailed] <command>
+        int command_start = arg_offset + 1;
+        bool detailed = std::string(argv[command_start]) == "--detailed" && command_start + 1 < argc;
+        if (detailed) command_start++;
         std::string command;
-        for (int i = arg_offset + 1; i < argc; ++i) {
-            if (i > arg_offset + 1) command += " ";
+        for (int i = command_start; i < argc; ++i) {
+            if (i > command_start) command += " ";
             command += argv[i];
         }
         
-        auto response = gemini.explainCommand(command);
+        tt::GeminiClient* gemini = backend.client();
+        if (!gemini) return 1;
+        RequestMeter meter(tt::RequestMode::EXPLAIN, backend);
+        if (detailed) {
+            int status = streamDetailedExplanation(*gemini, command);
+            if (status != 0) meter.failed();
+            return status;
+        }
+        
+        auto response = gemini->explainCommand(command);
         if (response.success) {
             printExplanation(response.content);
         } else {
+            meter.failed();
             std::cerr << RED << "Error: " << response.error << RESET << "\n";
             return 1;
         }
@@ -689,29 +1373,73 @@ int main(int argc, char* argv[]) {
             command += argv[i];
         }
         
-        std::string prompt = 
-            "Explain this command to a 5-year-old in 2-3 simple sentences using a real-world analogy: " + command + "\n\n"
-            "No emojis, no bullet points. Very short and simple. "
-            "Respond in the language corresponding to this locale: " + language + ".";
-        
-        auto response = gemini.generateContent(prompt);
+        tt::GeminiClient* gemini = backend.client();
+        if (!gemini) return 1;
+        RequestMeter meter(tt::RequestMode::ELI5, backend);
+        auto response = gemini->generateContent(tt::prompts::ELI5_BRIEF.render({backend.language(), command}));
         if (response.success) {
             printExplanation(response.content);
         } else {
+            meter.failed();
             std::cerr << RED << "Error: " << response.error << RESET << "\n";
             return 1;
         }
     }
     else if (first_arg == "whatif" && argc > arg_offset + 1) {
-        // What-if mode: tt whatif <command>
+        // What-if mode: tt whatif [--dry-run] <command>
+        int command_start = arg_offset + 1;
+        std::string cwd = std::filesystem::current_path().string();
+        // Everything besides command and cwd that the answer depends on
+        std::string variant = backend.model() + "\n" + backend.language();
+        std::optional<tt::DryRunOptions> dry_run;
+        if (std::string(argv[command_start]) == "--dry-run" && command_start + 1 < argc) {
+            dry_run.emplace();
+            dry_run->roots.push_back(cwd);
+            for (const auto& root : splitRoots(getDryRunRoots())) {
+                dry_run->roots.push_back(root);
+            }
+            variant += "\ndry-run";
+            for (const auto& root : dry_run->roots) {
+                variant += ":" + root;
+            }
+            ++command_start;
+        }
+        
         std::string command;
-        for (int i = arg_offset + 1; i < argc; ++i) {
-            if (i > arg_offset + 1) command += " ";
+        for (int i = command_start; i < argc; ++i) {
+            if (i > command_start) command += " ";
             command += argv[i];
         }
         
-        auto result = simulator.simulate(command);
-        printSimulation(result);
+        // Repeated whatifs come from the cache while the paths the command
+        // touches are unchanged. Sessions are skipped: history shapes the answer
+        RequestMeter meter(tt::RequestMode::WHATIF, backend);
+        tt::SimulationCache simulation_cache("", variant);
+        SimulationPrinter printer;
+        if (session_name.empty()) {
+            if (auto cached = simulation_cache.lookup(command, cwd)) {
+                meter.cacheHit();
+                std::cout << CYAN << "⚡ cached (no relevant file changed since)" << RESET << "\n";
+                printer.replay(*cached);
+                return 0;
+            }
+        }
+        
+        tt::GeminiClient* gemini = backend.client();
+        if (!gemini) {
+            meter.failed();
+            return 1;
+        }
+        tt::Simulator simulator(*gemini);
+        if (dry_run) simulator.enableDryRun(std::move(*dry_run));
+        
+        auto started = std::chrono::system_clock::now();
+        auto result = simulator.simulate(command, printer);
+        printer.finish(result);
+        if (!result.predicted) meter.failed();
+        if (session_name.empty()) {
+            simulation_cache.store(command, cwd, result, started);
+        }
     }
     else {
         // Natural language query mode
@@ -723,48 +1451,88 @@ int main(int argc, char* argv[]) {
         
         if (run_mode) {
             // --run mode: Get command and execute
-            auto response = gemini.getCommandForTask(query);
+            // Near-repeat tasks come from the local cache. Sessions are skipped
+            // because their commands depend on the conversation context.
+            RequestMeter meter(tt::RequestMode::RUN, backend);
+            tt::QueryCache query_cache;
+            std::string cmd;
+            std::string explanation;
+            bool from_cache = false;
             
-            if (!response.success) {
-                std::cerr << RED << "Error: " << response.error << RESET << "\n";
-                return 1;
+            if (session_name.empty()) {
+                if (auto hit = query_cache.lookup(query)) {
+                    cmd = hit->command;
+                    explanation = hit->explanation;
+                    from_cache = true;
+                    meter.cacheHit();
+                    std::cout << "\n" << CYAN << "⚡ cached (" << std::fixed << std::setprecision(0)
+                              << hit->similarity * 100.0 << "% match: \"" << hit->matched_query << "\")"
+                              << RESET << "\n";
+                }
             }
             
-            std::string cmd = response.content;
-            cmd.erase(0, cmd.find_first_not_of(" \n\r\t"));
-            cmd.erase(cmd.find_last_not_of(" \n\r\t") + 1);
+            if (!from_cache) {
+                tt::GeminiClient* gemini = backend.client();
+                if (!gemini) {
+                    meter.failed();
+                    return 1;
+                }
+                auto response = gemini->getCommandForTask(query);
+                
+                if (!response.success) {
+                    meter.failed();
+                    std::cerr << RED << "Error: " << response.error << RESET << "\n";
+                    return 1;
+                }
+                
+                cmd = response.content;
+                cmd.erase(0, cmd.find_first_not_of(" \n\r\t"));
+                cmd.erase(cmd.find_last_not_of(" \n\r\t") + 1);
+                
+                // Explanation is stored in error field from getCommandForTask
+                explanation = response.error;
+            }
             
-            // Show explanation (stored in error field from getCommandForTask)
-            if (!response.error.empty()) {
-                std::cout << "\n" << YELLOW << "💡 " << RESET << response.error << "\n\n";
+            if (!explanation.empty()) {
+                std::cout << "\n" << YELLOW << "💡 " << RESET << explanation << "\n\n";
             }
+            meter.answered();
             
-            // Check if command is dangerous
-            if (isDangerousCommand(cmd)) {
-                if (!askDangerousConfirmation(cmd)) {
-                    std::cout << "Aborted.\n";
-                    return 0;
-                }
+            // Check if command is dangerous (cached commands included)
+            if (!confirmRisk(cmd)) {
+                std::cout << "Aborted.\n";
+                return 0;
             }
             
             std::cout << CYAN << "$ " << cmd << RESET << "\n\n";
             
             // Execute and capture output for session context
-            auto [exit_code, output] = executeAndCapture(cmd);
+            const tt::RunLimits& limits = backend.runLimits();
+            auto run = executeAndCapture(cmd, limits);
             
             // Save to session history for context in future queries
             if (!session_name.empty()) {
-                gemini.addCommandOutput(cmd, output);
+                backend.client()->addCommandOutput(cmd, run.output, runReport(run, limits));
+            }
+            
+            // Only commands that worked are worth repeating
+            if (!from_cache && session_name.empty() && run.exit_code == 0) {
+                query_cache.store(query, cmd, explanation);
             }
             
-            return exit_code;
+            return run.exit_code;
         } else {
             // Default mode: Streaming explanation
+            tt::GeminiClient* gemini = backend.client();
+            if (!gemini) return 1;
+            RequestMeter meter(tt::RequestMode::QUERY, backend);
             std::cout << "\n";
-            gemini.generateContentStreaming(query, [](const std::string& chunk) {
+            std::string prompt = query + "\n\n" + gemini->languageInstruction();
+            auto response = gemini->generateContentStreaming(prompt, [](const std::string& chunk) {
                 std::cout << chunk;
                 std::cout.flush();
             });
+            if (!response.success) meter.failed();
             std::cout << "\n\n";
         }
     }
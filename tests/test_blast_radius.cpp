@@ -0,0 +1,144 @@
+/**
+ * test_blast_radius.cpp - Unit tests for the blast radius analyzer
+ */
+
+#include "tt/BlastRadius.hpp"
+
+#include <cassert>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+namespace fs = std::filesystem;
+
+static fs::path tempDir() {
+    auto dir = fs::temp_directory_path() / "tt_test_blast_radius";
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+    return dir;
+}
+
+static void writeFile(const fs::path& path, size_t size) {
+    fs::create_directories(path.parent_path());
+    std::ofstream file(path);
+    file << std::string(size, 'x');
+}
+
+// build/{obj: 3 x 1000 B, bin: 1 x 5000 B, empty/}, build/README (100 B), notes.txt (10 B)
+static fs::path makeTree() {
+    auto dir = tempDir();
+    for (int i = 0; i < 3; ++i) writeFile(dir / "build" / "obj" / ("f" + std::to_string(i) + ".o"), 1000);
+    writeFile(dir / "build" / "bin" / "app", 5000);
+    writeFile(dir / "build" / "README", 100);
+    fs::create_directories(dir / "build" / "empty");
+    writeFile(dir / "notes.txt", 10);
+    return dir;
+}
+
+void test_recursive_rm() {
+    auto dir = makeTree();
+    auto report = tt::analyzeImpact("rm -rf " + (dir / "build").string());
+
+    assert(report.complete);
+    assert(report.files == 5);
+    assert(report.directories == 4);  // build, obj, bin, empty
+    assert(report.bytes == 8100);
+    assert(report.targets.size() == 1);
+
+    // Split by subdirectory, largest first; files directly in build/ go to build itself
+    assert(report.top.size() == 3);
+    assert(report.top[0].path == (dir / "build" / "bin").string() && report.top[0].bytes == 5000);
+    assert(report.top[1].path == (dir / "build" / "obj").string() && report.top[1].files == 3);
+    assert(report.top[2].path == (dir / "build").string() && report.top[2].bytes == 100);
+
+    std::cout << "[PASS] test_recursive_rm\n";
+}
+
+void test_globs_and_flags() {
+    auto dir = makeTree();
+    std::string build = (dir / "build").string();
+
+    // Without -r, rm skips directories
+    auto report = tt::analyzeImpact("rm -f " + build + "/*");
+    assert(report.files == 1 && report.bytes == 100 && report.directories == 0);
+
+    report = tt::analyzeImpact("rm -r " + build + "/* " + build + "/obj/f1.o");
+    assert(report.files == 5 && report.bytes == 8100);  // f1.o is inside an expanded target
+
+    // chmod's mode operand is not a path; -R walks, -x is a mode
+    report = tt::analyzeImpact("chmod 644 " + (dir / "notes.txt").string());
+    assert(report.files == 1 && report.bytes == 10);
+    report = tt::analyzeImpact("sudo chmod -R -x " + build);
+    assert(report.files == 5 && report.directories == 4);
+
+    // mv moves its sources, not the destination
+    report = tt::analyzeImpact("mv " + build + " " + (dir / "notes.txt").string() + " /nonexistent");
+    assert(report.files == 6);
+
+    // find -delete walks its roots; without a delete action it is harmless
+    report = tt::analyzeImpact("find " + build + " -name '*.o' -delete");
+    assert(report.files == 5);
+    assert(tt::analyzeImpact("find " + build + " -name '*.o'").empty());
+
+    report = tt::analyzeImpact("rm -rf $BUILD_DIR/* " + (dir / "missing").string());
+    assert(report.empty());
+    assert(report.unresolved.size() == 1 && report.unresolved[0] == "$BUILD_DIR/*");
+
+    assert(tt::analyzeImpact("ls -la " + build).empty());
+
+    std::cout << "[PASS] test_globs_and_flags\n";
+}
+
+void test_thread_counts_agree() {
+    auto dir = tempDir();
+    for (int d = 0; d < 20; ++d) {
+        for (int f = 0; f < 25; ++f) {
+            writeFile(dir / ("d" + std::to_string(d)) / ("s" + std::to_string(f % 5)) / ("f" + std::to_string(f)), d + f);
+        }
+    }
+
+    tt::ImpactOptions serial;
+    serial.threads = 1;
+    tt::ImpactOptions parallel;
+    parallel.threads = 8;
+    auto a = tt::measurePaths({dir.string()}, serial);
+    auto b = tt::measurePaths({dir.string()}, parallel);
+
+    assert(a.complete && b.complete);
+    assert(a.files == 500 && b.files == 500);
+    assert(a.directories == 121 && b.directories == 121);
+    assert(a.bytes == b.bytes);
+    assert(a.top.size() == 5 && b.top.size() == 5);
+    assert(a.top[0].path == b.top[0].path && a.top[0].path == (dir / "d19").string());
+
+    std::cout << "[PASS] test_thread_counts_agree\n";
+}
+
+void test_budget_gives_partial_result() {
+    auto dir = tempDir();
+    for (int d = 0; d < 50; ++d) {
+        writeFile(dir / ("d" + std::to_string(d)) / "f", 1);
+    }
+
+    tt::ImpactOptions options;
+    options.budget = std::chrono::milliseconds(0);
+    auto report = tt::measurePaths({dir.string()}, options);
+    assert(!report.complete);
+    assert(report.files < 50);
+
+    std::cout << "[PASS] test_budget_gives_partial_result\n";
+}
+
+int main() {
+    std::cout << "Running BlastRadius tests...\n\n";
+
+    test_recursive_rm();
+    test_globs_and_flags();
+    test_thread_counts_agree();
+    test_budget_gives_partial_result();
+
+    std::filesystem::remove_all(std::filesystem::temp_directory_path() / "tt_test_blast_radius");
+
+    std::cout << "\nAll tests passed!\n";
+    return 0;
+}
@@ -3,9 +3,12 @@
  */
 
 #include "tt/CommandParser.hpp"
+#include "tt/QuestionClassifier.hpp"
+#include "tt/ShellLexer.hpp"
 
 #include <cassert>
 #include <iostream>
+#include <string_view>
 
 void test_parse_simple_command() {
     tt::CommandParser parser;
@@ -69,6 +72,9 @@ void test_extract_intent() {
     std::string intent = parser.extractIntent("como eu encontro arquivos grandes?");
     
     assert(intent.find("?") == std::string::npos);
+    assert(intent == "encontro arquivos grandes");
+    assert(parser.extractIntent("¿Cómo puedo LISTAR archivos?") == "LISTAR archivos");
+    assert(parser.extractIntent("Please, how do I list files") == "list files");
     
     std::cout << "[PASS] test_extract_intent\n";
 }
@@ -83,6 +89,173 @@ void test_not_question() {
     std::cout << "[PASS] test_not_question\n";
 }
 
+void test_parse_quoted_args() {
+    tt::CommandParser parser;
+    
+    auto result = parser.parse("grep -r \"hello world\" 'src dir' a\\ b");
+    
+    assert(result.executable == "grep");
+    assert(result.args.size() == 3);
+    assert(result.args[0] == "hello world");
+    assert(result.args[1] == "src dir");
+    assert(result.args[2] == "a b");
+    
+    std::cout << "[PASS] test_parse_quoted_args\n";
+}
+
+void test_lexer_operators() {
+    tt::TokenList tokens;
+    tt::ShellLexer::tokenize("make && ./run 2>&1 | tee log.txt; echo done >> out || true &", tokens);
+    
+    using K = tt::TokenKind;
+    const K expected[] = {
+        K::WORD, K::AND_IF, K::WORD, K::IO_NUMBER, K::GREATAND, K::WORD, K::PIPE, K::WORD,
+        K::WORD, K::SEMI, K::WORD, K::WORD, K::DGREAT, K::WORD, K::OR_IF, K::WORD, K::AMP
+    };
+    assert(tokens.size() == sizeof(expected) / sizeof(expected[0]));
+    for (size_t i = 0; i < tokens.size(); ++i) {
+        assert(tokens[i].kind == expected[i]);
+    }
+    assert(tokens[3].text == "2");
+    assert(tokens.isInline());
+    
+    std::cout << "[PASS] test_lexer_operators\n";
+}
+
+void test_lexer_quoting_and_substitution() {
+    tt::TokenList tokens;
+    tt::ShellLexer::tokenize("echo \"a; b\" 'c | d' $(ls -d \"x y\") `date` ${HOME}/*.txt", tokens);
+    
+    assert(tokens.size() == 6);
+    assert(tokens[1].text == "\"a; b\"");
+    assert(tokens[1].has(tt::TOKEN_QUOTED));
+    assert(tokens[2].text == "'c | d'");
+    assert(tokens[3].text == "$(ls -d \"x y\")");
+    assert(tokens[3].has(tt::TOKEN_SUBSTITUTION));
+    assert(tokens[4].has(tt::TOKEN_SUBSTITUTION));
+    assert(tokens[5].has(tt::TOKEN_EXPANSION));
+    assert(tokens[5].has(tt::TOKEN_GLOB));
+    
+    assert(tt::unquote("\"a\\\"b\"") == "a\"b");
+    assert(tt::unquote("\"$(pwd)\"/x") == "$(pwd)/x");
+    assert(tt::unquote("$'a\\tb'") == "a\tb");
+    
+    std::cout << "[PASS] test_lexer_quoting_and_substitution\n";
+}
+
+void test_lexer_heredoc_and_comments() {
+    tt::TokenList tokens;
+    tt::ShellLexer::tokenize("cat <<'EOF' > f # note\nrm -rf /\nEOF\nls", tokens);
+    
+    using K = tt::TokenKind;
+    assert(tokens.size() == 8);
+    assert(tokens[1].kind == K::DLESS);
+    assert(tokens[4].kind == K::WORD && tokens[4].text == "f");
+    assert(tokens[5].kind == K::NEWLINE);
+    assert(tokens[6].kind == K::HEREDOC && tokens[6].text == "rm -rf /\n");
+    assert(tokens[7].text == "ls");
+    
+    tokens.clear();
+    tt::ShellLexer::tokenize("echo 'unterminated", tokens);
+    assert(tokens[1].has(tt::TOKEN_UNTERMINATED));
+    
+    std::cout << "[PASS] test_lexer_heredoc_and_comments\n";
+}
+
+void test_question_word_boundaries() {
+    // Keywords are whole words: "somewhat" is not "what"
+    assert(!tt::isQuestion("echo somewhat"));
+    assert(!tt::isQuestion("cat showcase.txt"));
+    assert(!tt::isQuestion("sort quality_report.csv"));
+    assert(tt::isQuestion("what is using port 8080"));
+    
+    // Imperatives only count as the opening word
+    assert(tt::isQuestion("show me the biggest files"));
+    assert(tt::isQuestion("please show disk usage"));
+    assert(tt::isQuestion("me mostra os processos"));
+    assert(!tt::isQuestion("git show HEAD"));
+    
+    // Accents, Spanish and the pt "o que" phrase
+    assert(tt::isQuestion("¿Cómo listo archivos ocultos"));
+    assert(tt::isQuestion("dónde está nginx.conf"));
+    assert(tt::isQuestion("o que faz o comando tar"));
+    assert(!tt::isQuestion("grep que arquivo.txt"));
+    
+    // '?' ends a question but is a glob inside a word
+    assert(tt::isQuestion("tem algum processo travado?"));
+    assert(!tt::isQuestion("ls file?.txt"));
+    
+    std::cout << "[PASS] test_question_word_boundaries\n";
+}
+
+void test_classify_questions_batch() {
+    const std::string_view inputs[] = {
+        "ls -la", "how do I untar a file", "quais portas estão abertas", "docker ps -a"
+    };
+    bool out[4] = {};
+    
+    assert(tt::classifyQuestions(inputs, out) == 2);
+    assert(!out[0] && out[1] && out[2] && !out[3]);
+    
+    std::cout << "[PASS] test_classify_questions_batch\n";
+}
+
+void test_compact_command() {
+    tt::CommandParser parser;
+    tt::CompactCommand command;
+    
+    parser.parse("git commit -m 'fix: \"quoted\" msg' --amend", command);
+    assert(command.executable() == "git");
+    assert(command.flagCount() == 2);
+    assert(command.flag(0) == "-m" && command.flag(1) == "--amend");
+    assert(command.argCount() == 2);
+    assert(command.arg(0) == "commit");
+    assert(command.arg(1) == "fix: \"quoted\" msg");
+    
+    auto legacy = command.toParsedCommand();
+    auto parsed = parser.parse("git commit -m 'fix: \"quoted\" msg' --amend");
+    assert(legacy.executable == parsed.executable && legacy.flags == parsed.flags);
+    assert(legacy.args == parsed.args && legacy.raw_input == parsed.raw_input);
+    
+    // Executables are interned: same name, same id
+    uint32_t git_id = command.executableId();
+    parser.parse("git status", command);
+    assert(command.executableId() == git_id);
+    assert(parser.executables().name(git_id) == "git");
+    
+    parser.parse("como eu listo arquivos?", command);
+    assert(command.isQuestion() && command.executable().empty());
+    assert(command.executableId() == tt::StringInterner::NONE);
+    
+    std::cout << "[PASS] test_compact_command\n";
+}
+
+void test_compact_command_list() {
+    tt::CommandParser parser;
+    tt::CompactCommandList commands;
+    
+    parser.parseCommands("FOO=1 sudo rm -rf /tmp/x 2>/dev/null | tee log && for f in a b; do ls $f; done", commands);
+    assert(commands.size() == 3);
+    assert(commands[0].executable() == "sudo");
+    assert(commands[0].rawInput() == "FOO=1 sudo rm -rf /tmp/x 2>/dev/null");
+    assert(commands[0].flagCount() == 1 && commands[0].flag(0) == "-rf");
+    assert(commands[1].executable() == "tee" && commands[1].arg(0) == "log");
+    assert(commands[2].executable() == "ls" && commands[2].arg(0) == "$f");
+    
+    // Matches the owning API, which reports the whole line as raw input
+    auto owned = parser.parseCommands("cat a.txt | grep -i foo");
+    parser.parseCommands("cat a.txt | grep -i foo", commands);
+    assert(owned.size() == commands.size());
+    for (size_t i = 0; i < owned.size(); ++i) {
+        auto converted = commands[i].toParsedCommand();
+        assert(converted.executable == owned[i].executable);
+        assert(converted.flags == owned[i].flags && converted.args == owned[i].args);
+        assert(owned[i].raw_input == "cat a.txt | grep -i foo");
+    }
+    
+    std::cout << "[PASS] test_compact_command_list\n";
+}
+
 int main() {
     std::cout << "Running CommandParser tests...\n\n";
     
@@ -93,6 +266,14 @@ int main() {
     test_detect_english_question();
     test_extract_intent();
     test_not_question();
+    test_parse_quoted_args();
+    test_lexer_operators();
+    test_lexer_quoting_and_substitution();
+    test_lexer_heredoc_and_comments();
+    test_question_word_boundaries();
+    test_classify_questions_batch();
+    test_compact_command();
+    test_compact_command_list();
     
     std::cout << "\nAll tests passed!\n";
     return 0;
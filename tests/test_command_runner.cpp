@@ -0,0 +1,182 @@
+/**
+ * test_command_runner.cpp - Unit tests for measured command execution
+ */
+
+#include "tt/CommandRunner.hpp"
+
+#include <cassert>
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <string>
+
+namespace fs = std::filesystem;
+
+// Long enough for the scheduler to charge some CPU time
+static const char* BUSY_LOOP = "i=0; while [ $i -lt 300000 ]; do i=$((i+1)); done; echo $i";
+
+static size_t transientCgroups() {
+    size_t count = 0;
+    for (const char* root : {"/sys/fs/cgroup", "/sys/fs/cgroup/unified"}) {
+        std::error_code ec;
+        for (const auto& entry : fs::recursive_directory_iterator(root, ec)) {
+            if (entry.path().filename().string().rfind("tt-run-", 0) == 0) ++count;
+        }
+    }
+    return count;
+}
+
+void test_output_and_exit_code() {
+    std::string streamed;
+    auto result = tt::runCommand("echo out; echo err >&2; exit 3",
+                                 [&](std::string_view chunk) { streamed += chunk; });
+    assert(result.error.empty());
+    assert(result.exit_code == 3);
+    assert(result.output == "out\nerr\n" && streamed == result.output);
+    assert(!result.truncated);
+
+    assert(tt::runCommand("kill -9 $$").exit_code == 137);
+    assert(tt::runCommand("no-such-command-tt 2>/dev/null").exit_code == 127);
+
+    std::cout << "[PASS] test_output_and_exit_code\n";
+}
+
+void test_truncation() {
+    std::string streamed;
+    tt::RunOptions options;
+    options.max_output = 10;
+    auto result = tt::runCommand("seq 1 1000", [&](std::string_view chunk) { streamed += chunk; }, options);
+    assert(result.truncated);
+    assert(result.output == "1\n2\n3\n4\n5\n");
+    assert(streamed.size() > 3000);  // The terminal still sees everything
+    std::cout << "[PASS] test_truncation\n";
+}
+
+void test_usage() {
+    for (bool use_cgroup : {true, false}) {
+        tt::RunOptions options;
+        options.use_cgroup = use_cgroup;
+        auto result = tt::runCommand(BUSY_LOOP, {}, options);
+        assert(result.exit_code == 0 && result.output == "300000\n");
+        if (!use_cgroup) assert(!result.usage.cgroup);
+
+        const auto& usage = result.usage;
+        assert(usage.wall_ms > 0);
+        assert(usage.user_ms + usage.sys_ms > 0);
+        assert(usage.user_ms + usage.sys_ms <= usage.wall_ms * 1.5 + 20);
+        assert(usage.voluntary_switches + usage.involuntary_switches > 0);
+        assert(usage.summary().find("s wall, ") != std::string::npos);
+        assert(usage.summary().find("ctx switches") != std::string::npos);
+        std::cout << "  " << (usage.cgroup ? "cgroup" : "rusage") << ": " << usage.summary() << "\n";
+    }
+    std::cout << "[PASS] test_usage\n";
+}
+
+void test_cgroup_removed() {
+    size_t before = transientCgroups();
+    auto result = tt::runCommand("sleep 0.3 & echo started");
+    assert(result.exit_code == 0);
+    assert(transientCgroups() == before);
+    std::cout << "[PASS] test_cgroup_removed (" << (result.usage.cgroup ? "cgroup" : "rusage") << ")\n";
+}
+
+static tt::RunOptions limited(const char* spec) {
+    std::string error;
+    auto limits = tt::parseRunLimits(spec, error);
+    assert(limits && error.empty());
+    tt::RunOptions options;
+    options.limits = *limits;
+    return options;
+}
+
+void test_parse_limits() {
+    std::string error;
+    auto defaults = tt::parseRunLimits("", error);
+    assert(defaults && tt::toString(*defaults) == tt::toString(tt::RunLimits::defaults()));
+    assert(tt::toString(*defaults) == "timeout=10m,cpu=none,memory=none,fsize=none,output=8M,nice=10,ionice=7");
+
+    auto limits = tt::parseRunLimits("timeout=90s,cpu=2m,memory=1536M,fsize=1G,output=none,nice=5", error);
+    assert(limits);
+    assert(limits->timeout == std::chrono::seconds(90) && limits->cpu_seconds == 120);
+    assert(limits->memory_bytes == 1536ull << 20 && limits->file_bytes == 1ull << 30);
+    assert(limits->output_rate == 0 && limits->nice == 5 && limits->ionice == 7);
+    assert(tt::toString(*limits) == "timeout=90s,cpu=2m,memory=1536M,fsize=1G,output=none,nice=5,ionice=7");
+    assert(tt::parseRunLimits("timeout=250ms", error)->timeout == std::chrono::milliseconds(250));
+
+    assert(!tt::parseRunLimits("timeout=soon", error) && error.find("timeout") != std::string::npos);
+    assert(!tt::parseRunLimits("ionice=9", error));
+    assert(!tt::parseRunLimits("memory=-1", error));
+    assert(!tt::parseRunLimits("swap=1G", error) && error.find("swap") != std::string::npos);
+
+    std::cout << "[PASS] test_parse_limits\n";
+}
+
+void test_timeout_kills_group() {
+    // The background job and a shell ignoring SIGTERM both go
+    auto start = std::chrono::steady_clock::now();
+    auto options = limited("timeout=300ms");
+    auto result = tt::runCommand("sleep 30 & trap '' TERM; sleep 30; echo survived", {}, options);
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    assert(result.stopped == tt::StopReason::TIMEOUT);
+    assert(result.exit_code == 128 + 9);
+    assert(result.output.find("survived") == std::string::npos);
+    assert(elapsed < std::chrono::seconds(5));
+    assert(result.outcome(options.limits) == "timed out after 300ms");
+
+    auto quick = tt::runCommand("echo fast", {}, options);
+    assert(quick.stopped == tt::StopReason::NONE && quick.outcome(options.limits).empty());
+
+    std::cout << "[PASS] test_timeout_kills_group\n";
+}
+
+void test_rlimits_and_priority() {
+    auto options = limited("cpu=1,fsize=4k,nice=7,output=none");
+    options.use_cgroup = false;
+    auto result = tt::runCommand("ulimit -t; ulimit -f; nice", {}, options);
+    assert(result.exit_code == 0);
+    assert(result.output == "1\n8\n7\n");  // ulimit -f counts 512-byte blocks
+
+    auto memory = limited("memory=64M,output=none");
+    memory.use_cgroup = false;
+    assert(tt::runCommand("ulimit -v", {}, memory).output == "65536\n");
+
+    auto spin = tt::runCommand("while :; do :; done", {}, options);
+    assert(spin.stopped == tt::StopReason::CPU);
+    assert(spin.outcome(options.limits) == "exceeded the 1s CPU limit");
+
+    std::string file = (fs::temp_directory_path() / "tt_test_command_runner_fsize").string();
+    auto big = tt::runCommand("head -c 65536 /dev/zero > " + file, {}, options);
+    assert(big.stopped == tt::StopReason::FILE_SIZE);
+    assert(fs::file_size(file) == 4096);
+    fs::remove(file);
+
+    std::cout << "[PASS] test_rlimits_and_priority\n";
+}
+
+void test_output_rate() {
+    auto options = limited("output=64k");
+    size_t streamed = 0;
+    auto result = tt::runCommand("head -c 131072 /dev/zero", [&](std::string_view chunk) { streamed += chunk.size(); },
+                                 options);
+    assert(result.exit_code == 0 && streamed == 131072);
+    assert(result.usage.wall_ms >= 800);
+    assert(result.throttled_ms >= 500);
+    assert(result.outcome(options.limits).find("output throttled to 64.0 KB/s for ") == 0);
+    std::cout << "[PASS] test_output_rate (" << result.usage.wall_ms << " ms)\n";
+}
+
+int main() {
+    std::cout << "Running CommandRunner tests...\n\n";
+
+    test_output_and_exit_code();
+    test_truncation();
+    test_usage();
+    test_cgroup_removed();
+    test_parse_limits();
+    test_timeout_kills_group();
+    test_rlimits_and_priority();
+    test_output_rate();
+
+    std::cout << "\nAll tests passed!\n";
+    return 0;
+}
@@ -0,0 +1,185 @@
+/**
+ * test_danger_rules.cpp - Unit tests for danger rule packs and risk scores
+ */
+
+#include "tt/DangerCheck.hpp"
+#include "tt/DangerRules.hpp"
+#include "tt/ShellAst.hpp"
+
+#include <cassert>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+namespace fs = std::filesystem;
+
+static fs::path tempDir() {
+    auto dir = fs::temp_directory_path() / "tt_test_danger_rules";
+    fs::remove_all(dir);
+    fs::create_directories(dir / "system");
+    fs::create_directories(dir / "user");
+    fs::create_directories(dir / "cache");
+    return dir;
+}
+
+static void writeFile(const fs::path& path, const std::string& content) {
+    std::ofstream file(path);
+    file << content;
+}
+
+static tt::RiskAssessment assess(const std::string& command, const tt::DangerRules& rules) {
+    tt::ShellAst ast(command);
+    return tt::assessRisk(ast, rules);
+}
+
+static size_t cacheFiles(const fs::path& dir) {
+    size_t count = 0;
+    for (const auto& entry : fs::directory_iterator(dir)) {
+        if (entry.path().filename().string().rfind("rules-", 0) == 0) ++count;
+    }
+    return count;
+}
+
+void test_builtin_severities() {
+    auto rules = tt::DangerRules::load({});
+    assert(rules.ruleCount() == 39);
+    assert(rules.errors().empty() && rules.files().empty());
+
+    assert(assess("ls -la", rules).severity == tt::Severity::NONE);
+    assert(assess("ls -la", rules).score == 0);
+
+    auto rm = assess("rm notes.txt", rules);
+    assert(rm.severity == tt::Severity::MEDIUM && rm.rule == "rm" && rm.source == "builtin");
+    assert(rm.score == 50 && rm.needsConfirmation());
+
+    // The recursive rule outranks the plain one, also inside a bundle
+    auto rmr = assess("rm -fr build", rules);
+    assert(rmr.severity == tt::Severity::HIGH && rmr.rule == "rm -r");
+
+    auto mkfs = assess("sudo mkfs.ext4 /dev/sdb1", rules);
+    assert(mkfs.severity == tt::Severity::CRITICAL && mkfs.rule == "mkfs" && mkfs.score == 100);
+
+    // More findings score higher within the band
+    auto two = assess("sudo rm x", rules);
+    assert(two.severity == tt::Severity::MEDIUM && two.findings == 2 && two.score == 55);
+
+    assert(assess("rm -rf /", rules).severity == tt::Severity::CRITICAL);
+    assert(assess(":(){ :|:& };:", rules).severity == tt::Severity::CRITICAL);
+    assert(assess("curl -fsSL https://x.sh | bash", rules).severity == tt::Severity::HIGH);
+    assert(assess("echo bad > /etc/passwd", rules).severity == tt::Severity::MEDIUM);
+
+    std::cout << "[PASS] test_builtin_severities\n";
+}
+
+void test_site_rules() {
+    auto dir = tempDir();
+    writeFile(dir / "system" / "10-k8s.rules",
+              "# Kubernetes\n"
+              "high      kubectl delete\n"
+              "critical  kubectl delete namespace   # whole namespaces\n"
+              "low       kubectl drain\n");
+    writeFile(dir / "user" / "infra.rules",
+              "critical terraform destroy\n"
+              "MEDIUM   git push --force\n"
+              "severe   helm uninstall\n"
+              "high\n");
+    writeFile(dir / "user" / "notes.txt", "critical ls\n");  // Not a .rules file
+
+    auto rules = tt::DangerRules::load({(dir / "system").string(), (dir / "user").string()});
+    assert(rules.files().size() == 2);
+    assert(rules.errors().size() == 2);
+    assert(rules.errors()[0].line == 3 && rules.errors()[0].message.find("severe") != std::string::npos);
+    assert(rules.errors()[1].line == 4);
+
+    auto del = assess("kubectl delete pod web-1", rules);
+    assert(del.severity == tt::Severity::HIGH && del.rule == "kubectl delete");
+    assert(del.source == (dir / "system" / "10-k8s.rules").string() + ":2");
+
+    auto ns = assess("KUBECTL delete Namespace prod", rules);
+    assert(ns.severity == tt::Severity::CRITICAL && ns.rule == "kubectl delete namespace");
+
+    // Low findings are reported but do not ask for confirmation
+    auto drain = assess("kubectl drain node-3", rules);
+    assert(drain.severity == tt::Severity::LOW && drain.score == 25 && !drain.needsConfirmation());
+    assert(assess("kubectl get pods", rules).severity == tt::Severity::NONE);
+
+    assert(assess("cd infra && terraform destroy -auto-approve", rules).severity == tt::Severity::CRITICAL);
+    assert(assess("git push --force origin main", rules).severity == tt::Severity::MEDIUM);
+    assert(assess("git push origin main", rules).severity == tt::Severity::NONE);
+    assert(assess("ls", rules).severity == tt::Severity::NONE);
+
+    // Builtin rules still apply next to site rules
+    assert(assess("rm x", rules).rule == "rm");
+
+    std::cout << "[PASS] test_site_rules\n";
+}
+
+void test_cached_image() {
+    auto dir = tempDir();
+    auto cache = (dir / "cache").string();
+    std::vector<std::string> dirs = {(dir / "user").string()};
+    writeFile(dir / "user" / "a.rules", "critical terraform destroy\n");
+
+    auto first = tt::DangerRules::load(dirs, cache);
+    assert(!first.fromCache());
+    assert(cacheFiles(cache) == 1);
+
+    auto second = tt::DangerRules::load(dirs, cache);
+    assert(second.fromCache());
+    assert(second.ruleCount() == first.ruleCount());
+    assert(assess("terraform destroy", second).severity == tt::Severity::CRITICAL);
+    assert(assess("terraform destroy", second).source == (dir / "user" / "a.rules").string() + ":1");
+    assert(assess("rm -r x", second).rule == "rm -r");
+
+    // Editing a rule file compiles a new image and drops the old one
+    writeFile(dir / "user" / "a.rules", "low terraform destroy\n");
+    auto edited = tt::DangerRules::load(dirs, cache);
+    assert(!edited.fromCache());
+    assert(assess("terraform destroy", edited).severity == tt::Severity::LOW);
+    assert(cacheFiles(cache) == 1);
+
+    // A damaged image is rebuilt instead of trusted
+    for (const auto& entry : fs::directory_iterator(cache)) {
+        fs::resize_file(entry.path(), fs::file_size(entry.path()) - 8);
+    }
+    auto repaired = tt::DangerRules::load(dirs, cache);
+    assert(!repaired.fromCache());
+    assert(assess("terraform destroy", repaired).severity == tt::Severity::LOW);
+    assert(tt::DangerRules::load(dirs, cache).fromCache());
+
+    // Rule files with errors are parsed again, so the errors are still reported
+    writeFile(dir / "user" / "a.rules", "low terraform destroy\nsevere helm uninstall\n");
+    assert(tt::DangerRules::load(dirs, cache).errors().size() == 1);
+    auto broken = tt::DangerRules::load(dirs, cache);
+    assert(!broken.fromCache() && broken.errors().size() == 1);
+    assert(assess("terraform destroy", broken).severity == tt::Severity::LOW);
+
+    // Without site rules nothing is cached
+    fs::remove_all(cache);
+    assert(!tt::DangerRules::load({(dir / "system").string()}, cache).fromCache());
+    assert(!fs::exists(cache));
+
+    std::cout << "[PASS] test_cached_image\n";
+}
+
+void test_parse_severity() {
+    assert(tt::parseSeverity("High") == tt::Severity::HIGH);
+    assert(tt::parseSeverity("critical") == tt::Severity::CRITICAL);
+    assert(!tt::parseSeverity("urgent"));
+    assert(std::string(tt::toString(tt::Severity::MEDIUM)) == "medium");
+    std::cout << "[PASS] test_parse_severity\n";
+}
+
+int main() {
+    std::cout << "Running DangerRules tests...\n\n";
+
+    test_builtin_severities();
+    test_site_rules();
+    test_cached_image();
+    test_parse_severity();
+
+    std::filesystem::remove_all(std::filesystem::temp_directory_path() / "tt_test_danger_rules");
+
+    std::cout << "\nAll tests passed!\n";
+    return 0;
+}
@@ -0,0 +1,149 @@
+/**
+ * test_dry_run.cpp - Unit tests for the dry-run sandbox
+ *
+ * Skips when the kernel does not allow unprivileged user namespaces.
+ */
+
+#include "tt/DryRun.hpp"
+
+#include <cassert>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+namespace fs = std::filesystem;
+
+static fs::path tempDir() {
+    auto dir = fs::temp_directory_path() / "tt_test_dry_run";
+    fs::remove_all(dir);
+    fs::create_directories(dir / "sub");
+    fs::create_directories(dir / "gone");
+    return dir;
+}
+
+static void writeFile(const fs::path& path, const std::string& content) {
+    std::ofstream file(path);
+    file << content;
+}
+
+static std::string readFile(const fs::path& path) {
+    std::ifstream file(path);
+    std::stringstream content;
+    content << file.rdbuf();
+    return content.str();
+}
+
+static bool hasEffect(const tt::DryRunResult& result, const fs::path& path, tt::FileChange change) {
+    for (const auto& effect : result.effects) {
+        if (effect.path == path.string() && effect.change == change) return true;
+    }
+    return false;
+}
+
+static tt::DryRunOptions optionsFor(const fs::path& root) {
+    tt::DryRunOptions options;
+    options.roots.push_back(root.string());
+    options.timeout = std::chrono::milliseconds(2000);
+    return options;
+}
+
+bool test_file_effects() {
+    auto dir = tempDir();
+    writeFile(dir / "keep", "a\n");
+    writeFile(dir / "mod", "b\n");
+    writeFile(dir / "del", "c\n");
+    writeFile(dir / "gone" / "x", "d\n");
+    writeFile(dir / "opened", "e\n");
+
+    std::string command = "cd " + dir.string() + " && echo new > new && echo more >> mod && rm del && "
+                          "rm -rf gone && mkdir made && touch made/f sub/inner && exec 3<>opened && echo ok";
+    auto result = tt::dryRun(command, optionsFor(dir));
+    if (!result.ran) {
+        std::cout << "[SKIP] dry run unavailable: " << result.error << "\n";
+        return false;
+    }
+
+    assert(result.exit_status == 0);
+    assert(!result.timed_out);
+    assert(result.output == "ok\n");
+    assert(hasEffect(result, dir / "new", tt::FileChange::CREATED));
+    assert(hasEffect(result, dir / "mod", tt::FileChange::MODIFIED));
+    assert(hasEffect(result, dir / "del", tt::FileChange::DELETED));
+    assert(hasEffect(result, dir / "gone", tt::FileChange::DELETED));
+    assert(hasEffect(result, dir / "made", tt::FileChange::CREATED));
+    assert(hasEffect(result, dir / "made" / "f", tt::FileChange::CREATED));
+    assert(hasEffect(result, dir / "sub" / "inner", tt::FileChange::CREATED));
+    assert(result.effects.size() == 7);  // "opened" was copied up but not changed
+
+    // Nothing reached the real directory
+    assert(!fs::exists(dir / "new"));
+    assert(readFile(dir / "mod") == "b\n");
+    assert(fs::exists(dir / "del"));
+    assert(fs::exists(dir / "gone" / "x"));
+    assert(!fs::exists(dir / "made"));
+
+    std::cout << "[PASS] test_file_effects (setup " << result.setup_ms << " ms)\n";
+    return true;
+}
+
+void test_outside_roots_read_only() {
+    auto dir = tempDir();
+    auto outside = fs::current_path() / "tt_test_dry_run_outside";
+    fs::create_directories(outside);
+
+    auto result = tt::dryRun("touch " + (outside / "f").string() + " && echo wrote", optionsFor(dir / "sub"));
+    assert(result.ran);
+    assert(result.output.find("wrote") == std::string::npos);
+    assert(!fs::exists(outside / "f"));
+    assert(result.effects.empty());
+
+    // Only the loopback interface, and only the sandbox's own processes
+    result = tt::dryRun("grep -c : /proc/net/dev", optionsFor(dir));
+    assert(result.output == "1\n");
+    result = tt::dryRun("ls /proc | grep -c '^[0-9]'", optionsFor(dir));
+    assert(!result.output.empty() && std::stoi(result.output) <= 4);
+
+    fs::remove_all(outside);
+    std::cout << "[PASS] test_outside_roots_read_only\n";
+}
+
+void test_timeout_kills_everything() {
+    auto dir = tempDir();
+    auto options = optionsFor(dir);
+    options.timeout = std::chrono::milliseconds(200);
+
+    auto result = tt::dryRun("sleep 30 & echo started; sleep 30", options);
+    assert(result.ran);
+    assert(result.timed_out);
+    assert(result.exit_status == 128 + 9);
+    assert(result.output == "started\n");
+    assert(result.total_ms < 5000);
+
+    result = tt::dryRun("exit 3", optionsFor(dir));
+    assert(result.exit_status == 3 && !result.timed_out);
+
+    std::cout << "[PASS] test_timeout_kills_everything\n";
+}
+
+void test_bad_roots() {
+    assert(!tt::dryRun("true", optionsFor("/")).error.empty());
+    assert(!tt::dryRun("true", optionsFor("/proc/self")).error.empty());
+    assert(!tt::dryRun("true", optionsFor("/nonexistent/tt")).error.empty());
+    std::cout << "[PASS] test_bad_roots\n";
+}
+
+int main() {
+    std::cout << "Running DryRun tests...\n\n";
+
+    test_bad_roots();
+    if (test_file_effects()) {
+        test_outside_roots_read_only();
+        test_timeout_kills_everything();
+    }
+
+    std::filesystem::remove_all(std::filesystem::temp_directory_path() / "tt_test_dry_run");
+
+    std::cout << "\nAll tests passed!\n";
+    return 0;
+}
@@ -0,0 +1,144 @@
+/**
+ * test_history_analyzer.cpp - Unit tests for HistoryAnalyzer
+ */
+
+#include "tt/HistoryAnalyzer.hpp"
+
+#include <cassert>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+namespace fs = std::filesystem;
+
+static fs::path tempDir() {
+    auto dir = fs::temp_directory_path() / "tt_test_history";
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+    return dir;
+}
+
+static void writeFile(const fs::path& path, const std::string& content, bool append = false) {
+    std::ofstream file(path, append ? std::ios::app : std::ios::trunc);
+    file << content;
+}
+
+void test_bash_history_counts() {
+    auto dir = tempDir();
+    writeFile(dir / "bash", "#1700000000\nls -la\ngit status\nls -l /tmp | grep -v foo\nsudo apt install htop\n");
+    
+    tt::HistoryAnalyzer analyzer((dir / "stats.json").string());
+    auto scan = analyzer.update({{(dir / "bash").string(), tt::HistoryFormat::BASH}});
+    
+    assert(scan.files == 1);
+    assert(scan.new_entries == 4);
+    assert(analyzer.totalEntries() == 4);
+    assert(analyzer.executableCount("ls") == 2);
+    assert(analyzer.executableCount("grep") == 1);
+    assert(analyzer.flagCount("ls", "-la") == 1);
+    assert(analyzer.flagCount("grep", "-v") == 1);
+    assert(analyzer.topExecutables(1)[0].name == "ls");
+    
+    std::cout << "[PASS] test_bash_history_counts\n";
+}
+
+void test_zsh_and_fish_formats() {
+    auto dir = tempDir();
+    writeFile(dir / "zsh", ": 1700000000:0;docker ps -a\n: 1700000001:0;for f in *.txt; do\\\nmv $f backup/\\\ndone\n");
+    writeFile(dir / "fish", "- cmd: git log --oneline\n  when: 1700000000\n- cmd: echo a\\nls --color=auto\n  when: 1700000001\n  paths:\n    - a\n");
+    
+    tt::HistoryAnalyzer analyzer((dir / "stats.json").string());
+    analyzer.update({
+        {(dir / "zsh").string(), tt::HistoryFormat::ZSH},
+        {(dir / "fish").string(), tt::HistoryFormat::FISH}
+    });
+    
+    assert(analyzer.totalEntries() == 4);
+    assert(analyzer.flagCount("docker", "-a") == 1);
+    assert(analyzer.executableCount("mv") == 1);
+    assert(analyzer.executableCount("for") == 0);
+    assert(analyzer.executableCount("f") == 0);
+    assert(analyzer.flagCount("git", "--oneline") == 1);
+    assert(analyzer.flagCount("ls", "--color") == 1);
+    assert(analyzer.executableCount("when") == 0);
+    
+    std::cout << "[PASS] test_zsh_and_fish_formats\n";
+}
+
+void test_incremental_offsets() {
+    auto dir = tempDir();
+    auto history = (dir / "bash").string();
+    auto stats = (dir / "stats.json").string();
+    std::vector<tt::HistorySource> sources = {{history, tt::HistoryFormat::BASH}};
+    
+    writeFile(history, "ls\nls\ncat partial");
+    {
+        tt::HistoryAnalyzer analyzer(stats);
+        auto scan = analyzer.update(sources);
+        assert(scan.new_entries == 2);  // Unterminated last line waits
+    }
+    
+    writeFile(history, " file\npwd\n", true);
+    {
+        // Fresh instance: offsets come from the saved state
+        tt::HistoryAnalyzer analyzer(stats);
+        auto scan = analyzer.update(sources);
+        assert(scan.new_entries == 2);
+        assert(analyzer.executableCount("ls") == 2);
+        assert(analyzer.executableCount("cat") == 1);
+        assert(analyzer.totalEntries() == 4);
+        
+        scan = analyzer.update(sources);
+        assert(scan.new_entries == 0);
+    }
+    
+    // Rewritten (truncated by HISTSIZE): counted again from scratch
+    writeFile(history, "pwd\nwhoami\n");
+    {
+        tt::HistoryAnalyzer analyzer(stats);
+        auto scan = analyzer.update(sources);
+        assert(scan.rescanned_files == 1);
+        assert(analyzer.executableCount("ls") == 0);
+        assert(analyzer.totalEntries() == 2);
+    }
+    
+    std::cout << "[PASS] test_incremental_offsets\n";
+}
+
+void test_parallel_chunks_match_serial() {
+    auto dir = tempDir();
+    auto history = (dir / "zsh").string();
+    
+    // Large enough to be split across threads
+    std::string content;
+    for (int i = 0; i < 40000; ++i) {
+        content += ": 1700000000:0;git commit -m 'change " + std::to_string(i) + "'\n";
+        content += ": 1700000000:0;echo 'one\\\ntwo' && make -j4\n";
+    }
+    writeFile(history, content);
+    
+    tt::HistoryAnalyzer analyzer((dir / "stats.json").string());
+    analyzer.update({{history, tt::HistoryFormat::ZSH}});
+    
+    assert(analyzer.totalEntries() == 80000);
+    assert(analyzer.executableCount("git") == 40000);
+    assert(analyzer.executableCount("make") == 40000);
+    assert(analyzer.executableCount("two") == 0);
+    assert(analyzer.flagCount("make", "-j4") == 40000);
+    
+    std::cout << "[PASS] test_parallel_chunks_match_serial\n";
+}
+
+int main() {
+    std::cout << "Running HistoryAnalyzer tests...\n\n";
+    
+    test_bash_history_counts();
+    test_zsh_and_fish_formats();
+    test_incremental_offsets();
+    test_parallel_chunks_match_serial();
+    
+    std::filesystem::remove_all(std::filesystem::temp_directory_path() / "tt_test_history");
+    
+    std::cout << "\nAll tests passed!\n";
+    return 0;
+}
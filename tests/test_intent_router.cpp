@@ -0,0 +1,73 @@
+/**
+ * test_intent_router.cpp - Unit tests for the local intent router
+ */
+
+#include "tt/IntentRouter.hpp"
+
+#include <cassert>
+#include <cmath>
+#include <iostream>
+
+void test_routes_obvious_inputs() {
+    assert(tt::routeIntent("hello") == tt::Intent::EXPLAIN);
+    assert(tt::routeIntent("what is a pipe?") == tt::Intent::EXPLAIN);
+    assert(tt::routeIntent("ls -la") == tt::Intent::SHELL);
+    assert(tt::routeIntent("git log --oneline") == tt::Intent::SHELL);
+    assert(tt::routeIntent("find all pdf files in my home") == tt::Intent::TASK);
+    
+    std::cout << "[PASS] test_routes_obvious_inputs\n";
+}
+
+void test_unseen_inputs() {
+    // Not in the training corpus
+    assert(tt::scoreIntent("o que é um processo em background?").intent == tt::Intent::EXPLAIN);
+    assert(tt::scoreIntent("docker logs -f --tail 100 web").intent == tt::Intent::SHELL);
+    assert(tt::scoreIntent("mostre os arquivos modificados hoje").intent == tt::Intent::TASK);
+    assert(tt::scoreIntent("grep -c warning build.log | tee count.txt").intent == tt::Intent::SHELL);
+    
+    std::cout << "[PASS] test_unseen_inputs\n";
+}
+
+void test_scores_are_probabilities() {
+    auto score = tt::scoreIntent("how many files are in this folder");
+    float sum = 0.0f;
+    for (float p : score.probability) {
+        assert(p >= 0.0f && p <= 1.0f);
+        sum += p;
+    }
+    assert(std::fabs(sum - 1.0f) < 1e-4f);
+    assert(score.confidence == score.probability[static_cast<size_t>(score.intent)]);
+    
+    // Ambiguous input stays with the model when the bar is high enough
+    assert(!tt::routeIntent("nginx", 0.999f).has_value());
+    
+    std::cout << "[PASS] test_scores_are_probabilities\n";
+}
+
+void test_feature_extraction_is_bounded() {
+    tt::IntentFeatures features;
+    tt::extractIntentFeatures("", features);
+    assert(features.count > 0);  // Bias and shape features only
+    
+    std::string long_input;
+    for (int i = 0; i < 500; ++i) long_input += "word" + std::to_string(i) + " ";
+    tt::extractIntentFeatures(long_input, features);
+    assert(features.count == tt::IntentFeatures::MAX_FEATURES);
+    for (size_t i = 0; i < features.count; ++i) {
+        assert(features.index[i] < tt::INTENT_FEATURE_COUNT);
+    }
+    
+    std::cout << "[PASS] test_feature_extraction_is_bounded\n";
+}
+
+int main() {
+    std::cout << "Running IntentRouter tests...\n\n";
+    
+    test_routes_obvious_inputs();
+    test_unseen_inputs();
+    test_scores_are_probabilities();
+    test_feature_extraction_is_bounded();
+    
+    std::cout << "\nAll tests passed!\n";
+    return 0;
+}
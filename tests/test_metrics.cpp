@@ -0,0 +1,186 @@
+/**
+ * test_metrics.cpp - Unit tests for the metrics store and the --stats report
+ */
+
+#include "tt/Metrics.hpp"
+
+#include <cassert>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+namespace fs = std::filesystem;
+using namespace std::chrono_literals;
+
+namespace {
+
+const fs::path STORE_PATH = fs::temp_directory_path() / "tt_test_metrics" / "metrics.bin";
+
+tt::RequestMetrics request(tt::RequestMode mode, const std::string& model, double total_ms,
+                           std::chrono::system_clock::time_point time = std::chrono::system_clock::now()) {
+    tt::RequestMetrics metrics;
+    metrics.time = time;
+    metrics.mode = mode;
+    metrics.model = model;
+    metrics.total_ms = total_ms;
+    metrics.model_ms = total_ms / 2;
+    return metrics;
+}
+
+} // anonymous namespace
+
+void test_round_trip() {
+    fs::remove_all(STORE_PATH.parent_path());
+    tt::MetricsStore store(STORE_PATH.string());
+    assert(store.read().empty());
+
+    tt::RequestMetrics metrics = request(tt::RequestMode::WHATIF, "a-model-name-longer-than-the-record-holds", 1234.5);
+    metrics.first_byte_ms = 321;
+    metrics.input_tokens = 900;
+    metrics.output_tokens = 120;
+    metrics.cached_tokens = 800;
+    metrics.cache_hit = true;
+    metrics.error = true;
+    assert(store.append(metrics));
+    assert(fs::file_size(STORE_PATH) == 64);
+
+    auto records = store.read();
+    assert(records.size() == 1);
+    const auto& back = records[0];
+    assert(back.mode == tt::RequestMode::WHATIF);
+    assert(back.model == "a-model-name-longer-than-the");  // First 28 bytes
+    assert(back.total_ms == 1234.5 && back.model_ms == 617.25 && back.first_byte_ms == 321);
+    assert(back.input_tokens == 900 && back.output_tokens == 120 && back.cached_tokens == 800);
+    assert(back.cache_hit && back.error);
+    assert(std::chrono::abs(back.time - metrics.time) < 1ms);
+
+    std::cout << "[PASS] test_round_trip\n";
+}
+
+void test_window_and_partial_records() {
+    fs::remove_all(STORE_PATH.parent_path());
+    tt::MetricsStore store(STORE_PATH.string());
+    auto now = std::chrono::system_clock::now();
+    store.append(request(tt::RequestMode::RUN, "m", 100, now - 48h));
+    store.append(request(tt::RequestMode::RUN, "m", 200, now - 1h));
+
+    // A write cut short leaves a partial record, which is skipped
+    {
+        std::ofstream file(STORE_PATH, std::ios::binary | std::ios::app);
+        file << "partial";
+    }
+    assert(store.read().size() == 2);
+    auto recent = store.read(now - 24h);
+    assert(recent.size() == 1 && recent[0].total_ms == 200);
+
+    store.clear();
+    assert(store.read().empty());
+
+    std::cout << "[PASS] test_window_and_partial_records\n";
+}
+
+void test_rotation() {
+    fs::remove_all(STORE_PATH.parent_path());
+    fs::create_directories(STORE_PATH.parent_path());
+    // A full file moves aside on the next append and is still read
+    {
+        std::ofstream file(STORE_PATH, std::ios::binary);
+        std::string filler(tt::MetricsStore::MAX_FILE_BYTES, '\0');
+        file << filler;
+    }
+    tt::MetricsStore store(STORE_PATH.string());
+    assert(store.append(request(tt::RequestMode::QUERY, "m", 10)));
+    assert(fs::exists(STORE_PATH.string() + ".1"));
+    assert(fs::file_size(STORE_PATH) == 64);
+    assert(store.read().size() == 1);  // Zeroed records have no valid version
+
+    store.clear();
+    assert(!fs::exists(STORE_PATH.string() + ".1"));
+
+    std::cout << "[PASS] test_rotation\n";
+}
+
+void test_summarize() {
+    std::vector<tt::RequestMetrics> records;
+    for (int i = 1; i <= 100; ++i) {
+        auto metrics = request(tt::RequestMode::RUN, "flash", i * 10.0);
+        metrics.input_tokens = 10;
+        metrics.cached_tokens = 4;
+        metrics.output_tokens = 2;
+        metrics.cache_hit = i % 4 == 0;
+        metrics.error = i == 50;
+        records.push_back(metrics);
+    }
+    records.push_back(request(tt::RequestMode::EXPLAIN, "pro", 2000));
+    records.push_back(request(tt::RequestMode::EXPLAIN, "pro", 1000));
+
+    tt::MetricsReport report = tt::summarize(records);
+    assert(report.groups.size() == 2);
+    const auto& run = report.groups[0];
+    assert(run.mode == tt::RequestMode::RUN && run.model == "flash");
+    assert(run.requests == 100 && run.errors == 1 && run.cache_hits == 25);
+    assert(run.p50_ms == 500 && run.p95_ms == 950 && run.p99_ms == 990);
+    assert(run.input_tokens == 1000 && run.cached_tokens == 400 && run.output_tokens == 200);
+    assert(run.total_ms == 50500 && run.model_ms == 25250);
+
+    const auto& explain = report.groups[1];
+    assert(explain.mode == tt::RequestMode::EXPLAIN && explain.requests == 2);
+    assert(explain.p50_ms == 1000 && explain.p99_ms == 2000);
+
+    assert(report.all.requests == 102 && report.all.errors == 1);
+    assert(tt::summarize({}).groups.empty() && tt::summarize({}).all.p99_ms == 0);
+
+    std::cout << "[PASS] test_summarize\n";
+}
+
+void test_prometheus() {
+    std::vector<tt::RequestMetrics> records = {request(tt::RequestMode::RUN, "flash\"x", 1500)};
+    records[0].input_tokens = 42;
+    std::string text = tt::toPrometheus(tt::summarize(records));
+
+    assert(text.find("# TYPE tt_requests gauge\n") != std::string::npos);
+    assert(text.find("tt_requests{mode=\"run\",model=\"flash\\\"x\"} 1\n") != std::string::npos);
+    assert(text.find("tt_request_latency_seconds{mode=\"run\",model=\"flash\\\"x\",quantile=\"0.95\"} 1.5\n") !=
+           std::string::npos);
+    assert(text.find("tt_tokens{mode=\"run\",model=\"flash\\\"x\",type=\"input\"} 42\n") != std::string::npos);
+    assert(text.find("tt_model_seconds{mode=\"run\",model=\"flash\\\"x\"} 0.75\n") != std::string::npos);
+
+    // An empty window still declares its families
+    std::string empty = tt::toPrometheus(tt::summarize({}));
+    assert(empty.find("# TYPE tt_requests gauge") != std::string::npos);
+    assert(empty.find("tt_requests{") == std::string::npos);
+
+    std::cout << "[PASS] test_prometheus\n";
+}
+
+void test_parse_window() {
+    assert(tt::parseWindow("30m") == std::chrono::seconds(1800));
+    assert(tt::parseWindow("24h") == std::chrono::seconds(86400));
+    assert(tt::parseWindow("7d") == std::chrono::seconds(7 * 86400));
+    assert(tt::parseWindow("2w") == std::chrono::seconds(14 * 86400));
+    assert(tt::parseWindow("all") == std::chrono::seconds(0));
+    assert(!tt::parseWindow(""));
+    assert(!tt::parseWindow("d"));
+    assert(!tt::parseWindow("0d"));
+    assert(!tt::parseWindow("7x"));
+    assert(!tt::parseWindow("-1h"));
+    assert(!tt::parseWindow("99999999999d"));
+
+    std::cout << "[PASS] test_parse_window\n";
+}
+
+int main() {
+    std::cout << "Running Metrics tests...\n\n";
+
+    test_round_trip();
+    test_window_and_partial_records();
+    test_rotation();
+    test_summarize();
+    test_prometheus();
+    test_parse_window();
+
+    fs::remove_all(STORE_PATH.parent_path());
+    std::cout << "\nAll tests passed!\n";
+    return 0;
+}
@@ -0,0 +1,84 @@
+/**
+ * test_prompt_template.cpp - Unit tests for compile-time prompt templates
+ */
+
+#include "tt/PromptTemplate.hpp"
+
+#include <cassert>
+#include <iostream>
+#include <string>
+
+namespace {
+
+constexpr tt::PromptTemplate GREETING{"Say hello to {} in {}."};
+constexpr tt::PromptTemplate STATIC_ONLY{"No slots here."};
+
+static_assert(GREETING.slotCount() == 2);
+static_assert(GREETING.prefix() == "Say hello to ");
+static_assert(GREETING.staticSize() == std::string_view("Say hello to  in .").size());
+static_assert(STATIC_ONLY.slotCount() == 0 && STATIC_ONLY.prefix() == "No slots here.");
+
+const tt::PromptTemplate* const ALL[] = {
+    &tt::prompts::SMART_QUERY,     &tt::prompts::COMMAND_FOR_TASK,   &tt::prompts::COMMAND_ONLY,
+    &tt::prompts::SUGGEST_COMMAND, &tt::prompts::EXPLAIN_BRIEF,      &tt::prompts::ELI5_BRIEF,
+    &tt::prompts::SIMULATE_BRIEF,  &tt::prompts::EXPLAIN_NORMAL,     &tt::prompts::EXPLAIN_ELI5,
+    &tt::prompts::EXPLAIN_DETAILED, &tt::prompts::SUGGEST_FIX,       &tt::prompts::PREDICTION,
+};
+
+} // anonymous namespace
+
+void test_render() {
+    std::string out = "leftover from the previous prompt";
+    GREETING.render(out, {"Ana", "Portuguese"});
+    assert(out == "Say hello to Ana in Portuguese.");
+
+    // Missing values render empty, extra ones are ignored
+    assert(GREETING.render({"Ana"}) == "Say hello to Ana in .");
+    assert(GREETING.render({"a", "b", "c"}) == "Say hello to a in b.");
+    assert(STATIC_ONLY.render({}) == "No slots here.");
+
+    // The buffer keeps its capacity for the next prompt
+    out.reserve(4096);
+    size_t capacity = out.capacity();
+    GREETING.render(out, {"Bia", "Spanish"});
+    assert(out.capacity() == capacity);
+
+    std::cout << "[PASS] test_render\n";
+}
+
+void test_stable_prefixes() {
+    // Instructions come first: the request-specific text changes only the tail
+    for (const auto* prompt : ALL) {
+        assert(prompt->slotCount() >= 1);
+        assert(prompt->prefix().size() * 10 >= prompt->staticSize() * 8);
+        std::string a = prompt->render({"rm -rf build", "x", "y", "z"});
+        std::string b = prompt->render({"ls", "x", "y", "z"});
+        assert(a.compare(0, prompt->prefix().size(), prompt->prefix()) == 0);
+        assert(b.compare(0, prompt->prefix().size(), prompt->prefix()) == 0);
+    }
+
+    // The language is a slot, given by the caller, never fixed in the text
+    for (const auto* prompt : ALL) {
+        std::string text = prompt->render({"", "", "", ""});
+        assert(text.find("Portugues") == std::string::npos);
+        assert(text.find("English") == std::string::npos);
+    }
+    std::string fix = tt::prompts::SUGGEST_FIX.render({"Respond in English.", "gti status", "not found"});
+    assert(fix.find("Respond in English.") < fix.find("Comando que falhou: gti status"));
+
+    std::string smart = tt::prompts::SMART_QUERY.render({"Respond in English.", "hi there"});
+    assert(smart.rfind("User request: hi there") == smart.size() - 22);
+    assert(smart.find("Respond in English.") < smart.find("User request:"));
+
+    std::cout << "[PASS] test_stable_prefixes\n";
+}
+
+int main() {
+    std::cout << "Running PromptTemplate tests...\n\n";
+
+    test_render();
+    test_stable_prefixes();
+
+    std::cout << "\nAll tests passed!\n";
+    return 0;
+}
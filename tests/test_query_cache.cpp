@@ -0,0 +1,248 @@
+/**
+ * test_query_cache.cpp - Unit tests for QueryCache
+ */
+
+#include "tt/CaseFold.hpp"
+#include "tt/DangerCheck.hpp"
+#include "tt/QueryCache.hpp"
+#include "tt/QueryNormalizer.hpp"
+
+#include <cassert>
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+
+static std::string tempCachePath() {
+    auto path = std::filesystem::temp_directory_path() / "tt_test_query_cache.json";
+    std::filesystem::remove(path);
+    return path.string();
+}
+
+void test_near_duplicate_hit() {
+    tt::QueryCache cache(tempCachePath());
+    cache.store("find biggest files", "du -ah . | sort -rh | head -10", "Lists the largest files");
+    
+    auto hit = cache.lookup("find the largest files here");
+    
+    assert(hit.has_value());
+    assert(hit->command == "du -ah . | sort -rh | head -10");
+    assert(hit->matched_query == "find biggest files");
+    assert(hit->similarity >= tt::QueryCache::DEFAULT_THRESHOLD);
+    
+    std::cout << "[PASS] test_near_duplicate_hit\n";
+}
+
+void test_cross_language_hit() {
+    tt::QueryCache cache(tempCachePath());
+    cache.store("find biggest files", "du -ah . | sort -rh | head -10", "");
+    
+    auto hit = cache.lookup("achar maiores arquivos");
+    
+    assert(hit.has_value());
+    assert(hit->exact);
+    
+    std::cout << "[PASS] test_cross_language_hit\n";
+}
+
+void test_unrelated_miss() {
+    tt::QueryCache cache(tempCachePath());
+    cache.store("find biggest files", "du -ah . | sort -rh | head -10", "");
+    
+    assert(!cache.lookup("show listening ports").has_value());
+    
+    std::cout << "[PASS] test_unrelated_miss\n";
+}
+
+void test_literals_must_match() {
+    tt::QueryCache cache(tempCachePath());
+    cache.store("delete files in /tmp/build", "rm -r /tmp/build/*", "");
+    
+    assert(!cache.lookup("delete files in /tmp/other").has_value());
+    assert(cache.lookup("delete the files in /tmp/build").has_value());
+    
+    std::cout << "[PASS] test_literals_must_match\n";
+}
+
+void test_persistence_and_stats() {
+    std::string path = tempCachePath();
+    {
+        tt::QueryCache cache(path);
+        cache.store("list hidden files", "ls -a", "");
+    }
+    
+    tt::QueryCache reloaded(path);
+    assert(reloaded.lookup("listar arquivos ocultos").has_value());
+    assert(!reloaded.lookup("check disk usage").has_value());
+    
+    auto stats = reloaded.stats();
+    assert(stats.entries == 1);
+    assert(stats.lookups == 2);
+    assert(stats.hits == 1);
+    
+    std::filesystem::remove(path);
+    
+    std::cout << "[PASS] test_persistence_and_stats\n";
+}
+
+void test_scope_words_must_match() {
+    tt::QueryCache cache(tempCachePath());
+    cache.store("kill node processes", "pkill node", "");
+    cache.store("delete log files", "find . -name '*.log' -delete", "");
+    
+    assert(!cache.lookup("kill all node processes").has_value());
+    assert(!cache.lookup("kill every node process").has_value());
+    assert(!cache.lookup("delete old log files").has_value());
+    assert(!cache.lookup("delete log files except today").has_value());
+    assert(cache.lookup("please delete the log files").has_value());
+    
+    // The qualifier is part of the entry, whatever word spells it
+    cache.store("kill all node processes", "killall node", "");
+    auto hit = cache.lookup("kill every node process");
+    assert(hit.has_value() && hit->command == "killall node");
+    
+    std::cout << "[PASS] test_scope_words_must_match\n";
+}
+
+void test_destructive_needs_same_terms() {
+    tt::QueryCache cache(tempCachePath());
+    const std::string remove = "rm -rf build dist";
+    assert(tt::assessRisk(remove).severity > tt::Severity::LOW);
+    cache.store("remove build output directories", remove, "");
+    cache.store("list build output directories", "ls -d build dist", "");
+    
+    // 4 of 5 terms in common clears the threshold, but not for rm -rf
+    assert(!cache.lookup("remove generated build output directories").has_value());
+    auto same_terms = cache.lookup("remove the build output directories now");
+    assert(same_terms.has_value() && same_terms->command == remove);
+    
+    auto harmless = cache.lookup("list generated build output directories");
+    assert(harmless.has_value() && harmless->command == "ls -d build dist" && !harmless->exact);
+    
+    std::cout << "[PASS] test_destructive_needs_same_terms\n";
+}
+
+void test_save_is_atomic_and_skips_misses() {
+    std::string path = tempCachePath();
+    tt::QueryCache cache(path);
+    assert(!cache.lookup("list hidden files").has_value());
+    assert(!std::filesystem::exists(path));
+    
+    cache.store("list hidden files", "ls -a", "");
+    auto perms = std::filesystem::status(path).permissions();
+    assert((perms & std::filesystem::perms::all) ==
+           (std::filesystem::perms::owner_read | std::filesystem::perms::owner_write));
+    for (const auto& entry : std::filesystem::directory_iterator(std::filesystem::path(path).parent_path())) {
+        assert(entry.path().string().rfind(path + ".tmp", 0) != 0);
+    }
+    
+    // The miss counted before the store was written with it
+    tt::QueryCache reloaded(path);
+    assert(reloaded.stats().lookups == 1 && reloaded.stats().entries == 1);
+    std::filesystem::remove(path);
+    
+    std::cout << "[PASS] test_save_is_atomic_and_skips_misses\n";
+}
+
+void test_normalize_query() {
+    assert(tt::normalizeQuery("Como eu listo arquivos?") == "listo arquivos");
+    assert(tt::normalizeQuery("  como eu   listo\tarquivos ") == "listo arquivos");
+    assert(tt::normalizeQuery("¿Cómo puedo listar archivos?") == "listar archivos");
+    assert(tt::normalizeQuery("Please, how do I list files?!") == "list files");
+    
+    // Decomposed accents compose; Latin-1 capitals fold
+    assert(tt::normalizeQuery("Como faço para listar AÇÕES") == "listar ações");
+    assert(tt::normalizeQuery("como fac\u0327o para listar ac\u0327o\u0303es") == "listar ações");
+    
+    // Operands keep their bytes; only sentence punctuation is trimmed
+    assert(tt::normalizeQuery("Delete /tmp/Build.") == "delete /tmp/Build");
+    assert(tt::normalizeQuery("list files in .") == "list files in .");
+    assert(tt::normalizeQuery("grep for 'Hello World'") == "grep for \"Hello World\"");
+    assert(tt::normalizeQuery("find myFile") == "find myFile");
+    
+    // Nothing is stripped when only filler would remain
+    assert(tt::normalizeQuery("how to") == "how to");
+    
+    std::cout << "[PASS] test_normalize_query\n";
+}
+
+void test_query_key() {
+    assert(tt::queryKey("Como eu listo arquivos?") == tt::queryKey("como eu listo arquivos"));
+    assert(!(tt::queryKey("listo arquivos") == tt::queryKey("listo pastas")));
+    assert(tt::queryKey("listo arquivos") == tt::normalizedKey("listo arquivos"));
+    
+    // MurmurHash3 x64/128 reference values, so persisted keys stay valid
+    assert(tt::normalizedKey("").hex() == "00000000000000000000000000000000");
+    auto key = tt::normalizedKey("hello");
+    assert(key.lo == 0xcbd8a7b341bd9b02ULL && key.hi == 0x5b1e906a48ae1d19ULL);
+    assert(key.hex() == "5b1e906a48ae1d19cbd8a7b341bd9b02");
+    
+    std::cout << "[PASS] test_query_key\n";
+}
+
+void test_normalized_key_hit() {
+    tt::QueryCache cache(tempCachePath());
+    
+    // No canonical terms, so only the normalized key can match
+    cache.store("~/src/*.cpp", "ls ~/src/*.cpp", "");
+    auto hit = cache.lookup("~/src/*.cpp?");
+    assert(hit.has_value() && hit->exact);
+    assert(!cache.lookup("~/src/*.hpp").has_value());
+    
+    std::cout << "[PASS] test_normalized_key_hit\n";
+}
+
+void test_fold_case() {
+    assert(tt::foldCase("LS -LA /TMP") == "ls -la /tmp");
+    assert(tt::foldCase("AÇÕES Élan ŽIŽEK ĹŇ Ÿ") == "ações élan žižek ĺň ÿ");
+    assert(tt::foldCase("ΑΘΗΝΑ Άρης ПРИВЕТ ЁЖ") == "αθηνα άρης привет ёж");
+    
+    // Mappings that would change the byte length are left alone
+    assert(tt::foldCase("İß×ſ") == "İß×ſ");
+    assert(tt::foldCase("\xC3") == "\xC3");
+    assert(tt::foldCase("日本 ABC \xF0\x9F\x98\x80 É") == "日本 abc \xF0\x9F\x98\x80 é");
+    
+    // Non-ASCII bytes on both sides of the 16- and 8-byte block edges
+    std::string text;
+    std::string expected;
+    for (int i = 0; i < 40; ++i) {
+        text += (i % 7 == 3) ? "Ç" : "Q";
+        expected += (i % 7 == 3) ? "ç" : "q";
+    }
+    assert(tt::foldCase(text) == expected);
+    tt::foldCaseInPlace(text.data(), text.size());
+    assert(text == expected);
+    
+    assert(tt::asciiPrefixLength("abcdefghijklmnopqrstuvwxyzÉ") == 26);
+    assert(tt::asciiPrefixLength("plain ascii") == 11);
+    assert(tt::equalsFolded("RmDir", "rmdir"));
+    assert(tt::equalsFolded("AÇÃO", "ação"));
+    assert(!tt::equalsFolded("AÇÃO", "acao"));
+    
+    // Accent-stripping letter fold used by the keyword matchers
+    std::string_view word = "Ação";
+    assert(tt::foldLetter(word, 0).letter == 'a');
+    assert(tt::foldLetter(word, 1).letter == 'c' && tt::foldLetter(word, 1).length == 2);
+    assert(tt::foldLetter("-", 0).letter == 0);
+    
+    std::cout << "[PASS] test_fold_case\n";
+}
+
+int main() {
+    std::cout << "Running QueryCache tests...\n\n";
+    
+    test_near_duplicate_hit();
+    test_cross_language_hit();
+    test_unrelated_miss();
+    test_literals_must_match();
+    test_persistence_and_stats();
+    test_scope_words_must_match();
+    test_destructive_needs_same_terms();
+    test_save_is_atomic_and_skips_misses();
+    test_normalize_query();
+    test_query_key();
+    test_normalized_key_hit();
+    test_fold_case();
+    
+    std::cout << "\nAll tests passed!\n";
+    return 0;
+}
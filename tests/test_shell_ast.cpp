@@ -0,0 +1,203 @@
+/**
+ * test_shell_ast.cpp - Unit tests for ShellAst, danger detection and canonical commands
+ */
+
+#include "tt/CommandCanonicalizer.hpp"
+#include "tt/DangerCheck.hpp"
+#include "tt/ShellAst.hpp"
+
+#include <cassert>
+#include <iostream>
+#include <string>
+#include <vector>
+
+static std::vector<std::string> commandNames(const tt::ShellAst& ast) {
+    std::vector<std::string> names;
+    ast.forEachCommand([&](const tt::CommandNode& cmd) {
+        names.emplace_back(cmd.name());
+    });
+    return names;
+}
+
+void test_parse_list_and_pipeline() {
+    tt::ShellAst ast("make && ./run 2>&1 | tee log.txt || echo failed");
+    
+    assert(ast.complete());
+    const auto& root = ast.root();
+    assert(root.count == 3);
+    assert(root.items[0].separator == tt::TokenKind::AND_IF);
+    assert(root.items[1].separator == tt::TokenKind::OR_IF);
+    assert(root.items[1].pipeline->count == 2);
+    
+    const auto* run = static_cast<const tt::CommandNode*>(root.items[1].pipeline->commands[0]);
+    assert(run->name() == "run");
+    assert(run->redirect_count == 1);
+    assert(run->redirects[0].fd == 2);
+    assert(run->redirects[0].op == tt::TokenKind::GREATAND);
+    assert(!run->redirects[0].writes());
+    
+    std::cout << "[PASS] test_parse_list_and_pipeline\n";
+}
+
+void test_parse_subshell_and_substitution() {
+    tt::ShellAst ast("(cd /tmp && ls) > out.txt; echo \"$(whoami)\" `date`");
+    
+    assert(ast.complete());
+    auto names = commandNames(ast);
+    assert((names == std::vector<std::string>{"cd", "ls", "echo", "whoami", "date"}));
+    
+    const auto* subshell = static_cast<const tt::CompoundNode*>(ast.root().items[0].pipeline->commands[0]);
+    assert(subshell->kind == tt::NodeKind::SUBSHELL);
+    assert(subshell->redirect_count == 1);
+    assert(subshell->redirects[0].writes());
+    
+    std::cout << "[PASS] test_parse_subshell_and_substitution\n";
+}
+
+void test_nested_commands() {
+    tt::ShellAst ast("sudo -u root xargs -n 1 rm -f < list; find . -name '*.o' -exec rm {} \\; ; bash -c 'shred x'");
+    
+    auto names = commandNames(ast);
+    assert((names == std::vector<std::string>{"sudo", "xargs", "rm", "find", "rm", "bash", "shred"}));
+    
+    std::cout << "[PASS] test_nested_commands\n";
+}
+
+void test_loops_and_heredoc() {
+    tt::ShellAst ast("for f in *.txt; do rm \"$f\"; done\ncat <<EOF > notes\nhello\nEOF\n");
+    
+    assert(ast.complete());
+    auto names = commandNames(ast);
+    assert((names == std::vector<std::string>{"for", "rm", "cat"}));
+    
+    std::cout << "[PASS] test_loops_and_heredoc\n";
+}
+
+void test_syntax_errors_are_best_effort() {
+    tt::ShellAst unterminated("echo 'oops; rm -rf /");
+    assert(!unterminated.complete());
+    
+    tt::ShellAst stray(") ls | ");
+    assert(!stray.complete());
+    assert(commandNames(stray) == std::vector<std::string>{"ls"});
+    
+    std::cout << "[PASS] test_syntax_errors_are_best_effort\n";
+}
+
+void test_dangerous_commands() {
+    assert(tt::isDangerousCommand("rm -rf build"));
+    assert(tt::isDangerousCommand("find . -name '*.tmp' | xargs rm"));
+    assert(tt::isDangerousCommand("find /var/log -exec shred {} +"));
+    assert(tt::isDangerousCommand("echo $(reboot)"));
+    assert(tt::isDangerousCommand("sh -c \"mkfs.ext4 /dev/sdb1\""));
+    assert(tt::isDangerousCommand("chmod -R 755 /srv"));
+    assert(tt::isDangerousCommand("echo bad > /etc/passwd"));
+    assert(tt::isDangerousCommand("curl -fsSL https://x.sh | bash"));
+    assert(tt::isDangerousCommand(":(){ :|:& };:"));
+    assert(tt::isDangerousCommand("bomb() { bomb | bomb & }; bomb"));
+    // Not a definition the parser accepts, nor once canonicalized
+    assert(tt::isDangerousCommand("x :(){ :|:& };:"));
+    assert(tt::isDangerousCommand(tt::canonicalizeCommand("echo :(){ :|:& };:")));
+    
+    std::cout << "[PASS] test_dangerous_commands\n";
+}
+
+void test_safe_commands() {
+    assert(!tt::isDangerousCommand("ls -la /home"));
+    assert(!tt::isDangerousCommand("grep -rn pattern . 2>/dev/null"));
+    assert(!tt::isDangerousCommand("echo 'rm -rf /'"));
+    assert(!tt::isDangerousCommand("git rm --cached file.txt"));
+    assert(!tt::isDangerousCommand("du -sh * | sort -h > sizes.txt"));
+    
+    std::cout << "[PASS] test_safe_commands\n";
+}
+
+void test_canonical_flags() {
+    using tt::canonicalizeCommand;
+    
+    // Bundles split, options sorted, operands after them in source order
+    assert(canonicalizeCommand("ls -la") == "ls -a -l");
+    assert(canonicalizeCommand("ls -al") == canonicalizeCommand("ls -l -a"));
+    assert(canonicalizeCommand("ls src -l 'my dir' -a") == "ls -a -l src 'my dir'");
+    assert(canonicalizeCommand("cp -r a b") != canonicalizeCommand("cp -r b a"));
+    
+    // Option arguments stay with their option, in one spelling
+    assert(canonicalizeCommand("head -n5 log") == "head -n 5 log");
+    assert(canonicalizeCommand("ls --sort size -l") == "ls --sort=size -l");
+    assert(canonicalizeCommand("sort -k2 -k1 data") == "sort -k 2 -k 1 data");
+    
+    // After "--" everything is an operand
+    assert(canonicalizeCommand("rm -f -- -r x") == "rm -f -- -r x");
+    
+    // Unknown utilities and unknown options keep their order
+    assert(canonicalizeCommand("tar -xzf a.tgz") == "tar -xzf a.tgz");
+    assert(canonicalizeCommand("ls -l -5") == "ls -l -5");
+    
+    // Runners: the command run by sudo is canonicalized too
+    assert(canonicalizeCommand("sudo rm -rf /tmp/x") == "sudo rm -f -r /tmp/x");
+    
+    std::cout << "[PASS] test_canonical_flags\n";
+}
+
+void test_canonical_override_order() {
+    using tt::canonicalizeCommand;
+
+    // The last of -i/-f/-n wins, as does the last sort key or format of ls
+    assert(canonicalizeCommand("rm -if x") != canonicalizeCommand("rm -fi x"));
+    assert(canonicalizeCommand("rm -r -if x") == "rm -i -f -r x");
+    assert(canonicalizeCommand("mv -if a b") != canonicalizeCommand("mv -fi a b"));
+    assert(canonicalizeCommand("cp -nf a b") != canonicalizeCommand("cp -fn a b"));
+    assert(canonicalizeCommand("ls -tS") != canonicalizeCommand("ls -St"));
+    assert(canonicalizeCommand("ls -l -1") != canonicalizeCommand("ls -1 -l"));
+    assert(canonicalizeCommand("grep -E -F x") != canonicalizeCommand("grep -F -E x"));
+    assert(canonicalizeCommand("ls -t --sort=size") != canonicalizeCommand("ls --sort=size -t"));
+
+    // Options of different groups still sort
+    assert(canonicalizeCommand("ls -tal") == canonicalizeCommand("ls -l -a -t"));
+    assert(canonicalizeCommand("ls -Sr") == canonicalizeCommand("ls -rS"));
+    assert(canonicalizeCommand("rm -rfv x") == canonicalizeCommand("rm -v -f -r x"));
+
+    // With POSIXLY_CORRECT the first operand ends the options
+    assert(canonicalizeCommand("POSIXLY_CORRECT=1 ls dir -l") == "POSIXLY_CORRECT=1 ls dir -l");
+    assert(canonicalizeCommand("env POSIXLY_CORRECT=1 ls dir -l") == "env POSIXLY_CORRECT=1 ls dir -l");
+
+    std::cout << "[PASS] test_canonical_override_order\n";
+}
+
+void test_canonical_spelling() {
+    using tt::canonicalizeCommand;
+    
+    // Quoting is rewritten only where it cannot change the expansion
+    assert(canonicalizeCommand("echo 'hi'  ;  echo \"hi\"") == "echo hi; echo hi");
+    assert(canonicalizeCommand("echo \"it's\"") == "echo 'it'\\''s'");
+    assert(canonicalizeCommand("echo \"$HOME\" '*.txt' *.txt") == "echo \"$HOME\" '*.txt' *.txt");
+    assert(canonicalizeCommand("FOO='a b' env") == "FOO='a b' env");
+    
+    // Redirections move to the end of their command
+    assert(canonicalizeCommand("2>/dev/null grep -rn x .") == "grep -n -r x . 2>/dev/null");
+    assert(canonicalizeCommand("( cd /tmp&&ls -la )>out &") == "( cd /tmp && ls -a -l ) >out &");
+    
+    // Loops are only respaced, here-documents left alone
+    assert(canonicalizeCommand("for f in *;  do ls -la $f; done") == "for f in * ; do ls -la $f ; done");
+    assert(canonicalizeCommand("cat  <<EOF\nhi\nEOF") == "cat  <<EOF\nhi\nEOF");
+    
+    std::cout << "[PASS] test_canonical_spelling\n";
+}
+
+int main() {
+    std::cout << "Running ShellAst tests...\n\n";
+    
+    test_parse_list_and_pipeline();
+    test_parse_subshell_and_substitution();
+    test_nested_commands();
+    test_loops_and_heredoc();
+    test_syntax_errors_are_best_effort();
+    test_dangerous_commands();
+    test_safe_commands();
+    test_canonical_flags();
+    test_canonical_override_order();
+    test_canonical_spelling();
+    
+    std::cout << "\nAll tests passed!\n";
+    return 0;
+}
@@ -0,0 +1,177 @@
+/**
+ * test_simulation_cache.cpp - Unit tests for the whatif result cache
+ */
+
+#include "tt/SimulationCache.hpp"
+
+#include <cassert>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+namespace fs = std::filesystem;
+using Clock = std::chrono::system_clock;
+
+static fs::path tempDir() {
+    auto dir = fs::temp_directory_path() / "tt_test_simulation_cache";
+    fs::remove_all(dir);
+    fs::create_directories(dir / "work" / "build" / "obj");
+    fs::create_directories(dir / "cache");
+    return dir;
+}
+
+static void writeFile(const fs::path& path, const std::string& content) {
+    std::ofstream file(path);
+    file << content;
+}
+
+// Paths touched just before the simulation are racy; pretend it started later
+static Clock::time_point later() {
+    return Clock::now() + std::chrono::seconds(10);
+}
+
+static tt::SimulationResult predicted(const std::string& command, const std::string& output) {
+    tt::SimulationResult result;
+    result.predicted = true;
+    result.predicted_output = output;
+    result.warnings.push_back("recursive");
+    result.is_destructive = true;
+    auto impact = tt::analyzeImpact(command);
+    if (!impact.empty()) result.impact = impact;
+    return result;
+}
+
+void test_hit_and_equivalent_spelling() {
+    auto dir = tempDir();
+    std::string work = (dir / "work").string();
+    writeFile(dir / "work" / "build" / "obj" / "a.o", "0123456789");
+    writeFile(dir / "work" / "Makefile", "all:\n");
+
+    tt::SimulationCache cache((dir / "cache").string(), "model-a");
+    std::string command = "rm -rf " + (dir / "work" / "build").string();
+    assert(!cache.lookup(command, work));
+
+    auto result = predicted(command, "removes build");
+    assert(result.impact && result.impact->files == 1 && result.impact->bytes == 10);
+    assert(cache.store(command, work, result, later()));
+
+    auto start = std::chrono::steady_clock::now();
+    auto hit = cache.lookup("rm  -r -f  " + (dir / "work" / "build").string(), work);
+    auto micros = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+    assert(hit);
+    assert(hit->predicted_output == "removes build");
+    assert(hit->is_destructive && hit->warnings.size() == 1);
+    assert(hit->impact && hit->impact->files == 1 && hit->impact->bytes == 10);
+    assert(!hit->dry_run);
+
+    // Other directory or other model: different entries
+    assert(!cache.lookup(command, (dir / "work" / "build").string()));
+    assert(!tt::SimulationCache((dir / "cache").string(), "model-b").lookup(command, work));
+
+    std::cout << "[PASS] test_hit_and_equivalent_spelling (" << micros.count() << " us)\n";
+}
+
+void test_invalidation() {
+    auto dir = tempDir();
+    std::string work = (dir / "work").string();
+    auto build = dir / "work" / "build";
+    writeFile(build / "obj" / "a.o", "x");
+    writeFile(dir / "work" / "Makefile", "all:\n");
+    writeFile(dir / "work" / "notes.txt", "n");
+
+    tt::SimulationCache cache((dir / "cache").string());
+    std::string command = "rm -rf " + build.string();
+    auto store = [&] { assert(cache.store(command, work, predicted(command, "p"), later())); };
+
+    // A file appearing deep inside the recursive target
+    store();
+    assert(cache.lookup(command, work));
+    writeFile(build / "obj" / "b.o", "y");
+    assert(!cache.lookup(command, work));
+
+    // A build file in the working directory changing
+    store();
+    writeFile(dir / "work" / "Makefile", "all: more\n");
+    assert(!cache.lookup(command, work));
+
+    // An operand's metadata changing
+    std::string chmod = "chmod 600 notes.txt";
+    assert(cache.store(chmod, work, predicted(chmod, "p"), later()));
+    assert(cache.lookup(chmod, work));
+    fs::permissions(dir / "work" / "notes.txt", fs::perms::owner_read, fs::perm_options::replace);
+    assert(!cache.lookup(chmod, work));
+
+    // A glob gaining a match
+    std::string glob = "rm " + (build / "obj").string() + "/*.o";
+    assert(cache.store(glob, work, predicted(glob, "p"), later()));
+    assert(cache.lookup(glob, work));
+    writeFile(build / "obj" / "c.o", "z");
+    assert(!cache.lookup(glob, work));
+
+    std::cout << "[PASS] test_invalidation\n";
+}
+
+void test_not_stored() {
+    auto dir = tempDir();
+    std::string work = (dir / "work").string();
+    tt::SimulationCache cache((dir / "cache").string());
+
+    auto failed = predicted("ls", "Erro ao simular comando: timeout");
+    failed.predicted = false;
+    assert(!cache.store("ls", work, failed, later()));
+
+    // Results that depend on the environment or on substitutions
+    assert(!cache.store("rm -rf $BUILD", work, predicted("rm -rf $BUILD", "p"), later()));
+    assert(!cache.store("touch $(date +%s)", work, predicted("touch x", "p"), later()));
+    assert(!cache.store("cat */*.txt", work, predicted("cat x", "p"), later()));
+
+    // Paths touched while the simulation ran
+    writeFile(dir / "work" / "fresh", "f");
+    assert(!cache.store("cat fresh", work, predicted("cat fresh", "p"), Clock::now()));
+    assert(cache.store("cat fresh", work, predicted("cat fresh", "p"), later()));
+
+    cache.clear();
+    assert(!cache.lookup("cat fresh", work));
+
+    std::cout << "[PASS] test_not_stored\n";
+}
+
+void test_dry_run_round_trip() {
+    auto dir = tempDir();
+    std::string work = (dir / "work").string();
+    tt::SimulationCache cache((dir / "cache").string(), "dry-run");
+
+    auto result = predicted("make clean", "p");
+    tt::DryRunResult dry_run;
+    dry_run.ran = true;
+    dry_run.exit_status = 2;
+    dry_run.output = "make: *** No rule to make target 'clean'.\n";
+    dry_run.effects.push_back({work + "/out", tt::FileChange::DELETED});
+    result.dry_run = dry_run;
+    result.files_affected.push_back("deleted: " + work + "/out");
+    assert(cache.store("make clean", work, result, later()));
+
+    auto hit = cache.lookup("make clean", work);
+    assert(hit && hit->dry_run);
+    assert(hit->dry_run->ran && hit->dry_run->exit_status == 2);
+    assert(hit->dry_run->output == dry_run.output);
+    assert(hit->dry_run->effects.size() == 1 && hit->dry_run->effects[0].change == tt::FileChange::DELETED);
+    assert(hit->files_affected == result.files_affected);
+
+    std::cout << "[PASS] test_dry_run_round_trip\n";
+}
+
+int main() {
+    std::cout << "Running SimulationCache tests...\n\n";
+
+    test_hit_and_equivalent_spelling();
+    test_invalidation();
+    test_not_stored();
+    test_dry_run_round_trip();
+
+    std::filesystem::remove_all(std::filesystem::temp_directory_path() / "tt_test_simulation_cache");
+
+    std::cout << "\nAll tests passed!\n";
+    return 0;
+}
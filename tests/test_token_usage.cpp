@@ -0,0 +1,131 @@
+/**
+ * test_token_usage.cpp - Unit tests for usageMetadata parsing and the token ledger
+ */
+
+#include "tt/TokenUsage.hpp"
+
+#include <cassert>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include <nlohmann/json.hpp>
+
+namespace fs = std::filesystem;
+using json = nlohmann::json;
+using namespace std::chrono_literals;
+
+namespace {
+
+const fs::path LEDGER_PATH = fs::temp_directory_path() / "tt_test_usage" / "usage.json";
+
+tt::TokenUsage usage(uint32_t prompt, uint32_t candidates, uint32_t cached = 0, uint32_t thoughts = 0) {
+    tt::TokenUsage out;
+    out.prompt = prompt;
+    out.candidates = candidates;
+    out.cached = cached;
+    out.thoughts = thoughts;
+    return out;
+}
+
+} // anonymous namespace
+
+void test_usage_metadata() {
+    // As sent with a response, or with the last event of a stream
+    auto full = tt::fromUsageMetadata(json::parse(R"({
+        "promptTokenCount": 1200, "candidatesTokenCount": 85, "cachedContentTokenCount": 1024,
+        "thoughtsTokenCount": 40, "totalTokenCount": 1325,
+        "promptTokensDetails": [{"modality": "TEXT", "tokenCount": 1200}]
+    })"));
+    assert(full.prompt == 1200 && full.candidates == 85 && full.cached == 1024 && full.thoughts == 40);
+    assert(full.output() == 125 && !full.empty());
+
+    // Earlier stream events carry only the prompt; other fields are optional
+    auto partial = tt::fromUsageMetadata(json::parse(R"({"promptTokenCount": 7})"));
+    assert(partial.prompt == 7 && partial.candidates == 0 && partial.cached == 0 && partial.thoughts == 0);
+
+    assert(tt::fromUsageMetadata(json::parse("null")).empty());
+    assert(tt::fromUsageMetadata(json::parse(R"({"promptTokenCount": "12"})")).empty());
+    assert(tt::fromUsageMetadata(json::parse(R"({"promptTokenCount": -3})")).empty());
+
+    std::cout << "[PASS] test_usage_metadata\n";
+}
+
+void test_ledger_days_and_sessions() {
+    fs::remove_all(LEDGER_PATH.parent_path());
+    tt::TokenLedger ledger(LEDGER_PATH.string());
+    assert(ledger.days().empty() && !ledger.session("proj"));
+
+    auto now = std::chrono::system_clock::now();
+    ledger.add(usage(100, 10, 80), "", now - 24h);
+    ledger.add(usage(200, 20, 0, 5), "proj", now);
+    ledger.add(usage(300, 30, 250), "proj", now);
+    ledger.add(tt::TokenUsage{}, "proj", now);  // Failed requests report nothing
+
+    auto days = ledger.days();
+    assert(days.size() == 2);
+    assert(days[0].first < days[1].first);
+    assert(days[0].second.requests == 1 && days[0].second.prompt == 100 && days[0].second.cached == 80);
+    const auto& today = days[1].second;
+    assert(today.requests == 2 && today.prompt == 500 && today.candidates == 50 && today.thoughts == 5);
+    assert(today.cached == 250 && today.last_prompt == 300);
+
+    auto session = ledger.session("proj");
+    assert(session && session->requests == 2 && session->prompt == 500 && session->last_prompt == 300);
+    assert(!ledger.session(""));
+
+    // Another process sees the same totals
+    assert(tt::TokenLedger(LEDGER_PATH.string()).session("proj")->prompt == 500);
+
+    ledger.forgetSession("proj");
+    assert(!ledger.session("proj"));
+    assert(ledger.days().size() == 2);
+
+    ledger.clear();
+    assert(ledger.days().empty());
+
+    std::cout << "[PASS] test_ledger_days_and_sessions\n";
+}
+
+void test_ledger_keeps_recent_days() {
+    fs::remove_all(LEDGER_PATH.parent_path());
+    tt::TokenLedger ledger(LEDGER_PATH.string());
+    auto now = std::chrono::system_clock::now();
+    for (int day = 100; day >= 0; --day) {
+        ledger.add(usage(day + 1, 1), "", now - std::chrono::hours(24 * day));
+    }
+    auto days = ledger.days();
+    assert(days.size() == tt::TokenLedger::MAX_DAYS);
+    assert(days.back().second.prompt == 1);  // Today survived, the oldest went
+
+    std::cout << "[PASS] test_ledger_keeps_recent_days\n";
+}
+
+void test_corrupt_ledger() {
+    fs::remove_all(LEDGER_PATH.parent_path());
+    fs::create_directories(LEDGER_PATH.parent_path());
+    {
+        std::ofstream file(LEDGER_PATH);
+        file << "{not json";
+    }
+    tt::TokenLedger ledger(LEDGER_PATH.string());
+    assert(ledger.days().empty());
+    ledger.add(usage(5, 1));
+    assert(ledger.days().size() == 1);
+
+    std::cout << "[PASS] test_corrupt_ledger\n";
+}
+
+int main() {
+    std::cout << "Running TokenUsage tests...\n\n";
+
+    test_usage_metadata();
+    test_ledger_days_and_sessions();
+    test_ledger_keeps_recent_days();
+    test_corrupt_ledger();
+
+    fs::remove_all(LEDGER_PATH.parent_path());
+    std::cout << "\nAll tests passed!\n";
+    return 0;
+}
@@ -0,0 +1,124 @@
+/**
+ * test_trace.cpp - Unit tests for latency spans and the Chrome trace writer
+ */
+
+#include "tt/PromptTemplate.hpp"
+#include "tt/Trace.hpp"
+
+#include <cassert>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include <nlohmann/json.hpp>
+
+namespace fs = std::filesystem;
+using json = nlohmann::json;
+
+namespace {
+
+const fs::path TRACE_PATH = fs::temp_directory_path() / "tt_test_trace.json";
+
+json readTrace() {
+    assert(tt::trace::flush());
+    std::ifstream file(TRACE_PATH);
+    json trace = json::parse(file);
+    assert(trace.contains("traceEvents") && trace["traceEvents"].is_array());
+    return trace;
+}
+
+// Complete events with this name
+std::vector<json> spans(const json& trace, const std::string& name) {
+    std::vector<json> out;
+    for (const auto& event : trace["traceEvents"]) {
+        if (event["ph"] == "X" && event["name"] == name) out.push_back(event);
+    }
+    return out;
+}
+
+} // anonymous namespace
+
+void test_disabled() {
+    // Nothing is recorded or written before start()
+    assert(!tt::trace::enabled());
+    {
+        tt::trace::Span span("never", "test");
+        span.arg("key", "value");
+        span.arg("count", int64_t{3});
+    }
+    tt::trace::record("never", "test", 0, 10);
+    assert(!tt::trace::flush());
+
+    std::cout << "[PASS] test_disabled\n";
+}
+
+void test_spans() {
+    fs::remove(TRACE_PATH);
+    tt::trace::start(TRACE_PATH.string());
+    assert(tt::trace::enabled());
+
+    {
+        tt::trace::Span outer("outer", "test");
+        outer.arg("mode", "run \"quoted\"\n");
+        outer.arg("bytes", int64_t{1234});
+        tt::trace::Span inner("inner", "test");
+    }
+    tt::trace::record("phase", "http", 100, 250, "\"status\":200");
+    tt::trace::record("negative", "http", 100, -5);
+
+    json trace = readTrace();
+    auto outer = spans(trace, "outer");
+    auto inner = spans(trace, "inner");
+    assert(outer.size() == 1 && inner.size() == 1);
+    assert(outer[0]["cat"] == "test");
+    assert(outer[0]["args"]["mode"] == "run \"quoted\"\n");
+    assert(outer[0]["args"]["bytes"] == 1234);
+    assert(!inner[0].contains("args"));
+
+    // The inner span lies within the outer one, on the same thread
+    int64_t outer_start = outer[0]["ts"], outer_dur = outer[0]["dur"];
+    int64_t inner_start = inner[0]["ts"], inner_dur = inner[0]["dur"];
+    assert(inner_start >= outer_start && inner_start + inner_dur <= outer_start + outer_dur);
+    assert(outer[0]["tid"] == inner[0]["tid"] && outer[0]["pid"] == inner[0]["pid"]);
+
+    auto phase = spans(trace, "phase");
+    assert(phase.size() == 1 && phase[0]["ts"] == 100 && phase[0]["dur"] == 250);
+    assert(phase[0]["args"]["status"] == 200);
+    assert(spans(trace, "negative")[0]["dur"] == 0);
+
+    // The process is named for the viewer
+    bool named = false;
+    for (const auto& event : trace["traceEvents"]) {
+        if (event["ph"] == "M" && event["args"]["name"] == "tt") named = true;
+    }
+    assert(named);
+
+    std::cout << "[PASS] test_spans\n";
+}
+
+void test_prompt_build() {
+    // Rendering a prompt template is one span, with the prompt size
+    std::string prompt = tt::prompts::COMMAND_ONLY.render({"list files"});
+    json trace = readTrace();
+    auto builds = spans(trace, "prompt.build");
+    assert(!builds.empty());
+    assert(builds.back()["args"]["bytes"] == static_cast<int64_t>(prompt.size()));
+
+    std::cout << "[PASS] test_prompt_build\n";
+}
+
+int main() {
+    std::cout << "Running Trace tests...\n\n";
+
+    test_disabled();
+    test_spans();
+    test_prompt_build();
+
+    // Written once more, then nothing is left for the exit hook
+    assert(tt::trace::stop());
+    assert(!tt::trace::enabled());
+    fs::remove(TRACE_PATH);
+    std::cout << "\nAll tests passed!\n";
+    return 0;
+}
@@ -0,0 +1,260 @@
+/**
+ * train_intent.cpp - Train and evaluate the local intent router
+ *
+ *   train_intent <corpus.tsv> <IntentWeights.inc>
+ *       Report 5-fold cross-validated accuracy, then train on the whole
+ *       corpus and write the weight table compiled into tt_core.
+ *
+ *   train_intent --eval <corpus.tsv> [min_confidence]
+ *       Score the weights compiled into this binary: accuracy, confusion
+ *       matrix, how many inputs would skip smartQuery and how many of those
+ *       are routed correctly, and the cost of one scoreIntent call.
+ *
+ * Model: multinomial logistic regression over extractIntentFeatures(),
+ * trained with SGD and L2 on the features each example touches.
+ */
+
+#include "tt/IntentRouter.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct Example {
+    tt::Intent label;
+    std::string text;
+};
+
+using Weights = std::vector<std::array<float, tt::INTENT_COUNT>>;
+
+constexpr int EPOCHS = 40;
+constexpr float LEARNING_RATE = 0.2f;
+constexpr float L2 = 1e-4f;
+constexpr int FOLDS = 5;
+
+bool parseLabel(const std::string& name, tt::Intent& out) {
+    for (size_t c = 0; c < tt::INTENT_COUNT; ++c) {
+        if (name == tt::toString(static_cast<tt::Intent>(c))) {
+            out = static_cast<tt::Intent>(c);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool loadCorpus(const std::string& path, std::vector<Example>& out) {
+    std::ifstream file(path);
+    if (!file) {
+        std::cerr << "Cannot open " << path << "\n";
+        return false;
+    }
+
+    std::string line;
+    int line_no = 0;
+    while (std::getline(file, line)) {
+        ++line_no;
+        if (line.empty() || line[0] == '#') continue;
+        size_t tab = line.find('\t');
+        Example example;
+        if (tab == std::string::npos || !parseLabel(line.substr(0, tab), example.label)) {
+            std::cerr << path << ":" << line_no << ": expected <explain|task|shell><TAB><input>\n";
+            return false;
+        }
+        example.text = line.substr(tab + 1);
+        out.push_back(std::move(example));
+    }
+    return true;
+}
+
+void softmax(const float* logits, float* out) {
+    float max_logit = *std::max_element(logits, logits + tt::INTENT_COUNT);
+    float sum = 0.0f;
+    for (size_t c = 0; c < tt::INTENT_COUNT; ++c) {
+        out[c] = std::exp(logits[c] - max_logit);
+        sum += out[c];
+    }
+    for (size_t c = 0; c < tt::INTENT_COUNT; ++c) out[c] /= sum;
+}
+
+void predict(const Weights& weights, const tt::IntentFeatures& features, float* probability) {
+    float logits[tt::INTENT_COUNT] = {};
+    for (size_t i = 0; i < features.count; ++i) {
+        for (size_t c = 0; c < tt::INTENT_COUNT; ++c) logits[c] += weights[features.index[i]][c];
+    }
+    softmax(logits, probability);
+}
+
+Weights train(const std::vector<Example>& examples) {
+    Weights weights(tt::INTENT_FEATURE_COUNT, std::array<float, tt::INTENT_COUNT>{});
+
+    std::vector<tt::IntentFeatures> features(examples.size());
+    for (size_t i = 0; i < examples.size(); ++i) {
+        tt::extractIntentFeatures(examples[i].text, features[i]);
+    }
+
+    std::vector<size_t> order(examples.size());
+    for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+    std::mt19937 rng(42);
+
+    for (int epoch = 0; epoch < EPOCHS; ++epoch) {
+        std::shuffle(order.begin(), order.end(), rng);
+        float rate = LEARNING_RATE / (1.0f + epoch * 0.1f);
+
+        for (size_t i : order) {
+            float probability[tt::INTENT_COUNT];
+            predict(weights, features[i], probability);
+
+            for (size_t c = 0; c < tt::INTENT_COUNT; ++c) {
+                float target = static_cast<size_t>(examples[i].label) == c ? 1.0f : 0.0f;
+                float gradient = probability[c] - target;
+                for (size_t f = 0; f < features[i].count; ++f) {
+                    float& w = weights[features[i].index[f]][c];
+                    w -= rate * (gradient + L2 * w);
+                }
+            }
+        }
+    }
+    return weights;
+}
+
+int crossValidate(const std::vector<Example>& examples) {
+    std::vector<Example> shuffled = examples;
+    std::mt19937 rng(7);
+    std::shuffle(shuffled.begin(), shuffled.end(), rng);
+
+    size_t correct = 0, routed = 0, routed_correct = 0;
+    for (int fold = 0; fold < FOLDS; ++fold) {
+        std::vector<Example> train_set, test_set;
+        for (size_t i = 0; i < shuffled.size(); ++i) {
+            (static_cast<int>(i % FOLDS) == fold ? test_set : train_set).push_back(shuffled[i]);
+        }
+
+        Weights weights = train(train_set);
+        for (const auto& example : test_set) {
+            tt::IntentFeatures features;
+            tt::extractIntentFeatures(example.text, features);
+            float probability[tt::INTENT_COUNT];
+            predict(weights, features, probability);
+            size_t best = std::max_element(probability, probability + tt::INTENT_COUNT) - probability;
+            bool right = best == static_cast<size_t>(example.label);
+            if (right) ++correct;
+            if (probability[best] >= tt::DEFAULT_ROUTE_CONFIDENCE) {
+                ++routed;
+                if (right) ++routed_correct;
+            }
+        }
+    }
+
+    double accuracy = 100.0 * correct / shuffled.size();
+    std::printf("%d-fold cross-validated accuracy: %.1f%% (%zu/%zu)\n",
+                FOLDS, accuracy, correct, shuffled.size());
+    std::printf("Held out, confidence >= %.2f: %.1f%% routed locally, %.1f%% of those correct\n",
+                tt::DEFAULT_ROUTE_CONFIDENCE, 100.0 * routed / shuffled.size(),
+                routed ? 100.0 * routed_correct / routed : 0.0);
+    return static_cast<int>(accuracy * 10 + 0.5);
+}
+
+bool writeWeights(const std::string& path, const Weights& weights, size_t examples, int cv_permille) {
+    std::ofstream out(path);
+    if (!out) {
+        std::cerr << "Cannot write " << path << "\n";
+        return false;
+    }
+
+    out << "// Generated by tools/train_intent.cpp from tools/intent_corpus.tsv - do not edit.\n"
+        << "// " << examples << " examples, " << FOLDS << "-fold cross-validated accuracy "
+        << cv_permille / 10 << "." << cv_permille % 10 << "%\n"
+        << "// Columns: explain, task, shell\n\n"
+        << "constexpr IntentWeight INTENT_WEIGHTS[] = {\n";
+
+    char line[96];
+    size_t written = 0;
+    for (size_t f = 0; f < weights.size(); ++f) {
+        const auto& row = weights[f];
+        if (std::fabs(row[0]) < 1e-4f && std::fabs(row[1]) < 1e-4f && std::fabs(row[2]) < 1e-4f) continue;
+        std::snprintf(line, sizeof(line), "    {%zu, {%.4ff, %.4ff, %.4ff}},\n", f, row[0], row[1], row[2]);
+        out << line;
+        ++written;
+    }
+    out << "};\n";
+
+    std::printf("Wrote %zu non-zero feature rows to %s\n", written, path.c_str());
+    return true;
+}
+
+int evaluate(const std::vector<Example>& examples, float min_confidence) {
+    size_t confusion[tt::INTENT_COUNT][tt::INTENT_COUNT] = {};
+    size_t correct = 0, routed = 0, routed_correct = 0;
+
+    for (const auto& example : examples) {
+        auto score = tt::scoreIntent(example.text);
+        size_t actual = static_cast<size_t>(example.label);
+        size_t predicted = static_cast<size_t>(score.intent);
+        ++confusion[actual][predicted];
+        if (actual == predicted) ++correct;
+        if (score.confidence >= min_confidence) {
+            ++routed;
+            if (actual == predicted) ++routed_correct;
+        }
+    }
+
+    std::printf("Accuracy: %.1f%% (%zu/%zu)\n\n", 100.0 * correct / examples.size(), correct, examples.size());
+    std::printf("%-10s %8s %8s %8s   (rows: label, columns: predicted)\n", "", "explain", "task", "shell");
+    for (size_t a = 0; a < tt::INTENT_COUNT; ++a) {
+        std::printf("%-10s %8zu %8zu %8zu\n", tt::toString(static_cast<tt::Intent>(a)),
+                    confusion[a][0], confusion[a][1], confusion[a][2]);
+    }
+
+    std::printf("\nAt confidence >= %.2f: %.1f%% routed locally, %.1f%% of those correct\n",
+                min_confidence, 100.0 * routed / examples.size(),
+                routed ? 100.0 * routed_correct / routed : 0.0);
+
+    // Latency of one scoreIntent call over the whole corpus
+    constexpr int ROUNDS = 200;
+    float sink = 0.0f;
+    auto start = std::chrono::steady_clock::now();
+    for (int round = 0; round < ROUNDS; ++round) {
+        for (const auto& example : examples) sink += tt::scoreIntent(example.text).confidence;
+    }
+    auto end = std::chrono::steady_clock::now();
+    double ns = std::chrono::duration<double, std::nano>(end - start).count() / (ROUNDS * examples.size());
+    std::printf("scoreIntent: %.0f ns per input (checksum %.1f)\n", ns, sink);
+    return 0;
+}
+
+void printUsage() {
+    std::cerr << "Usage: train_intent <corpus.tsv> <IntentWeights.inc>\n"
+              << "       train_intent --eval <corpus.tsv> [min_confidence]\n";
+}
+
+} // anonymous namespace
+
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        printUsage();
+        return 1;
+    }
+
+    std::string first = argv[1];
+    bool eval = first == "--eval";
+    std::vector<Example> examples;
+    if (!loadCorpus(eval ? argv[2] : first, examples) || examples.empty()) return 1;
+
+    if (eval) {
+        float min_confidence = argc > 3 ? std::stof(argv[3]) : tt::DEFAULT_ROUTE_CONFIDENCE;
+        return evaluate(examples, min_confidence);
+    }
+
+    int cv_permille = crossValidate(examples);
+    Weights weights = train(examples);
+    return writeWeights(argv[2], weights, examples.size(), cv_permille) ? 0 : 1;
+}